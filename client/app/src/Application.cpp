@@ -14,7 +14,16 @@
 #include <volk.h>
 #endif
 
+#include <BulkLoader.hpp>
 #include <Database.hpp>
+#include <IndexAdvisor.hpp>
+#include <PlanView.hpp>
+#include <QueryPlan.hpp>
+#include <RepricingWorker.hpp>
+#include <ResultExport.hpp>
+#include <ResultCursor.hpp>
+#include <ReportQueries.hpp>
+#include <ResultTable.hpp>
 
 namespace nsudb
 {
@@ -286,223 +295,30 @@ namespace nsudb
 
     }  // namespace ImGuiUtils
 
-    static int32_t s_SelectedQueryIndex                        = -1;
-    static const std::vector<std::string> s_HardcodedDbQueries = {
-        // 1
-        R"(SELECT b.outlet_id, o.address, ot.name AS outlet_type
-       FROM branches b
-       JOIN outlets o ON b.outlet_id = o.id
-       JOIN outlet_types ot ON o.type_id = ot.id;)",
-
-        R"(SELECT k.outlet_id, o.address, ot.name AS outlet_type, k.branch_id
-       FROM kiosks k
-       JOIN outlets o ON k.outlet_id = o.id
-       JOIN outlet_types ot ON o.type_id = ot.id;)",
-
-        R"(SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
-       FROM outlets o
-       JOIN outlet_types ot ON o.type_id = ot.id;)",
-
-        R"(SELECT COUNT(*) AS total_order_points FROM outlets;)",
-
-        // 2
-        R"(SELECT b.outlet_id AS branch_outlet_id,
-              COUNT(o.id) AS orders_count
-       FROM branches b
-       LEFT JOIN orders o ON o.outlet_id = b.outlet_id
-           AND o.accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp
-       GROUP BY b.outlet_id
-       ORDER BY b.outlet_id;)",
-
-        R"(SELECT k.outlet_id AS kiosk_outlet_id,
-              COUNT(o.id) AS orders_count
-       FROM kiosks k
-       LEFT JOIN orders o ON o.outlet_id = k.outlet_id
-           AND o.accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp
-       GROUP BY k.outlet_id
-       ORDER BY k.outlet_id;)",
-
-        R"(SELECT COUNT(*) AS total_orders
-       FROM orders
-       WHERE accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp;)",
-
-        // 3
-        R"(WITH filtered_orders AS (
-           SELECT o.*, so.service_type_id, so.count, so.id AS service_order_id
-           FROM orders o
-           LEFT JOIN service_orders so ON o.id = so.order_id
-           WHERE o.accept_time BETWEEN '2024-05-20 10:00:00' AND '2024-05-22 16:45:00'
-             AND o.outlet_id IN (1, 3)
-       )
-       SELECT fo.service_type_id,
-              st.name AS service_name,
-              fo.is_urgent,
-              COUNT(DISTINCT fo.id) AS orders_count
-       FROM filtered_orders fo
-       LEFT JOIN service_types st ON fo.service_type_id = st.id
-       GROUP BY fo.service_type_id, st.name, fo.is_urgent
-       ORDER BY st.name, fo.is_urgent;)",
-
-        // 4
-        R"(CREATE OR REPLACE VIEW filtered_orders AS
-       SELECT o.*
-       FROM orders o
-       WHERE o.accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp
-         AND (o.outlet_id = 1 OR o.outlet_id = 3);
-
-       CREATE OR REPLACE VIEW service_order_sums AS
-       SELECT o.is_urgent, so.service_type_id, SUM(o.overall_price) AS revenue
-       FROM filtered_orders o
-       JOIN service_orders so ON o.id = so.order_id
-       GROUP BY o.is_urgent, so.service_type_id;
-
-       SELECT sos.service_type_id,
-              st.name AS service_name,
-              sos.is_urgent,
-              sos.revenue
-       FROM service_order_sums sos
-       JOIN service_types st ON sos.service_type_id = st.id
-       ORDER BY st.name, sos.is_urgent;)",
-
-        // 5
-        R"(SELECT o.is_urgent, SUM(f.amount) AS total_printed_photos
-       FROM frames f
-       JOIN print_orders po ON f.print_order_id = po.id
-       JOIN orders o ON po.order_id = o.id
-       WHERE o.accept_time BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-         AND o.outlet_id IN (SELECT outlet_id FROM branches)
-       GROUP BY o.is_urgent;
-
-       SELECT o.is_urgent, SUM(f.amount) AS total_printed_photos
-       FROM frames f
-       JOIN print_orders po ON f.print_order_id = po.id
-       JOIN orders o ON po.order_id = o.id
-       WHERE o.accept_time BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-         AND o.outlet_id IN (SELECT outlet_id FROM kiosks)
-       GROUP BY o.is_urgent;
-
-       SELECT o.is_urgent, SUM(f.amount) AS total_printed_photos
-       FROM frames f
-       JOIN print_orders po ON f.print_order_id = po.id
-       JOIN orders o ON po.order_id = o.id
-       WHERE o.accept_time BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-       GROUP BY o.is_urgent;)",
-
-        // 6
-        R"(SELECT o.is_urgent, COUNT(f.id) AS total_films
-       FROM films f
-       JOIN service_orders so ON f.service_order_id = so.id
-       JOIN orders o ON o.id = so.order_id
-       WHERE o.accept_time BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-         AND o.outlet_id IN (SELECT outlet_id FROM branches WHERE outlet_id = 1)
-       GROUP BY o.is_urgent;
-
-       SELECT o.is_urgent, COUNT(f.id) AS total_films
-       FROM films f
-       JOIN service_orders so ON f.service_order_id = so.id
-       JOIN orders o ON o.id = so.order_id
-       WHERE o.accept_time BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-         AND o.outlet_id IN (SELECT outlet_id FROM kiosks WHERE outlet_id = 3)
-       GROUP BY o.is_urgent;)",
-
-        // 7
-        R"(SELECT DISTINCT v.id AS vendor_id, v.name AS vendor_name,
-                      i.id AS item_id, i.name AS item_name,
-                      di.quantity, di.price, d.date
-       FROM vendors v
-       JOIN deliveries d ON d.vendor_id = v.id
-       JOIN delivery_items di ON di.delivery_id = d.id
-       JOIN items i ON i.id = di.item_id
-       WHERE d.date BETWEEN '2024-01-01 10:00:00'::timestamp AND '2024-12-30 16:45:00'::timestamp
-         AND di.quantity >= 2
-       ORDER BY v.id;)",
-
-        // 8
-        R"(SELECT DISTINCT c.id AS client_id, c.full_name, c.discount,
-                      o.id AS order_id, o.overall_price, o.outlet_id
-       FROM clients c
-       JOIN orders o ON o.client_id = c.id
-       WHERE c.discount > 0
-         AND o.overall_price >= 5
-         AND o.outlet_id = 3
-       ORDER BY c.id;)",
-
-        // 9
-        R"(SELECT COALESCE(SUM(stni.count * i.price * so.count), 0) AS total_revenue
-       FROM orders o
-       JOIN service_orders so ON so.order_id = o.id
-       JOIN service_types_needed_items stni ON stni.service_type_id = so.service_type_id
-       JOIN items i ON i.id = stni.item_id
-       WHERE o.accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp
-         AND o.outlet_id = 1;)",
-
-        // 10
-        R"(WITH orders_in_branch AS (
-           SELECT o.id FROM orders o WHERE o.outlet_id = 1
-       ),
-       service_orders_in_branch AS (
-           SELECT so.* FROM service_orders so
-           JOIN orders_in_branch ob ON so.order_id = ob.id
-       ),
-       items_demand_in_branch AS (
-           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
-           FROM service_orders_in_branch so
-           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
-           GROUP BY stni.item_id
-       ),
-       items_demand_overall AS (
-           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
-           FROM service_orders so
-           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
-           GROUP BY stni.item_id
-       )
-       SELECT i.id AS item_id, i.name AS item_name, f.name AS firm_name,
-              COALESCE(d_branch.total_quantity, 0) AS demand_in_branch,
-              COALESCE(d_overall.total_quantity, 0) AS demand_overall
-       FROM items i
-       LEFT JOIN firms f ON i.firm_id = f.id
-       LEFT JOIN items_demand_in_branch d_branch ON i.id = d_branch.item_id
-       LEFT JOIN items_demand_overall d_overall ON i.id = d_overall.item_id
-       WHERE COALESCE(d_branch.total_quantity, 0) > 0 OR COALESCE(d_overall.total_quantity, 0) > 0
-       ORDER BY demand_overall DESC, demand_in_branch DESC;)",
-
-        // 11
-        R"(WITH filtered_orders AS (
-           SELECT o.id
-           FROM orders o
-           WHERE o.accept_time BETWEEN '2024-05-20 10:00:00'::timestamp AND '2024-05-22 16:45:00'::timestamp
-             AND o.outlet_id = 1
-       ),
-       service_orders_filtered AS (
-           SELECT so.*
-           FROM service_orders so
-           JOIN filtered_orders fo ON so.order_id = fo.id
-       ),
-       items_sold AS (
-           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
-           FROM service_orders_filtered so
-           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
-           GROUP BY stni.item_id
-       )
-       SELECT i.id AS item_id, i.name AS item_name, f.name AS firm_name,
-              COALESCE(items_sold.total_quantity, 0) AS quantity_sold
-       FROM items i
-       LEFT JOIN firms f ON i.firm_id = f.id
-       LEFT JOIN items_sold ON i.id = items_sold.item_id
-       WHERE items_sold.total_quantity IS NOT NULL
-       ORDER BY quantity_sold DESC;)",
-
-        // 12
-        R"(SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
-       FROM outlets o
-       JOIN outlet_types ot ON o.type_id = ot.id
-       ORDER BY o.id;
-
-       SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
-       FROM outlets o
-       JOIN outlet_types ot ON o.type_id = ot.id
-       WHERE ot.name = 'kiosk'
-       ORDER BY o.id;)"};
+    static int32_t s_SelectedQueryIndex = -1;
+
+    // Indeterminate bar + elapsed time/rows, so it's obvious the frame loop is alive while the worker waits for the server.
+    static void DrawQueryProgress(const QueryTask& task) noexcept
+    {
+        char overlay[128]{};
+        if (task.GetStatus() == EQueryStatus::Pending)
+            snprintf(overlay, sizeof(overlay), "Queued...");
+        else
+            snprintf(overlay, sizeof(overlay), "Running %.2f s, %zu rows received", task.GetElapsedSeconds(), task.GetRowsReceived());
+
+        ImGui::ProgressBar(-1.0f * static_cast<float>(ImGui::GetTime()), ImVec2(-FLT_MIN, 0.0f), overlay);
+    }
+
+    static std::string QuoteIdentifier(std::string_view identifier) noexcept
+    {
+        std::string quoted{"\""};
+        for (const char c : identifier)
+        {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
 
     void Application::Run() noexcept
     {
@@ -514,13 +330,73 @@ namespace nsudb
         ImVec4 clear_color           = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
         // App state
-        std::optional<QueryResult> tableQueryResult{};
+        std::unique_ptr<ResultCursor> tableCursor{nullptr};  // pages the selected table on demand
+        ResultTable tableCursorGrid{};
+        bool bTablesFocused{false};  // TABLES pane focus last frame, its cursor is suspended when it goes
+        ResultTable sqlResultGrid{};
 
         char sqlQueryBuffer[8192] = "SELECT * FROM outlet_types";  // Query input buffer
-        std::optional<QueryResult> lastQueryResult{std::nullopt};  // Stores the last executed query result
+        std::shared_ptr<const QueryResult> lastQueryResult{nullptr};  // Stores the last executed query result
+        std::string lastQueryError{};
         std::vector<std::string> tableNames{};
         uint32_t selectedTableIndex{};
 
+        // In-flight queries, polled every frame instead of blocking it.
+        QueryHandle sqlQueryTask{nullptr};
+        QueryHandle tableNamesTask{nullptr};
+        QueryHandle allReportsTask{nullptr};     // every report as one pipelined batch
+        QueryHandle rollupRefreshTask{nullptr};  // refresh_daily_rollups(), started next to the reports that read the rollups
+        std::unique_ptr<BulkLoader> bulkLoader{nullptr};
+        std::unique_ptr<RepricingWorker> repricingWorker{nullptr};
+        std::unique_ptr<IndexAdvisor> indexAdvisor{nullptr};
+        std::unique_ptr<QueryExporter> queryExporter{nullptr};
+        std::unique_ptr<QueryProfiler> queryProfiler{nullptr};
+        const auto ResetQueryTasks = [&]()
+        {
+            sqlQueryTask      = nullptr;
+            tableNamesTask    = nullptr;
+            allReportsTask    = nullptr;
+            rollupRefreshTask = nullptr;
+            tableCursor.reset();  // closes the server-side cursor, so it has to go before the connection
+            bulkLoader.reset();   // rolls a running import back
+            repricingWorker.reset();
+            indexAdvisor.reset();
+            queryExporter.reset();  // cancels a running export, the partial file is deleted
+            queryProfiler.reset();
+        };
+
+        // A short transaction of its own, reports don't wait for it. Skipped while the previous one still runs.
+        const auto StartRollupRefresh = [&]()
+        {
+            if (rollupRefreshTask && !rollupRefreshTask->IsFinished()) return;
+            if (rollupRefreshTask && rollupRefreshTask->GetStatus() == EQueryStatus::Failed)
+                LOG_WARN("Rollup refresh failed: {}", rollupRefreshTask->GetError());
+
+            rollupRefreshTask = m_DbConn->ExecuteAsync(std::string(s_RefreshRollupsSql));
+        };
+
+        char importPathBuffer[512] = "database/data";
+        bool bDeferImportTriggers  = true;
+
+        static constexpr const char* s_ExportFormatNames[] = {"CSV", "Columnar"};
+        static constexpr const char* s_ExportSourceNames[] = {"Loaded SQL result", "SQL query (streamed)", "Selected table (streamed)"};
+        char exportPathBuffer[512] = "exports/result.csv";
+        int32_t exportFormatIndex{0};
+        int32_t exportSourceIndex{0};
+
+        int32_t repricingBatchSize = RepricingWorkerDesc::s_DefaultBatchSize;
+        bool bFollowRepricingQueue = false;
+
+        int advisorMinScannedRows = static_cast<int>(IndexAdvisorDesc::s_DefaultMinScannedRows);
+
+        std::vector<std::string> allReportsTitles{};  // in batch order, taken when the run starts
+        std::vector<BatchResult> allReportsResults{};
+        std::vector<ResultTable> allReportsGrids{};
+        std::string allReportsError{};
+        float allReportsSeconds{0.0f};
+
+        char statsDumpPathBuffer[512] = "logs/query_stats.json";
+
         constexpr const char* queryTableNames = "SELECT tablename\n"
                                                 "FROM pg_tables\n"
                                                 "WHERE schemaname = 'public'\n"
@@ -531,9 +407,18 @@ namespace nsudb
         dbDesc.Database.resize(32, 0);
         dbDesc.Username.resize(32, 0);
         dbDesc.Password.resize(32, 0);
-
-        static bool s_bShowDbConnWindow      = true;  // On startup we have to enter db options first.
-        static bool s_bShowAppSettingsWindow = false;
+        ConnectionPoolDesc poolDesc = {};
+        uint32_t resultCacheMiB     = ResultCacheDesc::s_DefaultMemoryBudget >> 20;
+
+        static bool s_bShowDbConnWindow       = true;  // On startup we have to enter db options first.
+        static bool s_bShowAppSettingsWindow  = false;
+        static bool s_bShowImportWindow       = false;
+        static bool s_bShowExportWindow       = false;
+        static bool s_bShowRepricingWindow    = false;
+        static bool s_bShowIndexAdvisorWindow = false;
+        static bool s_bShowAllReportsWindow   = false;
+        static bool s_bShowPerformanceWindow  = false;
+        static bool s_bShowProfileWindow      = false;
 
         // Main loop
         while (!glfwWindowShouldClose(m_Window))
@@ -619,12 +504,18 @@ namespace nsudb
 
                         if (ImGui::MenuItem("Close Database"))
                         {
-                            tableQueryResult   = {};
                             selectedTableIndex = {};
                             tableNames.clear();
+                            ResetQueryTasks();
                             m_DbConn.reset();
                         }
 
+                        if (ImGui::MenuItem("Import CSV...", nullptr, false, m_DbConn != nullptr)) s_bShowImportWindow = true;
+                        if (ImGui::MenuItem("Export...")) s_bShowExportWindow = true;
+                        if (ImGui::MenuItem("Repricing Queue...", nullptr, false, m_DbConn != nullptr)) s_bShowRepricingWindow = true;
+                        if (ImGui::MenuItem("Index Advisor...", nullptr, false, m_DbConn != nullptr)) s_bShowIndexAdvisorWindow = true;
+                        if (ImGui::MenuItem("Performance...", nullptr, false, m_DbConn != nullptr)) s_bShowPerformanceWindow = true;
+                        if (ImGui::MenuItem("Query Profile...", nullptr, false, m_DbConn != nullptr)) s_bShowProfileWindow = true;
                         if (ImGui::MenuItem("Open Settings")) s_bShowAppSettingsWindow = true;
 
                         ImGui::Separator();
@@ -655,6 +546,9 @@ namespace nsudb
                         ImGui::InputText("Password", dbDesc.Password.data(), dbDesc.Password.size(),
                                          ImGuiInputTextFlags_Password);  // Password field
                         ImGui::InputInt("Port", &dbDesc.Port);
+                        ImGui::InputScalar("Min connections", ImGuiDataType_U32, &poolDesc.MinConnections);
+                        ImGui::InputScalar("Max connections", ImGuiDataType_U32, &poolDesc.MaxConnections);
+                        ImGui::InputScalar("Result cache, MiB (0 - off)", ImGuiDataType_U32, &resultCacheMiB);
                         ImGui::Separator();
 
                         // --- Calculate button size dynamically ---
@@ -671,7 +565,9 @@ namespace nsudb
 
                         if (ImGui::Button("Connect", ImVec2(button_width, 0)))
                         {
-                            m_DbConn = std::make_unique<DatabaseConnection>(dbDesc);
+                            ResetQueryTasks();
+                            m_DbConn = std::make_unique<DatabaseConnection>(
+                                dbDesc, poolDesc, ResultCacheDesc{.MemoryBudget = static_cast<std::size_t>(resultCacheMiB) << 20});
                             if (!m_DbConn->TryConnectIfNotConnected()) m_DbConn.reset();
 
                             LOG_TRACE("Attempting to connect to database:");
@@ -714,10 +610,429 @@ namespace nsudb
                     {
                         ImGui::SliderFloat("Font Scale", &io.FontGlobalScale, 1.0f, 20.0f);
 
+                        uint32_t querySampleRate   = Logger::GetQuerySampleRate();
+                        uint64_t maxLoggedQueryLen = Logger::GetMaxQueryLength();
+                        const bool bSamplingChanged =
+                            ImGui::InputScalar("Log every Nth query (0 - none)", ImGuiDataType_U32, &querySampleRate) |
+                            ImGui::InputScalar("Max logged query length (0 - full)", ImGuiDataType_U64, &maxLoggedQueryLen);
+                        if (bSamplingChanged) Logger::SetQuerySampling(querySampleRate, maxLoggedQueryLen);
+
                         ImGui::EndPopup();
                     }
                 }
 
+                // Bulk import, COPY runs on its own thread and connection, the window only polls progress.
+                if (s_bShowImportWindow)
+                {
+                    if (ImGui::Begin("Import CSV", &s_bShowImportWindow))
+                    {
+                        ImGui::InputText("File or directory", importPathBuffer, sizeof(importPathBuffer));
+                        ImGui::Checkbox("Defer price/storage triggers, recompute once after the load", &bDeferImportTriggers);
+
+                        const bool bImportRunning = bulkLoader && !bulkLoader->IsFinished();
+                        if (m_DbConn && !bImportRunning && ImGui::Button("Import"))
+                        {
+                            BulkLoadDesc loadDesc{};
+                            loadDesc.Paths.emplace_back(importPathBuffer);
+                            loadDesc.bDeferTriggers = bDeferImportTriggers;
+                            bulkLoader              = std::make_unique<BulkLoader>(*m_DbConn, std::move(loadDesc));
+                        }
+
+                        if (bImportRunning)
+                        {
+                            if (ImGui::Button("Cancel Import")) bulkLoader->Cancel();
+
+                            char overlay[192]{};
+                            const float elapsedSeconds = bulkLoader->GetElapsedSeconds();
+                            const double mibPerSecond =
+                                static_cast<double>(bulkLoader->GetBytesSent()) / (1024.0 * 1024.0) / std::max(elapsedSeconds, 0.001f);
+                            if (bulkLoader->IsRecomputing())
+                                snprintf(overlay, sizeof(overlay), "Recomputing prices and storage, %.1f s", elapsedSeconds);
+                            else
+                                snprintf(overlay, sizeof(overlay), "%s (%zu/%zu), %llu rows, %.1f MiB/s",
+                                         bulkLoader->GetCurrentTableName().c_str(), bulkLoader->GetCurrentFileIndex() + 1,
+                                         bulkLoader->GetFiles().size(), static_cast<unsigned long long>(bulkLoader->GetRowsLoaded()),
+                                         mibPerSecond);
+
+                            ImGui::ProgressBar(bulkLoader->GetProgress(), ImVec2(-FLT_MIN, 0.0f), overlay);
+                        }
+                        else if (bulkLoader && bulkLoader->GetStatus() == EQueryStatus::Done)
+                            ImGui::Text("Loaded %llu rows from %zu files in %.2f s (set-based recompute %.2f s).",
+                                        static_cast<unsigned long long>(bulkLoader->GetRowsLoaded()), bulkLoader->GetFiles().size(),
+                                        bulkLoader->GetElapsedSeconds(), bulkLoader->GetRecomputeSeconds());
+                        else if (bulkLoader)
+                            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", bulkLoader->GetError().c_str());
+                    }
+                    ImGui::End();
+                }
+
+                // Results to disk on the exporter's thread: a loaded result straight from memory, a query or table streamed by its own
+                // connection.
+                if (s_bShowExportWindow)
+                {
+                    if (ImGui::Begin("Export", &s_bShowExportWindow))
+                    {
+                        ImGui::InputText("Output file", exportPathBuffer, sizeof(exportPathBuffer));
+                        ImGui::Combo("Format", &exportFormatIndex, s_ExportFormatNames, IM_ARRAYSIZE(s_ExportFormatNames));
+                        ImGui::Combo("Source", &exportSourceIndex, s_ExportSourceNames, IM_ARRAYSIZE(s_ExportSourceNames));
+
+                        const bool bHasSource = exportSourceIndex == 0 ? lastQueryResult && lastQueryResult->GetColumnCount() != 0
+                                                : exportSourceIndex == 1 ? m_DbConn != nullptr
+                                                                         : m_DbConn && selectedTableIndex < tableNames.size();
+                        const bool bExportRunning = queryExporter && !queryExporter->IsFinished();
+                        if (bHasSource && !bExportRunning && ImGui::Button("Export"))
+                        {
+                            ExportDesc exportDesc{};
+                            exportDesc.Path   = exportPathBuffer;
+                            exportDesc.Format = static_cast<EExportFormat>(exportFormatIndex);
+
+                            queryExporter.reset();
+                            if (exportSourceIndex == 0)
+                                queryExporter = std::make_unique<QueryExporter>(lastQueryResult, std::move(exportDesc));
+                            else
+                            {
+                                std::string exportQuery = exportSourceIndex == 1
+                                                              ? std::string(sqlQueryBuffer)
+                                                              : "SELECT * FROM " + QuoteIdentifier(tableNames[selectedTableIndex]);
+                                queryExporter = std::make_unique<QueryExporter>(*m_DbConn, std::move(exportQuery), std::move(exportDesc));
+                            }
+                        }
+
+                        const auto mibPerSecond = [](uint64_t byteCount, float seconds)
+                        { return static_cast<double>(byteCount) / (1024.0 * 1024.0) / std::max(seconds, 0.001f); };
+                        if (bExportRunning)
+                        {
+                            if (ImGui::Button("Cancel Export")) queryExporter->Cancel();
+
+                            ImGui::Text("%llu rows, %.1f MiB written, %.1f MiB/s",
+                                        static_cast<unsigned long long>(queryExporter->GetRowsWritten()),
+                                        static_cast<double>(queryExporter->GetBytesWritten()) / (1024.0 * 1024.0),
+                                        mibPerSecond(queryExporter->GetBytesWritten(), queryExporter->GetElapsedSeconds()));
+                        }
+                        else if (queryExporter && queryExporter->GetStatus() == EQueryStatus::Done)
+                            ImGui::Text("Exported %llu rows (%.1f MiB) in %.2f s, %.1f MiB/s.",
+                                        static_cast<unsigned long long>(queryExporter->GetRowsWritten()),
+                                        static_cast<double>(queryExporter->GetBytesWritten()) / (1024.0 * 1024.0),
+                                        queryExporter->GetElapsedSeconds(),
+                                        mibPerSecond(queryExporter->GetBytesWritten(), queryExporter->GetElapsedSeconds()));
+                        else if (queryExporter)
+                            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", queryExporter->GetError().c_str());
+                    }
+                    ImGui::End();
+                }
+
+                // Orders queued by discount changes (09-repricing-queue.sql), repriced in batches off the render thread.
+                if (s_bShowRepricingWindow)
+                {
+                    if (ImGui::Begin("Repricing Queue", &s_bShowRepricingWindow))
+                    {
+                        const bool bRepricingRunning = repricingWorker && !repricingWorker->IsFinished();
+                        if (!bRepricingRunning)
+                        {
+                            ImGui::InputInt("Batch size", &repricingBatchSize, 100, 1000);
+                            ImGui::Checkbox("Keep running when the queue is empty", &bFollowRepricingQueue);
+
+                            if (m_DbConn && ImGui::Button("Start"))
+                            {
+                                const RepricingWorkerDesc workerDesc{.BatchSize      = repricingBatchSize,
+                                                                     .bStopWhenEmpty = !bFollowRepricingQueue};
+                                repricingWorker = std::make_unique<RepricingWorker>(*m_DbConn, workerDesc);
+                            }
+                        }
+                        else if (ImGui::Button("Stop"))
+                            repricingWorker->Stop();
+
+                        if (repricingWorker)
+                        {
+                            char overlay[160]{};
+                            if (repricingWorker->IsIdle())
+                                snprintf(overlay, sizeof(overlay), "Queue empty, %llu orders repriced",
+                                         static_cast<unsigned long long>(repricingWorker->GetOrdersRepriced()));
+                            else
+                                snprintf(overlay, sizeof(overlay), "%llu repriced, %lld pending, %.0f orders/s",
+                                         static_cast<unsigned long long>(repricingWorker->GetOrdersRepriced()),
+                                         static_cast<long long>(std::max<int64_t>(repricingWorker->GetPendingCount(), 0)),
+                                         repricingWorker->GetOrdersPerSecond());
+
+                            ImGui::ProgressBar(repricingWorker->GetProgress(), ImVec2(-FLT_MIN, 0.0f), overlay);
+
+                            if (repricingWorker->IsFinished())
+                            {
+                                if (repricingWorker->GetStatus() == EQueryStatus::Failed)
+                                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", repricingWorker->GetError().c_str());
+                                else
+                                    ImGui::Text("%s after %llu batches in %.2f s.",
+                                                repricingWorker->GetStatus() == EQueryStatus::Done ? "Done" : "Stopped",
+                                                static_cast<unsigned long long>(repricingWorker->GetBatchCount()),
+                                                repricingWorker->GetElapsedSeconds());
+                            }
+                        }
+                    }
+                    ImGui::End();
+                }
+
+                // EXPLAIN (ANALYZE, BUFFERS) of every predefined report with their default parameters, seq scans and index proposals.
+                if (s_bShowIndexAdvisorWindow)
+                {
+                    if (ImGui::Begin("Index Advisor", &s_bShowIndexAdvisorWindow))
+                    {
+                        if (indexAdvisor) indexAdvisor->Poll();
+
+                        const bool bAdvisorRunning = indexAdvisor && !indexAdvisor->IsFinished();
+                        if (!bAdvisorRunning)
+                        {
+                            ImGui::InputInt("Min scanned rows", &advisorMinScannedRows, 1000, 10000);
+                            if (m_DbConn && ImGui::Button("Analyze Reports"))
+                                indexAdvisor = std::make_unique<IndexAdvisor>(*m_DbConn, CreateReportQueries(),
+                                                                              IndexAdvisorDesc{.MinScannedRows = advisorMinScannedRows});
+                        }
+
+                        if (indexAdvisor)
+                        {
+                            char overlay[64]{};
+                            snprintf(overlay, sizeof(overlay), "%zu/%zu statements", indexAdvisor->GetCompletedCount(),
+                                     indexAdvisor->GetStatementCount());
+                            ImGui::ProgressBar(indexAdvisor->GetProgress(), ImVec2(-FLT_MIN, 0.0f), overlay);
+
+                            const std::string script = indexAdvisor->BuildSuggestionScript();
+                            if (!script.empty() && ImGui::Button("Copy Suggestions to Editor"))
+                            {
+                                strncpy(sqlQueryBuffer, script.c_str(), sizeof(sqlQueryBuffer) - 1);
+                                sqlQueryBuffer[sizeof(sqlQueryBuffer) - 1] = '\0';
+                            }
+
+                            const ImVec4 flaggedColor(1.0f, 0.6f, 0.3f, 1.0f);
+                            for (const auto& report : indexAdvisor->GetReports())
+                            {
+                                const auto flaggedCount = std::count_if(report.SeqScans.begin(), report.SeqScans.end(),
+                                                                        [](const SeqScanFinding& scan) { return scan.bFlagged; });
+
+                                // ### keeps the tree node id stable while the label changes.
+                                char header[256]{};
+                                if (report.Status == EQueryStatus::Done)
+                                    snprintf(header, sizeof(header), "%s: %.2f ms, %lld hit / %lld read, %zu seq scans (%zu flagged)###%s",
+                                             report.Title.c_str(), report.ExecutionMilliseconds,
+                                             static_cast<long long>(report.SharedHitBlocks),
+                                             static_cast<long long>(report.SharedReadBlocks), report.SeqScans.size(),
+                                             static_cast<std::size_t>(flaggedCount), report.Title.c_str());
+                                else
+                                    snprintf(header, sizeof(header), "%s: %s###%s", report.Title.c_str(),
+                                             report.Status == EQueryStatus::Failed ? "failed" : "running...", report.Title.c_str());
+
+                                if (!ImGui::TreeNode(header)) continue;
+
+                                if (!report.Error.empty()) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", report.Error.c_str());
+                                for (const auto& scan : report.SeqScans)
+                                {
+                                    const ImVec4 textColor = scan.bFlagged ? flaggedColor : ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled);
+                                    ImGui::TextColored(textColor, "Seq Scan on %s %s: %lld rows, %lld removed by filter, %.2f ms",
+                                                       scan.Relation.c_str(), scan.Alias.c_str(), static_cast<long long>(scan.RowsReturned),
+                                                       static_cast<long long>(scan.RowsRemoved), scan.ScanMilliseconds);
+                                    if (!scan.Filter.empty()) ImGui::TextWrapped("    Filter: %s", scan.Filter.c_str());
+                                    for (const auto& suggestion : scan.SuggestedIndexes)
+                                        ImGui::BulletText("%s", suggestion.c_str());
+                                }
+                                ImGui::TreePop();
+                            }
+                        }
+                    }
+                    ImGui::End();
+                }
+
+                // EXPLAIN ANALYZE plans of the editor's statements ("Profile"), one collapsible tree per statement.
+                if (s_bShowProfileWindow)
+                {
+                    if (ImGui::Begin("Query Profile", &s_bShowProfileWindow))
+                    {
+                        if (queryProfiler) queryProfiler->Poll();
+
+                        if (!queryProfiler)
+                            ImGui::TextDisabled("Profile next to Run Query explains every statement in the editor.");
+                        else if (!queryProfiler->IsFinished())
+                        {
+                            DrawQueryProgress(*queryProfiler->GetTask());
+                            if (ImGui::Button("Cancel")) queryProfiler->Cancel();
+                        }
+                        else if (!queryProfiler->GetError().empty())
+                            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", queryProfiler->GetError().c_str());
+                        else
+                        {
+                            const std::vector<QueryPlan>& plans = queryProfiler->GetPlans();
+                            for (std::size_t i{}; i < plans.size(); ++i)
+                            {
+                                // First line of the statement names it, ### keeps the header id stable.
+                                const std::string_view firstLine = std::string_view(plans[i].Sql).substr(0, plans[i].Sql.find('\n'));
+                                char header[160]{};
+                                snprintf(header, sizeof(header), "%zu. %.*s###Plan%zu", i + 1,
+                                         static_cast<int>(std::min<std::size_t>(firstLine.size(), 120)), firstLine.data(), i);
+                                if (!ImGui::CollapsingHeader(header, ImGuiTreeNodeFlags_DefaultOpen)) continue;
+
+                                ImGui::PushID(static_cast<int>(i));
+                                DrawQueryPlan("##Plan", plans[i]);
+                                ImGui::PopID();
+                            }
+                        }
+                    }
+                    ImGui::End();
+                }
+
+                // Results of "Run All Reports", one tab per report, each with its own error if it failed.
+                if (s_bShowAllReportsWindow)
+                {
+                    if (ImGui::Begin("All Reports", &s_bShowAllReportsWindow))
+                    {
+                        if (allReportsTask)
+                        {
+                            if (allReportsTask->IsFinished())
+                            {
+                                switch (allReportsTask->GetStatus())
+                                {
+                                    case EQueryStatus::Done:
+                                        allReportsResults = allReportsTask->TakeBatchResults();
+                                        allReportsGrids   = std::vector<ResultTable>(allReportsResults.size());
+                                        allReportsSeconds = allReportsTask->GetElapsedSeconds();
+                                        break;
+                                    case EQueryStatus::Cancelled: allReportsError = "Reports cancelled."; break;
+                                    default: allReportsError = allReportsTask->GetError(); break;
+                                }
+                                allReportsTask = nullptr;
+                            }
+                            else
+                            {
+                                DrawQueryProgress(*allReportsTask);
+                                if (m_DbConn && ImGui::Button("Cancel")) m_DbConn->Cancel(allReportsTask);
+                            }
+                        }
+
+                        if (!allReportsError.empty()) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", allReportsError.c_str());
+
+                        if (!allReportsTask && !allReportsResults.empty())
+                        {
+                            ImGui::Text("%zu reports in %.3f s, sent as one pipeline", allReportsResults.size(), allReportsSeconds);
+                            if (ImGui::BeginTabBar("##AllReportsTabs"))
+                            {
+                                for (std::size_t i{}; i < allReportsResults.size() && i < allReportsTitles.size(); ++i)
+                                {
+                                    if (!ImGui::BeginTabItem(allReportsTitles[i].c_str())) continue;
+
+                                    const BatchResult& batch = allReportsResults[i];
+                                    if (!batch.Result)
+                                        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", batch.Error.c_str());
+                                    else if (batch.Result->GetColumnCount() != 0)
+                                    {
+                                        ImGui::Text("%zu rows, %zu cols", batch.Result->GetRowCount(), batch.Result->GetColumnCount());
+
+                                        char gridId[32]{};
+                                        snprintf(gridId, sizeof(gridId), "AllReportsTable%zu", i);
+                                        static constexpr ImGuiTableFlags s_ReportTableFlags =
+                                            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
+                                            ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY;
+                                        allReportsGrids[i].Draw(gridId, *batch.Result, s_ReportTableFlags);
+                                    }
+                                    ImGui::EndTabItem();
+                                }
+                                ImGui::EndTabBar();
+                            }
+                        }
+                    }
+                    ImGui::End();
+                }
+
+                // Live query timings of the current connection, histograms filled by the pool workers.
+                if (s_bShowPerformanceWindow)
+                {
+                    if (ImGui::Begin("Performance", &s_bShowPerformanceWindow) && m_DbConn)
+                    {
+                        QueryStats& queryStats = m_DbConn->GetQueryStats();
+                        ImGui::Text("%llu queries, %llu failed, %llu served from the result cache",
+                                    static_cast<unsigned long long>(queryStats.GetHistogram(EQueryMetric::TotalTime).GetCount()),
+                                    static_cast<unsigned long long>(queryStats.GetFailedCount()),
+                                    static_cast<unsigned long long>(queryStats.GetCacheHitCount()));
+                        ImGui::SameLine();
+                        if (ImGui::Button("Reset")) queryStats.Reset();
+
+                        ImGui::InputText("##StatsDumpPath", statsDumpPathBuffer, sizeof(statsDumpPathBuffer));
+                        ImGui::SameLine();
+                        if (ImGui::Button("Dump JSON")) queryStats.WriteJson(statsDumpPathBuffer);
+
+                        static constexpr ImGuiTableFlags s_StatsTableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                                                                             ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
+
+                        // In EQueryMetric order, times are shown in milliseconds.
+                        static constexpr const char* s_MetricLabels[] = {"Queue, ms", "Acquire, ms", "Server, ms",
+                                                                         "Transfer, ms", "Build, ms",  "Total, ms",
+                                                                         "Rows",         "Bytes",      "Allocations"};
+                        if (ImGui::BeginTable("##QueryMetrics", 6, s_StatsTableFlags))
+                        {
+                            for (const char* header : {"Metric", "Mean", "P50", "P95", "P99", "Max"})
+                                ImGui::TableSetupColumn(header);
+                            ImGui::TableHeadersRow();
+
+                            for (std::size_t i{}; i < static_cast<std::size_t>(EQueryMetric::Count); ++i)
+                            {
+                                const EQueryMetric metric = static_cast<EQueryMetric>(i);
+                                if (!QueryStats::IsMetricCollected(metric)) continue;
+
+                                const StatsHistogram& histogram = queryStats.GetHistogram(metric);
+                                const double scale              = QueryStats::IsTimeMetric(metric) ? 1e-3 : 1.0;
+                                const char* valueFormat         = QueryStats::IsTimeMetric(metric) ? "%.3f" : "%.0f";
+
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                ImGui::TextUnformatted(s_MetricLabels[i]);
+                                for (const double value : {histogram.GetMean(), static_cast<double>(histogram.GetPercentile(50.0)),
+                                                           static_cast<double>(histogram.GetPercentile(95.0)),
+                                                           static_cast<double>(histogram.GetPercentile(99.0)),
+                                                           static_cast<double>(histogram.GetMax())})
+                                {
+                                    ImGui::TableNextColumn();
+                                    ImGui::Text(valueFormat, value * scale);
+                                }
+                            }
+                            ImGui::EndTable();
+                        }
+
+                        static constexpr std::size_t s_SlowestShownCount = 20;
+                        ImGui::SeparatorText("Slowest recent queries");
+                        if (ImGui::BeginTable("##SlowestQueries", 8, s_StatsTableFlags | ImGuiTableFlags_ScrollY))
+                        {
+                            for (const char* header : {"Total, ms", "Server, ms", "Transfer, ms", "Build, ms", "Rows", "Bytes", "Allocs"})
+                                ImGui::TableSetupColumn(header);
+                            ImGui::TableSetupColumn("SQL", ImGuiTableColumnFlags_WidthStretch);
+                            ImGui::TableSetupScrollFreeze(0, 1);
+                            ImGui::TableHeadersRow();
+
+                            for (const QueryTiming& timing : queryStats.GetSlowestRecent(s_SlowestShownCount))
+                            {
+                                ImGui::TableNextRow();
+                                for (const EQueryMetric metric : {EQueryMetric::TotalTime, EQueryMetric::ServerTime,
+                                                                  EQueryMetric::TransferTime, EQueryMetric::BuildTime})
+                                {
+                                    ImGui::TableNextColumn();
+                                    ImGui::Text("%.3f", static_cast<double>(timing.Get(metric)) * 1e-3);
+                                }
+                                for (const EQueryMetric metric : {EQueryMetric::Rows, EQueryMetric::Bytes, EQueryMetric::Allocations})
+                                {
+                                    ImGui::TableNextColumn();
+                                    if (!QueryStats::IsMetricCollected(metric))
+                                        ImGui::TextDisabled("-");
+                                    else
+                                        ImGui::Text("%llu", static_cast<unsigned long long>(timing.Get(metric)));
+                                }
+                                ImGui::TableNextColumn();
+                                if (timing.bSucceeded)
+                                    ImGui::TextUnformatted(timing.Sql.c_str());
+                                else
+                                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", timing.Sql.c_str());
+                                if (ImGui::IsItemHovered() && timing.StatementCount > 1)
+                                    ImGui::SetTooltip("first of %zu statements", timing.StatementCount);
+                            }
+                            ImGui::EndTable();
+                        }
+                    }
+                    ImGui::End();
+                }
+
                 static const ImGuiWindowFlags_ dbWindowFlags = {};  // ImGuiWindowFlags_NoMove;
 
                 // Queries
@@ -726,37 +1041,70 @@ namespace nsudb
                     //    
                     ImGui::Text("Predefined Queries:");
 
+                    static std::vector<ReportQuery> s_Reports = []()
+                    {
+                        auto reports = CreateReportQueries();
+                        for (auto& report : reports)
+                            for (auto& param : report.Params)
+                                param.Value.resize(64, 0);  // edited in place by ImGui::InputText
+
+                        return reports;
+                    }();
                     //  ,   dangling pointer
-                    static std::vector<std::string> queryLabelsStorage;
                     static std::vector<const char*> queryLabels;
 
-                    queryLabelsStorage.clear();
                     queryLabels.clear();
-                    queryLabelsStorage.reserve(s_HardcodedDbQueries.size());
-                    queryLabels.reserve(s_HardcodedDbQueries.size());
+                    queryLabels.reserve(s_Reports.size());
+                    for (const auto& report : s_Reports)
+                        queryLabels.push_back(report.Title.c_str());
 
-                    for (size_t i = 0; i < s_HardcodedDbQueries.size(); ++i)
+                    const bool bReportSelected = s_SelectedQueryIndex >= 0 && s_SelectedQueryIndex < static_cast<int>(s_Reports.size());
+                    const auto CopyReportToEditor = [&]()
                     {
-                        queryLabelsStorage.emplace_back("Query " + std::to_string(i + 1));
-                        queryLabels.push_back(queryLabelsStorage.back().c_str());
-                    }
+                        const std::string reportSql = BuildReportSqlText(s_Reports[s_SelectedQueryIndex]);
+                        strncpy(sqlQueryBuffer, reportSql.c_str(), sizeof(sqlQueryBuffer) - 1);
+                        sqlQueryBuffer[sizeof(sqlQueryBuffer) - 1] = '\0';  // safety null-termination
+                    };
 
                     if (ImGui::Combo("##PredefinedQueries", &s_SelectedQueryIndex, queryLabels.data(),
                                      static_cast<int>(queryLabels.size())))
                     {
-                        if (s_SelectedQueryIndex >= 0 && s_SelectedQueryIndex < static_cast<int>(s_HardcodedDbQueries.size()))
+                        if (s_SelectedQueryIndex >= 0 && s_SelectedQueryIndex < static_cast<int>(s_Reports.size())) CopyReportToEditor();
+                    }
+
+                    ImGui::SameLine();
+                    if (ImGui::Button("Copy to Editor") && bReportSelected) CopyReportToEditor();
+
+                    if (bReportSelected)
+                    {
+                        // Values are bound to the prepared statements, not spliced into the SQL.
+                        for (auto& param : s_Reports[s_SelectedQueryIndex].Params)
+                            ImGui::InputText(param.Name.c_str(), param.Value.data(), param.Value.size());
+
+                        if (m_DbConn && !sqlQueryTask && ImGui::Button("Run Report"))
                         {
-                            strncpy(sqlQueryBuffer, s_HardcodedDbQueries[s_SelectedQueryIndex].c_str(), sizeof(sqlQueryBuffer) - 1);
-                            sqlQueryBuffer[sizeof(sqlQueryBuffer) - 1] = '\0';  // safety null-termination
+                            if (s_Reports[s_SelectedQueryIndex].bReadsRollups) StartRollupRefresh();
+                            sqlQueryTask = m_DbConn->ExecutePreparedAsync(BuildReportStatements(s_Reports[s_SelectedQueryIndex]));
                         }
+                        ImGui::SameLine();
                     }
 
-                    ImGui::SameLine();
-                    if (ImGui::Button("Copy to Editor") && s_SelectedQueryIndex >= 0 &&
-                        s_SelectedQueryIndex < static_cast<int>(s_HardcodedDbQueries.size()))
+                    // Each report is a batch of its own, so one failing doesn't take the others down with it.
+                    if (m_DbConn && !allReportsTask && ImGui::Button("Run All Reports"))
                     {
-                        strncpy(sqlQueryBuffer, s_HardcodedDbQueries[s_SelectedQueryIndex].c_str(), sizeof(sqlQueryBuffer) - 1);
-                        sqlQueryBuffer[sizeof(sqlQueryBuffer) - 1] = '\0';
+                        std::vector<std::vector<QueryStatement>> batches{};
+                        allReportsTitles.clear();
+                        for (const auto& report : s_Reports)
+                        {
+                            batches.emplace_back(BuildReportStatements(report));
+                            allReportsTitles.emplace_back(report.Title);
+                        }
+
+                        allReportsResults.clear();
+                        allReportsError.clear();
+                        StartRollupRefresh();
+                        allReportsTask          = m_DbConn->ExecutePipelinedAsync(std::move(batches));
+                        s_bShowAllReportsWindow = true;
                     }
 
                     ImGui::Separator();
@@ -767,9 +1115,25 @@ namespace nsudb
                                               ImVec2(-FLT_MIN, ImGui::GetContentRegionAvail().y * 0.4f), ImGuiInputTextFlags_AllowTabInput);
 
                     //  
-                    if (m_DbConn && ImGui::Button("Run Query"))
+                    if (m_DbConn && !sqlQueryTask && ImGui::Button("Run Query"))
+                    {
+                        sqlQueryTask = m_DbConn->ExecuteAsync(sqlQueryBuffer);
+                    }
+
+                    // EXPLAIN (ANALYZE, BUFFERS) of every statement in the editor, plans open in the Query Profile window.
+                    if (m_DbConn && !sqlQueryTask && !(queryProfiler && !queryProfiler->IsFinished()))
                     {
-                        lastQueryResult = m_DbConn->Execute(sqlQueryBuffer);
+                        ImGui::SameLine();
+                        if (ImGui::Button("Profile"))
+                        {
+                            queryProfiler        = std::make_unique<QueryProfiler>(*m_DbConn, SplitSqlStatements(sqlQueryBuffer));
+                            s_bShowProfileWindow = true;
+                        }
+                    }
+
+                    if (m_DbConn && sqlQueryTask && ImGui::Button("Cancel Query"))
+                    {
+                        m_DbConn->Cancel(sqlQueryTask);
                     }
 
                     ImGui::SameLine();
@@ -777,56 +1141,90 @@ namespace nsudb
                     ImGui::SameLine();
                     if (ImGui::Button("Clear Result"))
                     {
-                        lastQueryResult = std::nullopt;
+                        lastQueryResult = nullptr;
+                        lastQueryError.clear();
                     }
 
-                    //  
-                    if (lastQueryResult && !lastQueryResult->ColumnNames.empty())
+                    if (m_DbConn)
                     {
-                        ImGui::Separator();
-                        ImGui::Text("Result: %zu rows, %zu cols", lastQueryResult->Rows.size(), lastQueryResult->ColumnNames.size());
+                        const auto poolStats = m_DbConn->GetPoolStats();
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("| connections: %u open, %u idle, %u waiting", poolStats.OpenConnections,
+                                            poolStats.IdleConnections, poolStats.WaitingCallers);
 
-                        if (ImGui::BeginTable("SQLQueryResultTable", lastQueryResult->ColumnNames.size(),
-                                              ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
-                                                  ImGuiTableFlags_Hideable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchSame))
+                        if (const auto cacheStats = m_DbConn->GetResultCacheStats())
                         {
-                            for (const auto& colName : lastQueryResult->ColumnNames)
-                            {
-                                ImGui::TableSetupColumn(colName.c_str());
-                            }
-                            ImGui::TableHeadersRow();
+                            ImGui::SameLine();
+                            if (cacheStats->bListening)
+                                ImGui::TextDisabled("| cache: %zu results, %.1f MiB, %llu hits, %llu misses", cacheStats->EntryCount,
+                                                    static_cast<double>(cacheStats->MemoryUsage) / (1 << 20),
+                                                    static_cast<unsigned long long>(cacheStats->HitCount),
+                                                    static_cast<unsigned long long>(cacheStats->MissCount));
+                            else
+                                ImGui::TextDisabled("| cache: not listening");
+                        }
+                    }
 
-                            for (const auto& row : lastQueryResult->Rows)
+                    if (sqlQueryTask)
+                    {
+                        if (sqlQueryTask->IsFinished())
+                        {
+                            lastQueryError.clear();
+                            switch (sqlQueryTask->GetStatus())
                             {
-                                ImGui::TableNextRow();
-                                for (size_t j = 0; j < row.size(); ++j)
-                                {
-                                    ImGui::TableSetColumnIndex(j);
-                                    ImGui::TextUnformatted(row[j].c_str());
-                                }
+                                case EQueryStatus::Done:
+                                    lastQueryResult = sqlQueryTask->TakeResult();
+                                    sqlResultGrid.Reset();
+                                    break;
+                                case EQueryStatus::Cancelled: lastQueryError = "Query cancelled."; break;
+                                default: lastQueryError = sqlQueryTask->GetError(); break;
                             }
-
-                            ImGui::EndTable();
+                            sqlQueryTask = nullptr;
                         }
+                        else
+                            DrawQueryProgress(*sqlQueryTask);
+                    }
+
+                    if (!lastQueryError.empty()) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", lastQueryError.c_str());
+
+                    //  
+                    if (lastQueryResult && lastQueryResult->GetColumnCount() != 0)
+                    {
+                        ImGui::Separator();
+                        ImGui::Text("Result: %zu rows, %zu cols", lastQueryResult->GetRowCount(), lastQueryResult->GetColumnCount());
+
+                        sqlResultGrid.Draw("SQLQueryResultTable", *lastQueryResult,
+                                           ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
+                                               ImGuiTableFlags_Hideable | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY);
                     }
                 }
                 ImGui::End();
 
                 // Tables
                 {
-                    if (ImGui::Begin("TABLES", nullptr, dbWindowFlags) && m_DbConn)
+                    // The cursor's transaction holds back vacuum, it's closed as soon as the pane loses focus (or gets hidden).
+                    // Scrolling an unfocused pane re-opens it, the idle timeout closes it again.
+                    const bool bTablesVisible     = ImGui::Begin("TABLES", nullptr, dbWindowFlags);
+                    const bool bTablesWereFocused = bTablesFocused;
+                    bTablesFocused                = bTablesVisible && ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+                    if (tableCursor && bTablesWereFocused && !bTablesFocused) tableCursor->Suspend();
+
+                    if (bTablesVisible && m_DbConn)
                     {
                         // Fetch table names only once, or when a refresh is triggered
-                        if (tableNames.empty())
+                        if (tableNames.empty() && !tableNamesTask) tableNamesTask = m_DbConn->ExecuteAsync(queryTableNames);
+
+                        if (tableNamesTask && tableNamesTask->IsFinished())
                         {
-                            if (const auto queryResult = m_DbConn->Execute(queryTableNames); queryResult)
+                            if (const auto queryResult = tableNamesTask->TakeResult(); queryResult)
                             {
                                 tableNames.clear();  // Clear previous list
-                                for (const auto& row : queryResult->Rows)
-                                    if (!row.empty()) tableNames.emplace_back(row[0]);  // tablename is the first column
+                                for (std::size_t row{}; queryResult->GetColumnCount() != 0 && row < queryResult->GetRowCount(); ++row)
+                                    tableNames.emplace_back(queryResult->GetValue(row, 0));  // tablename is the first column
 
                                 std::sort(tableNames.begin(), tableNames.end());  // Keep it sorted
                             }
+                            tableNamesTask = nullptr;
                         }
 
                         // Left Pane: List of Tables
@@ -835,7 +1233,8 @@ namespace nsudb
                         ImGui::Text("Database Tables:");
                         ImGui::Separator();
 
-                        const char* selectedTableName = tableNames[selectedTableIndex].c_str();
+                        const char* selectedTableName =
+                            selectedTableIndex < tableNames.size() ? tableNames[selectedTableIndex].c_str() : nullptr;
                         for (uint32_t i{}; i < tableNames.size(); ++i)
                         {
                             const auto& currentTableName = tableNames[i];
@@ -843,11 +1242,10 @@ namespace nsudb
 
                             selectedTableIndex = i;
                             selectedTableName  = tableNames[selectedTableIndex].c_str();
-                            // Query content of the selected table
-                            const std::string queryContent =
-                                "SELECT * FROM " + std::string(selectedTableName) + " LIMIT 100;";  // Add LIMIT for safety
-
-                            tableQueryResult = m_DbConn->Execute(queryContent);
+                            // Query content of the selected table, rows are paged in while scrolling, so no LIMIT is needed
+                            tableCursor.reset();
+                            tableCursor = m_DbConn->OpenCursor("SELECT * FROM " + QuoteIdentifier(selectedTableName));
+                            tableCursorGrid.Reset();
                         }
                         ImGui::EndChild();
 
@@ -860,30 +1258,24 @@ namespace nsudb
                             ImGui::Text("Content of table: %s", selectedTableName);
                             ImGui::Separator();
 
-                            if (tableQueryResult && !tableQueryResult->Rows.empty())
-                            {
-                                // Display table header
-                                if (ImGui::BeginTable("##TableData", tableQueryResult->ColumnNames.size(),
-                                                      ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable |
-                                                          ImGuiTableFlags_Hideable | ImGuiTableFlags_ScrollY))
-                                {
-                                    for (const auto& colName : tableQueryResult->ColumnNames)
-                                        ImGui::TableSetupColumn(colName.c_str());
-
-                                    ImGui::TableHeadersRow();
+                            if (tableCursor) tableCursor->Update();
 
-                                    // Display table rows
-                                    for (const auto& row : tableQueryResult->Rows)
-                                    {
-                                        ImGui::TableNextRow();
-                                        for (uint32_t col{}; col < row.size(); ++col)
-                                        {
-                                            ImGui::TableSetColumnIndex(col);
-                                            ImGui::TextUnformatted(row[col].c_str());
-                                        }
-                                    }
-                                    ImGui::EndTable();
-                                }
+                            if (tableCursor && tableCursor->HasFailed())
+                                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", tableCursor->GetError().c_str());
+                            else if (tableCursor && !tableCursor->IsOpen())
+                                ImGui::TextDisabled("Opening cursor...");
+                            else if (tableCursor && tableCursor->GetColumnNames().empty())
+                                ImGui::TextDisabled("Table is empty.");
+                            else if (tableCursor)
+                            {
+                                ImGui::Text("%s%zu rows, %zu pages of %zu rows cached%s", tableCursor->IsRowCountKnown() ? "" : "~",
+                                            tableCursor->GetRowCount(), tableCursor->GetCachedPageCount(), tableCursor->GetPageSize(),
+                                            tableCursor->IsSuspended() ? " (cursor closed while idle)" : "");
+
+                                // Missing pages are fetched as the clipper reaches them
+                                tableCursorGrid.Draw("##TableData", *tableCursor,
+                                                     ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable |
+                                                         ImGuiTableFlags_Hideable | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY);
                             }
                         }
 
@@ -0,0 +1,562 @@
+#include "Benchmarks.hpp"
+
+#include <imgui.h>
+
+#include <BinaryFormat.hpp>
+#include <Database.hpp>
+#include <Logger.hpp>
+#include <QueryResult.hpp>
+#include <ResultSearch.hpp>
+#include <ResultTable.hpp>
+
+namespace nsudb
+{
+
+    namespace Benchmarks
+    {
+        struct AllocationStats final
+        {
+            std::size_t LiveBytes{0};
+            std::size_t AllocationCount{0};
+        };
+
+        // Lets the legacy layout report exactly what it asks from the heap, benchmark is single threaded.
+        static AllocationStats s_LegacyAllocationStats{};
+
+        template <typename T> struct CountingAllocator
+        {
+            using value_type = T;
+
+            CountingAllocator() noexcept = default;
+            template <typename U> CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+            T* allocate(std::size_t count)
+            {
+                s_LegacyAllocationStats.LiveBytes += count * sizeof(T);
+                ++s_LegacyAllocationStats.AllocationCount;
+                return std::allocator<T>{}.allocate(count);
+            }
+
+            void deallocate(T* ptr, std::size_t count) noexcept
+            {
+                s_LegacyAllocationStats.LiveBytes -= count * sizeof(T);
+                std::allocator<T>{}.deallocate(ptr, count);
+            }
+
+            template <typename U> bool operator==(const CountingAllocator<U>&) const noexcept { return true; }
+        };
+
+        using LegacyString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+        using LegacyRow    = std::vector<LegacyString, CountingAllocator<LegacyString>>;
+        using LegacyRows   = std::vector<LegacyRow, CountingAllocator<LegacyRow>>;
+
+        static constexpr std::size_t s_ColumnCount = 7;
+
+        // Shaped like `orders` joined with an outlet address, which is what the reports mostly return.
+        static std::vector<std::string> GenerateCells(std::size_t rowCount) noexcept
+        {
+            static constexpr std::array<std::string_view, 4> s_Addresses = {
+                "Novosibirsk, Pirogova st. 1", "Novosibirsk, Lenina st. 21", "Berdsk, Lenina st. 10", "Akademgorodok, Ilyicha st. 4"};
+
+            std::mt19937 rng(42);
+            std::vector<std::string> cells;
+            cells.reserve(rowCount * s_ColumnCount);
+            for (std::size_t row{}; row < rowCount; ++row)
+            {
+                char timestamp[32]{};
+                snprintf(timestamp, sizeof(timestamp), "2024-%02u-%02u %02u:%02u:00", uint32_t(1 + rng() % 12), uint32_t(1 + rng() % 28),
+                         uint32_t(rng() % 24), uint32_t(rng() % 60));
+
+                cells.emplace_back(std::to_string(row + 1));
+                cells.emplace_back(timestamp);
+                cells.emplace_back(std::to_string(rng() % 10000) + "." + std::to_string(10 + rng() % 90));
+                cells.emplace_back(rng() % 4 == 0 ? "t" : "f");
+                cells.emplace_back(std::to_string(1 + rng() % 16));
+                cells.emplace_back(std::to_string(1 + rng() % 100000));
+                cells.emplace_back(s_Addresses[rng() % s_Addresses.size()]);
+            }
+
+            return cells;
+        }
+
+        template <typename Func> static double MeasureBestMs(Func&& func, uint32_t iterationCount = 5) noexcept
+        {
+            double bestMs = std::numeric_limits<double>::max();
+            for (uint32_t i{}; i < iterationCount; ++i)
+            {
+                const auto startTime = std::chrono::steady_clock::now();
+                func();
+                const auto endTime = std::chrono::steady_clock::now();
+                bestMs             = std::min(bestMs, std::chrono::duration<double, std::milli>(endTime - startTime).count());
+            }
+
+            return bestMs;
+        }
+
+        void RunResultStoreBenchmark(std::size_t rowCount) noexcept
+        {
+            const auto cells = GenerateCells(rowCount);
+
+            // Both fills mimic the row callback: cells arrive row by row, without knowing the final row count.
+            AllocationStats legacyStats{};
+            const double legacyMs = MeasureBestMs(
+                [&]()
+                {
+                    s_LegacyAllocationStats = {};
+                    {
+                        LegacyRows rows;
+                        for (std::size_t row{}; row < rowCount; ++row)
+                        {
+                            auto& rowData = rows.emplace_back();
+                            rowData.resize(s_ColumnCount);
+                            for (std::size_t col{}; col < s_ColumnCount; ++col)
+                                rowData[col] = LegacyString(cells[row * s_ColumnCount + col].c_str());
+                        }
+                        legacyStats = s_LegacyAllocationStats;
+                    }
+                });
+
+            std::size_t columnarBytes{0};
+            const double columnarMs = MeasureBestMs(
+                [&]()
+                {
+                    QueryResult result(std::vector<std::string>(s_ColumnCount, "column"));
+                    for (std::size_t row{}; row < rowCount; ++row)
+                    {
+                        for (std::size_t col{}; col < s_ColumnCount; ++col)
+                            result.AppendValue(col, cells[row * s_ColumnCount + col]);
+                        result.CommitRow();
+                    }
+                    columnarBytes = result.GetMemoryUsage();
+                });
+
+            constexpr double s_MiB = 1024.0 * 1024.0;
+            std::printf("result store benchmark: %zu rows x %zu columns (best of 5)\n", rowCount, s_ColumnCount);
+            std::printf("  %-28s %10.2f ms %10.2f MiB %12zu allocations\n", "vector<vector<string>>", legacyMs,
+                        static_cast<double>(legacyStats.LiveBytes) / s_MiB, legacyStats.AllocationCount);
+            std::printf("  %-28s %10.2f ms %10.2f MiB %12s allocations\n", "columnar QueryResult", columnarMs,
+                        static_cast<double>(columnarBytes) / s_MiB, "O(log n)");
+        }
+
+        struct FrameTimeStats final
+        {
+            double MeanMs{0.0};
+            double P99Ms{0.0};
+        };
+
+        template <typename Func> static FrameTimeStats MeasureFrames(uint32_t frameCount, Func&& drawContents) noexcept
+        {
+            std::vector<double> frameTimesMs;
+            frameTimesMs.reserve(frameCount);
+            for (uint32_t frame{}; frame < frameCount; ++frame)
+            {
+                const auto startTime = std::chrono::steady_clock::now();
+
+                ImGui::NewFrame();
+                ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+                ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+                ImGui::Begin("##BenchmarkWindow", nullptr, ImGuiWindowFlags_NoDecoration);
+                drawContents();
+                ImGui::End();
+                ImGui::Render();
+
+                frameTimesMs.emplace_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+            }
+
+            std::sort(frameTimesMs.begin(), frameTimesMs.end());
+            FrameTimeStats stats{};
+            stats.MeanMs = std::accumulate(frameTimesMs.begin(), frameTimesMs.end(), 0.0) / frameTimesMs.size();
+            stats.P99Ms  = frameTimesMs[std::min(frameTimesMs.size() - 1, frameTimesMs.size() * 99 / 100)];
+            return stats;
+        }
+
+        void RunResultTableBenchmark() noexcept
+        {
+            IMGUI_CHECKVERSION();
+            ImGui::CreateContext();
+
+            // No backend: fixed display size/delta time and a CPU-side font atlas is all NewFrame() needs.
+            ImGuiIO& io    = ImGui::GetIO();
+            io.DisplaySize = ImVec2(1280.0f, 720.0f);
+            io.DeltaTime   = 1.0f / 60.0f;
+            io.IniFilename = nullptr;
+
+            unsigned char* fontPixels{nullptr};
+            int fontWidth{0}, fontHeight{0};
+            io.Fonts->GetTexDataAsRGBA32(&fontPixels, &fontWidth, &fontHeight);
+
+            static constexpr ImGuiTableFlags s_TableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
+                                                            ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY;
+            static constexpr uint32_t s_FrameCount        = 120;
+
+            std::printf("result grid frame time benchmark: %u frames per case, 1280x720, CPU side only\n", s_FrameCount);
+            std::printf("  %10s %22s %22s\n", "rows", "every row (mean/p99)", "ResultTable (mean/p99)");
+            for (const std::size_t rowCount : {1'000ull, 10'000ull, 100'000ull, 200'000ull, 1'000'000ull})
+            {
+                const auto cells = GenerateCells(rowCount);
+
+                QueryResult result(
+                    std::vector<std::string>{"id", "accept_time", "overall_price", "is_urgent", "outlet_id", "client_id", "address"});
+                for (std::size_t row{}; row < rowCount; ++row)
+                {
+                    for (std::size_t col{}; col < s_ColumnCount; ++col)
+                        result.AppendValue(col, cells[row * s_ColumnCount + col]);
+                    result.CommitRow();
+                }
+
+                // The pre-ResultTable loop, kept here only as the baseline. Big results get fewer frames, it's slow enough.
+                const uint32_t naiveFrameCount = rowCount > 100'000 ? 10 : s_FrameCount;
+                const auto naiveStats          = MeasureFrames(naiveFrameCount,
+                                                      [&]()
+                                                      {
+                                                          if (!ImGui::BeginTable("##Naive", s_ColumnCount, s_TableFlags)) return;
+
+                                                          for (const auto& columnName : result.GetColumnNames())
+                                                              ImGui::TableSetupColumn(columnName.c_str());
+                                                          ImGui::TableHeadersRow();
+
+                                                          for (std::size_t row{}; row < result.GetRowCount(); ++row)
+                                                          {
+                                                              ImGui::TableNextRow();
+                                                              for (std::size_t col{}; col < s_ColumnCount; ++col)
+                                                              {
+                                                                  ImGui::TableSetColumnIndex(static_cast<int>(col));
+                                                                  const std::string_view value = result.GetValue(row, col);
+                                                                  ImGui::TextUnformatted(value.data(), value.data() + value.size());
+                                                              }
+                                                          }
+                                                          ImGui::EndTable();
+                                                      });
+
+                ResultTable grid{};
+                const auto clippedStats = MeasureFrames(s_FrameCount, [&]() { grid.Draw("##Clipped", result, s_TableFlags); });
+
+                std::printf("  %10zu %10.3f/%8.3f ms %10.3f/%8.3f ms\n", rowCount, naiveStats.MeanMs, naiveStats.P99Ms, clippedStats.MeanMs,
+                            clippedStats.P99Ms);
+            }
+
+            ImGui::DestroyContext();
+        }
+
+        template <typename T> static void AppendBigEndian(std::string& out, T value) noexcept
+        {
+            for (int32_t shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8)
+                out += static_cast<char>((static_cast<std::make_unsigned_t<T>>(value) >> shift) & 0xFF);
+        }
+
+        // Days since 1970-01-01, see http://howardhinnant.github.io/date_algorithms.html
+        static int64_t DaysFromCivil(int64_t year, uint32_t month, uint32_t day) noexcept
+        {
+            year -= month <= 2;
+            const int64_t era        = (year >= 0 ? year : year - 399) / 400;
+            const uint32_t yearOfEra = static_cast<uint32_t>(year - era * 400);
+            const uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            const uint32_t dayOfEra  = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+            return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+        }
+
+        // Same value the server sends for numeric(10, 2): base-10000 groups of the integer part, then the fraction group.
+        static std::string EncodeNumericCents(int64_t cents) noexcept
+        {
+            std::vector<int16_t> digits{};
+            for (int64_t integerPart = cents / 100; integerPart > 0; integerPart /= 10000)
+                digits.insert(digits.begin(), static_cast<int16_t>(integerPart % 10000));
+
+            const int16_t weight = static_cast<int16_t>(digits.size()) - 1;
+            if (cents % 100 != 0) digits.emplace_back(static_cast<int16_t>(cents % 100 * 100));
+
+            std::string bytes{};
+            AppendBigEndian<int16_t>(bytes, static_cast<int16_t>(digits.size()));
+            AppendBigEndian<int16_t>(bytes, digits.empty() ? 0 : weight);
+            AppendBigEndian<uint16_t>(bytes, 0);  // positive
+            AppendBigEndian<int16_t>(bytes, 2);   // dscale
+            for (const int16_t digit : digits)
+                AppendBigEndian<int16_t>(bytes, digit);
+
+            return bytes;
+        }
+
+        static void PrintFormatRow(const char* name, double fillMs, std::size_t rowCount, std::size_t memoryBytes) noexcept
+        {
+            constexpr double s_MiB = 1024.0 * 1024.0;
+            std::printf("  %-20s %10.2f ms %12.0f rows/s %10.2f MiB\n", name, fillMs, static_cast<double>(rowCount) / (fillMs * 1e-3),
+                        static_cast<double>(memoryBytes) / s_MiB);
+        }
+
+        // Formats every cell like the grid would, returns the total length so the work can't be optimized out.
+        static std::size_t FormatAllCells(const QueryResult& result) noexcept
+        {
+            std::size_t totalLength{0};
+            QueryResult::FormatBuffer formatBuffer{};
+            for (std::size_t row{}; row < result.GetRowCount(); ++row)
+                for (std::size_t col{}; col < result.GetColumnCount(); ++col)
+                    totalLength += result.FormatValue(row, col, formatBuffer).size();
+
+            return totalLength;
+        }
+
+        static void RunSyntheticResultFormatBenchmark(std::size_t rowCount) noexcept
+        {
+            static constexpr std::array<std::string_view, 4> s_Addresses = {
+                "Novosibirsk, Pirogova st. 1", "Novosibirsk, Lenina st. 21", "Berdsk, Lenina st. 10", "Akademgorodok, Ilyicha st. 4"};
+            static constexpr std::array<uint32_t, s_ColumnCount> s_TypeOids = {
+                BinaryFormat::Int4, BinaryFormat::Timestamp, BinaryFormat::Numeric, BinaryFormat::Bool,
+                BinaryFormat::Int4, BinaryFormat::Int4,      BinaryFormat::Varchar};
+
+            // Every row once as the server would send it in text and once in binary.
+            std::mt19937 rng(42);
+            std::vector<std::string> textCells, binaryCells;
+            textCells.reserve(rowCount * s_ColumnCount);
+            binaryCells.reserve(rowCount * s_ColumnCount);
+            for (std::size_t row{}; row < rowCount; ++row)
+            {
+                const uint32_t month           = 1 + rng() % 12;
+                const uint32_t day             = 1 + rng() % 28;
+                const int64_t secondOfDay      = (rng() % 24) * 3600 + (rng() % 60) * 60;
+                const int64_t cents            = static_cast<int64_t>(rng() % 1'000'000);
+                const bool bUrgent             = rng() % 4 == 0;
+                const int32_t outletId         = static_cast<int32_t>(1 + rng() % 16);
+                const int32_t clientId         = static_cast<int32_t>(1 + rng() % 100000);
+                const std::string_view address = s_Addresses[rng() % s_Addresses.size()];
+
+                char timestamp[32]{}, price[32]{};
+                snprintf(timestamp, sizeof(timestamp), "2024-%02u-%02u %02lld:%02lld:00", month, day,
+                         static_cast<long long>(secondOfDay / 3600), static_cast<long long>(secondOfDay / 60 % 60));
+                snprintf(price, sizeof(price), "%lld.%02lld", static_cast<long long>(cents / 100), static_cast<long long>(cents % 100));
+
+                textCells.emplace_back(std::to_string(row + 1));
+                textCells.emplace_back(timestamp);
+                textCells.emplace_back(price);
+                textCells.emplace_back(bUrgent ? "t" : "f");
+                textCells.emplace_back(std::to_string(outletId));
+                textCells.emplace_back(std::to_string(clientId));
+                textCells.emplace_back(address);
+
+                const int64_t acceptTime = ((DaysFromCivil(2024, month, day) - 10957) * 86400 + secondOfDay) * 1'000'000;
+                AppendBigEndian<int32_t>(binaryCells.emplace_back(), static_cast<int32_t>(row + 1));
+                AppendBigEndian<int64_t>(binaryCells.emplace_back(), acceptTime);
+                binaryCells.emplace_back(EncodeNumericCents(cents));
+                binaryCells.emplace_back(1, bUrgent ? '\1' : '\0');
+                AppendBigEndian<int32_t>(binaryCells.emplace_back(), outletId);
+                AppendBigEndian<int32_t>(binaryCells.emplace_back(), clientId);
+                binaryCells.emplace_back(address);
+            }
+
+            const std::vector<std::string> columnNames{"id",        "accept_time", "overall_price", "is_urgent",
+                                                       "outlet_id", "client_id",   "address"};
+            QueryResult textResult{}, binaryResult{};
+            const double textFillMs = MeasureBestMs(
+                [&]()
+                {
+                    textResult = QueryResult(columnNames);
+                    for (std::size_t row{}; row < rowCount; ++row)
+                    {
+                        for (std::size_t col{}; col < s_ColumnCount; ++col)
+                            textResult.AppendValue(col, textCells[row * s_ColumnCount + col]);
+                        textResult.CommitRow();
+                    }
+                });
+            const double binaryFillMs = MeasureBestMs(
+                [&]()
+                {
+                    binaryResult = QueryResult(columnNames);
+                    for (std::size_t col{}; col < s_ColumnCount; ++col)
+                        binaryResult.SetColumnType(col, BinaryFormat::GetColumnType(s_TypeOids[col]));
+
+                    for (std::size_t row{}; row < rowCount; ++row)
+                    {
+                        for (std::size_t col{}; col < s_ColumnCount; ++col)
+                            BinaryFormat::AppendValue(binaryResult, col, s_TypeOids[col], binaryCells[row * s_ColumnCount + col]);
+                        binaryResult.CommitRow();
+                    }
+                });
+
+            // Displaying everything is the worst case for lazy formatting, the grid only formats visible cells.
+            std::size_t textLength{0}, binaryLength{0};
+            const double textFormatMs   = MeasureBestMs([&]() { textLength = FormatAllCells(textResult); });
+            const double binaryFormatMs = MeasureBestMs([&]() { binaryLength = FormatAllCells(binaryResult); });
+
+            // Client-side aggregate over overall_price, text has to be reparsed every time.
+            double textSum{0.0}, binarySum{0.0};
+            const double textSumMs = MeasureBestMs(
+                [&]()
+                {
+                    textSum = 0.0;
+                    for (std::size_t row{}; row < rowCount; ++row)
+                        textSum += std::strtod(std::string(textResult.GetValue(row, 2)).c_str(), nullptr);
+                });
+            const double binarySumMs = MeasureBestMs(
+                [&]()
+                {
+                    binarySum = 0.0;
+                    for (std::size_t row{}; row < rowCount; ++row)
+                        binarySum += binaryResult.GetFloat64(row, 2);
+                });
+
+            std::printf("result format benchmark: %zu synthetic `orders` rows (best of 5)\n", rowCount);
+            std::printf("  fill\n");
+            PrintFormatRow("text cells", textFillMs, rowCount, textResult.GetMemoryUsage());
+            PrintFormatRow("binary decode", binaryFillMs, rowCount, binaryResult.GetMemoryUsage());
+            std::printf("  format every cell: text %.2f ms, binary %.2f ms (%zu vs %zu chars)\n", textFormatMs, binaryFormatMs, textLength,
+                        binaryLength);
+            std::printf("  SUM(overall_price): text %.2f ms, binary %.2f ms (%.2f vs %.2f)\n", textSumMs, binarySumMs, textSum, binarySum);
+        }
+
+        static void RunDatabaseResultFormatBenchmark(const DatabaseDesc& databaseDesc, uint32_t iterationCount) noexcept
+        {
+            Logger::Init();
+            Logger::GetLogger()->set_level(spdlog::level::warn);  // no per-query trace lines in the output
+
+            {
+                DatabaseConnection connection(databaseDesc, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1});
+                if (!connection.TryConnectIfNotConnected())
+                {
+                    std::printf("failed to connect to %s:%d/%s\n", databaseDesc.HostName.c_str(), static_cast<int32_t>(databaseDesc.Port),
+                                databaseDesc.Database.c_str());
+                    Logger::Shutdown();
+                    return;
+                }
+
+                std::printf("result format benchmark: %s (best of %u, includes transfer)\n", databaseDesc.Database.c_str(), iterationCount);
+                for (const char* tableName : {"orders", "frames"})
+                {
+                    const std::string query = std::string("SELECT * FROM ") + tableName;
+                    std::printf("  %s\n", query.c_str());
+                    for (const EResultFormat resultFormat : {EResultFormat::Text, EResultFormat::Binary})
+                    {
+                        std::size_t rowCount{0}, memoryBytes{0};
+                        const double fetchMs = MeasureBestMs(
+                            [&]()
+                            {
+                                const auto result = connection.Execute(query, resultFormat);
+                                rowCount          = result ? result->GetRowCount() : 0;
+                                memoryBytes       = result ? result->GetMemoryUsage() : 0;
+                            },
+                            iterationCount);
+
+                        PrintFormatRow(resultFormat == EResultFormat::Text ? "text" : "binary", fetchMs, rowCount, memoryBytes);
+                    }
+                }
+            }
+
+            Logger::Shutdown();
+        }
+
+        void RunResultFormatBenchmark(std::size_t rowCount, const DatabaseDesc* databaseDesc, uint32_t iterationCount) noexcept
+        {
+            RunSyntheticResultFormatBenchmark(rowCount);
+            if (databaseDesc) RunDatabaseResultFormatBenchmark(*databaseDesc, std::max(iterationCount, 1u));
+        }
+
+        // Shaped like `clients` fetched in binary: id int4, full_name varchar, is_professional bool, discount numeric(5, 2).
+        static QueryResult GenerateClients(std::size_t rowCount) noexcept
+        {
+            static constexpr std::array<std::string_view, 12> s_FirstNames = {
+                "John", "Jane", "Peter", "Alice", "Ivan", "Olga", "Sergey", "Maria", "Dmitry", "Anna", "Pavel", "Elena"};
+            static constexpr std::array<std::string_view, 12> s_LastNames = {
+                "Doe", "Smith", "Jones", "Brown", "Ivanov", "Petrova", "Sidorov", "Kuznetsova", "Popov", "Sokolova", "Lebedev", "Novikova"};
+
+            std::mt19937 rng(42);
+            QueryResult result(std::vector<std::string>{"id", "full_name", "is_professional", "discount"});
+            result.SetColumnType(0, EColumnType::Int32);
+            result.SetColumnType(2, EColumnType::Bool);
+            result.SetColumnType(3, EColumnType::Numeric);
+            result.Reserve(rowCount);
+
+            std::string fullName{};
+            for (std::size_t row{}; row < rowCount; ++row)
+            {
+                fullName.assign(s_FirstNames[rng() % s_FirstNames.size()]);
+                fullName.append(" ").append(s_LastNames[rng() % s_LastNames.size()]);
+
+                result.AppendInt64(0, static_cast<int64_t>(row + 1));
+                result.AppendValue(1, fullName);
+                result.AppendInt64(2, rng() % 4 == 0);
+                result.AppendNumeric(3, static_cast<int64_t>(rng() % 4) * 500, 2);
+                result.CommitRow();
+            }
+
+            return result;
+        }
+
+        // What a find feature without the columnar store would do: every cell formatted, lowercased and searched on its own.
+        static std::size_t CountMatchesNaive(const QueryResult& result, std::string_view pattern) noexcept
+        {
+            std::string lowercasePattern(pattern);
+            std::ranges::transform(lowercasePattern, lowercasePattern.begin(),
+                                   [](const char c) { return static_cast<char>(std::tolower(c)); });
+
+            std::size_t matchCount{0};
+            QueryResult::FormatBuffer formatBuffer{};
+            for (std::size_t row{}; row < result.GetRowCount(); ++row)
+            {
+                for (std::size_t col{}; col < result.GetColumnCount(); ++col)
+                {
+                    if (result.IsNull(row, col)) continue;
+
+                    std::string cell(result.FormatValue(row, col, formatBuffer));
+                    std::ranges::transform(cell, cell.begin(), [](const char c) { return static_cast<char>(std::tolower(c)); });
+                    if (cell.find(lowercasePattern) != std::string::npos) ++matchCount;
+                }
+            }
+
+            return matchCount;
+        }
+
+        void RunResultSearchBenchmark(std::size_t rowCount) noexcept
+        {
+            const QueryResult result = GenerateClients(rowCount);
+
+            std::vector<ESearchKernel> kernels{ESearchKernel::Scalar};
+            if (GetFastestSearchKernel() >= ESearchKernel::Sse2) kernels.emplace_back(ESearchKernel::Sse2);
+            if (GetFastestSearchKernel() >= ESearchKernel::Avx2) kernels.emplace_back(ESearchKernel::Avx2);
+
+            std::printf("result search benchmark: %zu synthetic `clients` rows, %u threads (best of 5)\n", rowCount,
+                        std::thread::hardware_concurrency());
+
+            // The kernel alone, one thread over the full_name arena: how far the vector compares get ahead of a byte loop.
+            const std::string_view fullNames = result.GetColumnArena(1);
+            std::printf("  single scan of full_name (%.2f MiB), pattern without hits\n",
+                        static_cast<double>(fullNames.size()) / (1024.0 * 1024.0));
+            for (const ESearchKernel kernel : kernels)
+            {
+                const TextSearcher searcher("xyzzy", false, kernel);
+                std::size_t position{0};
+                const double scanMs = MeasureBestMs([&]() { position = searcher.Find(fullNames); });
+                std::printf("    %-8s %10.3f ms %8.2f GiB/s%s\n", GetSearchKernelName(kernel), scanMs,
+                            static_cast<double>(fullNames.size()) / (scanMs * 1e-3) / (1024.0 * 1024.0 * 1024.0),
+                            position == std::string_view::npos ? "" : " (unexpected hit)");
+            }
+
+            // Whole result, typed columns formatted on the fly, as the find box runs it.
+            std::printf("  find in every column: %-12s %10s", "pattern", "naive");
+            for (const ESearchKernel kernel : kernels)
+                std::printf(" %10s", GetSearchKernelName(kernel));
+            std::printf(" %10s\n", "cells");
+            for (const std::string_view pattern : {"xyzzy", "smith", "jane sm", "42"})
+            {
+                std::size_t naiveCount{0};
+                const double naiveMs = MeasureBestMs([&]() { naiveCount = CountMatchesNaive(result, pattern); }, 1);
+                std::printf("  %22s%-12.*s %7.2f ms", "", static_cast<int>(pattern.size()), pattern.data(), naiveMs);
+
+                std::size_t matchCount{0};
+                for (const ESearchKernel kernel : kernels)
+                {
+                    const TextSearcher searcher(pattern, false, kernel);
+                    std::printf(" %7.2f ms", MeasureBestMs([&]() { matchCount = FindInResult(result, searcher).size(); }));
+                }
+                std::printf(" %10zu%s\n", matchCount, matchCount == naiveCount ? "" : " (differs from naive)");
+            }
+
+            // Typing on: "smit" -> "smith" only rechecks the cells "smit" matched.
+            const TextSearcher prefixSearcher("smit");
+            const TextSearcher searcher("smith");
+            const auto candidates = FindInResult(result, prefixSearcher);
+            std::size_t refinedCount{0};
+            const double refineMs = MeasureBestMs([&]() { refinedCount = RefineSearchMatches(result, searcher, candidates).size(); });
+            std::printf("  refine \"smit\" -> \"smith\": %zu -> %zu cells in %.2f ms\n", candidates.size(), refinedCount, refineMs);
+        }
+
+    }  // namespace Benchmarks
+
+}  // namespace nsudb
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace nsudb
+{
+
+    struct DatabaseDesc;
+
+    namespace Benchmarks
+    {
+        // Fills the old vector<vector<string>> row layout and the columnar QueryResult with the same synthetic `orders`-like rows,
+        // prints fill time, heap bytes and allocation counts of both.
+        void RunResultStoreBenchmark(std::size_t rowCount) noexcept;
+
+        // Renders growing results through a headless ImGui context (no window, no GPU) with the old every-row loop
+        // and with the clipped ResultTable, prints mean/p99 CPU frame time of both.
+        void RunResultTableBenchmark() noexcept;
+
+        // Synthetic `orders` rows stored from text cells vs decoded from their binary encoding, then the cost of formatting
+        // them for display and of summing overall_price. With a database also fetches `orders` and `frames` in both formats.
+        void RunResultFormatBenchmark(std::size_t rowCount, const DatabaseDesc* databaseDesc, uint32_t iterationCount) noexcept;
+
+        // Synthetic `clients` rows searched for a few name fragments: a naive per-cell find against FindInResult() with every
+        // search kernel the CPU has, the raw single-thread scan speed of each kernel and the narrowing of a longer pattern.
+        void RunResultSearchBenchmark(std::size_t rowCount) noexcept;
+    }  // namespace Benchmarks
+
+}  // namespace nsudb
@@ -0,0 +1,224 @@
+#include "BinaryFormat.hpp"
+
+#include <bit>
+#include <charconv>
+
+namespace nsudb
+{
+
+    namespace BinaryFormat
+    {
+        // Binary format is big endian, read byte by byte so unaligned libpq buffers are fine too.
+        template <typename T> static T ReadBigEndian(const char* data) noexcept
+        {
+            using TUnsigned = std::make_unsigned_t<T>;
+
+            TUnsigned value{0};
+            for (std::size_t i{}; i < sizeof(T); ++i)
+                value = static_cast<TUnsigned>((value << 8) | static_cast<uint8_t>(data[i]));
+
+            return static_cast<T>(value);
+        }
+
+        static constexpr uint16_t s_NumericNegative      = 0x4000;
+        static constexpr uint16_t s_NumericNaN           = 0xC000;
+        static constexpr uint16_t s_NumericPlusInfinity  = 0xD000;
+        static constexpr uint16_t s_NumericMinusInfinity = 0xF000;
+        static constexpr int32_t s_NumericMaxExactScale  = 18;  // 10^18 still fits into int64
+
+        // numeric goes over the wire as base-10000 digits: ndigits, weight (of the first digit), sign, dscale, digits[ndigits].
+        // Values that fit into int64 once scaled by 10^dscale stay exact, the rest (and NaN/infinity) become a double.
+        static void AppendNumeric(QueryResult& result, std::size_t column, std::string_view bytes) noexcept
+        {
+            const int16_t digitCount   = ReadBigEndian<int16_t>(bytes.data());
+            const int16_t weight       = ReadBigEndian<int16_t>(bytes.data() + 2);
+            const uint16_t sign        = ReadBigEndian<uint16_t>(bytes.data() + 4);
+            const int16_t displayScale = ReadBigEndian<int16_t>(bytes.data() + 6);
+            if (digitCount < 0 || bytes.size() < 8 + static_cast<std::size_t>(digitCount) * 2)
+            {
+                result.AppendNull(column);
+                return;
+            }
+
+            const auto appendDouble = [&](double value)
+            { result.AppendNumeric(column, std::bit_cast<int64_t>(value), QueryResult::s_NumericAsFloat64); };
+
+            switch (sign)
+            {
+                case s_NumericNaN: appendDouble(std::numeric_limits<double>::quiet_NaN()); return;
+                case s_NumericPlusInfinity: appendDouble(std::numeric_limits<double>::infinity()); return;
+                case s_NumericMinusInfinity: appendDouble(-std::numeric_limits<double>::infinity()); return;
+                default: break;
+            }
+
+            const bool bNegative = sign == s_NumericNegative;
+            const char* digits   = bytes.data() + 8;
+
+            constexpr uint64_t s_MaxMagnitude = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+            bool bFits                        = displayScale <= s_NumericMaxExactScale;
+            uint64_t magnitude{0};
+            for (int16_t i{}; bFits && i < digitCount; ++i)
+            {
+                const uint64_t digit = static_cast<uint16_t>(ReadBigEndian<int16_t>(digits + i * 2));
+                bFits                = magnitude <= (s_MaxMagnitude - digit) / 10000;
+                magnitude            = magnitude * 10000 + digit;
+            }
+
+            // Digits so far are an integer in units of 10000^(weight - digitCount + 1), move that to units of 10^-dscale.
+            // Groups past dscale are always zero (the server rounds to dscale), so dividing them away is exact.
+            int32_t exponent = 4 * (weight - digitCount + 1) + displayScale;
+            for (; bFits && exponent > 0 && magnitude != 0; --exponent)
+            {
+                bFits = magnitude <= s_MaxMagnitude / 10;
+                magnitude *= 10;
+            }
+            for (; bFits && exponent < 0 && magnitude != 0; ++exponent)
+                magnitude /= 10;
+
+            if (bFits)
+            {
+                const int64_t scaledValue = static_cast<int64_t>(magnitude);
+                result.AppendNumeric(column, bNegative ? -scaledValue : scaledValue, static_cast<uint8_t>(displayScale));
+                return;
+            }
+
+            double value{0.0};
+            for (int16_t i{}; i < digitCount; ++i)
+                value = value * 10000.0 + static_cast<uint16_t>(ReadBigEndian<int16_t>(digits + i * 2));
+            value *= std::pow(10000.0, weight - digitCount + 1);
+
+            appendDouble(bNegative ? -value : value);
+        }
+
+        static void AppendFloat4AsText(QueryResult& result, std::size_t column, float value) noexcept
+        {
+            if (std::isnan(value)) return result.AppendValue(column, "NaN");
+            if (std::isinf(value)) return result.AppendValue(column, value > 0 ? "Infinity" : "-Infinity");
+
+            // Shortest round-trip form of the float itself, the same digits the server prints.
+            char buffer[32]{};
+            const auto [end, errorCode] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            result.AppendValue(column, std::string_view(buffer, end - buffer));
+        }
+
+        static void AppendHexText(QueryResult& result, std::size_t column, std::string_view bytes, bool bUuid) noexcept
+        {
+            static constexpr std::string_view s_HexDigits = "0123456789abcdef";
+
+            std::string text{};
+            text.reserve(2 + bytes.size() * 2 + 4);
+            if (!bUuid) text += "\\x";
+
+            for (std::size_t i{}; i < bytes.size(); ++i)
+            {
+                if (bUuid && (i == 4 || i == 6 || i == 8 || i == 10)) text += '-';
+
+                const uint8_t byte = static_cast<uint8_t>(bytes[i]);
+                text += s_HexDigits[byte >> 4];
+                text += s_HexDigits[byte & 0xF];
+            }
+
+            result.AppendValue(column, text);
+        }
+
+        EColumnType GetColumnType(uint32_t typeOid) noexcept
+        {
+            switch (typeOid)
+            {
+                case Bool: return EColumnType::Bool;
+                case Int2:
+                case Int4: return EColumnType::Int32;
+                case Int8: return EColumnType::Int64;
+                case Float8: return EColumnType::Float64;
+                case Numeric: return EColumnType::Numeric;
+                case Date: return EColumnType::Date;
+                case Timestamp: return EColumnType::Timestamp;
+                case TimestampTz: return EColumnType::TimestampTz;
+                default: return EColumnType::Text;
+            }
+        }
+
+        bool IsNumericType(uint32_t typeOid) noexcept
+        {
+            switch (typeOid)
+            {
+                case Int2:
+                case Int4:
+                case Int8:
+                case Float4:
+                case Float8:
+                case Numeric: return true;
+                default: return false;
+            }
+        }
+
+        bool HasTextRendering(uint32_t typeOid) noexcept
+        {
+            switch (typeOid)
+            {
+                case Bytea:
+                case Char:
+                case Name:
+                case Text:
+                case Json:
+                case Float4:
+                case Bpchar:
+                case Varchar:
+                case Uuid: return true;
+                default: return GetColumnType(typeOid) != EColumnType::Text;
+            }
+        }
+
+        void AppendValue(QueryResult& result, std::size_t column, uint32_t typeOid, std::string_view bytes) noexcept
+        {
+            // Fixed-width types with a short buffer can only come from a server/protocol mismatch, show them as NULL.
+            const auto hasSize = [&](std::size_t size)
+            {
+                if (bytes.size() >= size) return true;
+
+                result.AppendNull(column);
+                return false;
+            };
+
+            switch (typeOid)
+            {
+                case Bool:
+                    if (hasSize(1)) result.AppendInt64(column, bytes[0] != 0);
+                    break;
+                case Int2:
+                    if (hasSize(2)) result.AppendInt64(column, ReadBigEndian<int16_t>(bytes.data()));
+                    break;
+                case Int4:
+                case Date:
+                    if (hasSize(4)) result.AppendInt64(column, ReadBigEndian<int32_t>(bytes.data()));
+                    break;
+                case Int8:
+                case Timestamp:
+                case TimestampTz:
+                    if (hasSize(8)) result.AppendInt64(column, ReadBigEndian<int64_t>(bytes.data()));
+                    break;
+                case Float8:
+                    if (hasSize(8)) result.AppendFloat64(column, std::bit_cast<double>(ReadBigEndian<uint64_t>(bytes.data())));
+                    break;
+                case Numeric:
+                    if (hasSize(8)) AppendNumeric(result, column, bytes);
+                    break;
+                case Float4:
+                    if (hasSize(4)) AppendFloat4AsText(result, column, std::bit_cast<float>(ReadBigEndian<uint32_t>(bytes.data())));
+                    break;
+                case Uuid:
+                    if (hasSize(16)) AppendHexText(result, column, bytes.substr(0, 16), true);
+                    break;
+                case Char:
+                case Name:
+                case Text:
+                case Json:
+                case Bpchar:
+                case Varchar: result.AppendValue(column, bytes); break;
+                default: AppendHexText(result, column, bytes, false); break;
+            }
+        }
+
+    }  // namespace BinaryFormat
+
+}  // namespace nsudb
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <QueryResult.hpp>
+
+namespace nsudb
+{
+
+    // Decoding of PostgreSQL binary-format (network byte order) values into QueryResult columns.
+    namespace BinaryFormat
+    {
+        // Builtin type OIDs, see pg_type.dat.
+        enum ETypeOid : uint32_t
+        {
+            Bool        = 16,
+            Bytea       = 17,
+            Char        = 18,
+            Name        = 19,
+            Int8        = 20,
+            Int2        = 21,
+            Int4        = 23,
+            Text        = 25,
+            Json        = 114,
+            Float4      = 700,
+            Float8      = 701,
+            Bpchar      = 1042,
+            Varchar     = 1043,
+            Date        = 1082,
+            Timestamp   = 1114,
+            TimestampTz = 1184,
+            Numeric     = 1700,
+            Uuid        = 2950
+        };
+
+        // Column type values of this OID are decoded into, everything without a typed form lands in Text.
+        EColumnType GetColumnType(uint32_t typeOid) noexcept;
+
+        // Integer, floating point and numeric types, whatever format their values arrive in.
+        bool IsNumericType(uint32_t typeOid) noexcept;
+
+        // False for types whose binary form has no readable rendering here, those get stored hex-escaped (\x...).
+        bool HasTextRendering(uint32_t typeOid) noexcept;
+
+        // Appends one non-NULL value to the current row, the column type must come from GetColumnType(typeOid).
+        void AppendValue(QueryResult& result, std::size_t column, uint32_t typeOid, std::string_view bytes) noexcept;
+    }  // namespace BinaryFormat
+
+}  // namespace nsudb
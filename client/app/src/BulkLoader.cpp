@@ -0,0 +1,538 @@
+#include "BulkLoader.hpp"
+#include <Logger.hpp>
+
+#include <pgfe/pgfe.hpp>
+#include <libpq-fe.h>
+
+namespace nsudb
+{
+
+    // Parents before children, same as 06-fill-tables.sql. Anything else goes last in name order.
+    static constexpr std::array<std::string_view, 27> s_TableLoadOrder = {"outlet_types",
+                                                                          "outlets",
+                                                                          "branches",
+                                                                          "photo_stores",
+                                                                          "kiosks",
+                                                                          "service_types",
+                                                                          "service_types_outlets",
+                                                                          "firms",
+                                                                          "items",
+                                                                          "clients",
+                                                                          "orders",
+                                                                          "print_discounts",
+                                                                          "print_orders",
+                                                                          "storages",
+                                                                          "service_orders",
+                                                                          "film_development_orders",
+                                                                          "films",
+                                                                          "vendors",
+                                                                          "vendor_items",
+                                                                          "paper_types",
+                                                                          "paper_sizes",
+                                                                          "print_prices",
+                                                                          "frames",
+                                                                          "deliveries",
+                                                                          "delivery_items",
+                                                                          "service_types_needed_items",
+                                                                          "storage_items"};
+
+    struct DeferrableTrigger final
+    {
+        std::string_view TableName{};
+        std::string_view TriggerName{};
+    };
+
+    // INSERT triggers whose effect the set-based pass of 07-bulk-load.sql reproduces. The overall price ones are statement
+    // level (08-statement-triggers.sql) and would fire once per COPY, deferring them still saves recomputing the same orders
+    // after every file. With 14-inventory-ledger.sql the storage ones are statement level too and only append to the ledger,
+    // the same functions the pass calls.
+    static constexpr std::array<DeferrableTrigger, 5> s_DeferrableTriggers = {{
+        {"service_orders", "trg_after_service_orders_insert"},
+        {"service_orders", "trg_after_service_orders_items_use"},
+        {"print_orders", "trg_after_print_orders_insert"},
+        {"frames", "trg_after_frames_insert"},
+        {"delivery_items", "trg_after_delivery_items_change"},
+    }};
+
+    // Rows the load transaction inserted itself, which is exactly what the deferred triggers would have seen.
+    static constexpr std::string_view s_InsertedByLoad = "xmin = pg_current_xact_id()::xid";
+
+    struct PartitionedTable final
+    {
+        std::string_view TableName{};
+        std::string_view PartitionKey{};
+        std::string_view ParentTableName{};     // where a file without the key takes it from, empty for orders
+        std::string_view ParentIdColumn{};      // references the parent's id
+        std::string_view ParentPartitionKey{};
+    };
+
+    // Tables partitioned by the order's accept time (13-monthly-partitions.sql). A child row without the key would be re-inserted
+    // one by one by the trigger of the DEFAULT partition, and the files of the children don't repeat their order's time.
+    // Their rows are copied into a staging table and moved over from there with the key joined in, parents before children.
+    static constexpr std::array<PartitionedTable, 4> s_PartitionedTables = {{
+        {"orders", "accept_time", {}, {}, {}},
+        {"print_orders", "order_accept_time", "orders", "order_id", "accept_time"},
+        {"service_orders", "order_accept_time", "orders", "order_id", "accept_time"},
+        {"frames", "order_accept_time", "print_orders", "print_order_id", "order_accept_time"},
+    }};
+
+    static const PartitionedTable* FindPartitionedTable(std::string_view tableName) noexcept
+    {
+        const auto it = std::find_if(s_PartitionedTables.begin(), s_PartitionedTables.end(),
+                                     [&](const PartitionedTable& table) { return table.TableName == tableName; });
+        return it != s_PartitionedTables.end() ? &*it : nullptr;
+    }
+
+    static std::size_t GetTableLoadRank(std::string_view tableName) noexcept
+    {
+        return static_cast<std::size_t>(std::find(s_TableLoadOrder.begin(), s_TableLoadOrder.end(), tableName) - s_TableLoadOrder.begin());
+    }
+
+    static std::string TrimErrorMessage(const char* message) noexcept
+    {
+        std::string error = message ? message : "";
+        while (!error.empty() && (error.back() == '\n' || error.back() == '\r'))
+            error.pop_back();
+
+        return error;
+    }
+
+    static std::string EscapeIdentifier(PGconn* conn, std::string_view identifier) noexcept
+    {
+        char* escaped = PQescapeIdentifier(conn, identifier.data(), identifier.size());
+        if (!escaped) return std::string(identifier);
+
+        std::string result = escaped;
+        PQfreemem(escaped);
+        return result;
+    }
+
+    static std::string EscapeLiteral(PGconn* conn, std::string_view literal) noexcept
+    {
+        char* escaped = PQescapeLiteral(conn, literal.data(), literal.size());
+        if (!escaped) return "''";
+
+        std::string result = escaped;
+        PQfreemem(escaped);
+        return result;
+    }
+
+    // Everything here talks to libpq on the pooled connection's handle: COPY IN needs PQputCopyData() anyway,
+    // and the load is one long transaction that nothing else touches.
+    static bool ExecuteCommand(PGconn* conn, const std::string& sql, std::string& error) noexcept
+    {
+        PGresult* result            = PQexec(conn, sql.c_str());
+        const ExecStatusType status = PQresultStatus(result);
+        const bool bSucceeded       = status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+        if (!bSucceeded) error = result ? TrimErrorMessage(PQresultErrorMessage(result)) : TrimErrorMessage(PQerrorMessage(conn));
+
+        PQclear(result);
+        return bSucceeded;
+    }
+
+    // Moves the staged rows of a partitioned table over and drops the staging table. Orders get the partitions of their months
+    // first (create_order_partitions is granted to manager only), children without the key in the file take it from their parent
+    // row. A missing parent leaves the key NULL, the DEFAULT partition's trigger finds no order either and fails the INSERT.
+    static bool InsertStagedRows(PGconn* conn, const PartitionedTable& table, const std::vector<std::string>& columnNames,
+                                 const std::string& tableName, const std::string& stagingName, std::string& error) noexcept
+    {
+        std::string columnList{}, selectList{};
+        for (const auto& columnName : columnNames)
+        {
+            const std::string column = EscapeIdentifier(conn, columnName);
+            columnList += (columnList.empty() ? "" : ", ") + column;
+            selectList += (selectList.empty() ? "s." : ", s.") + column;
+        }
+
+        const bool bHasKey             = std::find(columnNames.begin(), columnNames.end(), table.PartitionKey) != columnNames.end();
+        const std::string partitionKey = EscapeIdentifier(conn, table.PartitionKey);
+        std::string fromClause         = " FROM " + stagingName + " s";
+        if (table.ParentTableName.empty())
+        {
+            // Without accept_time in the file the orders take NOW(), that month is kept ahead of time anyway.
+            if (bHasKey && !ExecuteCommand(conn,
+                                           "SELECT create_order_partitions(MIN(" + partitionKey + "), MAX(" + partitionKey + "))" +
+                                               fromClause,
+                                           error))
+                return false;
+        }
+        else if (!bHasKey)
+        {
+            columnList += ", " + partitionKey;
+            selectList += ", p." + EscapeIdentifier(conn, table.ParentPartitionKey);
+            fromClause += " LEFT JOIN " + EscapeIdentifier(conn, table.ParentTableName) + " p ON p.id = s." +
+                          EscapeIdentifier(conn, table.ParentIdColumn);
+        }
+
+        return ExecuteCommand(conn, "INSERT INTO " + tableName + " (" + columnList + ") SELECT " + selectList + fromClause, error) &&
+               ExecuteCommand(conn, "DROP TABLE " + stagingName, error);
+    }
+
+    // Header names, unquoted. The CSVs come from our own exports, so no embedded commas/newlines in names.
+    static std::vector<std::string> ReadCsvHeader(std::istream& stream) noexcept
+    {
+        std::string line{};
+        std::getline(stream, line);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.size() >= 3 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);  // UTF-8 BOM
+
+        std::vector<std::string> columnNames{};
+        for (const auto columnName : std::views::split(line, ','))
+        {
+            std::string name(columnName.begin(), columnName.end());
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"') name = name.substr(1, name.size() - 2);
+            if (!name.empty()) columnNames.emplace_back(std::move(name));
+        }
+
+        return columnNames;
+    }
+
+    BulkLoader::BulkLoader(DatabaseConnection& connection, BulkLoadDesc desc) noexcept
+        : m_Connection(connection), m_Desc(std::move(desc)), m_StartTime(std::chrono::steady_clock::now())
+    {
+        m_Desc.ChunkSize = std::clamp<std::size_t>(m_Desc.ChunkSize, 4 * 1024, 64 * 1024 * 1024);
+
+        std::error_code errorCode{};
+        const auto addFile = [&](const std::filesystem::path& path)
+        {
+            const uint64_t byteCount = std::filesystem::file_size(path, errorCode);
+            m_Files.emplace_back(path, path.stem().string(), errorCode ? 0 : byteCount);
+            m_TotalBytes += m_Files.back().ByteCount;
+        };
+
+        for (const auto& path : m_Desc.Paths)
+        {
+            if (std::filesystem::is_directory(path, errorCode))
+            {
+                for (const auto& entry : std::filesystem::directory_iterator(path, errorCode))
+                    if (entry.is_regular_file() && entry.path().extension() == ".csv") addFile(entry.path());
+            }
+            else if (std::filesystem::is_regular_file(path, errorCode))
+                addFile(path);
+            else
+                m_Error = "No such file or directory: " + path.string();
+        }
+
+        for (const auto& stream : m_Desc.Streams)
+        {
+            m_Files.emplace_back(std::filesystem::path{}, stream.TableName, stream.EstimatedBytes, &stream);
+            m_TotalBytes += stream.EstimatedBytes;
+        }
+
+        if (m_Error.empty() && m_Files.empty()) m_Error = "No CSV files to load.";
+        if (!m_Error.empty())
+        {
+            LOG_ERROR("Bulk load: {}", m_Error);
+            m_Status.store(EQueryStatus::Failed, std::memory_order_release);
+            m_bFinished.store(true, std::memory_order_release);
+            return;
+        }
+
+        std::sort(m_Files.begin(), m_Files.end(),
+                  [](const BulkLoadFile& lhs, const BulkLoadFile& rhs)
+                  {
+                      const std::size_t lhsRank = GetTableLoadRank(lhs.TableName), rhsRank = GetTableLoadRank(rhs.TableName);
+                      return lhsRank != rhsRank ? lhsRank < rhsRank : lhs.TableName < rhs.TableName;
+                  });
+
+        m_Thread = std::thread(&BulkLoader::Run, this);
+    }
+
+    BulkLoader::~BulkLoader() noexcept
+    {
+        Cancel();
+        if (m_Thread.joinable()) m_Thread.join();
+    }
+
+    float BulkLoader::GetElapsedSeconds() const noexcept
+    {
+        int64_t elapsedNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (elapsedNs == 0)
+            elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        return static_cast<float>(static_cast<double>(elapsedNs) * 1e-9);
+    }
+
+    void BulkLoader::Cancel() noexcept
+    {
+        if (IsFinished()) return;
+
+        // COPY itself checks the flag between chunks, the request covers the set-based pass and slow COMMITs.
+        std::scoped_lock lock(m_CancelMutex);
+        m_bCancelRequested.store(true, std::memory_order_release);
+        if (!m_CancelHandle) return;
+
+        char errorBuffer[256]{};
+        if (!PQcancel(m_CancelHandle, errorBuffer, sizeof(errorBuffer))) LOG_WARN("Failed to send cancel request: {}", errorBuffer);
+    }
+
+    void BulkLoader::Run() noexcept
+    {
+        m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+        bool bSucceeded = false;
+        if (PooledConnection connection = m_Connection.AcquireConnection(); connection)
+        {
+            {
+                std::scoped_lock lock(m_CancelMutex);
+                m_CancelHandle = connection.GetCancelHandle();
+            }
+
+            bSucceeded = Load(connection);
+
+            std::scoped_lock lock(m_CancelMutex);
+            m_CancelHandle = nullptr;
+        }
+        else
+            m_Error = "No database connection available.";
+
+        EQueryStatus status = bSucceeded ? EQueryStatus::Done : EQueryStatus::Failed;
+        if (!bSucceeded && m_bCancelRequested.load(std::memory_order_acquire))
+        {
+            status  = EQueryStatus::Cancelled;
+            m_Error = "Load cancelled, nothing was written.";
+        }
+
+        if (bSucceeded)
+            LOG_TRACE("Bulk load: {} rows, {} bytes in {:.2f} s ({:.2f} s set-based recompute)", GetRowsLoaded(), GetBytesSent(),
+                      GetElapsedSeconds(), GetRecomputeSeconds());
+        else
+            LOG_ERROR("Bulk load failed: {}", m_Error);
+
+        m_EndTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count(),
+                          std::memory_order_release);
+        m_Status.store(status, std::memory_order_release);
+        m_bFinished.store(true, std::memory_order_release);
+    }
+
+    bool BulkLoader::Load(PooledConnection& connection) noexcept
+    {
+        PGconn* conn = connection->native_handle();
+
+        // pgfe runs its connections non-blocking, COPY IN is a lot simpler with blocking sends and no slower.
+        const int32_t wasNonBlocking = PQisnonblocking(conn);
+        PQsetnonblocking(conn, 0);
+
+        std::vector<std::string_view> deferredTables{};
+        const auto isDeferred = [&](std::string_view tableName)
+        { return std::find(deferredTables.begin(), deferredTables.end(), tableName) != deferredTables.end(); };
+
+        const auto loadInTransaction = [&]() -> bool
+        {
+            if (!ExecuteCommand(conn, "BEGIN", m_Error)) return false;
+
+            // DISABLE TRIGGER is transactional (and locks the table until COMMIT), so nobody ever sees the tables without them.
+            for (const auto& trigger : s_DeferrableTriggers)
+            {
+                if (!m_Desc.bDeferTriggers) break;
+
+                const bool bLoaded = std::any_of(m_Files.begin(), m_Files.end(),
+                                                 [&](const BulkLoadFile& file) { return file.TableName == trigger.TableName; });
+                if (!bLoaded) continue;
+
+                if (!ExecuteCommand(conn,
+                                    "ALTER TABLE " + EscapeIdentifier(conn, trigger.TableName) + " DISABLE TRIGGER " +
+                                        EscapeIdentifier(conn, trigger.TriggerName),
+                                    m_Error))
+                    return false;
+
+                if (!isDeferred(trigger.TableName)) deferredTables.emplace_back(trigger.TableName);
+            }
+
+            for (std::size_t i{}; i < m_Files.size(); ++i)
+            {
+                m_CurrentFileIndex.store(i, std::memory_order_relaxed);
+                if (!CopyFile(conn, m_Files[i])) return false;
+            }
+
+            if (!deferredTables.empty())
+            {
+                m_bRecomputing.store(true, std::memory_order_relaxed);
+                const auto recomputeStartTime = std::chrono::steady_clock::now();
+
+                std::vector<std::string> repricedOrders{};
+                if (isDeferred("frames"))
+                    repricedOrders.emplace_back("SELECT po.order_id FROM frames f JOIN print_orders po "
+                                                "ON f.print_order_id = po.id AND f.order_accept_time = po.order_accept_time "
+                                                "WHERE f." +
+                                                std::string(s_InsertedByLoad));
+                if (isDeferred("print_orders"))
+                    repricedOrders.emplace_back("SELECT order_id FROM print_orders WHERE " + std::string(s_InsertedByLoad));
+                if (isDeferred("service_orders"))
+                    repricedOrders.emplace_back("SELECT order_id FROM service_orders WHERE " + std::string(s_InsertedByLoad));
+
+                std::vector<std::string> recomputeStatements{};
+                if (isDeferred("delivery_items"))
+                    recomputeStatements.emplace_back("SELECT apply_delivery_items_to_storage(ARRAY(SELECT id FROM delivery_items WHERE " +
+                                                     std::string(s_InsertedByLoad) + "))");
+                if (isDeferred("service_orders"))
+                    recomputeStatements.emplace_back("SELECT apply_service_orders_to_storage(ARRAY(SELECT id FROM service_orders WHERE " +
+                                                     std::string(s_InsertedByLoad) + "))");
+                if (!repricedOrders.empty())
+                {
+                    std::string orderIdsQuery = repricedOrders.front();
+                    for (std::size_t i = 1; i < repricedOrders.size(); ++i)
+                        orderIdsQuery += " UNION " + repricedOrders[i];
+
+                    recomputeStatements.emplace_back("SELECT recalculate_order_overall_prices(ARRAY(" + orderIdsQuery + "))");
+                }
+
+                for (const auto& statement : recomputeStatements)
+                    if (m_bCancelRequested.load(std::memory_order_acquire) || !ExecuteCommand(conn, statement, m_Error)) return false;
+
+                m_RecomputeSeconds.store(std::chrono::duration<float>(std::chrono::steady_clock::now() - recomputeStartTime).count(),
+                                         std::memory_order_relaxed);
+                m_bRecomputing.store(false, std::memory_order_relaxed);
+            }
+
+            for (const auto& trigger : s_DeferrableTriggers)
+            {
+                if (!isDeferred(trigger.TableName)) continue;
+
+                if (!ExecuteCommand(conn,
+                                    "ALTER TABLE " + EscapeIdentifier(conn, trigger.TableName) + " ENABLE TRIGGER " +
+                                        EscapeIdentifier(conn, trigger.TriggerName),
+                                    m_Error))
+                    return false;
+            }
+
+            return !m_bCancelRequested.load(std::memory_order_acquire) && ExecuteCommand(conn, "COMMIT", m_Error);
+        };
+
+        const bool bSucceeded = loadInTransaction();
+        if (!bSucceeded)
+        {
+            std::string rollbackError{};
+            if (PQtransactionStatus(conn) != PQTRANS_IDLE && !ExecuteCommand(conn, "ROLLBACK", rollbackError))
+                LOG_WARN("Bulk load: rollback failed: {}", rollbackError);
+        }
+        else
+        {
+            // Fresh statistics for the planner, millions of new rows make the old ones useless. Not worth failing the load over.
+            std::string tableList{}, analyzeError{};
+            for (const auto& file : m_Files)
+                tableList += (tableList.empty() ? "" : ", ") + EscapeIdentifier(conn, file.TableName);
+
+            if (!ExecuteCommand(conn, "ANALYZE " + tableList, analyzeError)) LOG_WARN("Bulk load: ANALYZE failed: {}", analyzeError);
+        }
+
+        PQsetnonblocking(conn, wasNonBlocking);
+        return bSucceeded;
+    }
+
+    bool BulkLoader::CopyFile(PGconn* conn, const BulkLoadFile& file) noexcept
+    {
+        std::ifstream stream{};
+        std::vector<std::string> columnNames{};
+        if (file.Stream)
+            columnNames = file.Stream->ColumnNames;
+        else
+        {
+            stream.open(file.Path, std::ios::binary);
+            if (!stream)
+            {
+                m_Error = "Failed to open " + file.Path.string();
+                return false;
+            }
+
+            // Header doubles as the column list and HEADER MATCH makes the server check it, the whole file is sent as is.
+            columnNames = ReadCsvHeader(stream);
+            if (columnNames.empty())
+            {
+                m_Error = file.Path.string() + " has no header line.";
+                return false;
+            }
+            stream.clear();
+            stream.seekg(0);
+        }
+
+        const std::string tableName = EscapeIdentifier(conn, file.TableName);
+        std::string columnList{};
+        for (const auto& columnName : columnNames)
+            columnList += (columnList.empty() ? "" : ", ") + EscapeIdentifier(conn, columnName);
+
+        // Staging table of just the file's columns, gone at the end of the load transaction at the latest.
+        const PartitionedTable* partitionedTable = FindPartitionedTable(file.TableName);
+        const std::string copyTarget = partitionedTable ? EscapeIdentifier(conn, "bulk_load_" + file.TableName) : tableName;
+        if (partitionedTable && !ExecuteCommand(conn,
+                                                "CREATE TEMP TABLE " + copyTarget + " ON COMMIT DROP AS SELECT " + columnList + " FROM " +
+                                                    tableName + " WITH NO DATA",
+                                                m_Error))
+            return false;
+
+        const std::string copyStatement =
+            "COPY " + copyTarget + " (" + columnList + ") FROM STDIN (FORMAT csv" + (file.Stream ? ")" : ", HEADER MATCH)");
+        PGresult* copyResult            = PQexec(conn, copyStatement.c_str());
+        if (PQresultStatus(copyResult) != PGRES_COPY_IN)
+        {
+            m_Error = file.TableName + ": " + TrimErrorMessage(copyResult ? PQresultErrorMessage(copyResult) : PQerrorMessage(conn));
+            PQclear(copyResult);
+            return false;
+        }
+        PQclear(copyResult);
+
+        std::string abortReason{};
+        const auto sendChunk = [&](std::string_view chunk) -> bool
+        {
+            if (m_bCancelRequested.load(std::memory_order_acquire))
+            {
+                abortReason = "cancelled by user";
+                return false;
+            }
+            if (PQputCopyData(conn, chunk.data(), static_cast<int>(chunk.size())) != 1)
+            {
+                abortReason = TrimErrorMessage(PQerrorMessage(conn));
+                return false;
+            }
+
+            m_BytesSent.fetch_add(chunk.size(), std::memory_order_relaxed);
+            return true;
+        };
+
+        if (file.Stream)
+        {
+            if (!file.Stream->Produce(sendChunk) && abortReason.empty()) abortReason = "failed to generate rows";
+        }
+        else
+        {
+            // Raw file bytes in big chunks, the server does the CSV parsing, rows don't have to line up with chunk borders.
+            std::vector<char> chunk(m_Desc.ChunkSize);
+            while (stream)
+            {
+                stream.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                const std::streamsize readSize = stream.gcount();
+                if (readSize <= 0 || !sendChunk(std::string_view(chunk.data(), static_cast<std::size_t>(readSize)))) break;
+            }
+            if (abortReason.empty() && stream.bad()) abortReason = "failed to read " + file.Path.string();
+        }
+
+        // Bad rows and constraint violations only show up in the final result.
+        PQputCopyEnd(conn, abortReason.empty() ? nullptr : abortReason.c_str());
+
+        bool bSucceeded = abortReason.empty();
+        if (!bSucceeded) m_Error = file.TableName + ": " + abortReason;
+        while (PGresult* result = PQgetResult(conn))
+        {
+            if (PQresultStatus(result) == PGRES_COMMAND_OK)
+                m_RowsLoaded.fetch_add(std::strtoull(PQcmdTuples(result), nullptr, 10), std::memory_order_relaxed);
+            else if (bSucceeded)
+            {
+                m_Error    = file.TableName + ": " + TrimErrorMessage(PQresultErrorMessage(result));
+                bSucceeded = false;
+            }
+            PQclear(result);
+        }
+        if (!bSucceeded) return false;
+
+        if (partitionedTable && !InsertStagedRows(conn, *partitionedTable, columnNames, tableName, copyTarget, m_Error)) return false;
+
+        // Ids come from the file, so the serial sequence has to be moved past them or the next INSERT collides.
+        if (std::find(columnNames.begin(), columnNames.end(), "id") == columnNames.end()) return true;
+
+        return ExecuteCommand(conn,
+                              "SELECT setval(pg_get_serial_sequence(" + EscapeLiteral(conn, tableName) + ", 'id'), MAX(id)) FROM " +
+                                  tableName + " HAVING MAX(id) IS NOT NULL",
+                              m_Error);
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Database.hpp>
+
+struct pg_conn;
+
+namespace nsudb
+{
+
+    // Receives a table's CSV text in pieces, false stops the producer (failed send or cancelled load).
+    using BulkLoadSink = std::function<bool(std::string_view)>;
+
+    // Table whose rows are produced on the fly rather than read from a file, see DataGenerator.
+    struct BulkLoadStream final
+    {
+        std::string TableName{};
+        std::vector<std::string> ColumnNames{};
+        uint64_t EstimatedBytes{0};  // progress only
+
+        // Called once on the loader thread, writes every row without a header line. False fails the load.
+        std::function<bool(const BulkLoadSink&)> Produce{};
+    };
+
+    struct BulkLoadDesc final
+    {
+        static constexpr std::size_t s_DefaultChunkSize = 1 << 20;
+
+        // Files and/or directories (every *.csv inside). The file name without extension is the table name, the header
+        // line the column list, same layout as database/data.
+        std::vector<std::filesystem::path> Paths{};
+        std::size_t ChunkSize{s_DefaultChunkSize};  // bytes read and sent per COPY data message
+
+        // Loaded along with the files, in the same foreign key order.
+        std::vector<BulkLoadStream> Streams{};
+
+        // Disables the overall price and storage triggers of the loaded tables during COPY and applies their effect afterwards
+        // in one set-based pass (07-bulk-load.sql), instead of once per row or file.
+        bool bDeferTriggers{false};
+    };
+
+    struct BulkLoadFile final
+    {
+        std::filesystem::path Path{};
+        std::string TableName{};
+        uint64_t ByteCount{0};
+        const BulkLoadStream* Stream{nullptr};  // instead of Path, points into BulkLoadDesc::Streams
+    };
+
+    // Streams local CSV files (and generated tables) into their tables through COPY FROM STDIN, all of them in one transaction
+    // on one pooled connection, so a failure in any file leaves the database untouched. Files are loaded in foreign key order.
+    // Runs on its own thread, everything here is safe to poll every frame.
+    struct BulkLoader final
+    {
+        BulkLoader(DatabaseConnection& connection, BulkLoadDesc desc) noexcept;
+        ~BulkLoader() noexcept;  // cancels a running load and waits for the rollback
+
+        BulkLoader(const BulkLoader&)            = delete;
+        BulkLoader& operator=(const BulkLoader&) = delete;
+
+        bool IsFinished() const noexcept { return m_bFinished.load(std::memory_order_acquire); }
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Guarded by IsFinished(), the loader thread doesn't touch it after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+
+        // Load order, fixed before the thread starts.
+        const std::vector<BulkLoadFile>& GetFiles() const noexcept { return m_Files; }
+        std::size_t GetCurrentFileIndex() const noexcept { return m_CurrentFileIndex.load(std::memory_order_relaxed); }
+        const std::string& GetCurrentTableName() const noexcept { return m_Files[GetCurrentFileIndex()].TableName; }
+        bool IsRecomputing() const noexcept { return m_bRecomputing.load(std::memory_order_relaxed); }
+
+        uint64_t GetBytesSent() const noexcept { return m_BytesSent.load(std::memory_order_relaxed); }
+        uint64_t GetTotalBytes() const noexcept { return m_TotalBytes; }
+        // Generated tables only have an estimated size, hence the clamp.
+        float GetProgress() const noexcept
+        {
+            return m_TotalBytes == 0 ? 1.0f : std::min(static_cast<float>(GetBytesSent()) / m_TotalBytes, 1.0f);
+        }
+        uint64_t GetRowsLoaded() const noexcept { return m_RowsLoaded.load(std::memory_order_relaxed); }
+        float GetElapsedSeconds() const noexcept;
+        float GetRecomputeSeconds() const noexcept { return m_RecomputeSeconds.load(std::memory_order_relaxed); }
+
+        // Rolls the whole load back, also cancels a running set-based pass on the server.
+        void Cancel() noexcept;
+
+      private:
+        DatabaseConnection& m_Connection;
+        BulkLoadDesc m_Desc{};
+        std::vector<BulkLoadFile> m_Files{};
+        uint64_t m_TotalBytes{0};
+        std::string m_Error{};
+
+        std::chrono::steady_clock::time_point m_StartTime{};
+        std::atomic<int64_t> m_EndTimeNs{0};  // since m_StartTime
+        std::atomic<uint64_t> m_BytesSent{0};
+        std::atomic<uint64_t> m_RowsLoaded{0};
+        std::atomic<std::size_t> m_CurrentFileIndex{0};
+        std::atomic<float> m_RecomputeSeconds{0.0f};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bRecomputing{false};
+        std::atomic_bool m_bCancelRequested{false};
+        std::atomic_bool m_bFinished{false};
+
+        std::mutex m_CancelMutex{};
+        pg_cancel* m_CancelHandle{nullptr};  // guarded by m_CancelMutex, set while the connection is checked out
+
+        std::thread m_Thread{};
+
+        void Run() noexcept;
+        bool Load(PooledConnection& connection) noexcept;
+        bool CopyFile(pg_conn* conn, const BulkLoadFile& file) noexcept;
+    };
+
+}  // namespace nsudb
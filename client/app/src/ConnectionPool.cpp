@@ -0,0 +1,294 @@
+#include "ConnectionPool.hpp"
+#include <Logger.hpp>
+#include <PreparedStatementCache.hpp>
+
+#include <pgfe/pgfe.hpp>
+#include <libpq-fe.h>
+
+namespace nsudb
+{
+
+    namespace pgfe = dmitigr::pgfe;
+
+    struct PooledConnection::Entry final
+    {
+        std::unique_ptr<pgfe::Connection> Connection{nullptr};
+        pg_cancel* CancelHandle{nullptr};
+        PreparedStatementCache PreparedStatements{};
+        std::chrono::steady_clock::time_point LastReleaseTime{};
+        bool bSessionDirty{false};
+
+        ~Entry() noexcept
+        {
+            if (CancelHandle) PQfreeCancel(CancelHandle);
+            if (Connection && Connection->is_connected()) Connection->disconnect();
+        }
+    };
+
+    pgfe::Connection& PooledConnection::Get() const noexcept
+    {
+        assert(m_Entry && "Empty PooledConnection!");
+        return *m_Entry->Connection;
+    }
+
+    pg_cancel* PooledConnection::GetCancelHandle() const noexcept
+    {
+        return m_Entry ? m_Entry->CancelHandle : nullptr;
+    }
+
+    PreparedStatementCache& PooledConnection::GetPreparedStatements() const noexcept
+    {
+        assert(m_Entry && "Empty PooledConnection!");
+        return m_Entry->PreparedStatements;
+    }
+
+    void PooledConnection::MarkSessionDirty() noexcept
+    {
+        if (m_Entry) m_Entry->bSessionDirty = true;
+    }
+
+    void PooledConnection::Release() noexcept
+    {
+        if (!m_Entry) return;
+
+        m_Pool->Release(std::exchange(m_Entry, nullptr));
+        m_Pool = nullptr;
+    }
+
+    ConnectionPool::ConnectionPool(const DatabaseDesc& databaseDesc, const ConnectionPoolDesc& poolDesc) noexcept
+        : m_Desc(databaseDesc), m_PoolDesc(poolDesc)
+    {
+        m_PoolDesc.MaxConnections = std::max(m_PoolDesc.MaxConnections, 1u);
+        m_PoolDesc.MinConnections = std::min(m_PoolDesc.MinConnections, m_PoolDesc.MaxConnections);
+    }
+
+    ConnectionPool::~ConnectionPool() noexcept
+    {
+        Shutdown();
+
+        std::scoped_lock lock(m_Mutex);
+        assert(m_OpenCount == m_Idle.size() && "Connections still checked out while destroying the pool!");
+        m_Idle.clear();
+    }
+
+    void ConnectionPool::Shutdown() noexcept
+    {
+        {
+            std::scoped_lock lock(m_Mutex);
+            m_bShutdown = true;
+        }
+        m_ReleasedCV.notify_all();
+    }
+
+    bool ConnectionPool::WarmUp() noexcept
+    {
+        std::vector<PooledConnection> connections{};
+        for (uint32_t i{}; i < m_PoolDesc.MinConnections; ++i)
+        {
+            auto connection = Acquire(std::chrono::milliseconds(0));
+            if (!connection) break;
+
+            connections.emplace_back(std::move(connection));
+        }
+
+        return !connections.empty() || GetStats().OpenConnections > 0;
+    }
+
+    PooledConnection ConnectionPool::Acquire() noexcept
+    {
+        return Acquire(m_PoolDesc.AcquireTimeout);
+    }
+
+    PooledConnection ConnectionPool::Acquire(std::chrono::milliseconds timeout) noexcept
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        std::unique_lock lock(m_Mutex);
+        while (!m_bShutdown)
+        {
+            if (!m_Idle.empty())
+            {
+                // Most recently released first, it's the least likely one to have been dropped by the server.
+                std::unique_ptr<PooledConnection::Entry> entry = std::move(m_Idle.back());
+                m_Idle.pop_back();
+
+                lock.unlock();
+                const bool bUsable = PrepareForReuse(*entry);
+                lock.lock();
+
+                if (bUsable) return PooledConnection(this, entry.release());
+
+                --m_OpenCount;
+                continue;
+            }
+
+            if (m_OpenCount < m_PoolDesc.MaxConnections)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                if (now < m_NextConnectTime)
+                {
+                    // Server was unreachable a moment ago, don't hammer it. Someone may release a connection meanwhile.
+                    if (deadline < m_NextConnectTime)
+                    {
+                        LOG_WARN("Connection pool: reconnect backoff ({}ms), giving up.", m_ReconnectBackoff.count());
+                        return {};
+                    }
+
+                    ++m_WaitingCount;
+                    m_ReleasedCV.wait_until(lock, m_NextConnectTime);
+                    --m_WaitingCount;
+                    continue;
+                }
+
+                ++m_OpenCount;
+                lock.unlock();
+                std::unique_ptr<PooledConnection::Entry> entry = Connect();
+                lock.lock();
+
+                if (entry)
+                {
+                    m_ReconnectBackoff = std::chrono::milliseconds(0);
+                    m_NextConnectTime  = {};
+                    return PooledConnection(this, entry.release());
+                }
+
+                --m_OpenCount;
+                ++m_ConnectFailureCount;
+                m_ReconnectBackoff = std::clamp(m_ReconnectBackoff * 2, m_PoolDesc.MinReconnectBackoff, m_PoolDesc.MaxReconnectBackoff);
+                m_NextConnectTime  = std::chrono::steady_clock::now() + m_ReconnectBackoff;
+                m_ReleasedCV.notify_all();
+                return {};
+            }
+
+            ++m_WaitingCount;
+            const bool bTimedOut = m_ReleasedCV.wait_until(lock, deadline) == std::cv_status::timeout;
+            --m_WaitingCount;
+
+            if (bTimedOut && m_Idle.empty() && m_OpenCount >= m_PoolDesc.MaxConnections)
+            {
+                LOG_WARN("Connection pool: all {} connections busy for {}ms.", m_PoolDesc.MaxConnections, timeout.count());
+                return {};
+            }
+        }
+
+        return {};
+    }
+
+    ConnectionPool::Stats ConnectionPool::GetStats() const noexcept
+    {
+        std::scoped_lock lock(m_Mutex);
+        return Stats{.OpenConnections = m_OpenCount,
+                     .IdleConnections = static_cast<uint32_t>(m_Idle.size()),
+                     .WaitingCallers  = m_WaitingCount,
+                     .ConnectFailures = m_ConnectFailureCount};
+    }
+
+    std::unique_ptr<PooledConnection::Entry> ConnectionPool::Connect() noexcept
+    {
+        auto entry = std::make_unique<PooledConnection::Entry>();
+        try
+        {
+            static constexpr uint32_t s_ConnTimeoutSeconds = 5;
+
+            auto connectionOptions = pgfe::Connection_options{}
+                                         .set(pgfe::Communication_mode::net)
+                                         .set_hostname(m_Desc.HostName.c_str())
+                                         .set_database(m_Desc.Database.c_str())
+                                         .set_username(m_Desc.Username.c_str())
+                                         .set_connect_timeout(std::chrono::seconds(s_ConnTimeoutSeconds))
+                                         .set_port(m_Desc.Port);
+            // Without one libpq takes PGPASSWORD or the password file, which is how the command line modes pass it.
+            if (!m_Desc.Password.empty()) connectionOptions.set_password(m_Desc.Password.c_str());
+
+            entry->Connection = std::make_unique<pgfe::Connection>(connectionOptions);
+            entry->Connection->connect();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR(e.what());
+            return nullptr;
+        }
+
+        // Cancel object is bound to the backend, so every connection gets its own.
+        entry->CancelHandle    = PQgetCancel(entry->Connection->native_handle());
+        entry->LastReleaseTime = std::chrono::steady_clock::now();
+
+        LOG_TRACE("Connected to DB - {}, as {}", m_Desc.Database, m_Desc.Username);
+        return entry;
+    }
+
+    bool ConnectionPool::PrepareForReuse(PooledConnection::Entry& entry) noexcept
+    {
+        PGconn* nativeConnection = entry.Connection->native_handle();
+        if (!entry.Connection->is_connected() || PQstatus(nativeConnection) != CONNECTION_OK) return false;
+
+        const bool bNeedsPing = std::chrono::steady_clock::now() - entry.LastReleaseTime >= m_PoolDesc.IdleValidationInterval;
+        try
+        {
+            // Previous owner left a cursor WITH HOLD, SET or temp table behind, the next one must not see it.
+            // Same as DISCARD ALL minus DEALLOCATE ALL, the cached prepared statements are worth keeping.
+            if (entry.bSessionDirty)
+            {
+                static constexpr std::array<const char*, 5> s_ResetStatements = {"CLOSE ALL", "RESET ALL", "DISCARD TEMP", "UNLISTEN *",
+                                                                                 "SELECT pg_advisory_unlock_all()"};
+                for (const char* resetStatement : s_ResetStatements)
+                    entry.Connection->execute([](auto&&) {}, resetStatement);
+
+                entry.bSessionDirty = false;
+            }
+            else if (bNeedsPing)
+                entry.Connection->execute([](auto&&) {}, "SELECT 1");
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARN("Connection pool: dropping stale connection - {}", e.what());
+            return false;
+        }
+
+        return true;
+    }
+
+    void ConnectionPool::Release(PooledConnection::Entry* entry) noexcept
+    {
+        std::unique_ptr<PooledConnection::Entry> ownedEntry(entry);
+
+        // A query that failed inside BEGIN leaves the session aborted, roll it back here rather than poisoning the next user.
+        PGconn* nativeConnection = ownedEntry->Connection->native_handle();
+        bool bReusable           = ownedEntry->Connection->is_connected() && PQstatus(nativeConnection) == CONNECTION_OK;
+        if (bReusable)
+        {
+            switch (PQtransactionStatus(nativeConnection))
+            {
+                case PQTRANS_IDLE: break;
+                case PQTRANS_INTRANS:
+                case PQTRANS_INERROR:
+                    try
+                    {
+                        ownedEntry->Connection->execute([](auto&&) {}, "ROLLBACK");
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG_WARN("Connection pool: rollback on release failed - {}", e.what());
+                        bReusable = false;
+                    }
+                    break;
+                default: bReusable = false; break;  // still busy or unknown, can't be handed out
+            }
+        }
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            if (bReusable)
+            {
+                ownedEntry->LastReleaseTime = std::chrono::steady_clock::now();
+                m_Idle.emplace_back(std::move(ownedEntry));
+            }
+            else
+                --m_OpenCount;
+        }
+        m_ReleasedCV.notify_one();
+
+        // Broken connection is destroyed (and disconnected) outside of the lock.
+    }
+
+}  // namespace nsudb
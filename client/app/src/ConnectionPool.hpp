@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+namespace dmitigr::pgfe
+{
+    class Connection;
+}
+
+struct pg_cancel;
+
+namespace nsudb
+{
+
+    struct PreparedStatementCache;
+
+    struct DatabaseDesc final
+    {
+        std::string HostName{"127.0.0.1"};
+        std::string Database{};
+        std::string Username{};
+        std::string Password{};  // empty: libpq takes PGPASSWORD or the password file
+        int_fast32_t Port{5432};
+    };
+
+    struct ConnectionPoolDesc final
+    {
+        uint32_t MinConnections{1};  // opened up front by WarmUp()
+        uint32_t MaxConnections{4};
+        std::chrono::milliseconds AcquireTimeout{std::chrono::seconds(10)};
+        std::chrono::milliseconds IdleValidationInterval{std::chrono::seconds(30)};  // idle longer than this gets pinged before reuse
+        std::chrono::milliseconds MinReconnectBackoff{250};
+        std::chrono::milliseconds MaxReconnectBackoff{std::chrono::seconds(8)};
+    };
+
+    struct ConnectionPool;
+
+    // RAII checkout of one pooled connection, goes back to the pool on destruction.
+    // Whoever holds it owns the session exclusively, there is no locking inside.
+    struct PooledConnection final
+    {
+        PooledConnection() noexcept = default;
+        ~PooledConnection() noexcept { Release(); }
+
+        PooledConnection(const PooledConnection&)            = delete;
+        PooledConnection& operator=(const PooledConnection&) = delete;
+
+        PooledConnection(PooledConnection&& other) noexcept
+            : m_Pool(std::exchange(other.m_Pool, nullptr)), m_Entry(std::exchange(other.m_Entry, nullptr))
+        {
+        }
+
+        PooledConnection& operator=(PooledConnection&& other) noexcept
+        {
+            if (this == &other) return *this;
+
+            Release();
+            m_Pool  = std::exchange(other.m_Pool, nullptr);
+            m_Entry = std::exchange(other.m_Entry, nullptr);
+            return *this;
+        }
+
+        explicit operator bool() const noexcept { return m_Entry != nullptr; }
+
+        dmitigr::pgfe::Connection& Get() const noexcept;
+        dmitigr::pgfe::Connection* operator->() const noexcept { return &Get(); }
+
+        // Bound to the backend of this connection, valid as long as the checkout is held.
+        pg_cancel* GetCancelHandle() const noexcept;
+
+        // Statements prepared on this connection, they live as long as the connection does.
+        PreparedStatementCache& GetPreparedStatements() const noexcept;
+
+        // Session state (cursors, SET, temp tables) was touched, the pool resets it before handing the connection out again.
+        void MarkSessionDirty() noexcept;
+
+        void Release() noexcept;
+
+      private:
+        friend struct ConnectionPool;
+        struct Entry;
+
+        ConnectionPool* m_Pool{nullptr};
+        Entry* m_Entry{nullptr};
+
+        PooledConnection(ConnectionPool* pool, Entry* entry) noexcept : m_Pool(pool), m_Entry(entry) {}
+    };
+
+    // Fixed set of up to MaxConnections sessions to one database. Idle connections are validated before reuse,
+    // broken ones are dropped and reopened on demand with exponential backoff, so a dead server fails fast
+    // instead of every caller sitting in connect timeouts.
+    struct ConnectionPool final
+    {
+        ConnectionPool(const DatabaseDesc& databaseDesc, const ConnectionPoolDesc& poolDesc = {}) noexcept;
+        ~ConnectionPool() noexcept;
+
+        ConnectionPool(const ConnectionPool&)            = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        // Opens connections up to MinConnections, false if not even one could be established.
+        bool WarmUp() noexcept;
+
+        // Blocks until a connection is free (or can be opened) or the timeout expires, empty handle on failure.
+        PooledConnection Acquire() noexcept;
+        PooledConnection Acquire(std::chrono::milliseconds timeout) noexcept;
+
+        // Wakes up blocked Acquire() calls, they return empty handles from now on.
+        void Shutdown() noexcept;
+
+        const DatabaseDesc& GetDatabaseDesc() const noexcept { return m_Desc; }
+        const ConnectionPoolDesc& GetPoolDesc() const noexcept { return m_PoolDesc; }
+
+        struct Stats final
+        {
+            uint32_t OpenConnections{0};
+            uint32_t IdleConnections{0};
+            uint32_t WaitingCallers{0};
+            uint64_t ConnectFailures{0};
+        };
+        Stats GetStats() const noexcept;
+
+      private:
+        friend struct PooledConnection;
+
+        DatabaseDesc m_Desc{};
+        ConnectionPoolDesc m_PoolDesc{};
+
+        mutable std::mutex m_Mutex{};
+        std::condition_variable m_ReleasedCV{};
+        std::vector<std::unique_ptr<PooledConnection::Entry>> m_Idle{};  // back is the most recently released
+        uint32_t m_OpenCount{0};                                          // idle + checked out + being opened
+        uint32_t m_WaitingCount{0};
+        uint64_t m_ConnectFailureCount{0};
+        std::chrono::steady_clock::time_point m_NextConnectTime{};
+        std::chrono::milliseconds m_ReconnectBackoff{0};
+        bool m_bShutdown{false};
+
+        std::unique_ptr<PooledConnection::Entry> Connect() noexcept;
+        bool PrepareForReuse(PooledConnection::Entry& entry) noexcept;
+        void Release(PooledConnection::Entry* entry) noexcept;
+    };
+
+}  // namespace nsudb
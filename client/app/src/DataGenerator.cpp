@@ -0,0 +1,1355 @@
+#include "DataGenerator.hpp"
+#include <Logger.hpp>
+
+#include <charconv>
+#include <condition_variable>
+
+namespace nsudb
+{
+
+    enum EGeneratedTable : std::size_t
+    {
+        OutletTypes = 0,
+        Outlets,
+        Branches,
+        PhotoStores,
+        Kiosks,
+        ServiceTypes,
+        ServiceTypesOutlets,
+        Firms,
+        Items,
+        Clients,
+        Orders,
+        PrintDiscounts,
+        PrintOrders,
+        Storages,
+        ServiceOrders,
+        FilmDevelopmentOrders,
+        Films,
+        Vendors,
+        VendorItems,
+        PaperTypes,
+        PaperSizes,
+        PrintPrices,
+        Frames,
+        Deliveries,
+        DeliveryItems,
+        ServiceTypesNeededItems,
+        StorageItems,
+        Count
+    };
+
+    struct GeneratedTableSchema final
+    {
+        std::string_view Name{};
+        std::string_view Columns{};
+        uint32_t AverageRowBytes{0};
+    };
+
+    // Same order as the loader's, parents before children.
+    static constexpr std::array<GeneratedTableSchema, EGeneratedTable::Count> s_TableSchemas = {{
+        {"outlet_types", "id,name", 12},
+        {"outlets", "id,address,num_workers,type_id", 36},
+        {"branches", "outlet_id", 5},
+        {"photo_stores", "outlet_id", 5},
+        {"kiosks", "outlet_id,branch_id", 9},
+        {"service_types", "id,name,price", 28},
+        {"service_types_outlets", "id,service_type_id,outlet_type_id", 8},
+        {"firms", "id,name", 12},
+        {"items", "id,name,price,firm_id", 36},
+        {"clients", "id,full_name,is_professional,discount", 36},
+        {"orders", "id,accept_time,overall_price,is_urgent,outlet_id,client_id", 52},
+        {"print_discounts", "id,photo_amount,discount", 12},
+        {"print_orders", "id,order_id,order_accept_time,print_discount_id", 38},
+        {"storages", "id,capacity,outlet_id", 16},
+        {"service_orders", "id,count,order_id,order_accept_time,service_type_id", 40},
+        {"film_development_orders", "id,service_order_id,code", 26},
+        {"films", "id,code,service_order_id", 28},
+        {"vendors", "id,name", 22},
+        {"vendor_items", "id,price,quantity,vendor_id,item_id", 22},
+        {"paper_types", "id,name", 10},
+        {"paper_sizes", "id,name", 8},
+        {"print_prices", "id,price,paper_size_id,paper_type_id", 14},
+        {"frames", "id,amount,frame_number,print_order_id,order_accept_time,print_price_id", 46},
+        {"deliveries", "id,date,storage_id,vendor_id", 22},
+        {"delivery_items", "id,price,quantity,delivery_id,item_id", 26},
+        {"service_types_needed_items", "item_id,count,service_type_id", 8},
+        {"storage_items", "id,quantity,item_id,storage_id", 20},
+    }};
+
+    static constexpr uint64_t s_OrdersPerScale  = 100'000;
+    static constexpr uint64_t s_ClientsPerScale = 20'000;
+    static constexpr uint64_t s_OrdersPerBlock  = 4096;
+    static constexpr uint64_t s_ClientsPerBlock = 65536;
+
+    // Ids of outlet_types, 'branch' and 'kiosk' are the names the triggers and reports look for.
+    enum EOutletType : uint32_t
+    {
+        Branch = 1,
+        PhotoStore,
+        Kiosk
+    };
+    static constexpr std::array<std::string_view, 3> s_OutletTypeNames = {"branch", "photostore", "kiosk"};
+
+    struct ServiceTypeDesc final
+    {
+        std::string_view Name{};
+        int64_t PriceCents{0};
+        std::array<bool, 3> bOfferedAt{};  // branch, photo store, kiosk
+    };
+
+    // The film development service is looked up by its Russian name (05-create-triggers.sql), spelled out as UTF-8 bytes
+    // so the source file's code page doesn't matter. Kiosks take films in for the branches, photo stores don't.
+    static constexpr uint32_t s_FilmDevelopmentServiceTypeId = 1;
+    static constexpr std::array<ServiceTypeDesc, 8> s_ServiceTypes = {{
+        {"\xD0\x9F\xD1\x80\xD0\xBE\xD1\x8F\xD0\xB2\xD0\xBA\xD0\xB0 "
+         "\xD0\xBF\xD0\xBB\xD0\xB5\xD0\xBD\xD0\xBA\xD0\xB8",
+         15000,
+         {true, false, true}},
+        {"Film scanning", 20000, {true, true, false}},
+        {"Passport photos", 35000, {true, true, true}},
+        {"Photo restoration", 90000, {true, true, false}},
+        {"Photo book", 120000, {true, true, false}},
+        {"Large format printing", 60000, {true, true, false}},
+        {"Camera repair", 150000, {true, true, false}},
+        {"Lamination", 8000, {true, true, true}},
+    }};
+
+    struct PrintDiscountDesc final
+    {
+        uint32_t PhotoAmount{0};
+        int64_t DiscountBasisPoints{0};  // percent * 100, like NUMERIC(5, 2)
+    };
+
+    // A print order gets the largest tier its total amount of photos reaches.
+    static constexpr std::array<PrintDiscountDesc, 5> s_PrintDiscounts = {{{1, 0}, {10, 300}, {36, 500}, {100, 1000}, {300, 1500}}};
+
+    static constexpr std::array<std::string_view, 4> s_PaperTypeNames   = {"Glossy", "Matte", "Satin", "Metallic"};
+    static constexpr std::array<double, 4> s_PaperTypePriceFactors      = {1.0, 1.0, 1.2, 1.6};
+    static constexpr std::array<double, 4> s_PaperTypeWeights           = {0.55, 0.3, 0.1, 0.05};
+    static constexpr std::array<std::string_view, 6> s_PaperSizeNames   = {"9x13", "10x15", "13x18", "15x21", "20x30", "30x40"};
+    static constexpr std::array<int64_t, 6> s_PaperSizePriceCents       = {1200, 1500, 2500, 3500, 9000, 25000};
+    static constexpr std::array<double, 6> s_PaperSizeWeights           = {0.15, 0.5, 0.12, 0.12, 0.08, 0.03};
+    static constexpr std::array<uint32_t, 5> s_FrameAmounts             = {1, 2, 3, 5, 10};
+    static constexpr std::array<double, 5> s_FrameAmountWeights         = {0.72, 0.14, 0.06, 0.05, 0.03};
+    static constexpr std::array<double, 3> s_PrintOrderCountWeights     = {0.3, 0.55, 0.15};
+    static constexpr std::array<double, 3> s_ServiceOrderCountWeights   = {0.45, 0.4, 0.15};
+    static constexpr uint32_t s_MaxFramesPerPrintOrder                  = 120;
+    static constexpr double s_FrameCountDecay                           = 0.9;  // P(n + 1 frames) / P(n), about 10 on average
+
+    // Seasonal shape of accept_time: summer and December peaks, busier weekends (Monday first), shop hours.
+    static constexpr std::array<double, 12> s_MonthWeights   = {0.7, 0.75, 0.85, 0.9, 1.0, 1.15, 1.25, 1.2, 1.0, 0.9, 0.95, 1.5};
+    static constexpr std::array<double, 7> s_WeekdayWeights  = {0.9, 0.9, 0.95, 1.0, 1.1, 1.35, 1.2};
+    static constexpr std::array<double, 24> s_HourWeights    = {0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 5, 7, 8, 8, 7, 7, 8, 9, 9, 7, 4, 0, 0, 0};
+    static constexpr double s_YearlyGrowth                   = 0.15;
+
+    static constexpr std::array<std::string_view, 24> s_FirmNames = {
+        "Kodak",   "Fujifilm", "Ilford", "Agfa",      "Canon",   "Nikon", "Sony",   "Epson",         "HP",         "Polaroid",
+        "Lomography", "Tetenal", "Hahnemuhle", "Tamron", "Sigma", "Manfrotto", "Lowepro", "Hama", "Rollei", "Olympus",
+        "Leica",   "Pentax",   "Konica Minolta", "Cinestill"};
+
+    // Consumed by the services (service_types_needed_items) vs. sold and delivered, the two never share an item.
+    static constexpr std::array<std::string_view, 8> s_SupplyKinds = {
+        "developer", "fixer", "photo paper roll", "ink cartridge", "laminating film", "photobook cover", "scanner kit", "ID photo paper"};
+    static constexpr std::array<std::string_view, 10> s_RetailKinds = {
+        "35mm film",   "120 film",    "instant film", "camera battery", "memory card",
+        "photo album", "frame 10x15", "frame 20x30",  "camera strap",   "lens cleaning kit"};
+    static constexpr uint32_t s_SupplyItemCount = 40;
+    static constexpr uint32_t s_RetailItemCount = 110;
+
+    static constexpr std::array<std::string_view, 10> s_VendorRegions = {"Nord", "Sib",   "Ural", "Volga", "Baltic",
+                                                                         "Amur", "Altai", "Ob",   "Kama",  "Yenisei"};
+    static constexpr std::array<std::string_view, 4> s_VendorSuffixes = {" Photo Supply", " Trading", " Distribution", " Imaging"};
+    static constexpr std::array<std::string_view, 20> s_FirstNames = {
+        "Ivan",  "Anna",   "Sergey", "Maria", "Dmitry", "Elena", "Alexey", "Olga",   "Pavel", "Irina",
+        "Nikita", "Tatiana", "Artem", "Daria", "Maxim", "Sofia", "Egor",   "Polina", "Roman", "Ksenia"};
+    static constexpr std::array<std::string_view, 20> s_LastNames = {
+        "Ivanov",  "Petrov", "Smirnov",  "Kuznetsov", "Popov",   "Vasiliev", "Sokolov", "Mikhailov", "Novikov",  "Fedorov",
+        "Morozov", "Volkov", "Alekseev", "Lebedev",   "Semenov", "Egorov",   "Pavlov",  "Kozlov",    "Stepanov", "Nikolaev"};
+    static constexpr std::array<std::string_view, 12> s_StreetNames = {"Lenina",   "Mira",     "Sovetskaya", "Gagarina", "Pushkina",
+                                                                       "Kirova",   "Tsvetnoy", "Pirogova",   "Morskoy",  "Ilyicha",
+                                                                       "Zolotodolinskaya", "Detsky"};
+
+    // Independent draw streams, so adding draws to one table never shifts another's data.
+    enum class EStream : uint64_t
+    {
+        Outlets = 1,
+        Items,
+        Clients,
+        Orders,
+        Vendors,
+        Deliveries,
+        NeededItems,
+        Stock
+    };
+
+    // SplitMix64 seeded per (seed, stream, entity or block): tiny state, cheap to create per block, and the same sequence on
+    // every compiler and platform.
+    struct GeneratorRandom final
+    {
+        GeneratorRandom(uint64_t seed, EStream stream, uint64_t index) noexcept
+            : m_State(Mix(seed + Mix((static_cast<uint64_t>(stream) << 48) ^ index)))
+        {
+        }
+
+        uint64_t Next() noexcept { return Mix(m_State += 0x9E3779B97F4A7C15ull); }
+
+        // [0, bound), multiply-shift instead of modulo, the bias is far below anything the data could show.
+        uint32_t Below(uint32_t bound) noexcept { return static_cast<uint32_t>(((Next() >> 32) * bound) >> 32); }
+        int64_t Between(int64_t low, int64_t high) noexcept { return low + Below(static_cast<uint32_t>(high - low + 1)); }
+
+        // [0, 1) with 53 random bits.
+        double Real() noexcept { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+
+      private:
+        uint64_t m_State{0};
+
+        static constexpr uint64_t Mix(uint64_t z) noexcept
+        {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+    };
+
+    // Cumulative weights as 32-bit thresholds, one draw and a binary search per sample. Zero weights are never picked.
+    struct WeightedTable final
+    {
+        WeightedTable() noexcept = default;
+        explicit WeightedTable(std::span<const double> weights) noexcept
+        {
+            const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+            double running     = 0.0;
+            m_Thresholds.reserve(weights.size());
+            for (const double weight : weights)
+            {
+                running += weight;
+                m_Thresholds.push_back(static_cast<uint64_t>(running / total * 4294967296.0));
+            }
+            if (!m_Thresholds.empty()) m_Thresholds.back() = 1ull << 32;
+        }
+
+        uint32_t Sample(GeneratorRandom& random) const noexcept
+        {
+            const uint64_t draw = random.Next() >> 32;
+            return static_cast<uint32_t>(std::upper_bound(m_Thresholds.begin(), m_Thresholds.end(), draw) - m_Thresholds.begin());
+        }
+
+      private:
+        std::vector<uint64_t> m_Thresholds{};
+    };
+
+    struct DataGenerator::Catalogue final
+    {
+        struct Outlet final
+        {
+            EOutletType Type{EOutletType::Branch};
+            uint32_t BranchId{0};  // kiosks only
+            uint32_t NumWorkers{1};
+            std::string Address{};
+        };
+
+        struct Item final
+        {
+            std::string Name{};
+            int64_t PriceCents{0};
+            uint32_t FirmId{0};  // 0 = NULL
+        };
+
+        struct VendorItem final
+        {
+            uint32_t VendorId{0};
+            uint32_t ItemId{0};
+            int64_t PriceCents{0};
+            uint32_t Quantity{0};
+        };
+
+        struct Delivery final
+        {
+            std::chrono::sys_days Date{};
+            uint32_t StorageId{0};
+            uint32_t VendorId{0};
+        };
+
+        struct DeliveryItem final
+        {
+            uint32_t DeliveryId{0};
+            uint32_t ItemId{0};
+            int64_t PriceCents{0};
+            uint32_t Quantity{0};
+        };
+
+        struct NeededItem final
+        {
+            uint32_t ItemId{0};
+            uint32_t ServiceTypeId{0};
+            uint32_t Count{0};
+        };
+
+        struct StorageItem final
+        {
+            uint32_t StorageId{0};
+            uint32_t ItemId{0};
+            int64_t Quantity{0};
+        };
+
+        struct PrintPrice final
+        {
+            int64_t PriceCents{0};
+            uint32_t PaperSizeId{0};
+            uint32_t PaperTypeId{0};
+        };
+
+        std::chrono::sys_days StartDay{};
+        int64_t StartSeconds{0};
+        std::vector<double> DayCumulative{};  // share of all orders accepted by the end of each day
+        std::array<double, 24> HourCumulative{};
+
+        std::vector<Outlet> Outlets{};  // outlet id - 1, storage id - 1 as well
+        std::vector<uint32_t> BranchIds{};
+        WeightedTable OutletTable{};
+        std::array<std::vector<uint32_t>, 3> ServiceTypesByOutletType{};
+
+        std::vector<Item> Items{};  // supply items first
+        std::vector<VendorItem> VendorItems{};
+        std::vector<uint32_t> VendorItemOffsets{};  // per vendor into VendorItems, one past the end last
+        std::vector<Delivery> Deliveries{};
+        std::vector<DeliveryItem> DeliveryItems{};
+        std::vector<NeededItem> NeededItems{};
+        std::vector<StorageItem> StorageItems{};
+        std::vector<int64_t> StorageCapacities{};
+
+        std::vector<PrintPrice> PrintPrices{};
+        WeightedTable PrintPriceTable{};
+        WeightedTable FrameCountTable{};  // frame count - 1
+        WeightedTable FrameAmountTable{};
+        WeightedTable PrintOrderCountTable{};
+        WeightedTable ServiceOrderCountTable{};
+
+        uint64_t ClientCount{0};
+        uint64_t OrderCount{0};
+        uint64_t OrderBlockCount{0};
+
+        // Children before each order block, OrderBlockCount + 1 entries, the last one the total.
+        std::vector<uint64_t> PrintOrderOffsets{};
+        std::vector<uint64_t> ServiceOrderOffsets{};
+        std::vector<uint64_t> FrameOffsets{};
+        std::vector<uint64_t> FilmOffsets{};
+        std::vector<uint64_t> FilmDevelopmentOffsets{};
+
+        // Supply items used by each outlet's services, outlet index * s_SupplyItemCount + supply item index.
+        std::vector<uint64_t> Consumption{};
+    };
+
+    struct DataGenerator::OrderBlockPlan final
+    {
+        struct Order final
+        {
+            int64_t AcceptSeconds{0};
+            int64_t PriceCents{0};
+            uint32_t OutletId{0};
+            uint32_t ClientId{0};
+            uint32_t PrintOrderCount{0};
+            uint32_t ServiceOrderCount{0};
+            bool bUrgent{false};
+        };
+
+        struct PrintOrder final
+        {
+            uint32_t DiscountId{0};
+            uint32_t FrameCount{0};
+        };
+
+        struct Frame final
+        {
+            uint32_t Amount{0};
+            uint32_t PrintPriceId{0};
+        };
+
+        struct ServiceOrder final
+        {
+            uint32_t ServiceTypeId{0};
+            uint32_t Count{0};  // films for film development
+        };
+
+        uint64_t FirstOrderIndex{0};
+        std::vector<Order> Orders{};
+        std::vector<PrintOrder> PrintOrders{};
+        std::vector<Frame> Frames{};
+        std::vector<ServiceOrder> ServiceOrders{};
+    };
+
+    struct ClientProfile final
+    {
+        bool bProfessional{false};
+        int64_t DiscountBasisPoints{0};
+    };
+
+    // Professionals get 10.00, what trg_set_professional_discount() would set on INSERT anyway, a few regulars 5.00.
+    static ClientProfile GetClientProfile(uint64_t seed, uint64_t clientId) noexcept
+    {
+        GeneratorRandom random(seed, EStream::Clients, clientId);
+        const double draw = random.Real();
+        if (draw < 0.06) return {.bProfessional = true, .DiscountBasisPoints = 1000};
+        if (draw < 0.14) return {.bProfessional = false, .DiscountBasisPoints = 500};
+
+        return {};
+    }
+
+    static void AppendInteger(std::string& out, int64_t value) noexcept
+    {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    static void AppendTwoDigits(std::string& out, int64_t value) noexcept
+    {
+        out += static_cast<char>('0' + value / 10);
+        out += static_cast<char>('0' + value % 10);
+    }
+
+    // NUMERIC(10, 2) text, values are never negative.
+    static void AppendCents(std::string& out, int64_t cents) noexcept
+    {
+        AppendInteger(out, cents / 100);
+        out += '.';
+        AppendTwoDigits(out, cents % 100);
+    }
+
+    static void AppendDate(std::string& out, std::chrono::sys_days day) noexcept
+    {
+        const std::chrono::year_month_day date{day};
+        AppendInteger(out, static_cast<int32_t>(date.year()));
+        out += '-';
+        AppendTwoDigits(out, static_cast<unsigned>(date.month()));
+        out += '-';
+        AppendTwoDigits(out, static_cast<unsigned>(date.day()));
+    }
+
+    static void AppendTimestamp(std::string& out, int64_t seconds) noexcept
+    {
+        const int64_t days = seconds / 86400, secondOfDay = seconds % 86400;
+        AppendDate(out, std::chrono::sys_days{std::chrono::days{days}});
+        out += ' ';
+        AppendTwoDigits(out, secondOfDay / 3600);
+        out += ':';
+        AppendTwoDigits(out, secondOfDay / 60 % 60);
+        out += ':';
+        AppendTwoDigits(out, secondOfDay % 60);
+    }
+
+    // Blocks are produced by worker threads at most a window ahead of the consumer, which gets them strictly in order on the
+    // calling thread. A slot is reused once consumed, so memory is the window times a block however many blocks there are.
+    // consume() returning false stops the workers after their current block.
+    static bool GenerateInOrder(uint64_t blockCount, uint32_t threadCount, const std::function<uint64_t(uint64_t, std::string&)>& generate,
+                                const std::function<bool(std::string_view, uint64_t)>& consume) noexcept
+    {
+        if (blockCount == 1)
+        {
+            std::string text{};
+            const uint64_t rowCount = generate(0, text);
+            return consume(text, rowCount);
+        }
+
+        struct Slot final
+        {
+            std::string Text{};
+            uint64_t RowCount{0};
+            bool bReady{false};
+        };
+
+        const uint64_t window = 2ull * threadCount;
+        std::vector<Slot> slots(window);
+        std::mutex mutex{};
+        std::condition_variable condition{};
+        uint64_t nextBlock{0}, consumedBlocks{0};
+        bool bStopped{false};
+
+        const auto work = [&]()
+        {
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                condition.wait(lock, [&] { return bStopped || nextBlock >= blockCount || nextBlock < consumedBlocks + window; });
+                if (bStopped || nextBlock >= blockCount) return;
+
+                const uint64_t block = nextBlock++;
+                Slot& slot           = slots[block % window];
+                lock.unlock();
+
+                slot.Text.clear();
+                slot.RowCount = generate(block, slot.Text);
+
+                lock.lock();
+                slot.bReady = true;
+                condition.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers{};
+        workers.reserve(threadCount);
+        for (uint32_t i{}; i < threadCount; ++i)
+            workers.emplace_back(work);
+
+        bool bSucceeded = true;
+        for (uint64_t block{}; block < blockCount && bSucceeded; ++block)
+        {
+            Slot& slot = slots[block % window];
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&] { return slot.bReady; });
+            }
+
+            bSucceeded = consume(slot.Text, slot.RowCount);
+
+            std::scoped_lock lock(mutex);
+            slot.bReady = false;
+            ++consumedBlocks;
+            bStopped = !bSucceeded;
+            condition.notify_all();
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        return bSucceeded;
+    }
+
+    DataGenerator::DataGenerator(DataGeneratorDesc desc) noexcept : m_Desc(desc), m_Catalogue(std::make_unique<Catalogue>())
+    {
+        using namespace std::chrono;
+
+        m_Desc.ScaleFactor = std::max(m_Desc.ScaleFactor, 1e-4);
+        m_Desc.MonthCount  = std::max(m_Desc.MonthCount, 1);
+        Catalogue& catalogue = *m_Catalogue;
+        const uint64_t seed  = m_Desc.Seed;
+
+        // Time: cumulative order share per day, weights are products of plain doubles so every platform builds the same table.
+        catalogue.StartDay     = sys_days{year{m_Desc.StartYear} / January / 1};
+        catalogue.StartSeconds = catalogue.StartDay.time_since_epoch().count() * 86400;
+        const sys_days endDay  = sys_days{(year{m_Desc.StartYear} / January + months{m_Desc.MonthCount}) / 1};
+        const int64_t dayCount = (endDay - catalogue.StartDay).count();
+
+        double runningWeight = 0.0;
+        catalogue.DayCumulative.reserve(static_cast<std::size_t>(dayCount));
+        for (int64_t day{}; day < dayCount; ++day)
+        {
+            const sys_days date = catalogue.StartDay + days{day};
+            const uint32_t monthIndex = static_cast<unsigned>(year_month_day{date}.month()) - 1;
+            const uint32_t weekdayIndex = (weekday{date}.c_encoding() + 6) % 7;  // Monday first
+            runningWeight += s_MonthWeights[monthIndex] * s_WeekdayWeights[weekdayIndex] * (1.0 + s_YearlyGrowth * day / 365.0);
+            catalogue.DayCumulative.push_back(runningWeight);
+        }
+        for (double& cumulative : catalogue.DayCumulative)
+            cumulative /= runningWeight;
+
+        const double hourTotal = std::accumulate(s_HourWeights.begin(), s_HourWeights.end(), 0.0);
+        double runningHour     = 0.0;
+        for (std::size_t hour{}; hour < s_HourWeights.size(); ++hour)
+        {
+            runningHour += s_HourWeights[hour];
+            catalogue.HourCumulative[hour] = runningHour / hourTotal;
+        }
+
+        // Outlets: the first is always a branch so kiosks have one to belong to.
+        const uint64_t outletCount = std::max<uint64_t>(8, static_cast<uint64_t>(std::llround(60.0 * std::sqrt(m_Desc.ScaleFactor))));
+        catalogue.Outlets.resize(outletCount);
+        for (uint64_t i{}; i < outletCount; ++i)
+        {
+            GeneratorRandom random(seed, EStream::Outlets, i + 1);
+            auto& outlet      = catalogue.Outlets[i];
+            const double draw = random.Real();
+            outlet.Type       = i == 0 || draw < 0.25 ? EOutletType::Branch : draw < 0.5 ? EOutletType::PhotoStore : EOutletType::Kiosk;
+            outlet.NumWorkers = static_cast<uint32_t>(outlet.Type == EOutletType::Branch       ? random.Between(8, 30)
+                                                      : outlet.Type == EOutletType::PhotoStore ? random.Between(3, 10)
+                                                                                               : random.Between(1, 2));
+            outlet.Address    = std::to_string(random.Between(1, 150)) + " " +
+                             std::string(s_StreetNames[random.Below(static_cast<uint32_t>(s_StreetNames.size()))]) + " St";
+            if (outlet.Type == EOutletType::Branch) catalogue.BranchIds.push_back(static_cast<uint32_t>(i + 1));
+        }
+
+        // Busy outlets are spread over the ids: a shuffled rank gives each its 1/rank share, branches draw twice as many
+        // orders as photo stores and kiosks half as many.
+        GeneratorRandom outletRandom(seed, EStream::Outlets, 0);
+        std::vector<uint32_t> ranks(outletCount);
+        std::iota(ranks.begin(), ranks.end(), 1u);
+        for (uint64_t i = outletCount - 1; i > 0; --i)
+            std::swap(ranks[i], ranks[outletRandom.Below(static_cast<uint32_t>(i + 1))]);
+
+        std::vector<double> outletWeights(outletCount);
+        for (uint64_t i{}; i < outletCount; ++i)
+        {
+            auto& outlet = catalogue.Outlets[i];
+            if (outlet.Type == EOutletType::Kiosk)
+                outlet.BranchId = catalogue.BranchIds[outletRandom.Below(static_cast<uint32_t>(catalogue.BranchIds.size()))];
+
+            const double typeFactor = outlet.Type == EOutletType::Branch ? 2.0 : outlet.Type == EOutletType::PhotoStore ? 1.0 : 0.5;
+            outletWeights[i]        = typeFactor / ranks[i];
+        }
+        catalogue.OutletTable = WeightedTable(outletWeights);
+
+        for (uint32_t serviceTypeId = 1; serviceTypeId <= s_ServiceTypes.size(); ++serviceTypeId)
+            for (std::size_t type{}; type < catalogue.ServiceTypesByOutletType.size(); ++type)
+                if (s_ServiceTypes[serviceTypeId - 1].bOfferedAt[type]) catalogue.ServiceTypesByOutletType[type].push_back(serviceTypeId);
+
+        // Items: supply first, then retail goods; some have no known firm.
+        for (uint32_t i{}; i < s_SupplyItemCount + s_RetailItemCount; ++i)
+        {
+            GeneratorRandom random(seed, EStream::Items, i + 1);
+            const bool bSupply         = i < s_SupplyItemCount;
+            const std::string_view kind = bSupply ? s_SupplyKinds[i % s_SupplyKinds.size()]
+                                                  : s_RetailKinds[(i - s_SupplyItemCount) % s_RetailKinds.size()];
+            const uint32_t firmId       = random.Real() < 0.08 ? 0 : random.Below(static_cast<uint32_t>(s_FirmNames.size())) + 1;
+            const std::string_view firm = firmId ? s_FirmNames[firmId - 1] : std::string_view("Generic");
+            catalogue.Items.emplace_back(std::string(firm) + " " + std::string(kind),
+                                         bSupply ? random.Between(150, 4000) * 100 : random.Between(100, 25000) * 100, firmId);
+        }
+
+        for (uint32_t serviceTypeId = 1; serviceTypeId <= s_ServiceTypes.size(); ++serviceTypeId)
+        {
+            GeneratorRandom random(seed, EStream::NeededItems, serviceTypeId);
+            const uint32_t neededCount = static_cast<uint32_t>(random.Between(1, 3));
+            const uint32_t firstItem   = random.Below(s_SupplyItemCount);
+            for (uint32_t i{}; i < neededCount; ++i)
+                catalogue.NeededItems.emplace_back((firstItem + i * 7) % s_SupplyItemCount + 1, serviceTypeId,
+                                                   static_cast<uint32_t>(random.Between(1, 3)));
+        }
+
+        // Vendors sell a few retail items each.
+        const uint32_t vendorCount = static_cast<uint32_t>(s_VendorRegions.size() * s_VendorSuffixes.size());
+        std::vector<uint32_t> retailItemIds(s_RetailItemCount);
+        std::iota(retailItemIds.begin(), retailItemIds.end(), s_SupplyItemCount + 1);
+        for (uint32_t vendorId = 1; vendorId <= vendorCount; ++vendorId)
+        {
+            GeneratorRandom random(seed, EStream::Vendors, vendorId);
+            catalogue.VendorItemOffsets.push_back(static_cast<uint32_t>(catalogue.VendorItems.size()));
+
+            const uint32_t soldCount = static_cast<uint32_t>(random.Between(8, 20));
+            for (uint32_t i{}; i < soldCount; ++i)
+            {
+                std::swap(retailItemIds[i], retailItemIds[i + random.Below(s_RetailItemCount - i)]);
+                const uint32_t itemId = retailItemIds[i];
+                const int64_t price   = catalogue.Items[itemId - 1].PriceCents * random.Between(55, 85) / 100;
+                catalogue.VendorItems.emplace_back(vendorId, itemId, price, static_cast<uint32_t>(random.Between(0, 5000)));
+            }
+        }
+        catalogue.VendorItemOffsets.push_back(static_cast<uint32_t>(catalogue.VendorItems.size()));
+
+        // Two deliveries a month to every storage, one storage per outlet.
+        for (uint64_t storageId = 1; storageId <= outletCount; ++storageId)
+        {
+            GeneratorRandom random(seed, EStream::Deliveries, storageId);
+            const uint32_t deliveryCount = static_cast<uint32_t>(m_Desc.MonthCount) * 2;
+            for (uint32_t i{}; i < deliveryCount; ++i)
+            {
+                const int64_t day       = dayCount * i / deliveryCount + random.Below(static_cast<uint32_t>(dayCount / deliveryCount + 1));
+                const uint32_t vendorId = random.Below(vendorCount) + 1;
+                catalogue.Deliveries.emplace_back(catalogue.StartDay + days{std::min(day, dayCount - 1)}, static_cast<uint32_t>(storageId),
+                                                  vendorId);
+
+                const uint32_t firstVendorItem = catalogue.VendorItemOffsets[vendorId - 1];
+                const uint32_t soldCount       = catalogue.VendorItemOffsets[vendorId] - firstVendorItem;
+                const uint32_t itemCount       = std::min(static_cast<uint32_t>(random.Between(1, 4)), soldCount);
+                const uint32_t firstPick       = random.Below(soldCount);
+                for (uint32_t item{}; item < itemCount; ++item)
+                {
+                    const auto& vendorItem = catalogue.VendorItems[firstVendorItem + (firstPick + item) % soldCount];
+                    catalogue.DeliveryItems.emplace_back(static_cast<uint32_t>(catalogue.Deliveries.size()), vendorItem.ItemId,
+                                                         vendorItem.PriceCents, static_cast<uint32_t>(random.Between(10, 200)));
+                }
+            }
+        }
+
+        // Prints: every size on every paper, 10x15 glossy by far the most common.
+        std::vector<double> printPriceWeights{};
+        for (uint32_t size{}; size < s_PaperSizeNames.size(); ++size)
+            for (uint32_t type{}; type < s_PaperTypeNames.size(); ++type)
+            {
+                const double price = static_cast<double>(s_PaperSizePriceCents[size]) * s_PaperTypePriceFactors[type];
+                catalogue.PrintPrices.emplace_back(static_cast<int64_t>(price), size + 1, type + 1);
+                printPriceWeights.push_back(s_PaperSizeWeights[size] * s_PaperTypeWeights[type]);
+            }
+        catalogue.PrintPriceTable = WeightedTable(printPriceWeights);
+
+        std::vector<double> frameCountWeights(s_MaxFramesPerPrintOrder);
+        double frameCountWeight = 1.0;
+        for (double& weight : frameCountWeights)
+        {
+            weight = frameCountWeight;
+            frameCountWeight *= s_FrameCountDecay;
+        }
+        catalogue.FrameCountTable        = WeightedTable(frameCountWeights);
+        catalogue.FrameAmountTable       = WeightedTable(s_FrameAmountWeights);
+        catalogue.PrintOrderCountTable   = WeightedTable(s_PrintOrderCountWeights);
+        catalogue.ServiceOrderCountTable = WeightedTable(s_ServiceOrderCountWeights);
+
+        catalogue.ClientCount     = std::max<uint64_t>(10, static_cast<uint64_t>(std::llround(m_Desc.ScaleFactor * s_ClientsPerScale)));
+        catalogue.OrderCount      = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(m_Desc.ScaleFactor * s_OrdersPerScale)));
+        catalogue.OrderBlockCount = (catalogue.OrderCount + s_OrdersPerBlock - 1) / s_OrdersPerBlock;
+
+        CountOrderBlocks();
+        BuildStock();
+
+        const auto isPhotoStore        = [](const Catalogue::Outlet& outlet) { return outlet.Type == EOutletType::PhotoStore; };
+        const uint64_t photoStoreCount = std::count_if(catalogue.Outlets.begin(), catalogue.Outlets.end(), isPhotoStore);
+        const auto countOf = [&](EGeneratedTable table) -> uint64_t
+        {
+            switch (table)
+            {
+                case OutletTypes: return s_OutletTypeNames.size();
+                case Outlets: return outletCount;
+                case Branches: return catalogue.BranchIds.size();
+                case PhotoStores: return photoStoreCount;
+                case Kiosks: return outletCount - catalogue.BranchIds.size() - photoStoreCount;
+                case ServiceTypes: return s_ServiceTypes.size();
+                case ServiceTypesOutlets:
+                    return catalogue.ServiceTypesByOutletType[0].size() + catalogue.ServiceTypesByOutletType[1].size() +
+                           catalogue.ServiceTypesByOutletType[2].size();
+                case Firms: return s_FirmNames.size();
+                case Items: return catalogue.Items.size();
+                case Clients: return catalogue.ClientCount;
+                case Orders: return catalogue.OrderCount;
+                case PrintDiscounts: return s_PrintDiscounts.size();
+                case PrintOrders: return catalogue.PrintOrderOffsets.back();
+                case Storages: return outletCount;
+                case ServiceOrders: return catalogue.ServiceOrderOffsets.back();
+                case FilmDevelopmentOrders: return catalogue.FilmDevelopmentOffsets.back();
+                case Films: return catalogue.FilmOffsets.back();
+                case Vendors: return vendorCount;
+                case VendorItems: return catalogue.VendorItems.size();
+                case PaperTypes: return s_PaperTypeNames.size();
+                case PaperSizes: return s_PaperSizeNames.size();
+                case PrintPrices: return catalogue.PrintPrices.size();
+                case Frames: return catalogue.FrameOffsets.back();
+                case Deliveries: return catalogue.Deliveries.size();
+                case DeliveryItems: return catalogue.DeliveryItems.size();
+                case ServiceTypesNeededItems: return catalogue.NeededItems.size();
+                case StorageItems: return catalogue.StorageItems.size();
+                default: return 0;
+            }
+        };
+
+        for (std::size_t i{}; i < s_TableSchemas.size(); ++i)
+        {
+            const auto& schema = s_TableSchemas[i];
+            GeneratedTable table{.Name = schema.Name, .RowCount = countOf(static_cast<EGeneratedTable>(i))};
+            for (const auto column : std::views::split(schema.Columns, ','))
+                table.ColumnNames.emplace_back(column.begin(), column.end());
+            table.EstimatedBytes = table.RowCount * schema.AverageRowBytes;
+            m_Tables.emplace_back(std::move(table));
+        }
+
+        LOG_TRACE("Data generator: scale {}, seed {}, {} rows in {} order blocks", m_Desc.ScaleFactor, seed, GetTotalRows(),
+                  catalogue.OrderBlockCount);
+    }
+
+    DataGenerator::~DataGenerator() noexcept = default;
+
+    uint64_t DataGenerator::GetTotalRows() const noexcept
+    {
+        return std::accumulate(m_Tables.begin(), m_Tables.end(), uint64_t{0},
+                               [](uint64_t total, const GeneratedTable& table) { return total + table.RowCount; });
+    }
+
+    uint32_t DataGenerator::GetThreadCount() const noexcept
+    {
+        return m_Desc.ThreadCount ? m_Desc.ThreadCount : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Everything about an order block comes from the block's own stream, in a fixed order of draws, so any table's rows of
+    // the block can be regenerated independently and agree with each other.
+    void DataGenerator::PlanOrderBlock(uint64_t block, OrderBlockPlan& plan) const noexcept
+    {
+        const Catalogue& catalogue = *m_Catalogue;
+        GeneratorRandom random(m_Desc.Seed, EStream::Orders, block);
+
+        plan.FirstOrderIndex        = block * s_OrdersPerBlock;
+        const uint64_t orderCount   = std::min(s_OrdersPerBlock, catalogue.OrderCount - plan.FirstOrderIndex);
+        const double orderCountReal = static_cast<double>(catalogue.OrderCount);
+        plan.Orders.clear();
+        plan.PrintOrders.clear();
+        plan.Frames.clear();
+        plan.ServiceOrders.clear();
+
+        for (uint64_t i{}; i < orderCount; ++i)
+        {
+            OrderBlockPlan::Order order{};
+
+            // Inverse of the seasonal distribution at the order's position, so accept_time grows with the id.
+            const double share = (static_cast<double>(plan.FirstOrderIndex + i) + random.Real()) / orderCountReal;
+            const auto dayIt   = std::upper_bound(catalogue.DayCumulative.begin(), catalogue.DayCumulative.end() - 1, share);
+            const std::size_t day  = static_cast<std::size_t>(dayIt - catalogue.DayCumulative.begin());
+            const double dayStart  = day ? catalogue.DayCumulative[day - 1] : 0.0;
+            const double dayShare  = std::clamp((share - dayStart) / (catalogue.DayCumulative[day] - dayStart), 0.0, 1.0);
+            const auto hourIt      = std::upper_bound(catalogue.HourCumulative.begin(), catalogue.HourCumulative.end() - 1, dayShare);
+            const std::size_t hour = static_cast<std::size_t>(hourIt - catalogue.HourCumulative.begin());
+            const double hourStart = hour ? catalogue.HourCumulative[hour - 1] : 0.0;
+            const double hourShare = std::clamp((dayShare - hourStart) / (catalogue.HourCumulative[hour] - hourStart), 0.0, 1.0);
+            order.AcceptSeconds    = catalogue.StartSeconds + static_cast<int64_t>(day) * 86400 + static_cast<int64_t>(hour) * 3600 +
+                                  std::min(static_cast<int64_t>(hourShare * 3600.0), int64_t{3599});
+
+            const uint32_t outletIndex = catalogue.OutletTable.Sample(random);
+            const auto& outlet         = catalogue.Outlets[outletIndex];
+            order.OutletId             = outletIndex + 1;
+            order.bUrgent              = outlet.Type == EOutletType::Branch && random.Real() < 0.12;
+
+            // Regulars: the cube pulls most orders towards the low client ids.
+            const double clientDraw = random.Real();
+            order.ClientId = static_cast<uint32_t>(std::min(catalogue.ClientCount - 1,
+                                                            static_cast<uint64_t>(clientDraw * clientDraw * clientDraw *
+                                                                                  static_cast<double>(catalogue.ClientCount)))) +
+                             1;
+
+            order.PrintOrderCount   = catalogue.PrintOrderCountTable.Sample(random);
+            order.ServiceOrderCount = catalogue.ServiceOrderCountTable.Sample(random);
+            if (order.PrintOrderCount == 0 && order.ServiceOrderCount == 0) order.PrintOrderCount = 1;
+
+            // overall_price the way the triggers compute it, in 1e-8 cents: the print discounts are exact in that unit,
+            // the NUMERIC(10, 2) rounding happens once at the end. No film is ever bought where it's developed
+            // (items.name = films.code never matches), so development is never free.
+            const int64_t clientFactor = 10000 - GetClientProfile(m_Desc.Seed, order.ClientId).DiscountBasisPoints;
+            int64_t price{0};
+            for (uint32_t printOrder{}; printOrder < order.PrintOrderCount; ++printOrder)
+            {
+                const uint32_t frameCount = catalogue.FrameCountTable.Sample(random) + 1;
+                uint32_t totalAmount{0};
+                int64_t framePrice{0};
+                for (uint32_t frame{}; frame < frameCount; ++frame)
+                {
+                    const uint32_t amount       = s_FrameAmounts[catalogue.FrameAmountTable.Sample(random)];
+                    const uint32_t printPriceId = catalogue.PrintPriceTable.Sample(random) + 1;
+                    plan.Frames.emplace_back(amount, printPriceId);
+                    totalAmount += amount;
+                    framePrice += amount * catalogue.PrintPrices[printPriceId - 1].PriceCents;
+                }
+
+                uint32_t discountId = 1;
+                while (discountId < s_PrintDiscounts.size() && s_PrintDiscounts[discountId].PhotoAmount <= totalAmount)
+                    ++discountId;
+                plan.PrintOrders.emplace_back(discountId, frameCount);
+                price += framePrice * (10000 - s_PrintDiscounts[discountId - 1].DiscountBasisPoints) * clientFactor;
+            }
+
+            const auto& offeredTypes = catalogue.ServiceTypesByOutletType[outlet.Type - 1];
+            for (uint32_t serviceOrder{}; serviceOrder < order.ServiceOrderCount; ++serviceOrder)
+            {
+                const uint32_t serviceTypeId = offeredTypes[random.Below(static_cast<uint32_t>(offeredTypes.size()))];
+                const uint32_t count         = static_cast<uint32_t>(random.Between(1, 3));
+                plan.ServiceOrders.emplace_back(serviceTypeId, count);
+                price += count * s_ServiceTypes[serviceTypeId - 1].PriceCents * (order.bUrgent ? 2 : 1) * 100'000'000;
+            }
+
+            order.PriceCents = (price + 50'000'000) / 100'000'000;
+            plan.Orders.push_back(order);
+        }
+    }
+
+    // First pass over all order blocks: how many children each one has, for the ids of later blocks, and how much of each
+    // supply item every outlet's services use up, for the opening stock.
+    void DataGenerator::CountOrderBlocks() noexcept
+    {
+        Catalogue& catalogue      = *m_Catalogue;
+        const uint64_t blockCount = catalogue.OrderBlockCount;
+        for (auto* offsets : {&catalogue.PrintOrderOffsets, &catalogue.ServiceOrderOffsets, &catalogue.FrameOffsets, &catalogue.FilmOffsets,
+                              &catalogue.FilmDevelopmentOffsets})
+            offsets->assign(blockCount + 1, 0);
+
+        const uint32_t threadCount = static_cast<uint32_t>(std::min<uint64_t>(GetThreadCount(), blockCount));
+        std::vector<std::vector<uint64_t>> consumption(threadCount,
+                                                       std::vector<uint64_t>(catalogue.Outlets.size() * s_SupplyItemCount, 0));
+        std::atomic<uint64_t> nextBlock{0};
+
+        const auto work = [&](uint32_t workerIndex)
+        {
+            OrderBlockPlan plan{};
+            auto& workerConsumption = consumption[workerIndex];
+            for (uint64_t block = nextBlock++; block < blockCount; block = nextBlock++)
+            {
+                PlanOrderBlock(block, plan);
+
+                uint64_t filmCount{0}, filmDevelopmentCount{0};
+                std::size_t serviceOrderIndex{0};
+                for (const auto& order : plan.Orders)
+                    for (uint32_t i{}; i < order.ServiceOrderCount; ++i)
+                    {
+                        const auto& serviceOrder = plan.ServiceOrders[serviceOrderIndex++];
+                        if (serviceOrder.ServiceTypeId == s_FilmDevelopmentServiceTypeId)
+                        {
+                            filmCount += serviceOrder.Count;
+                            ++filmDevelopmentCount;
+                        }
+
+                        for (const auto& needed : catalogue.NeededItems)
+                            if (needed.ServiceTypeId == serviceOrder.ServiceTypeId)
+                                workerConsumption[(order.OutletId - 1) * s_SupplyItemCount + needed.ItemId - 1] +=
+                                    static_cast<uint64_t>(needed.Count) * serviceOrder.Count;
+                    }
+
+                // Each block writes its own slot, the prefix sums come after the join.
+                catalogue.PrintOrderOffsets[block + 1]      = plan.PrintOrders.size();
+                catalogue.ServiceOrderOffsets[block + 1]    = plan.ServiceOrders.size();
+                catalogue.FrameOffsets[block + 1]           = plan.Frames.size();
+                catalogue.FilmOffsets[block + 1]            = filmCount;
+                catalogue.FilmDevelopmentOffsets[block + 1] = filmDevelopmentCount;
+            }
+        };
+
+        std::vector<std::thread> workers{};
+        for (uint32_t i{}; i < threadCount; ++i)
+            workers.emplace_back(work, i);
+        for (auto& worker : workers)
+            worker.join();
+
+        for (auto* offsets : {&catalogue.PrintOrderOffsets, &catalogue.ServiceOrderOffsets, &catalogue.FrameOffsets, &catalogue.FilmOffsets,
+                              &catalogue.FilmDevelopmentOffsets})
+            std::partial_sum(offsets->begin(), offsets->end(), offsets->begin());
+
+        catalogue.Consumption.assign(catalogue.Outlets.size() * s_SupplyItemCount, 0);
+        for (const auto& workerConsumption : consumption)
+            for (std::size_t i{}; i < workerConsumption.size(); ++i)
+                catalogue.Consumption[i] += workerConsumption[i];
+    }
+
+    // Opening stock of every supply item an outlet's services need: what they use up over the whole span plus a reserve.
+    // Capacity leaves room for that and all deliveries. storage_items ids start past the delivery item count, the ids the
+    // delivery trigger's INSERT ... ON CONFLICT may take from the sequence when the load doesn't defer it (without the
+    // inventory ledger of 14-inventory-ledger.sql, which leaves storage_items to the compaction).
+    void DataGenerator::BuildStock() noexcept
+    {
+        Catalogue& catalogue = *m_Catalogue;
+        std::vector<int64_t> storedQuantities(catalogue.Outlets.size(), 0);
+        for (const auto& deliveryItem : catalogue.DeliveryItems)
+            storedQuantities[catalogue.Deliveries[deliveryItem.DeliveryId - 1].StorageId - 1] += deliveryItem.Quantity;
+
+        for (uint32_t outletIndex{}; outletIndex < catalogue.Outlets.size(); ++outletIndex)
+        {
+            GeneratorRandom random(m_Desc.Seed, EStream::Stock, outletIndex + 1);
+            const auto& offeredTypes = catalogue.ServiceTypesByOutletType[catalogue.Outlets[outletIndex].Type - 1];
+            for (uint32_t itemIndex{}; itemIndex < s_SupplyItemCount; ++itemIndex)
+            {
+                const bool bNeeded = std::any_of(catalogue.NeededItems.begin(), catalogue.NeededItems.end(),
+                                                 [&](const Catalogue::NeededItem& needed)
+                                                 {
+                                                     return needed.ItemId == itemIndex + 1 &&
+                                                            std::find(offeredTypes.begin(), offeredTypes.end(), needed.ServiceTypeId) !=
+                                                                offeredTypes.end();
+                                                 });
+                if (!bNeeded) continue;
+
+                const int64_t quantity =
+                    static_cast<int64_t>(catalogue.Consumption[outletIndex * s_SupplyItemCount + itemIndex]) + random.Between(20, 400);
+                catalogue.StorageItems.emplace_back(outletIndex + 1, itemIndex + 1, quantity);
+                storedQuantities[outletIndex] += quantity;
+            }
+
+            const int64_t capacity = (storedQuantities[outletIndex] * random.Between(125, 200) / 100 + 99) / 100 * 100;
+            catalogue.StorageCapacities.push_back(std::clamp<int64_t>(capacity, 100, std::numeric_limits<int32_t>::max()));
+        }
+    }
+
+    uint64_t DataGenerator::GetBlockCount(std::size_t tableIndex) const noexcept
+    {
+        switch (tableIndex)
+        {
+            case Clients: return (m_Catalogue->ClientCount + s_ClientsPerBlock - 1) / s_ClientsPerBlock;
+            case Orders:
+            case PrintOrders:
+            case ServiceOrders:
+            case FilmDevelopmentOrders:
+            case Films:
+            case Frames: return m_Catalogue->OrderBlockCount;
+            default: return 1;
+        }
+    }
+
+    void DataGenerator::GenerateBlock(std::size_t tableIndex, uint64_t block, std::string& out) const noexcept
+    {
+        const Catalogue& catalogue = *m_Catalogue;
+        const auto row             = [&out](std::initializer_list<int64_t> values)
+        {
+            for (const int64_t value : values)
+            {
+                AppendInteger(out, value);
+                out += ',';
+            }
+            out.back() = '\n';
+        };
+
+        switch (tableIndex)
+        {
+            case OutletTypes:
+                for (uint32_t i{}; i < s_OutletTypeNames.size(); ++i)
+                    ((out += std::to_string(i + 1)) += ',').append(s_OutletTypeNames[i]) += '\n';
+                break;
+
+            case Outlets:
+                for (uint32_t i{}; i < catalogue.Outlets.size(); ++i)
+                {
+                    const auto& outlet = catalogue.Outlets[i];
+                    AppendInteger(out, i + 1);
+                    ((out += ',') += outlet.Address) += ',';
+                    row({outlet.NumWorkers, outlet.Type});
+                }
+                break;
+
+            case Branches:
+            case PhotoStores:
+            case Kiosks:
+                for (uint32_t i{}; i < catalogue.Outlets.size(); ++i)
+                {
+                    const auto& outlet       = catalogue.Outlets[i];
+                    const EOutletType wanted = tableIndex == Branches      ? EOutletType::Branch
+                                               : tableIndex == PhotoStores ? EOutletType::PhotoStore
+                                                                           : EOutletType::Kiosk;
+                    if (outlet.Type != wanted) continue;
+
+                    if (wanted == EOutletType::Kiosk)
+                        row({i + 1, outlet.BranchId});
+                    else
+                        row({i + 1});
+                }
+                break;
+
+            case ServiceTypes:
+                for (uint32_t i{}; i < s_ServiceTypes.size(); ++i)
+                {
+                    AppendInteger(out, i + 1);
+                    ((out += ',') += s_ServiceTypes[i].Name) += ',';
+                    AppendCents(out, s_ServiceTypes[i].PriceCents);
+                    out += '\n';
+                }
+                break;
+
+            case ServiceTypesOutlets:
+            {
+                uint32_t id{0};
+                for (uint32_t type{}; type < catalogue.ServiceTypesByOutletType.size(); ++type)
+                    for (const uint32_t serviceTypeId : catalogue.ServiceTypesByOutletType[type])
+                        row({++id, serviceTypeId, type + 1});
+                break;
+            }
+
+            case Firms:
+                for (uint32_t i{}; i < s_FirmNames.size(); ++i)
+                    ((out += std::to_string(i + 1)) += ',').append(s_FirmNames[i]) += '\n';
+                break;
+
+            case Items:
+                for (uint32_t i{}; i < catalogue.Items.size(); ++i)
+                {
+                    const auto& item = catalogue.Items[i];
+                    AppendInteger(out, i + 1);
+                    ((out += ',') += item.Name) += ',';
+                    AppendCents(out, item.PriceCents);
+                    out += ',';
+                    if (item.FirmId) AppendInteger(out, item.FirmId);
+                    out += '\n';
+                }
+                break;
+
+            case Clients:
+            {
+                const uint64_t firstId = block * s_ClientsPerBlock + 1;
+                const uint64_t lastId  = std::min(firstId + s_ClientsPerBlock - 1, catalogue.ClientCount);
+                for (uint64_t id = firstId; id <= lastId; ++id)
+                {
+                    // Names draw from their own stream so the profile stays a function of the id alone.
+                    GeneratorRandom random(m_Desc.Seed ^ 0x5A17, EStream::Clients, id);
+                    const ClientProfile profile = GetClientProfile(m_Desc.Seed, id);
+                    AppendInteger(out, static_cast<int64_t>(id));
+                    out += ',';
+                    ((out += s_FirstNames[random.Below(static_cast<uint32_t>(s_FirstNames.size()))]) += ' ') +=
+                        s_LastNames[random.Below(static_cast<uint32_t>(s_LastNames.size()))];
+                    out += profile.bProfessional ? ",TRUE," : ",FALSE,";
+                    AppendCents(out, profile.DiscountBasisPoints);
+                    out += '\n';
+                }
+                break;
+            }
+
+            case PrintDiscounts:
+                for (uint32_t i{}; i < s_PrintDiscounts.size(); ++i)
+                {
+                    AppendInteger(out, i + 1);
+                    out += ',';
+                    AppendInteger(out, s_PrintDiscounts[i].PhotoAmount);
+                    out += ',';
+                    AppendCents(out, s_PrintDiscounts[i].DiscountBasisPoints);
+                    out += '\n';
+                }
+                break;
+
+            case Storages:
+                for (uint32_t i{}; i < catalogue.Outlets.size(); ++i)
+                    row({i + 1, catalogue.StorageCapacities[i], i + 1});
+                break;
+
+            case Vendors:
+                for (uint32_t i{}; i < catalogue.VendorItemOffsets.size() - 1; ++i)
+                {
+                    AppendInteger(out, i + 1);
+                    ((out += ',') += s_VendorRegions[i % s_VendorRegions.size()]) += s_VendorSuffixes[i / s_VendorRegions.size()];
+                    out += '\n';
+                }
+                break;
+
+            case VendorItems:
+                for (uint32_t i{}; i < catalogue.VendorItems.size(); ++i)
+                {
+                    const auto& vendorItem = catalogue.VendorItems[i];
+                    AppendInteger(out, i + 1);
+                    out += ',';
+                    AppendCents(out, vendorItem.PriceCents);
+                    out += ',';
+                    row({vendorItem.Quantity, vendorItem.VendorId, vendorItem.ItemId});
+                }
+                break;
+
+            case PaperTypes:
+            case PaperSizes:
+            {
+                const auto names = tableIndex == PaperTypes ? std::span<const std::string_view>(s_PaperTypeNames)
+                                                            : std::span<const std::string_view>(s_PaperSizeNames);
+                for (uint32_t i{}; i < names.size(); ++i)
+                    ((out += std::to_string(i + 1)) += ',').append(names[i]) += '\n';
+                break;
+            }
+
+            case PrintPrices:
+                for (uint32_t i{}; i < catalogue.PrintPrices.size(); ++i)
+                {
+                    const auto& printPrice = catalogue.PrintPrices[i];
+                    AppendInteger(out, i + 1);
+                    out += ',';
+                    AppendCents(out, printPrice.PriceCents);
+                    out += ',';
+                    row({printPrice.PaperSizeId, printPrice.PaperTypeId});
+                }
+                break;
+
+            case Deliveries:
+                for (uint32_t i{}; i < catalogue.Deliveries.size(); ++i)
+                {
+                    const auto& delivery = catalogue.Deliveries[i];
+                    AppendInteger(out, i + 1);
+                    out += ',';
+                    AppendDate(out, delivery.Date);
+                    out += ',';
+                    row({delivery.StorageId, delivery.VendorId});
+                }
+                break;
+
+            case DeliveryItems:
+                for (uint32_t i{}; i < catalogue.DeliveryItems.size(); ++i)
+                {
+                    const auto& deliveryItem = catalogue.DeliveryItems[i];
+                    AppendInteger(out, i + 1);
+                    out += ',';
+                    AppendCents(out, deliveryItem.PriceCents);
+                    out += ',';
+                    row({deliveryItem.Quantity, deliveryItem.DeliveryId, deliveryItem.ItemId});
+                }
+                break;
+
+            case ServiceTypesNeededItems:
+                for (const auto& needed : catalogue.NeededItems)
+                    row({needed.ItemId, needed.Count, needed.ServiceTypeId});
+                break;
+
+            case StorageItems:
+            {
+                int64_t id = static_cast<int64_t>(catalogue.DeliveryItems.size());
+                for (const auto& storageItem : catalogue.StorageItems)
+                    row({++id, storageItem.Quantity, storageItem.ItemId, storageItem.StorageId});
+                break;
+            }
+
+            default:
+            {
+                // Order-side tables, regenerated from the block's plan.
+                OrderBlockPlan plan{};
+                PlanOrderBlock(block, plan);
+
+                uint64_t printOrderId      = catalogue.PrintOrderOffsets[block];
+                uint64_t serviceOrderId    = catalogue.ServiceOrderOffsets[block];
+                uint64_t frameId           = catalogue.FrameOffsets[block];
+                uint64_t filmId            = catalogue.FilmOffsets[block];
+                uint64_t filmDevelopmentId = catalogue.FilmDevelopmentOffsets[block];
+                std::size_t printOrderIndex{0}, frameIndex{0}, serviceOrderIndex{0};
+
+                for (uint64_t i{}; i < plan.Orders.size(); ++i)
+                {
+                    const auto& order      = plan.Orders[i];
+                    const int64_t orderId  = static_cast<int64_t>(plan.FirstOrderIndex + i + 1);
+                    const auto appendTime = [&] { AppendTimestamp(out, order.AcceptSeconds); };
+
+                    if (tableIndex == Orders)
+                    {
+                        AppendInteger(out, orderId);
+                        out += ',';
+                        appendTime();
+                        out += ',';
+                        AppendCents(out, order.PriceCents);
+                        out += order.bUrgent ? ",TRUE," : ",FALSE,";
+                        row({order.OutletId, order.ClientId});
+                        continue;
+                    }
+
+                    for (uint32_t p{}; p < order.PrintOrderCount; ++p)
+                    {
+                        const auto& printOrder = plan.PrintOrders[printOrderIndex++];
+                        ++printOrderId;
+                        if (tableIndex == PrintOrders)
+                        {
+                            row({static_cast<int64_t>(printOrderId), orderId});
+                            out.back() = ',';
+                            appendTime();
+                            out += ',';
+                            row({printOrder.DiscountId});
+                        }
+
+                        for (uint32_t frameNumber = 1; frameNumber <= printOrder.FrameCount; ++frameNumber)
+                        {
+                            const auto& frame = plan.Frames[frameIndex++];
+                            ++frameId;
+                            if (tableIndex != Frames) continue;
+
+                            row({static_cast<int64_t>(frameId), frame.Amount, frameNumber, static_cast<int64_t>(printOrderId)});
+                            out.back() = ',';
+                            appendTime();
+                            out += ',';
+                            row({frame.PrintPriceId});
+                        }
+                    }
+
+                    for (uint32_t s{}; s < order.ServiceOrderCount; ++s)
+                    {
+                        const auto& serviceOrder = plan.ServiceOrders[serviceOrderIndex++];
+                        ++serviceOrderId;
+                        if (tableIndex == ServiceOrders)
+                        {
+                            row({static_cast<int64_t>(serviceOrderId), serviceOrder.Count, orderId});
+                            out.back() = ',';
+                            appendTime();
+                            out += ',';
+                            row({serviceOrder.ServiceTypeId});
+                        }
+                        if (serviceOrder.ServiceTypeId != s_FilmDevelopmentServiceTypeId) continue;
+
+                        ++filmDevelopmentId;
+                        if (tableIndex == FilmDevelopmentOrders)
+                        {
+                            row({static_cast<int64_t>(filmDevelopmentId), static_cast<int64_t>(serviceOrderId)});
+                            out.back() = ',';
+                            out += "FD";
+                            AppendInteger(out, static_cast<int64_t>(filmDevelopmentId));
+                            out += '\n';
+                        }
+
+                        for (uint32_t film{}; film < serviceOrder.Count; ++film)
+                        {
+                            ++filmId;
+                            if (tableIndex != Films) continue;
+
+                            AppendInteger(out, static_cast<int64_t>(filmId));
+                            out += ",FILM";
+                            AppendInteger(out, static_cast<int64_t>(filmId));
+                            out += ',';
+                            row({static_cast<int64_t>(serviceOrderId)});
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    bool DataGenerator::Generate(std::size_t tableIndex, const BulkLoadSink& sink) noexcept
+    {
+        if (tableIndex >= m_Tables.size()) return false;
+        m_CurrentTableIndex.store(tableIndex, std::memory_order_relaxed);
+
+        // Only the order-side tables are big enough to split, the rest is one block. Rows per block go into the progress.
+        const uint64_t blockCount = GetBlockCount(tableIndex);
+        const uint64_t tableRows  = m_Tables[tableIndex].RowCount;
+        return GenerateInOrder(
+            blockCount, GetThreadCount(),
+            [&](uint64_t block, std::string& out) -> uint64_t
+            {
+                GenerateBlock(tableIndex, block, out);
+                return static_cast<uint64_t>(std::count(out.begin(), out.end(), '\n'));
+            },
+            [&](std::string_view text, uint64_t rowCount)
+            {
+                if (m_bCancelRequested.load(std::memory_order_acquire)) return false;
+                if (!text.empty() && !sink(text)) return false;
+
+                m_RowsGenerated.fetch_add(rowCount, std::memory_order_relaxed);
+                return true;
+            }) ||
+               (tableRows == 0 && !m_bCancelRequested.load(std::memory_order_acquire));
+    }
+
+    bool DataGenerator::WriteCsvFiles(const std::filesystem::path& directory, std::string& error) noexcept
+    {
+        std::error_code errorCode{};
+        std::filesystem::create_directories(directory, errorCode);
+        if (errorCode)
+        {
+            error = "Failed to create " + directory.string() + ": " + errorCode.message();
+            return false;
+        }
+
+        for (std::size_t i{}; i < m_Tables.size(); ++i)
+        {
+            const auto& table                    = m_Tables[i];
+            const std::filesystem::path path     = directory / (std::string(table.Name) + ".csv");
+            const std::filesystem::path partPath = path.string() + ".part";
+
+            std::ofstream stream(partPath, std::ios::binary | std::ios::trunc);
+            std::string header{};
+            for (const auto& columnName : table.ColumnNames)
+                (header += header.empty() ? "" : ",") += columnName;
+            stream << header << '\n';
+
+            const bool bGenerated = Generate(i,
+                                             [&](std::string_view text)
+                                             {
+                                                 stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+                                                 return static_cast<bool>(stream);
+                                             });
+            stream.close();
+
+            if (!bGenerated || !stream)
+            {
+                error = m_bCancelRequested.load(std::memory_order_acquire) ? std::string("Generation cancelled.")
+                                                                           : "Failed to write " + partPath.string();
+                std::filesystem::remove(partPath, errorCode);
+                LOG_ERROR("Data generator: {}", error);
+                return false;
+            }
+
+            std::filesystem::rename(partPath, path, errorCode);
+            if (errorCode)
+            {
+                error = "Failed to rename " + partPath.string() + ": " + errorCode.message();
+                LOG_ERROR("Data generator: {}", error);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<BulkLoadStream> DataGenerator::CreateLoadStreams() noexcept
+    {
+        std::vector<BulkLoadStream> streams{};
+        for (std::size_t i{}; i < m_Tables.size(); ++i)
+            streams.emplace_back(std::string(m_Tables[i].Name), m_Tables[i].ColumnNames, m_Tables[i].EstimatedBytes,
+                                 [this, i](const BulkLoadSink& sink) { return Generate(i, sink); });
+
+        return streams;
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <BulkLoader.hpp>
+
+namespace nsudb
+{
+
+    struct DataGeneratorDesc final
+    {
+        static constexpr uint64_t s_DefaultSeed = 20240520;
+
+        // 1 is about 100k orders, 1M frames and 20k clients. Order-side tables grow linearly, outlets with its square root,
+        // catalogues (service types, items, vendors, papers) stay the same.
+        double ScaleFactor{1.0};
+        uint64_t Seed{s_DefaultSeed};
+        uint32_t ThreadCount{0};  // 0 = one per hardware thread
+
+        // accept_time spans MonthCount months from January of StartYear, deliveries the same range.
+        int32_t StartYear{2023};
+        int32_t MonthCount{24};
+    };
+
+    struct GeneratedTable final
+    {
+        std::string_view Name{};
+        std::vector<std::string> ColumnNames{};
+        uint64_t RowCount{0};
+        uint64_t EstimatedBytes{0};  // for progress, not exact
+    };
+
+    // Referentially consistent synthetic data for all 27 tables at any scale, the same for the same seed and scale however
+    // many threads produce it: every order block and every entity draws from its own SplitMix64 stream, sampling goes
+    // through integer thresholds rather than <random> distributions (which differ between standard libraries).
+    //   outlets: a quarter branches, a quarter photo stores, the rest kiosks tied to a branch; orders spread over them
+    //            Zipf-like, a few busy outlets and a long tail, urgent orders only at branches
+    //   orders:  accept_time follows month, weekday and hour-of-day weights and grows with the id, like a real log;
+    //            overall_price is what the price triggers compute, so no recompute pass is needed
+    //   stock:   storage_items is opening stock that covers every service's consumption, deliveries bring retail goods
+    //            only, storage capacities fit both, so the storage triggers never fail
+    // Ids are explicit and dense, the target schema is expected to be empty (13-monthly-partitions.sql applied).
+    // The order-side children carry order_accept_time, so loading them needs no join with the parent.
+    struct DataGenerator final
+    {
+        explicit DataGenerator(DataGeneratorDesc desc) noexcept;  // sizes everything, counts the children of every order block
+        ~DataGenerator() noexcept;
+
+        DataGenerator(const DataGenerator&)            = delete;
+        DataGenerator& operator=(const DataGenerator&) = delete;
+
+        // All 27 tables in foreign key order.
+        const std::vector<GeneratedTable>& GetTables() const noexcept { return m_Tables; }
+        uint64_t GetTotalRows() const noexcept;
+
+        uint64_t GetRowsGenerated() const noexcept { return m_RowsGenerated.load(std::memory_order_relaxed); }
+        std::size_t GetCurrentTableIndex() const noexcept { return m_CurrentTableIndex.load(std::memory_order_relaxed); }
+
+        // Rows of one table as CSV without a header, handed to sink in order in pieces of whole rows. Blocks are produced by
+        // ThreadCount workers a few blocks ahead of the sink, so memory stays constant. False if the sink refused a piece
+        // or Cancel() was called. One table at a time.
+        bool Generate(std::size_t tableIndex, const BulkLoadSink& sink) noexcept;
+
+        // Every table as <directory>/<table>.csv with a header line, the layout of database/data, ready for --import-csv.
+        // Files are written as .part and renamed once complete.
+        bool WriteCsvFiles(const std::filesystem::path& directory, std::string& error) noexcept;
+
+        // Tables to load straight into a database with BulkLoader, no files in between. The generator has to outlive the load.
+        std::vector<BulkLoadStream> CreateLoadStreams() noexcept;
+
+        void Cancel() noexcept { m_bCancelRequested.store(true, std::memory_order_release); }
+
+      private:
+        struct Catalogue;
+        struct OrderBlockPlan;
+
+        DataGeneratorDesc m_Desc{};
+        std::vector<GeneratedTable> m_Tables{};
+        std::unique_ptr<Catalogue> m_Catalogue{};
+
+        std::atomic<uint64_t> m_RowsGenerated{0};
+        std::atomic<std::size_t> m_CurrentTableIndex{0};
+        std::atomic_bool m_bCancelRequested{false};
+
+        uint32_t GetThreadCount() const noexcept;
+        uint64_t GetBlockCount(std::size_t tableIndex) const noexcept;
+        void GenerateBlock(std::size_t tableIndex, uint64_t block, std::string& out) const noexcept;
+
+        void PlanOrderBlock(uint64_t block, OrderBlockPlan& plan) const noexcept;
+        void CountOrderBlocks() noexcept;
+        void BuildStock() noexcept;
+    };
+
+}  // namespace nsudb
@@ -1,108 +1,779 @@
 #include "Database.hpp"
 #include <Logger.hpp>
+#include <BinaryFormat.hpp>
+#include <PreparedStatementCache.hpp>
+#include <ResultCursor.hpp>
 
 #include <pgfe/pgfe.hpp>
+#include <libpq-fe.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#endif
 
 namespace nsudb
 {
 
     namespace pgfe = dmitigr::pgfe;
 
-    DatabaseConnection::DatabaseConnection(const DatabaseDesc& databaseDesc) noexcept : m_Desc(databaseDesc) {}
+    static constexpr std::size_t s_PipelineFlushInterval = 64;  // pipelined statements queued between flushes within a batch
+
+    // Every Nth row appended through the pgfe callback is timed and stands for the ones in between, two clock reads per row
+    // would cost about as much as appending a short one.
+    static constexpr std::size_t s_BuildTimeSampleInterval = 16;
+
+    static int64_t GetSteadyTimeNs() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    QueryTask::QueryTask(std::vector<QueryStatement> statements, bool bPrepared, EResultFormat resultFormat) noexcept
+        : m_Statements(std::move(statements)), m_bPrepared(bPrepared), m_ResultFormat(resultFormat), m_Future(m_Promise.get_future()),
+          m_SubmitTime(std::chrono::steady_clock::now())
+    {
+        assert(!m_Statements.empty());
+    }
+
+    bool QueryTask::IsFinished() const noexcept
+    {
+        return m_Future.valid() && m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    std::shared_ptr<const QueryResult> QueryTask::TakeResult() noexcept
+    {
+        if (!IsFinished()) return nullptr;
+
+        return m_Future.get();
+    }
+
+    std::vector<BatchResult> QueryTask::TakeBatchResults() noexcept
+    {
+        if (!IsFinished()) return {};
+
+        return std::move(m_BatchResults);
+    }
+
+    float QueryTask::GetElapsedSeconds() const noexcept
+    {
+        const int64_t startTimeNs = m_StartTimeNs.load(std::memory_order_acquire);
+        if (startTimeNs == 0) return 0.0f;  // still sitting in the queue
+
+        int64_t endTimeNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (endTimeNs == 0) endTimeNs = GetSteadyTimeNs();
+
+        return static_cast<float>(static_cast<double>(endTimeNs - startTimeNs) * 1e-9);
+    }
+
+    DatabaseConnection::DatabaseConnection(const DatabaseDesc& databaseDesc, const ConnectionPoolDesc& poolDesc,
+                                           const ResultCacheDesc& cacheDesc) noexcept
+        : m_Pool(databaseDesc, poolDesc)
+    {
+        if (cacheDesc.MemoryBudget > 0) m_ResultCache = std::make_unique<ResultCache>(databaseDesc, cacheDesc);
+
+        // More workers than connections would only queue up inside ConnectionPool::Acquire().
+        m_Workers.resize(m_Pool.GetPoolDesc().MaxConnections);
+        for (auto& worker : m_Workers)
+            worker = std::thread(&DatabaseConnection::WorkerLoop, this);
+    }
 
     DatabaseConnection::~DatabaseConnection() noexcept
     {
-        if (m_Connection && m_Connection->is_connected()) m_Connection->disconnect();
+        {
+            std::scoped_lock lock(m_QueueMutex);
+            m_bStopWorkers = true;
+            for (auto& task : m_PendingTasks)
+                task->m_bCancelRequested.store(true, std::memory_order_release);
+
+            // Don't wait for a slow report to finish on its own.
+            for (auto& task : m_RunningTasks)
+            {
+                task->m_bCancelRequested.store(true, std::memory_order_release);
+                if (!task->m_CancelHandle) continue;
+
+                char errorBuffer[256]{};
+                PQcancel(task->m_CancelHandle, errorBuffer, sizeof(errorBuffer));
+            }
+        }
+        m_QueueCV.notify_all();
+        m_Pool.Shutdown();  // workers blocked in Acquire() give up
+
+        for (auto& worker : m_Workers)
+            if (worker.joinable()) worker.join();
     }
 
     bool DatabaseConnection::TryConnectIfNotConnected() noexcept
     {
-        if (!m_Connection)
+        return m_Pool.WarmUp();
+    }
+
+    std::optional<QueryResult> DatabaseConnection::Execute(const std::string& query, EResultFormat resultFormat) noexcept
+    {
+        PooledConnection connection = m_Pool.Acquire();
+        if (!connection) return std::nullopt;
+
+        QueryResult queryResult{};
+        if (!ExecuteOnConnection(connection, QueryStatement{.Sql = query}, false, resultFormat, nullptr, queryResult)) return std::nullopt;
+
+        return queryResult;
+    }
+
+    bool DatabaseConnection::ExecuteOnConnection(PooledConnection& connection, const QueryStatement& statement, bool bPrepared,
+                                                 EResultFormat resultFormat, QueryTask* task, QueryResult& queryResult) noexcept
+    {
+        if (statement.Sql.empty()) return false;
+
+        try
         {
-            try
+            LOG_QUERY(m_Pool.GetDatabaseDesc().Database, statement.Sql);
+
+            // Set on every call, the pooled connection may have been left in either format by the previous task.
+            const bool bBinary = resultFormat == EResultFormat::Binary;
+            connection->set_result_format(bBinary ? pgfe::Data_format::binary : pgfe::Data_format::text);
+
+            // Server time runs until the first row arrives, what follows is transfer and build.
+            const int64_t executeStartNs = GetSteadyTimeNs();
+            int64_t firstRowNs{0};
+            int64_t buildNs{0};
+            std::size_t rowIndex{0};
+
+            std::vector<uint32_t> typeOids{};
+            const auto rowCallback = [&](auto&& row)
             {
-                static constexpr uint32_t s_ConnTimeoutSeconds = 5;
+                const bool bTimedRow     = rowIndex++ % s_BuildTimeSampleInterval == 0;
+                const int64_t rowStartNs = bTimedRow ? GetSteadyTimeNs() : 0;
+                if (firstRowNs == 0) firstRowNs = rowStartNs;
+
+                if (queryResult.GetColumnCount() == 0)
+                {
+                    std::vector<std::string> columnNames(row.field_count());
+                    for (std::size_t i{}; i < row.field_count(); ++i)
+                        columnNames[i] = row.field_name(i);
+
+                    queryResult.SetColumnNames(std::move(columnNames));
+                    for (std::size_t i{}; i < row.field_count(); ++i)
+                        queryResult.SetColumnTypeOid(i, row.info().data_type_oid(i));
+                    for (std::size_t i{}; bBinary && i < row.field_count(); ++i)
+                    {
+                        const uint32_t typeOid = row.info().data_type_oid(i);
+                        queryResult.SetColumnType(i, BinaryFormat::GetColumnType(typeOid));
+                        if (!BinaryFormat::HasTextRendering(typeOid))
+                            LOG_WARN("Column \"{}\" has type OID {} without binary decoding, shown hex-escaped.", row.field_name(i),
+                                     typeOid);
+                    }
+                }
+
+                // Later statements of a prepared task describe their own columns, rows are only appended where types agree.
+                if (bBinary && typeOids.empty())
+                {
+                    typeOids.resize(row.field_count());
+                    for (std::size_t i{}; i < row.field_count(); ++i)
+                        typeOids[i] = row.info().data_type_oid(i);
+                }
 
-                const auto connectionOptions = pgfe::Connection_options{}
-                                                   .set(pgfe::Communication_mode::net)
-                                                   .set_hostname(m_Desc.HostName.c_str())
-                                                   .set_database(m_Desc.Database.c_str())
-                                                   .set_username(m_Desc.Username.c_str())
-                                                   .set_password(m_Desc.Password.c_str())
-                                                   .set_connect_timeout(std::chrono::seconds(s_ConnTimeoutSeconds))
-                                                   .set_port(m_Desc.Port);
-                m_Connection = std::make_unique<pgfe::Connection>(connectionOptions);
+                // Copy straight from the libpq buffer into the column arenas, size is known so no strlen either.
+                // Multi-statement scripts may yield rows of a different shape, those are clamped to the first one.
+                const std::size_t columnCount = queryResult.GetColumnCount();
+                for (std::size_t i{}; i < columnCount; ++i)
+                {
+                    if (i >= row.field_count() || !row[i] ||
+                        (bBinary && BinaryFormat::GetColumnType(typeOids[i]) != queryResult.GetColumnType(i)))
+                    {
+                        queryResult.AppendNull(i);
+                        continue;
+                    }
+
+                    const auto field = row[i];
+                    const std::string_view bytes(static_cast<const char*>(field.bytes()), field.size());
+                    if (bBinary)
+                        BinaryFormat::AppendValue(queryResult, i, typeOids[i], bytes);
+                    else
+                        queryResult.AppendValue(i, bytes);
+                }
+                queryResult.CommitRow();
+
+                if (task) task->m_RowsReceived.fetch_add(1, std::memory_order_relaxed);
+                if (bTimedRow) buildNs += (GetSteadyTimeNs() - rowStartNs) * static_cast<int64_t>(s_BuildTimeSampleInterval);
+            };
+
+            const auto discardRowCallback = [](auto&&) {};
+            if (bPrepared)
+            {
+                auto& preparedStatement = connection.GetPreparedStatements().GetOrPrepare(connection.Get(), statement.Sql);
+                for (std::size_t i{}; i < statement.Params.size(); ++i)
+                    preparedStatement.bind(i, statement.Params[i]);
+
+                if (statement.bDiscardRows)
+                    preparedStatement.execute(discardRowCallback);
+                else
+                    preparedStatement.execute(rowCallback);
             }
-            catch (const std::exception& e)
+            else
             {
-                LOG_ERROR(e.what());
-                return false;
+                assert(statement.Params.empty() && "Parameters are only bound for prepared statements!");
+                if (statement.bDiscardRows)
+                    connection->execute(discardRowCallback, statement.Sql);
+                else
+                    connection->execute(rowCallback, statement.Sql);
+            }
+
+            if (task)
+            {
+                const int64_t endNs       = GetSteadyTimeNs();
+                const int64_t serverEndNs = firstRowNs != 0 ? firstRowNs : endNs;
+                const int64_t transferNs  = endNs - serverEndNs;
+                task->m_PhaseTimes.ServerNs += serverEndNs - executeStartNs;
+                task->m_PhaseTimes.BuildNs += std::min(buildNs, transferNs);
+                task->m_PhaseTimes.TransferNs += transferNs - std::min(buildNs, transferNs);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR(e.what());
+            if (task) task->m_Error = e.what();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Same column rules as the row callback of ExecuteOnConnection().
+    std::size_t AppendResultRows(const PGresult* pgResult, bool bBinary, QueryResult& queryResult) noexcept
+    {
+        const std::size_t fieldCount = static_cast<std::size_t>(PQnfields(pgResult));
+        if (queryResult.GetColumnCount() == 0)
+        {
+            std::vector<std::string> columnNames(fieldCount);
+            for (std::size_t i{}; i < fieldCount; ++i)
+                columnNames[i] = PQfname(pgResult, static_cast<int>(i));
+
+            queryResult.SetColumnNames(std::move(columnNames));
+            for (std::size_t i{}; i < fieldCount; ++i)
+                queryResult.SetColumnTypeOid(i, PQftype(pgResult, static_cast<int>(i)));
+            for (std::size_t i{}; bBinary && i < fieldCount; ++i)
+            {
+                const uint32_t typeOid = PQftype(pgResult, static_cast<int>(i));
+                queryResult.SetColumnType(i, BinaryFormat::GetColumnType(typeOid));
+                if (!BinaryFormat::HasTextRendering(typeOid))
+                    LOG_WARN("Column \"{}\" has type OID {} without binary decoding, shown hex-escaped.", queryResult.GetColumnNames()[i],
+                             typeOid);
             }
         }
 
-        if (!m_Connection->is_connected())
+        std::vector<uint32_t> typeOids(fieldCount);
+        for (std::size_t i{}; i < fieldCount; ++i)
+            typeOids[i] = PQftype(pgResult, static_cast<int>(i));
+
+        const int rowCount            = PQntuples(pgResult);
+        const std::size_t columnCount = queryResult.GetColumnCount();
+        for (int row{}; row < rowCount; ++row)
+        {
+            for (std::size_t i{}; i < columnCount; ++i)
+            {
+                const int field = static_cast<int>(i);
+                if (i >= fieldCount || PQgetisnull(pgResult, row, field) ||
+                    (bBinary && BinaryFormat::GetColumnType(typeOids[i]) != queryResult.GetColumnType(i)))
+                {
+                    queryResult.AppendNull(i);
+                    continue;
+                }
+
+                const std::string_view bytes(PQgetvalue(pgResult, row, field), PQgetlength(pgResult, row, field));
+                if (bBinary)
+                    BinaryFormat::AppendValue(queryResult, i, typeOids[i], bytes);
+                else
+                    queryResult.AppendValue(i, bytes);
+            }
+            queryResult.CommitRow();
+        }
+
+        return static_cast<std::size_t>(rowCount);
+    }
+
+    static std::string GetTrimmedErrorMessage(const char* message) noexcept
+    {
+        std::string error(message ? message : "");
+        while (!error.empty() && std::isspace(static_cast<unsigned char>(error.back())))
+            error.pop_back();
+
+        return error;
+    }
+
+    // Blocks until the connection's socket is readable, or writable too when asked. False on a socket error.
+    static bool WaitForSocket(PGconn* conn, bool bWritable) noexcept
+    {
+        const int socket = PQsocket(conn);
+        if (socket < 0) return false;
+
+#ifdef _WIN32
+        WSAPOLLFD pollFd{};
+        pollFd.fd     = static_cast<SOCKET>(socket);
+        pollFd.events = static_cast<SHORT>(POLLRDNORM | (bWritable ? POLLWRNORM : 0));
+        return WSAPoll(&pollFd, 1, -1) > 0;
+#else
+        pollfd pollFd{};
+        pollFd.fd     = socket;
+        pollFd.events = static_cast<short>(POLLIN | (bWritable ? POLLOUT : 0));
+
+        int readyCount{0};
+        while ((readyCount = poll(&pollFd, 1, -1)) < 0 && errno == EINTR)
+        {
+        }
+        return readyCount > 0;
+#endif
+    }
+
+    bool DatabaseConnection::ExecutePipelineOnConnection(PooledConnection& connection, QueryTask& task) noexcept
+    {
+        const std::vector<QueryStatement>& statements = task.m_Statements;
+        const bool bBinary                            = task.m_ResultFormat == EResultFormat::Binary;
+
+        // Misses in the statement cache are prepared up front at a round trip each, so a repeated set costs none. A set larger
+        // than the cache would evict its own statements while preparing them, those go out unnamed (parsed on every run).
+        PreparedStatementCache& preparedStatements = connection.GetPreparedStatements();
+        std::vector<std::string> statementNames(statements.size());
+        if (statements.size() <= preparedStatements.GetCapacity())
         {
             try
             {
-                m_Connection->connect();
+                for (std::size_t i{}; i < statements.size(); ++i)
+                    statementNames[i] = preparedStatements.GetOrPrepare(connection.Get(), statements[i].Sql).name();
             }
             catch (const std::exception& e)
             {
                 LOG_ERROR(e.what());
+                task.m_Error = e.what();
                 return false;
             }
+        }
+
+        // Tear down on a broken pipeline, the session can't be trusted afterwards and the pool drops disconnected entries.
+        PGconn* conn       = connection->native_handle();
+        const auto failure = [&](std::string error)
+        {
+            LOG_ERROR("Pipeline failed: {}", error);
+            task.m_Error = std::move(error);
+            connection->disconnect();
+            return false;
+        };
+
+        // Sending and reading are interleaved on a non-blocking socket: statements are flushed every sync (and every
+        // s_PipelineFlushInterval statements), more are only queued once the previous ones went out in full, and whatever
+        // results arrived meanwhile are read. Neither side can stall on full socket buffers however large the set is.
+        const int wasNonBlocking = PQisnonblocking(conn);
+        if (PQsetnonblocking(conn, 1) != 0 || PQenterPipelineMode(conn) != 1) return failure(GetTrimmedErrorMessage(PQerrorMessage(conn)));
+
+        LOG_TRACE("Database: {}, pipelining {} statements in {} batches", m_Pool.GetDatabaseDesc().Database, statements.size(),
+                  task.m_BatchEnds.size());
+
+        const int64_t sendStartNs    = GetSteadyTimeNs();
+        const int resultFormat       = bBinary ? 1 : 0;
+        const std::size_t batchCount = task.m_BatchEnds.size();
+
+        // A sync after every batch ends its implicit transaction, an error only aborts the rest of that batch.
+        std::size_t sentStatementCount{0};
+        std::size_t sentBatchCount{0};  // syncs sent
+        const auto sendNext = [&]() -> bool
+        {
+            if (sentStatementCount == task.m_BatchEnds[sentBatchCount])
+            {
+                ++sentBatchCount;
+                return PQpipelineSync(conn) == 1;
+            }
+
+            const QueryStatement& statement = statements[sentStatementCount];
+            std::vector<const char*> paramValues(statement.Params.size());
+            for (std::size_t i{}; i < statement.Params.size(); ++i)
+                paramValues[i] = statement.Params[i].c_str();
+
+            const int paramCount             = static_cast<int>(paramValues.size());
+            const std::string& statementName = statementNames[sentStatementCount++];
+            if (statementName.empty())
+                return PQsendQueryParams(conn, statement.Sql.c_str(), paramCount, nullptr, paramValues.data(), nullptr, nullptr,
+                                         resultFormat) == 1;
+
+            return PQsendQueryPrepared(conn, statementName.c_str(), paramCount, paramValues.data(), nullptr, nullptr, resultFormat) == 1;
+        };
+
+        // Every statement's results end with a null result, every batch with its sync. Only what was already sent is read,
+        // and only while libpq has it buffered. Server time runs until the first result is back, later ones count as transfer.
+        task.m_BatchResults.resize(batchCount);
+        std::size_t receivedStatementCount{0};
+        std::size_t receivedBatchCount{0};
+        QueryResult batchResult{};
+        std::string batchError{};
+        int64_t firstResultNs{0};
+        int64_t buildNs{0};
+        const auto receiveReady = [&]() -> bool
+        {
+            while (receivedBatchCount < batchCount && !PQisBusy(conn))
+            {
+                const bool bBatchDone = receivedStatementCount == task.m_BatchEnds[receivedBatchCount];
+                if (bBatchDone ? receivedBatchCount == sentBatchCount : receivedStatementCount == sentStatementCount) break;
+
+                PGresult* pgResult = PQgetResult(conn);
+                if (bBatchDone)
+                {
+                    const bool bSynced = pgResult && PQresultStatus(pgResult) == PGRES_PIPELINE_SYNC;
+                    PQclear(pgResult);
+                    if (!bSynced) return false;
+
+                    BatchResult& result = task.m_BatchResults[receivedBatchCount];
+                    if (batchError.empty())
+                        result.Result = std::make_shared<const QueryResult>(std::move(batchResult));
+                    else
+                    {
+                        LOG_WARN("Pipelined batch {} failed: {}", receivedBatchCount, batchError);
+                        result.Error = std::move(batchError);
+                    }
+
+                    batchResult = QueryResult{};
+                    batchError.clear();
+                    ++receivedBatchCount;
+                    continue;
+                }
+
+                if (!pgResult)
+                {
+                    ++receivedStatementCount;
+                    continue;
+                }
+
+                if (firstResultNs == 0) firstResultNs = GetSteadyTimeNs();
+
+                switch (PQresultStatus(pgResult))
+                {
+                    case PGRES_TUPLES_OK:
+                    {
+                        if (statements[receivedStatementCount].bDiscardRows) break;
+
+                        const int64_t buildStartNs = GetSteadyTimeNs();
+                        task.m_RowsReceived.fetch_add(AppendResultRows(pgResult, bBinary, batchResult), std::memory_order_relaxed);
+                        buildNs += GetSteadyTimeNs() - buildStartNs;
+                        break;
+                    }
+                    case PGRES_COMMAND_OK:
+                    case PGRES_PIPELINE_ABORTED: break;  // the latter after an earlier failure in the batch
+                    default:
+                        if (batchError.empty()) batchError = GetTrimmedErrorMessage(PQresultErrorMessage(pgResult));
+                        break;
+                }
+                PQclear(pgResult);
+            }
 
-            LOG_TRACE("Connected to DB - {}, as {}", m_Desc.Database, m_Desc.Username);
             return true;
+        };
+
+        bool bFlushPending = false;
+        while (receivedBatchCount < batchCount)
+        {
+            // PQflush() is 1 while part of the queue is still waiting for room in the socket buffer.
+            int flushStatus = bFlushPending ? PQflush(conn) : 0;
+            while (flushStatus == 0 && sentBatchCount < batchCount)
+            {
+                const std::size_t syncCount = sentBatchCount;
+                if (!sendNext()) return failure(GetTrimmedErrorMessage(PQerrorMessage(conn)));
+                if (sentBatchCount != syncCount || sentStatementCount % s_PipelineFlushInterval == 0) flushStatus = PQflush(conn);
+            }
+            if (flushStatus < 0) return failure(GetTrimmedErrorMessage(PQerrorMessage(conn)));
+            bFlushPending = flushStatus == 1;
+
+            if (PQconsumeInput(conn) != 1 || !receiveReady()) return failure(GetTrimmedErrorMessage(PQerrorMessage(conn)));
+            if (receivedBatchCount == batchCount) break;
+
+            if (!WaitForSocket(conn, bFlushPending)) return failure("Waiting on the connection socket failed.");
         }
 
+        if (PQexitPipelineMode(conn) != 1) return failure(GetTrimmedErrorMessage(PQerrorMessage(conn)));
+
+        PQsetnonblocking(conn, wasNonBlocking);
+
+        const int64_t endNs = GetSteadyTimeNs();
+        task.m_PhaseTimes.ServerNs += firstResultNs - sendStartNs;
+        task.m_PhaseTimes.BuildNs += buildNs;
+        task.m_PhaseTimes.TransferNs += std::max<int64_t>(0, endNs - firstResultNs - buildNs);
         return true;
     }
 
-    std::optional<QueryResult> DatabaseConnection::Execute(const std::string& query) noexcept
+    QueryHandle DatabaseConnection::ExecuteAsync(const std::string& query, const SessionHandle& session,
+                                                 EResultFormat resultFormat) noexcept
     {
-        std::optional<QueryResult> queryResult{std::nullopt};
-        if (!TryConnectIfNotConnected() || query.empty()) return queryResult;
+        return ExecuteAsync(std::vector<std::string>{query}, session, resultFormat);
+    }
 
-        try
+    QueryHandle DatabaseConnection::ExecuteAsync(std::vector<std::string> statements, const SessionHandle& session,
+                                                 EResultFormat resultFormat) noexcept
+    {
+        std::vector<QueryStatement> queryStatements(statements.size());
+        for (std::size_t i{}; i < statements.size(); ++i)
+            queryStatements[i].Sql = std::move(statements[i]);
+
+        return EnqueueTask(std::make_shared<QueryTask>(std::move(queryStatements), false, resultFormat), session);
+    }
+
+    QueryHandle DatabaseConnection::ExecutePreparedAsync(std::vector<QueryStatement> statements, const SessionHandle& session,
+                                                         EResultFormat resultFormat) noexcept
+    {
+        // More than one statement goes out as a single pipelined batch, a report costs one round trip however many it has.
+        const std::size_t statementCount = statements.size();
+        auto task                        = std::make_shared<QueryTask>(std::move(statements), true, resultFormat);
+        if (statementCount > 1) task->m_BatchEnds = {statementCount};
+
+        return EnqueueTask(std::move(task), session);
+    }
+
+    QueryHandle DatabaseConnection::ExecutePipelinedAsync(std::vector<std::vector<QueryStatement>> batches, const SessionHandle& session,
+                                                          EResultFormat resultFormat) noexcept
+    {
+        std::vector<QueryStatement> statements{};
+        std::vector<std::size_t> batchEnds{};
+        batchEnds.reserve(batches.size());
+        for (auto& batch : batches)
+        {
+            std::move(batch.begin(), batch.end(), std::back_inserter(statements));
+            batchEnds.emplace_back(statements.size());
+        }
+
+        auto task          = std::make_shared<QueryTask>(std::move(statements), true, resultFormat);
+        task->m_bPipelined = true;
+        task->m_BatchEnds  = std::move(batchEnds);
+        return EnqueueTask(std::move(task), session);
+    }
+
+    QueryHandle DatabaseConnection::EnqueueTask(QueryHandle task, const SessionHandle& session) noexcept
+    {
+        if (m_ResultCache)
+        {
+            // Pipelined batches and session tasks (cursor pages) are only checked for writes, never served from the cache.
+            task->m_CacheKey = m_ResultCache->MakeKey(task->m_Statements, task->m_bPrepared, task->m_ResultFormat);
+            if (task->m_bPipelined || session) task->m_CacheKey.Key.clear();
+
+            // A hit completes the task right away, it never reaches a worker.
+            if (auto cachedResult = m_ResultCache->Find(task->m_CacheKey))
+            {
+                const int64_t nowNs = GetSteadyTimeNs();
+                task->m_RowsReceived.store(cachedResult->GetRowCount(), std::memory_order_relaxed);
+                task->m_StartTimeNs.store(nowNs, std::memory_order_release);
+                task->m_EndTimeNs.store(nowNs, std::memory_order_release);
+                task->m_Status.store(EQueryStatus::Done, std::memory_order_release);
+                task->m_Promise.set_value(std::move(cachedResult));
+                m_QueryStats.RecordCacheHit();
+                return task;
+            }
+        }
+
+        {
+            std::scoped_lock lock(m_QueueMutex);
+            task->m_Session = session;
+            m_PendingTasks.emplace_back(task);
+        }
+        m_QueueCV.notify_one();
+
+        return task;
+    }
+
+    std::optional<ResultCache::Stats> DatabaseConnection::GetResultCacheStats() const noexcept
+    {
+        if (!m_ResultCache) return std::nullopt;
+
+        return m_ResultCache->GetStats();
+    }
+
+    std::unique_ptr<ResultCursor> DatabaseConnection::OpenCursor(const std::string& query) noexcept
+    {
+        return std::make_unique<ResultCursor>(*this, query);
+    }
+
+    void DatabaseConnection::Cancel(const QueryHandle& task) noexcept
+    {
+        if (!task || task->IsFinished()) return;
+
+        std::scoped_lock lock(m_QueueMutex);
+        task->m_bCancelRequested.store(true, std::memory_order_release);
+        if (!task->m_CancelHandle) return;  // not running, worker drops it once dequeued
+
+        char errorBuffer[256]{};
+        if (!PQcancel(task->m_CancelHandle, errorBuffer, sizeof(errorBuffer))) LOG_WARN("Failed to send cancel request: {}", errorBuffer);
+    }
+
+    void DatabaseConnection::RecordQueryStats(const QueryTask& task, EQueryStatus status, const std::shared_ptr<const QueryResult>& result,
+                                              int64_t endTimeNs, uint64_t allocationCount) noexcept
+    {
+        const auto toMicroseconds = [](int64_t nanoseconds) { return static_cast<uint64_t>(std::max<int64_t>(nanoseconds, 0) / 1000); };
+        const int64_t submitTimeNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(task.m_SubmitTime.time_since_epoch()).count();
+        const int64_t startTimeNs = task.m_StartTimeNs.load(std::memory_order_relaxed);
+
+        std::size_t byteCount = result ? result->GetDataSize() : 0;
+        for (const auto& batch : task.m_BatchResults)
+            if (batch.Result) byteCount += batch.Result->GetDataSize();
+
+        QueryTiming timing{};
+        timing.Sql            = task.m_Statements.front().Sql.substr(0, QueryTiming::s_MaxSqlLength);
+        timing.StatementCount = task.m_Statements.size();
+        timing.FinishTime     = std::chrono::system_clock::now();
+        timing.bSucceeded     = status == EQueryStatus::Done;
+        timing.Set(EQueryMetric::QueueTime, toMicroseconds(startTimeNs - submitTimeNs));
+        timing.Set(EQueryMetric::AcquireTime, toMicroseconds(task.m_PhaseTimes.AcquireNs));
+        timing.Set(EQueryMetric::ServerTime, toMicroseconds(task.m_PhaseTimes.ServerNs));
+        timing.Set(EQueryMetric::TransferTime, toMicroseconds(task.m_PhaseTimes.TransferNs));
+        timing.Set(EQueryMetric::BuildTime, toMicroseconds(task.m_PhaseTimes.BuildNs));
+        timing.Set(EQueryMetric::TotalTime, toMicroseconds(endTimeNs - submitTimeNs));
+        timing.Set(EQueryMetric::Rows, task.GetRowsReceived());
+        timing.Set(EQueryMetric::Bytes, byteCount);
+        timing.Set(EQueryMetric::Allocations, allocationCount);
+        m_QueryStats.Record(std::move(timing));
+    }
+
+    std::deque<QueryHandle>::iterator DatabaseConnection::FindRunnableTaskUnlocked() noexcept
+    {
+        return std::find_if(m_PendingTasks.begin(), m_PendingTasks.end(),
+                            [](const QueryHandle& task) { return !task->m_Session || !task->m_Session->m_bBusy; });
+    }
+
+    void DatabaseConnection::WorkerLoop() noexcept
+    {
+        while (true)
         {
-            LOG_TRACE("Database: {}, executing query: {}", m_Desc.Database, query);
+            QueryHandle task{nullptr};
+            SessionHandle session{nullptr};
+            {
+                std::unique_lock lock(m_QueueMutex);
+                m_QueueCV.wait(lock,
+                               [&]
+                               {
+                                   return (m_bStopWorkers && m_PendingTasks.empty()) ||
+                                          FindRunnableTaskUnlocked() != m_PendingTasks.end();
+                               });
+                if (m_bStopWorkers && m_PendingTasks.empty()) break;
 
-            QueryResult queryResultLocal{};
-            bool bColumnsInitialized = false;
+                const auto taskIt = FindRunnableTaskUnlocked();
+                task              = std::move(*taskIt);
+                m_PendingTasks.erase(taskIt);
+                m_RunningTasks.emplace_back(task);
 
-            m_Connection->execute(
-                [&](auto&& row)
+                session = std::move(task->m_Session);
+                if (session) session->m_bBusy = true;
+            }
+
+            task->m_StartTimeNs.store(GetSteadyTimeNs(), std::memory_order_release);
+            const uint64_t allocationCountBefore = GetThreadAllocationCount();
+
+            std::shared_ptr<const QueryResult> result{nullptr};
+            if (!task->IsCancelRequested())
+            {
+                task->m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+                // Session keeps its connection between tasks, a dead one is replaced (its state is gone either way).
+                PooledConnection taskConnection{};
+                PooledConnection* connection = &taskConnection;
+                if (session)
                 {
-                    if (!bColumnsInitialized)
-                    {
-                        queryResultLocal.ColumnNames.resize(row.field_count());
-                        for (std::size_t i{}; i < row.field_count(); ++i)
-                            queryResultLocal.ColumnNames[i] = row.field_name(i);
+                    connection = &session->m_Connection;
+                    if (*connection && !(*connection)->is_connected()) connection->Release();
+                }
+
+                if (!*connection)
+                {
+                    const int64_t acquireStartNs = GetSteadyTimeNs();
+                    *connection                  = m_Pool.Acquire();
+                    task->m_PhaseTimes.AcquireNs = GetSteadyTimeNs() - acquireStartNs;
+                    if (session) connection->MarkSessionDirty();
+                }
 
-                        bColumnsInitialized = true;
+                if (*connection)
+                {
+                    {
+                        std::scoped_lock lock(m_QueueMutex);
+                        task->m_CancelHandle = connection->GetCancelHandle();
                     }
 
-                    auto& rowData = queryResultLocal.Rows.emplace_back();
-                    rowData.resize(row.field_count());
-                    for (std::size_t i{}; i < row.field_count(); ++i)
+                    QueryResult statementResult{};
+                    bool bSucceeded = true;
+                    if (!task->m_BatchEnds.empty())
                     {
-                        if (!row[i].is_empty())
-                            rowData[i] = std::string((char*)row[i].bytes());
-                        else
-                            rowData[i] = "NULL";
+                        bSucceeded = ExecutePipelineOnConnection(*connection, *task);
+
+                        // A multi-statement prepared task went out as one batch, it still reports like a single result.
+                        if (bSucceeded && !task->m_bPipelined)
+                        {
+                            BatchResult& batch = task->m_BatchResults.front();
+                            bSucceeded         = batch.Result != nullptr;
+                            if (bSucceeded)
+                                result = std::move(batch.Result);
+                            else
+                                task->m_Error = std::move(batch.Error);
+                            task->m_BatchResults.clear();
+                        }
                     }
-                },
-                query);
+                    else
+                    {
+                        for (const auto& statement : task->m_Statements)
+                        {
+                            if (task->IsCancelRequested()) break;
 
-            queryResult = std::move(queryResultLocal);
-        }
-        catch (const std::exception& e)
-        {
-            LOG_ERROR(e.what());
-        }
+                            // Prepared tasks accumulate the rows of every statement, plain ones only return the last result.
+                            if (!task->m_bPrepared) statementResult = QueryResult{};
 
-        return queryResult;
+                            bSucceeded = ExecuteOnConnection(*connection, statement, task->m_bPrepared, task->m_ResultFormat, task.get(),
+                                                             statementResult);
+                            if (!bSucceeded) break;
+                        }
+                    }
+
+                    if (bSucceeded && !result) result = std::make_shared<const QueryResult>(std::move(statementResult));
+
+                    std::scoped_lock lock(m_QueueMutex);
+                    task->m_CancelHandle = nullptr;
+                }
+                else
+                    task->m_Error = "No database connection available.";
+            }
+
+            EQueryStatus status = EQueryStatus::Done;
+            if (task->IsCancelRequested())
+            {
+                status = EQueryStatus::Cancelled;
+                result = nullptr;
+            }
+            else if (!result)
+                status = EQueryStatus::Failed;
+
+            const int64_t endTimeNs        = GetSteadyTimeNs();
+            const uint64_t allocationCount = GetThreadAllocationCount() - allocationCountBefore;
+
+            {
+                std::scoped_lock lock(m_QueueMutex);
+                std::erase(m_RunningTasks, task);
+                if (session) session->m_bBusy = false;
+            }
+
+            // Next task of this session may be waiting for it, any idle worker can take it now.
+            if (session) m_QueueCV.notify_all();
+            session = nullptr;
+
+            // Own writes show up on the very next read instead of whenever the notification arrives.
+            if (m_ResultCache)
+            {
+                if (task->m_CacheKey.bWrites)
+                    m_ResultCache->InvalidateAll();
+                else if (status == EQueryStatus::Done)
+                    m_ResultCache->Insert(task->m_CacheKey, result);
+            }
+
+            // Pending tasks cancelled before they ran say nothing about the server.
+            if (task->m_Status.load(std::memory_order_relaxed) == EQueryStatus::Running)
+                RecordQueryStats(*task, status, result, endTimeNs, allocationCount);
+
+            task->m_EndTimeNs.store(endTimeNs, std::memory_order_release);
+            task->m_Status.store(status, std::memory_order_release);
+            task->m_Promise.set_value(std::move(result));
+        }
     }
 
 }  // namespace nsudb
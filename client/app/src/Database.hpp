@@ -2,42 +2,213 @@
 
 #include <memory>
 #include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
-namespace dmitigr::pgfe
-{
-    class Connection;
-}
+#include <ConnectionPool.hpp>
+#include <QueryResult.hpp>
+#include <QueryStats.hpp>
+#include <ResultCache.hpp>
+
+struct pg_result;
 
 namespace nsudb
 {
 
-    struct DatabaseDesc final
+    enum class EQueryStatus : uint8_t
+    {
+        Pending = 0,
+        Running,
+        Done,
+        Failed,
+        Cancelled
+    };
+
+    // Text is what psql shows and works for any statement, Binary decodes bool/int/numeric/date/timestamp columns
+    // straight into typed QueryResult columns (single statements only, it goes through the extended protocol).
+    enum class EResultFormat : uint8_t
+    {
+        Text = 0,
+        Binary
+    };
+
+    struct DatabaseSession;
+
+    // Rows of a libpq result appended to queryResult, with the column names/types taken from the first result appended.
+    // Returns the row count. Shared by pipelined batches and anything fetching through libpq directly (exports).
+    std::size_t AppendResultRows(const pg_result* pgResult, bool bBinary, QueryResult& queryResult) noexcept;
+
+    // One statement of a task. Parameters are sent separately ($1..$n, text format) rather than spliced into the SQL.
+    struct QueryStatement final
+    {
+        std::string Sql{};
+        std::vector<std::string> Params{};
+        bool bDiscardRows{false};  // run for its side effect only, rows don't go into the task's result
+    };
+
+    // One batch of a pipelined task: rows of its statements concatenated, or the error of the first one that failed.
+    struct BatchResult final
     {
-        std::string HostName{"127.0.0.1"};
-        std::string Database{};
-        std::string Username{};
-        std::string Password{};
-        int_fast32_t Port{5432};
+        std::shared_ptr<const QueryResult> Result{nullptr};
+        std::string Error{};
     };
 
-    struct QueryResult final
+    // Handle to a query submitted through DatabaseConnection::ExecuteAsync().
+    // Everything here is safe to poll from the render thread while the worker runs the query.
+    struct QueryTask final
     {
-        std::vector<std::vector<std::string>> Rows;
-        std::vector<std::string> ColumnNames;
+        QueryTask(std::vector<QueryStatement> statements, bool bPrepared = false,
+                  EResultFormat resultFormat = EResultFormat::Text) noexcept;
+        ~QueryTask() noexcept = default;
+
+        bool IsFinished() const noexcept;
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Valid once IsFinished() returns true, moves the result out of the task. Shared with the result cache, a hit costs
+        // no copy, hence const.
+        std::shared_ptr<const QueryResult> TakeResult() noexcept;
+
+        // Same for tasks from ExecutePipelinedAsync(), one entry per batch in submission order.
+        std::vector<BatchResult> TakeBatchResults() noexcept;
+
+        // Guarded by IsFinished(), worker doesn't touch it after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+        const std::string& GetQuery() const noexcept { return m_Statements.back().Sql; }
+
+        std::size_t GetRowsReceived() const noexcept { return m_RowsReceived.load(std::memory_order_relaxed); }
+        float GetElapsedSeconds() const noexcept;
+
+        bool IsCancelRequested() const noexcept { return m_bCancelRequested.load(std::memory_order_acquire); }
+
+      private:
+        friend struct DatabaseConnection;
+
+        std::vector<QueryStatement> m_Statements{};  // run back to back on one connection
+        std::string m_Error{};
+        bool m_bPrepared{false};                 // statements go through the connection's cache and all of their rows make up the result
+        bool m_bPipelined{false};                // results per batch in m_BatchResults, the task's own result is empty
+        std::vector<std::size_t> m_BatchEnds{};  // sent as one pipeline when set: end of every batch in m_Statements
+        std::vector<BatchResult> m_BatchResults{};
+        EResultFormat m_ResultFormat{EResultFormat::Text};
+        ResultCacheKey m_CacheKey{};  // empty key unless the result may be served from / stored into the cache
+        std::promise<std::shared_ptr<const QueryResult>> m_Promise{};
+        std::future<std::shared_ptr<const QueryResult>> m_Future{};
+
+        std::chrono::steady_clock::time_point m_SubmitTime{};
+        std::atomic<int64_t> m_StartTimeNs{0};
+        std::atomic<int64_t> m_EndTimeNs{0};
+
+        QueryPhaseTimes m_PhaseTimes{};  // worker only
+        std::atomic<std::size_t> m_RowsReceived{0};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bCancelRequested{false};
+
+        // Both guarded by DatabaseConnection::m_QueueMutex.
+        std::shared_ptr<DatabaseSession> m_Session{nullptr};  // dropped once the worker picks the task up
+        pg_cancel* m_CancelHandle{nullptr};                    // set while the task runs on a connection
     };
 
+    using QueryHandle = std::shared_ptr<QueryTask>;
+
+    // Pins one pooled connection so session state (cursors WITH HOLD, SET, temp tables) survives between tasks.
+    // Tasks submitted with the same session run one at a time in submission order, the connection goes back
+    // to the pool (and gets its state discarded) once the last reference is gone.
+    struct DatabaseSession final
+    {
+      private:
+        friend struct DatabaseConnection;
+
+        PooledConnection m_Connection{};  // checked out by the worker running the first task
+        bool m_bBusy{false};              // guarded by DatabaseConnection::m_QueueMutex
+    };
+
+    using SessionHandle = std::shared_ptr<DatabaseSession>;
+
+    struct ResultCursor;
+
     struct DatabaseConnection final
     {
-        DatabaseConnection(const DatabaseDesc& databaseDesc) noexcept;
+        // A non-zero cacheDesc.MemoryBudget answers repeated read-only tasks from a ResultCache, see there for what qualifies.
+        DatabaseConnection(const DatabaseDesc& databaseDesc, const ConnectionPoolDesc& poolDesc = {},
+                           const ResultCacheDesc& cacheDesc = {}) noexcept;
         ~DatabaseConnection() noexcept;
 
+        // Opens the pool's minimum connections, false if the server can't be reached at all.
         bool TryConnectIfNotConnected() noexcept;
 
-        std::optional<QueryResult> Execute(const std::string& query) noexcept;
+        // Blocks the calling thread until the whole result is materialized.
+        std::optional<QueryResult> Execute(const std::string& query, EResultFormat resultFormat = EResultFormat::Text) noexcept;
+
+        // Queues the query for the worker threads, returned handle can be polled every frame.
+        // Without a session it runs on whichever pooled connection is free, so independent queries run in parallel.
+        QueryHandle ExecuteAsync(const std::string& query, const SessionHandle& session = nullptr,
+                                 EResultFormat resultFormat = EResultFormat::Text) noexcept;
+
+        // Same, but runs the statements in order on the same connection and stops at the first failure.
+        // Result of the last statement is returned, useful for session state like MOVE + FETCH on a cursor.
+        QueryHandle ExecuteAsync(std::vector<std::string> statements, const SessionHandle& session = nullptr,
+                                 EResultFormat resultFormat = EResultFormat::Text) noexcept;
+
+        // Runs the statements as named prepared statements, cached per connection by SQL text, so repeated runs skip
+        // parse and plan. Rows of every statement are concatenated into one result, they're expected to share a shape.
+        QueryHandle ExecutePreparedAsync(std::vector<QueryStatement> statements, const SessionHandle& session = nullptr,
+                                         EResultFormat resultFormat = EResultFormat::Binary) noexcept;
+
+        // Sends every batch in one libpq pipeline and only then reads the results back, so the whole set costs about one
+        // network round trip. A batch behaves like an ExecutePreparedAsync() task of its own: rows concatenated, stops at its
+        // first failure, other batches unaffected. Results come from QueryTask::TakeBatchResults().
+        QueryHandle ExecutePipelinedAsync(std::vector<std::vector<QueryStatement>> batches, const SessionHandle& session = nullptr,
+                                          EResultFormat resultFormat = EResultFormat::Binary) noexcept;
+
+        SessionHandle OpenSession() const noexcept { return std::make_shared<DatabaseSession>(); }
+
+        // Raw checkout for work that doesn't fit a query task (COPY), blocks like the workers do.
+        PooledConnection AcquireConnection() noexcept { return m_Pool.Acquire(); }
+
+        // Server-side paged cursor over the query, see ResultCursor. Must not outlive the connection.
+        std::unique_ptr<ResultCursor> OpenCursor(const std::string& query) noexcept;
+
+        // Pending tasks are dropped by the worker, the running one gets a PostgreSQL cancel request.
+        void Cancel(const QueryHandle& task) noexcept;
+
+        ConnectionPool::Stats GetPoolStats() const noexcept { return m_Pool.GetStats(); }
+
+        // nullopt when the cache is disabled.
+        std::optional<ResultCache::Stats> GetResultCacheStats() const noexcept;
+
+        // Timings of every task run through the workers, see QueryStats.
+        QueryStats& GetQueryStats() noexcept { return m_QueryStats; }
+        const QueryStats& GetQueryStats() const noexcept { return m_QueryStats; }
 
       private:
-        DatabaseDesc m_Desc{};
-        std::unique_ptr<dmitigr::pgfe::Connection> m_Connection{nullptr};
+        ConnectionPool m_Pool;
+        std::unique_ptr<ResultCache> m_ResultCache{nullptr};
+        QueryStats m_QueryStats{};
+
+        std::vector<std::thread> m_Workers{};  // one per pooled connection
+        std::mutex m_QueueMutex{};
+        std::condition_variable m_QueueCV{};
+        std::deque<QueryHandle> m_PendingTasks{};
+        std::vector<QueryHandle> m_RunningTasks{};
+        bool m_bStopWorkers{false};
+
+        // Appends the rows to queryResult, false (and the error in the task) on failure.
+        bool ExecuteOnConnection(PooledConnection& connection, const QueryStatement& statement, bool bPrepared, EResultFormat resultFormat,
+                                 QueryTask* task, QueryResult& queryResult) noexcept;
+
+        // Runs task.m_BatchEnds as one pipeline into task.m_BatchResults, false if the pipeline itself broke.
+        bool ExecutePipelineOnConnection(PooledConnection& connection, QueryTask& task) noexcept;
+        QueryHandle EnqueueTask(QueryHandle task, const SessionHandle& session) noexcept;
+
+        // First queued task whose session (if any) is not busy, so per-session order is kept.
+        std::deque<QueryHandle>::iterator FindRunnableTaskUnlocked() noexcept;
+        void WorkerLoop() noexcept;
+
+        // Phase times of a task that ran, with its result and batch results still in place.
+        void RecordQueryStats(const QueryTask& task, EQueryStatus status, const std::shared_ptr<const QueryResult>& result,
+                              int64_t endTimeNs, uint64_t allocationCount) noexcept;
     };
 
 }  // namespace nsudb
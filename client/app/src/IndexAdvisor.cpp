@@ -0,0 +1,205 @@
+#include "IndexAdvisor.hpp"
+#include <Logger.hpp>
+
+#include <regex>
+
+namespace nsudb
+{
+
+    // One row per Seq Scan node (or a single row with NULL relation when there is none), plan totals repeated on every row.
+    // Join columns are the relation's foreign keys that no index starts with and that the plan mentions as alias.column,
+    // which only happens in join conditions (Hash Cond, Merge Cond, Join Filter) for a non-VERBOSE plan.
+    // A partition (13-monthly-partitions.sql) is reported as its partitioned table, an index created there covers every month.
+    static constexpr const char* s_AdvisorQuery = R"(SELECT (doc->0->>'Execution Time')::float8 AS execution_ms,
+       COALESCE((doc->0->'Plan'->>'Shared Hit Blocks')::int8, 0) AS shared_hit_blocks,
+       COALESCE((doc->0->'Plan'->>'Shared Read Blocks')::int8, 0) AS shared_read_blocks,
+       COALESCE(pg_partition_root(to_regclass(node->>'Relation Name')), to_regclass(node->>'Relation Name'))::text AS relation,
+       COALESCE(node->>'Alias', '') AS alias,
+       ((node->>'Actual Rows')::float8 * (node->>'Actual Loops')::float8)::int8 AS rows_returned,
+       (COALESCE((node->>'Rows Removed by Filter')::float8, 0) * (node->>'Actual Loops')::float8)::int8 AS rows_removed,
+       COALESCE(node->>'Filter', '') AS filter,
+       (node->>'Actual Total Time')::float8 * (node->>'Actual Loops')::float8 AS scan_ms,
+       COALESCE((
+           SELECT string_agg(a.attname, ',' ORDER BY a.attnum)
+           FROM pg_constraint con
+           JOIN pg_attribute a ON a.attrelid = con.conrelid AND a.attnum = con.conkey[1]
+           WHERE con.conrelid = to_regclass(node->>'Relation Name')
+             AND con.contype = 'f'
+             AND NOT EXISTS (SELECT 1 FROM pg_index i WHERE i.indrelid = con.conrelid AND i.indkey[0] = con.conkey[1])
+             AND strpos(doc::text, (node->>'Alias') || '.' || a.attname) > 0
+       ), '') AS join_columns
+FROM explain_analyze_json($1) AS doc
+LEFT JOIN LATERAL jsonb_path_query(doc, 'strict $.**? (@."Node Type" == "Seq Scan")') AS node ON TRUE)";
+
+    enum EAdvisorColumn : std::size_t
+    {
+        ExecutionMs = 0,
+        SharedHitBlocks,
+        SharedReadBlocks,
+        Relation,
+        Alias,
+        RowsReturned,
+        RowsRemoved,
+        Filter,
+        ScanMs,
+        JoinColumns
+    };
+
+    // Filter columns as "(column op" or "((column)::type op", the shapes EXPLAIN prints for a single table scan.
+    // Equality (including = ANY) goes first in an index, one range column after them, LIKE and <> don't get an index.
+    static void ParseFilterColumns(const std::string& filter, std::vector<std::string>& equalityColumns,
+                                   std::vector<std::string>& rangeColumns) noexcept
+    {
+        static const std::regex s_ConditionRegex(R"(\(\(?([A-Za-z_][A-Za-z0-9_]*)\)?(?:::[a-z ]+?)? (=|<=|>=|<|>) )");
+
+        const auto addUnique = [](std::vector<std::string>& columns, std::string column)
+        {
+            if (std::find(columns.begin(), columns.end(), column) == columns.end()) columns.emplace_back(std::move(column));
+        };
+
+        for (auto it = std::sregex_iterator(filter.begin(), filter.end(), s_ConditionRegex); it != std::sregex_iterator(); ++it)
+        {
+            if ((*it)[2] == "=")
+                addUnique(equalityColumns, (*it)[1]);
+            else
+                addUnique(rangeColumns, (*it)[1]);
+        }
+
+        // A column compared for equality somewhere doesn't need to be a range key as well.
+        std::erase_if(rangeColumns, [&](const std::string& column)
+                      { return std::find(equalityColumns.begin(), equalityColumns.end(), column) != equalityColumns.end(); });
+    }
+
+    static std::string BuildCreateIndex(const std::string& relation, const std::vector<std::string>& columns) noexcept
+    {
+        std::string indexName = "idx_" + relation, columnList{};
+        for (const auto& column : columns)
+        {
+            indexName += "_" + column;
+            columnList += (columnList.empty() ? "" : ", ") + column;
+        }
+        if (indexName.size() > 63) indexName.resize(63);  // NAMEDATALEN - 1, the server would truncate it anyway
+
+        return "CREATE INDEX IF NOT EXISTS " + indexName + " ON " + relation + " (" + columnList + ");";
+    }
+
+    IndexAdvisor::IndexAdvisor(DatabaseConnection& connection, const std::vector<ReportQuery>& reports, IndexAdvisorDesc desc) noexcept
+        : m_Connection(connection), m_Desc(desc)
+    {
+        const SessionHandle session = m_Connection.OpenSession();
+
+        m_Reports.reserve(reports.size());
+        for (const auto& report : reports)
+        {
+            m_Reports.emplace_back().Title = report.Title;
+
+            for (std::string sql : BuildReportSqlStatements(report))
+            {
+                // EXPLAIN takes exactly one statement, the reports end theirs with a semicolon.
+                while (!sql.empty() && (std::isspace(static_cast<unsigned char>(sql.back())) || sql.back() == ';'))
+                    sql.pop_back();
+
+                QueryStatement statement{.Sql = s_AdvisorQuery, .Params = {std::move(sql)}};
+                m_Tasks.emplace_back(m_Reports.size() - 1, m_Connection.ExecutePreparedAsync({std::move(statement)}, session));
+            }
+        }
+    }
+
+    IndexAdvisor::~IndexAdvisor() noexcept
+    {
+        for (const auto& statementTask : m_Tasks)
+            if (!statementTask.bCollected) m_Connection.Cancel(statementTask.Task);
+    }
+
+    void IndexAdvisor::Poll() noexcept
+    {
+        for (auto& statementTask : m_Tasks)
+        {
+            if (statementTask.bCollected || !statementTask.Task->IsFinished()) continue;
+
+            statementTask.bCollected = true;
+            ++m_CompletedCount;
+
+            ReportPlanAnalysis& report = m_Reports[statementTask.ReportIndex];
+            const EQueryStatus status  = statementTask.Task->GetStatus();
+            if (status != EQueryStatus::Done)
+            {
+                // First failure wins, the report's remaining statements still get analyzed.
+                if (report.Status != EQueryStatus::Failed && report.Status != EQueryStatus::Cancelled)
+                {
+                    report.Status = status;
+                    report.Error  = statementTask.Task->GetError();
+                    LOG_WARN("Index advisor: '{}' failed: {}", report.Title, report.Error);
+                }
+                continue;
+            }
+
+            if (const auto result = statementTask.Task->TakeResult(); result) CollectResult(report, *result);
+            if (report.Status == EQueryStatus::Pending) report.Status = EQueryStatus::Running;
+        }
+
+        // Reports are complete once all of their statements are.
+        for (std::size_t reportIndex{}; reportIndex < m_Reports.size(); ++reportIndex)
+        {
+            ReportPlanAnalysis& report = m_Reports[reportIndex];
+            if (report.Status != EQueryStatus::Running) continue;
+
+            const bool bAllCollected = std::all_of(m_Tasks.begin(), m_Tasks.end(), [&](const StatementTask& statementTask)
+                                                   { return statementTask.ReportIndex != reportIndex || statementTask.bCollected; });
+            if (bAllCollected) report.Status = EQueryStatus::Done;
+        }
+    }
+
+    void IndexAdvisor::CollectResult(ReportPlanAnalysis& report, const QueryResult& result) noexcept
+    {
+        if (result.GetRowCount() == 0 || result.GetColumnCount() <= JoinColumns) return;
+
+        report.ExecutionMilliseconds += result.GetFloat64(0, ExecutionMs);
+        report.SharedHitBlocks += result.GetInt64(0, SharedHitBlocks);
+        report.SharedReadBlocks += result.GetInt64(0, SharedReadBlocks);
+
+        for (std::size_t row{}; row < result.GetRowCount(); ++row)
+        {
+            if (result.IsNull(row, Relation)) continue;
+
+            SeqScanFinding& scan = report.SeqScans.emplace_back();
+            scan.Relation         = result.GetValue(row, Relation);
+            scan.Alias            = result.GetValue(row, Alias);
+            scan.Filter           = result.GetValue(row, Filter);
+            scan.RowsReturned     = result.GetInt64(row, RowsReturned);
+            scan.RowsRemoved      = result.GetInt64(row, RowsRemoved);
+            scan.ScanMilliseconds = result.GetFloat64(row, ScanMs);
+            scan.bFlagged         = scan.RowsReturned + scan.RowsRemoved >= m_Desc.MinScannedRows;
+            if (!scan.bFlagged) continue;
+
+            std::vector<std::string> equalityColumns{}, rangeColumns{};
+            ParseFilterColumns(scan.Filter, equalityColumns, rangeColumns);
+            if (!rangeColumns.empty()) equalityColumns.emplace_back(rangeColumns.front());
+            if (!equalityColumns.empty()) scan.SuggestedIndexes.emplace_back(BuildCreateIndex(scan.Relation, equalityColumns));
+
+            for (const auto joinColumn : std::views::split(std::string_view(result.GetValue(row, JoinColumns)), ','))
+            {
+                const std::string column(joinColumn.begin(), joinColumn.end());
+                if (!column.empty()) scan.SuggestedIndexes.emplace_back(BuildCreateIndex(scan.Relation, {column}));
+            }
+        }
+    }
+
+    std::string IndexAdvisor::BuildSuggestionScript() const noexcept
+    {
+        std::vector<std::string_view> statements{};
+        std::string script{};
+        for (const auto& report : m_Reports)
+            for (const auto& scan : report.SeqScans)
+                for (const auto& statement : scan.SuggestedIndexes)
+                {
+                    if (std::find(statements.begin(), statements.end(), statement) != statements.end()) continue;
+
+                    statements.emplace_back(statement);
+                    script += statement + "\n";
+                }
+
+        return script;
+    }
+
+}  // namespace nsudb
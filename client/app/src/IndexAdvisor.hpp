@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Database.hpp>
+#include <ReportQueries.hpp>
+
+namespace nsudb
+{
+
+    struct IndexAdvisorDesc final
+    {
+        static constexpr int64_t s_DefaultMinScannedRows = 10'000;
+
+        // Seq scans reading fewer rows (returned + removed by filter, over all loops) aren't worth an index.
+        int64_t MinScannedRows{s_DefaultMinScannedRows};
+    };
+
+    // One sequential scan node of a report's plan.
+    struct SeqScanFinding final
+    {
+        std::string Relation{};
+        std::string Alias{};
+        std::string Filter{};  // as EXPLAIN prints it, empty when the scan feeds a join unfiltered
+        int64_t RowsReturned{0};
+        int64_t RowsRemoved{0};
+        double ScanMilliseconds{0.0};
+        bool bFlagged{false};                       // read at least IndexAdvisorDesc::MinScannedRows
+        std::vector<std::string> SuggestedIndexes{};  // CREATE INDEX statements, only for flagged scans
+    };
+
+    struct ReportPlanAnalysis final
+    {
+        std::string Title{};
+        EQueryStatus Status{EQueryStatus::Pending};
+        std::string Error{};
+
+        // Summed over the report's statements.
+        double ExecutionMilliseconds{0.0};
+        int64_t SharedHitBlocks{0};
+        int64_t SharedReadBlocks{0};
+        std::vector<SeqScanFinding> SeqScans{};
+    };
+
+    // Runs every report statement under EXPLAIN (ANALYZE, BUFFERS) through explain_analyze_json() (10-report-indexes.sql),
+    // picks the Seq Scan nodes out of the JSON plan on the server and proposes indexes: the filter's equality columns
+    // followed by its first range column, and the scanned relation's foreign keys that the plan joins on but no index
+    // starts with. Statements run one after another on one session so their timings don't disturb each other.
+    struct IndexAdvisor final
+    {
+        IndexAdvisor(DatabaseConnection& connection, const std::vector<ReportQuery>& reports, IndexAdvisorDesc desc = {}) noexcept;
+        ~IndexAdvisor() noexcept;  // cancels whatever still runs
+
+        IndexAdvisor(const IndexAdvisor&)            = delete;
+        IndexAdvisor& operator=(const IndexAdvisor&) = delete;
+
+        // Collects finished statements, call every frame (or in a loop when headless).
+        void Poll() noexcept;
+
+        bool IsFinished() const noexcept { return m_CompletedCount == m_Tasks.size(); }
+        std::size_t GetCompletedCount() const noexcept { return m_CompletedCount; }
+        std::size_t GetStatementCount() const noexcept { return m_Tasks.size(); }
+        float GetProgress() const noexcept { return m_Tasks.empty() ? 1.0f : static_cast<float>(m_CompletedCount) / m_Tasks.size(); }
+
+        const std::vector<ReportPlanAnalysis>& GetReports() const noexcept { return m_Reports; }
+
+        // Every distinct suggestion so far, in report order, ready to paste into the SQL editor.
+        std::string BuildSuggestionScript() const noexcept;
+
+      private:
+        struct StatementTask final
+        {
+            std::size_t ReportIndex{0};
+            QueryHandle Task{nullptr};
+            bool bCollected{false};
+        };
+
+        DatabaseConnection& m_Connection;
+        IndexAdvisorDesc m_Desc{};
+        std::vector<ReportPlanAnalysis> m_Reports{};
+        std::vector<StatementTask> m_Tasks{};
+        std::size_t m_CompletedCount{0};
+
+        void CollectResult(ReportPlanAnalysis& report, const QueryResult& result) noexcept;
+    };
+
+}  // namespace nsudb
@@ -0,0 +1,93 @@
+#include "InventoryCompactor.hpp"
+#include <Logger.hpp>
+
+namespace nsudb
+{
+
+    InventoryCompactor::InventoryCompactor(DatabaseConnection& connection, InventoryCompactorDesc desc) noexcept
+        : m_Connection(connection), m_Desc(desc), m_StartTime(std::chrono::steady_clock::now())
+    {
+        m_Desc.BatchSize = std::clamp(m_Desc.BatchSize, 1, 1'000'000);
+        m_Thread         = std::thread(&InventoryCompactor::Run, this);
+    }
+
+    InventoryCompactor::~InventoryCompactor() noexcept
+    {
+        Stop();
+        if (m_Thread.joinable()) m_Thread.join();
+    }
+
+    float InventoryCompactor::GetElapsedSeconds() const noexcept
+    {
+        int64_t elapsedNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (elapsedNs == 0)
+            elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        return static_cast<float>(static_cast<double>(elapsedNs) * 1e-9);
+    }
+
+    float InventoryCompactor::GetMovementsPerSecond() const noexcept
+    {
+        return static_cast<float>(static_cast<double>(GetMovementsFolded()) / std::max(GetElapsedSeconds(), 0.001f));
+    }
+
+    void InventoryCompactor::Stop() noexcept
+    {
+        {
+            std::scoped_lock lock(m_StopMutex);
+            m_bStopRequested = true;
+        }
+        m_StopCV.notify_all();
+    }
+
+    bool InventoryCompactor::IsStopRequested() noexcept
+    {
+        std::scoped_lock lock(m_StopMutex);
+        return m_bStopRequested;
+    }
+
+    void InventoryCompactor::Run() noexcept
+    {
+        m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+        const std::string batchQuery = "SELECT compact_inventory_movements(" + std::to_string(m_Desc.BatchSize) + ")::bigint";
+
+        bool bSucceeded = true;
+        while (!IsStopRequested())
+        {
+            const auto result = m_Connection.Execute(batchQuery, EResultFormat::Binary);
+            if (!result || result->GetRowCount() == 0)
+            {
+                bSucceeded = false;
+                break;
+            }
+
+            const int64_t movementCount = result->GetInt64(0, 0);
+            if (movementCount > 0)
+            {
+                m_bIdle.store(false, std::memory_order_relaxed);
+                m_MovementsFolded.fetch_add(static_cast<uint64_t>(movementCount), std::memory_order_relaxed);
+                m_BatchCount.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            m_bIdle.store(true, std::memory_order_relaxed);
+            if (m_Desc.bStopWhenEmpty) break;
+
+            std::unique_lock lock(m_StopMutex);
+            m_StopCV.wait_for(lock, m_Desc.IdleInterval, [&] { return m_bStopRequested; });
+        }
+
+        // Execute() already logged the server's message.
+        if (!bSucceeded) m_Error = "Compaction batch failed, see the log for details.";
+
+        const EQueryStatus status = !bSucceeded ? EQueryStatus::Failed : IsStopRequested() ? EQueryStatus::Cancelled : EQueryStatus::Done;
+        LOG_TRACE("Inventory compaction: {} movements in {} batches, {:.2f} s", GetMovementsFolded(), GetBatchCount(), GetElapsedSeconds());
+
+        m_EndTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count(),
+                          std::memory_order_release);
+        m_Status.store(status, std::memory_order_release);
+        m_bFinished.store(true, std::memory_order_release);
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    struct InventoryCompactorDesc final
+    {
+        static constexpr int32_t s_DefaultBatchSize = 10'000;
+
+        int32_t BatchSize{s_DefaultBatchSize};                            // movements per compact_inventory_movements() call
+        std::chrono::milliseconds IdleInterval{std::chrono::seconds(5)};  // ledger polling period once it's empty
+        bool bStopWhenEmpty{false};  // one-shot fold instead of following the ledger
+    };
+
+    // Folds inventory_movements into storage_items (14-inventory-ledger.sql) in batches, every batch is one
+    // compact_inventory_movements() call and its own transaction, so the storage_items rows it touched are released before
+    // the next one. Runs on its own thread over the pool, everything here is safe to poll every frame.
+    struct InventoryCompactor final
+    {
+        InventoryCompactor(DatabaseConnection& connection, InventoryCompactorDesc desc = {}) noexcept;
+        ~InventoryCompactor() noexcept;  // stops after the running batch
+
+        InventoryCompactor(const InventoryCompactor&)            = delete;
+        InventoryCompactor& operator=(const InventoryCompactor&) = delete;
+
+        bool IsFinished() const noexcept { return m_bFinished.load(std::memory_order_acquire); }
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Guarded by IsFinished(), the worker thread doesn't touch it after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+
+        // Ledger is empty and the compactor waits for new movements.
+        bool IsIdle() const noexcept { return m_bIdle.load(std::memory_order_relaxed); }
+
+        uint64_t GetMovementsFolded() const noexcept { return m_MovementsFolded.load(std::memory_order_relaxed); }
+        uint64_t GetBatchCount() const noexcept { return m_BatchCount.load(std::memory_order_relaxed); }
+        float GetElapsedSeconds() const noexcept;
+        float GetMovementsPerSecond() const noexcept;
+
+        void Stop() noexcept;
+
+      private:
+        DatabaseConnection& m_Connection;
+        InventoryCompactorDesc m_Desc{};
+        std::string m_Error{};
+
+        std::chrono::steady_clock::time_point m_StartTime{};
+        std::atomic<int64_t> m_EndTimeNs{0};  // since m_StartTime
+        std::atomic<uint64_t> m_MovementsFolded{0};
+        std::atomic<uint64_t> m_BatchCount{0};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bIdle{false};
+        std::atomic_bool m_bFinished{false};
+
+        std::mutex m_StopMutex{};
+        std::condition_variable m_StopCV{};
+        bool m_bStopRequested{false};  // guarded by m_StopMutex
+
+        std::thread m_Thread{};
+
+        void Run() noexcept;
+        bool IsStopRequested() noexcept;
+    };
+
+}  // namespace nsudb
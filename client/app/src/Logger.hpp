@@ -4,11 +4,38 @@
 #include <string>  // Required for std::string
 
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>  // For console output with colors
-#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
 
 namespace nsudb
 {
+    // What a log call does when the async queue is full.
+    enum class ELogOverflowPolicy : uint8_t
+    {
+        Block = 0,      // waits for the logging thread, nothing is lost
+        OverrunOldest,  // replaces the oldest queued message, the caller never waits
+        DiscardNew      // drops the new message, the caller never waits
+    };
+
+    struct LoggerDesc final
+    {
+        static constexpr std::size_t s_DefaultQueueSize      = 8192;
+        static constexpr std::size_t s_DefaultMaxQueryLength = 512;
+
+        // Log calls only format and enqueue, sinks are written by spdlog's thread pool.
+        bool bAsync{true};
+        std::size_t QueueSize{s_DefaultQueueSize};  // messages, preallocated
+        // Block by default: the other policies drop whatever is queued or arriving, errors included.
+        ELogOverflowPolicy OverflowPolicy{ELogOverflowPolicy::Block};
+
+        std::size_t MaxFileSize{16ull << 20};  // logs/nsudb_app.log rotates into .1, .2, ... past this
+        std::size_t MaxFiles{3};               // previous runs are rotated out on start as well
+
+        uint32_t QuerySampleRate{1};                         // LOG_QUERY logs every Nth call, 0 none
+        std::size_t MaxQueryLength{s_DefaultMaxQueryLength};  // longer SQL is cut, 0 never cuts
+    };
+
     struct Logger final
     {
         Logger(const Logger&)            = delete;
@@ -17,7 +44,7 @@ namespace nsudb
         Logger(Logger&&)            = delete;
         Logger& operator=(Logger&&) = delete;
 
-        static void Init() noexcept
+        static void Init(const LoggerDesc& desc = {}) noexcept
         {
             if (s_bIsInitialized) return;
 
@@ -26,18 +53,31 @@ namespace nsudb
             console_sink->set_level(spdlog::level::trace);                     // Console shows all messages from trace up
             console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] %^[%l]%$: %v");  // Pattern with color
 
-            auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/nsudb_app.log", true);  // Single log file
+            auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>("logs/nsudb_app.log", desc.MaxFileSize, desc.MaxFiles,
+                                                                                    true);  // Rotate on open, every run starts a file
             file_sink->set_level(spdlog::level::trace);                 // File logs all messages from trace up
             file_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l]: %v");  // Pattern without color codes
 
-            // Create the main spdlog logger with both sinks
-            // If using async, replace spdlog::logger with spdlog::async_logger
-            m_SpdLogger = std::make_shared<spdlog::logger>("nsudb_main_logger", spdlog::sinks_init_list({console_sink, file_sink}));
+            // Create the main spdlog logger with both sinks, async ones share spdlog's global thread pool
+            const std::vector<spdlog::sink_ptr> sinks{console_sink, file_sink};
+            if (desc.bAsync)
+            {
+                spdlog::init_thread_pool(desc.QueueSize, 1);  // One thread keeps the messages in order
+                m_SpdLogger = std::make_shared<spdlog::async_logger>("nsudb_main_logger", sinks.begin(), sinks.end(), spdlog::thread_pool(),
+                                                                     GetSpdOverflowPolicy(desc.OverflowPolicy));
+            }
+            else
+                m_SpdLogger = std::make_shared<spdlog::logger>("nsudb_main_logger", sinks.begin(), sinks.end());
 
             // Set the overall log level for this logger instance
             m_SpdLogger->set_level(spdlog::level::trace);  // Default to most verbose
             m_SpdLogger->flush_on(spdlog::level::err);     // Flush immediately on error messages
 
+            // Everything else reaches the file within a second
+            spdlog::flush_every(std::chrono::seconds(1));
+
+            SetQuerySampling(desc.QuerySampleRate, desc.MaxQueryLength);
+
             // Register the logger globally with spdlog (optional, but useful)
             spdlog::register_logger(m_SpdLogger);
 
@@ -53,9 +93,10 @@ namespace nsudb
             if (!s_bIsInitialized) return;
 
             // Unregister and drop the logger
+            m_SpdLogger->flush();
             spdlog::drop("nsudb_main_logger");
 
-            // Shutdown spdlog's thread pool if async logging was enabled
+            // Shutdown spdlog's thread pool if async logging was enabled, queued messages are written first
             spdlog::shutdown();
             s_bIsInitialized = false;
             m_SpdLogger.reset();  // Release the shared_ptr
@@ -67,16 +108,66 @@ namespace nsudb
             return m_SpdLogger;
         }
 
+        // Can change while logging, e.g. from the settings window.
+        static void SetQuerySampling(uint32_t sampleRate, std::size_t maxQueryLength) noexcept
+        {
+            s_QuerySampleRate.store(sampleRate, std::memory_order_relaxed);
+            s_MaxQueryLength.store(maxQueryLength, std::memory_order_relaxed);
+        }
+
+        static uint32_t GetQuerySampleRate() noexcept { return s_QuerySampleRate.load(std::memory_order_relaxed); }
+        static std::size_t GetMaxQueryLength() noexcept { return s_MaxQueryLength.load(std::memory_order_relaxed); }
+
+        // Trace line for a statement about to run. Skipped calls cost a level check and an atomic increment,
+        // logged ones format at most MaxQueryLength bytes of SQL.
+        static void LogQuery(std::string_view database, std::string_view sql) noexcept
+        {
+            if (!m_SpdLogger->should_log(spdlog::level::trace)) return;
+
+            const uint32_t sampleRate = s_QuerySampleRate.load(std::memory_order_relaxed);
+            if (sampleRate == 0 || s_QueryCounter.fetch_add(1, std::memory_order_relaxed) % sampleRate != 0) return;
+
+            const std::size_t maxQueryLength = s_MaxQueryLength.load(std::memory_order_relaxed);
+            if (maxQueryLength == 0 || sql.size() <= maxQueryLength)
+            {
+                m_SpdLogger->trace("Database: {}, executing query: {}", database, sql);
+                return;
+            }
+
+            // Don't cut a UTF-8 sequence in half.
+            std::size_t cutLength = maxQueryLength;
+            while (cutLength > 0 && (static_cast<unsigned char>(sql[cutLength]) & 0xC0) == 0x80)
+                --cutLength;
+            m_SpdLogger->trace("Database: {}, executing query: {}... ({} bytes)", database, sql.substr(0, cutLength), sql.size());
+        }
+
       private:
         Logger() noexcept  = default;
         ~Logger() noexcept = default;
 
+        static spdlog::async_overflow_policy GetSpdOverflowPolicy(ELogOverflowPolicy overflowPolicy) noexcept
+        {
+            switch (overflowPolicy)
+            {
+                case ELogOverflowPolicy::Block: return spdlog::async_overflow_policy::block;
+                case ELogOverflowPolicy::OverrunOldest: return spdlog::async_overflow_policy::overrun_oldest;
+                case ELogOverflowPolicy::DiscardNew: return spdlog::async_overflow_policy::discard_new;
+            }
+
+            return spdlog::async_overflow_policy::block;
+        }
+
         static inline std::atomic_bool s_bIsInitialized{false};
         static inline std::shared_ptr<spdlog::logger> m_SpdLogger{nullptr};
+
+        static inline std::atomic<uint32_t> s_QuerySampleRate{1};
+        static inline std::atomic<std::size_t> s_MaxQueryLength{LoggerDesc::s_DefaultMaxQueryLength};
+        static inline std::atomic<uint64_t> s_QueryCounter{0};
     };
 
 #define LOG_ERROR(msg, ...) Logger::GetLogger()->error(msg, ##__VA_ARGS__)
 #define LOG_WARN(msg, ...) Logger::GetLogger()->warn(msg, ##__VA_ARGS__)
 #define LOG_TRACE(msg, ...) Logger::GetLogger()->trace(msg, ##__VA_ARGS__)
+#define LOG_QUERY(database, sql) Logger::LogQuery(database, sql)
 
 }  // namespace nsudb
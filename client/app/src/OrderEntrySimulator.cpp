@@ -0,0 +1,512 @@
+#include "OrderEntrySimulator.hpp"
+#include <Logger.hpp>
+
+#include <pgfe/pgfe.hpp>
+#include <libpq-fe.h>
+
+namespace nsudb
+{
+
+    // Set on the terminals' sessions, so the wait sampling sees only them. The pool resets it with the rest of the session.
+    static constexpr const char* s_ApplicationName = "order_entry_simulator";
+
+    static constexpr std::string_view s_DeadlockSqlState      = "40P01";
+    static constexpr std::string_view s_SerializationSqlState = "40001";
+
+    // The statements of one order, prepared once per terminal. Children get the accept time the same way the order does:
+    // LOCALTIMESTAMP stays put for the whole transaction, so every row lands in the order's partition.
+    struct OrderEntryStatement final
+    {
+        const char* Name{nullptr};
+        const char* Sql{nullptr};
+        int32_t ParamCount{0};
+    };
+
+    static constexpr std::array<OrderEntryStatement, 4> s_OrderEntryStatements = {{
+        {"order_entry_order",
+         "INSERT INTO orders (accept_time, overall_price, is_urgent, outlet_id, client_id) "
+         "VALUES (LOCALTIMESTAMP, 0, $1, $2, $3) RETURNING id",
+         3},
+        {"order_entry_service_orders",
+         "INSERT INTO service_orders (count, order_id, order_accept_time, service_type_id) "
+         "SELECT s.count, $1, LOCALTIMESTAMP, s.service_type_id FROM unnest($2::int[], $3::int[]) AS s(count, service_type_id)",
+         3},
+        {"order_entry_print_order",
+         "INSERT INTO print_orders (order_id, order_accept_time, print_discount_id) VALUES ($1, LOCALTIMESTAMP, $2) RETURNING id", 2},
+        {"order_entry_frames",
+         "INSERT INTO frames (amount, frame_number, print_order_id, order_accept_time, print_price_id) "
+         "SELECT f.amount, f.number, $1, LOCALTIMESTAMP, f.print_price_id "
+         "FROM unnest($2::int[], $3::int[]) WITH ORDINALITY AS f(amount, print_price_id, number)",
+         3},
+    }};
+
+    static constexpr std::array<const char*, 3> s_BeginStatements = {
+        "BEGIN ISOLATION LEVEL READ COMMITTED", "BEGIN ISOLATION LEVEL REPEATABLE READ", "BEGIN ISOLATION LEVEL SERIALIZABLE"};
+
+    struct OrderEntrySimulator::Catalogue final
+    {
+        // Only outlets with a storage, the storage triggers reject service orders anywhere else.
+        std::vector<int64_t> BranchIds{};
+        std::vector<int64_t> KioskIds{};
+        std::vector<int64_t> BranchServiceTypeIds{};
+        std::vector<int64_t> KioskServiceTypeIds{};
+        std::vector<int64_t> ClientIds{};
+        std::vector<int64_t> PrintDiscountIds{};
+        std::vector<int64_t> PrintPriceIds{};
+    };
+
+    struct OrderEntrySimulator::TerminalResult final
+    {
+        uint64_t Committed{0};
+        uint64_t Deadlocks{0};
+        uint64_t SerializationFailures{0};
+        uint64_t OtherErrors{0};
+        uint64_t Retries{0};
+        uint64_t Abandoned{0};
+        std::string FirstError{};
+
+        std::vector<double> LatenciesMs{};
+        std::array<double, EOrderEntryStep::Count> StepTotalMs{};
+        std::array<uint64_t, EOrderEntryStep::Count> StepCounts{};
+    };
+
+    // What went wrong in a transaction, the SQLSTATE decides whether it's worth another attempt.
+    struct TransactionError final
+    {
+        std::string SqlState{};
+        std::string Message{};
+    };
+
+    static std::string TrimErrorMessage(const char* message) noexcept
+    {
+        std::string error = message ? message : "";
+        while (!error.empty() && (error.back() == '\n' || error.back() == '\r'))
+            error.pop_back();
+
+        return error;
+    }
+
+    static bool CheckResult(PGconn* conn, PGresult* result, TransactionError& error) noexcept
+    {
+        const ExecStatusType status = PQresultStatus(result);
+        if (status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK) return true;
+
+        const char* sqlState = result ? PQresultErrorField(result, PG_DIAG_SQLSTATE) : nullptr;
+        error.SqlState       = sqlState ? sqlState : "";
+        error.Message        = result ? TrimErrorMessage(PQresultErrorMessage(result)) : TrimErrorMessage(PQerrorMessage(conn));
+        return false;
+    }
+
+    static bool ExecuteCommand(PGconn* conn, const char* sql, TransactionError& error) noexcept
+    {
+        PGresult* result      = PQexec(conn, sql);
+        const bool bSucceeded = CheckResult(conn, result, error);
+        PQclear(result);
+        return bSucceeded;
+    }
+
+    // Text parameters, the first column of the first row into value if there's one to return.
+    static bool ExecuteStatement(PGconn* conn, const OrderEntryStatement& statement, const std::array<const char*, 3>& params,
+                                 std::string* value, TransactionError& error) noexcept
+    {
+        PGresult* result = PQexecPrepared(conn, statement.Name, statement.ParamCount, params.data(), nullptr, nullptr, 0);
+        bool bSucceeded  = CheckResult(conn, result, error);
+        if (bSucceeded && value)
+        {
+            bSucceeded = PQntuples(result) > 0;
+            if (bSucceeded)
+                value->assign(PQgetvalue(result, 0, 0));
+            else
+                error.Message = std::string(statement.Name) + " returned no row";
+        }
+
+        PQclear(result);
+        return bSucceeded;
+    }
+
+    static void AppendArrayElement(std::string& array, int64_t value) noexcept
+    {
+        array += array.size() > 1 ? "," : "";
+        array += std::to_string(value);
+    }
+
+    template <typename T>
+    static const T& PickUniform(const std::vector<T>& values, std::mt19937_64& random) noexcept
+    {
+        return values[std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(random)];
+    }
+
+    // Nearest rank on sorted values.
+    static double GetPercentile(const std::vector<double>& sortedValues, uint32_t percentile) noexcept
+    {
+        if (sortedValues.empty()) return 0.0;
+
+        const std::size_t rank = (sortedValues.size() * percentile + 99) / 100;
+        return sortedValues[std::clamp<std::size_t>(rank, 1, sortedValues.size()) - 1];
+    }
+
+    OrderEntrySimulator::OrderEntrySimulator(DatabaseConnection& connection, OrderEntrySimulatorDesc desc) noexcept
+        : m_Connection(connection), m_Desc(desc), m_StartTime(std::chrono::steady_clock::now())
+    {
+        m_Desc.TerminalCount = std::clamp(m_Desc.TerminalCount, 1u, 1024u);
+        m_Desc.KioskShare    = std::clamp(m_Desc.KioskShare, 0.0, 1.0);
+        m_Thread             = std::thread(&OrderEntrySimulator::Run, this);
+    }
+
+    OrderEntrySimulator::~OrderEntrySimulator() noexcept
+    {
+        Stop();
+        if (m_Thread.joinable()) m_Thread.join();
+    }
+
+    float OrderEntrySimulator::GetElapsedSeconds() const noexcept
+    {
+        int64_t elapsedNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (elapsedNs == 0)
+            elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        return static_cast<float>(static_cast<double>(elapsedNs) * 1e-9);
+    }
+
+    void OrderEntrySimulator::Stop() noexcept
+    {
+        {
+            std::scoped_lock lock(m_StopMutex);
+            m_bStopRequested = true;
+        }
+        m_StopCV.notify_all();
+    }
+
+    bool OrderEntrySimulator::LoadCatalogue(Catalogue& catalogue) noexcept
+    {
+        const auto loadIds = [&](const std::string& query, std::vector<int64_t>& ids) -> bool
+        {
+            const auto result = m_Connection.Execute(query, EResultFormat::Binary);
+            if (!result) return false;
+
+            for (std::size_t row{}; row < result->GetRowCount(); ++row)
+                ids.push_back(result->GetInt64(row, 0));
+            return true;
+        };
+
+        const auto loadByOutletType = [&](const std::string& query, std::vector<int64_t>& branchIds, std::vector<int64_t>& kioskIds)
+        {
+            const auto result = m_Connection.Execute(query, EResultFormat::Binary);
+            if (!result) return false;
+
+            for (std::size_t row{}; row < result->GetRowCount(); ++row)
+                (result->GetValue(row, 1) == "branch" ? branchIds : kioskIds).push_back(result->GetInt64(row, 0));
+            return true;
+        };
+
+        // Clients are sampled by id, a list keeps that right with gaps in the sequence.
+        const bool bLoaded =
+            loadByOutletType("SELECT o.id, ot.name FROM outlets o JOIN outlet_types ot ON ot.id = o.type_id "
+                             "WHERE ot.name IN ('branch', 'kiosk') AND EXISTS (SELECT 1 FROM storages s WHERE s.outlet_id = o.id) "
+                             "ORDER BY o.id",
+                             catalogue.BranchIds, catalogue.KioskIds) &&
+            loadByOutletType("SELECT sto.service_type_id, ot.name FROM service_types_outlets sto "
+                             "JOIN outlet_types ot ON ot.id = sto.outlet_type_id WHERE ot.name IN ('branch', 'kiosk') "
+                             "ORDER BY sto.service_type_id",
+                             catalogue.BranchServiceTypeIds, catalogue.KioskServiceTypeIds) &&
+            loadIds("SELECT id FROM clients ORDER BY id LIMIT 1000000", catalogue.ClientIds) &&
+            loadIds("SELECT id FROM print_discounts ORDER BY id", catalogue.PrintDiscountIds) &&
+            loadIds("SELECT id FROM print_prices ORDER BY id", catalogue.PrintPriceIds);
+        if (!bLoaded)
+        {
+            m_Error = "Failed to read outlets, clients and prices, see the log for details.";
+            return false;
+        }
+
+        if (catalogue.BranchIds.empty() && catalogue.KioskIds.empty())
+            m_Error = "No branch or kiosk has a storage to take service orders.";
+        else if (catalogue.ClientIds.empty() || catalogue.PrintDiscountIds.empty() || catalogue.PrintPriceIds.empty())
+            m_Error = "Clients, print discounts or print prices are empty, load the data first.";
+
+        return m_Error.empty();
+    }
+
+    void OrderEntrySimulator::RunTerminal(uint32_t terminalIndex, const Catalogue& catalogue, TerminalResult& result) noexcept
+    {
+        PooledConnection connection = m_Connection.AcquireConnection();
+        if (!connection)
+        {
+            result.OtherErrors = 1;
+            result.FirstError  = "No database connection available.";
+            m_Errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        connection.MarkSessionDirty();
+
+        PGconn* conn = connection->native_handle();
+        const int32_t wasNonBlocking = PQisnonblocking(conn);
+        PQsetnonblocking(conn, 0);
+
+        // Kiosks and branches are interleaved so any terminal count keeps the share, every terminal stays at one outlet.
+        // With OutletCount set several terminals share an outlet, and with it the storage its service orders draw from.
+        const double share   = m_Desc.KioskShare;
+        const bool bKiosk    = catalogue.BranchIds.empty() ||
+                            (!catalogue.KioskIds.empty() && std::floor((terminalIndex + 1) * share) > std::floor(terminalIndex * share));
+        const auto& outlets  = bKiosk ? catalogue.KioskIds : catalogue.BranchIds;
+        const auto& services = bKiosk ? catalogue.KioskServiceTypeIds : catalogue.BranchServiceTypeIds;
+        const std::size_t usedOutletCount = m_Desc.OutletCount ? std::min<std::size_t>(m_Desc.OutletCount, outlets.size()) : outlets.size();
+        const std::string outletId        = std::to_string(outlets[terminalIndex % usedOutletCount]);
+
+        std::mt19937_64 random(m_Desc.Seed + terminalIndex);
+        TransactionError error{};
+        bool bPrepared = ExecuteCommand(conn, (std::string("SET application_name = '") + s_ApplicationName + "'").c_str(), error);
+        for (const auto& statement : s_OrderEntryStatements)
+        {
+            if (!bPrepared) break;
+
+            PGresult* prepared = PQprepare(conn, statement.Name, statement.Sql, statement.ParamCount, nullptr);
+            bPrepared          = CheckResult(conn, prepared, error);
+            PQclear(prepared);
+        }
+
+        const auto recordStep = [&](EOrderEntryStep step, std::chrono::steady_clock::time_point& stepStart)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            result.StepTotalMs[step] += std::chrono::duration<double, std::milli>(now - stepStart).count();
+            ++result.StepCounts[step];
+            stepStart = now;
+        };
+
+        while (bPrepared && !m_bStopping.load(std::memory_order_acquire))
+        {
+            // The order is drawn once and entered again as is after a deadlock, like a clerk pressing Save again.
+            const char* urgent       = !bKiosk && std::uniform_real_distribution<double>(0.0, 1.0)(random) < 0.12 ? "true" : "false";
+            const std::string client = std::to_string(PickUniform(catalogue.ClientIds, random));
+
+            std::string serviceCounts = "{", serviceTypeIds = "{";
+            const uint32_t serviceOrderCount = services.empty() ? 0 : std::uniform_int_distribution<uint32_t>(0, 2)(random);
+            for (uint32_t i{}; i < serviceOrderCount; ++i)
+            {
+                AppendArrayElement(serviceCounts, std::uniform_int_distribution<int64_t>(1, 3)(random));
+                AppendArrayElement(serviceTypeIds, PickUniform(services, random));
+            }
+            serviceCounts += '}';
+            serviceTypeIds += '}';
+
+            struct PrintOrderPlan final
+            {
+                std::string DiscountId{};
+                std::string Amounts{"{"};
+                std::string PrintPriceIds{"{"};
+            };
+            std::vector<PrintOrderPlan> printOrders(std::uniform_int_distribution<uint32_t>(serviceOrderCount ? 0 : 1, 2)(random));
+            for (auto& printOrder : printOrders)
+            {
+                printOrder.DiscountId     = std::to_string(PickUniform(catalogue.PrintDiscountIds, random));
+                const uint32_t frameCount = std::uniform_int_distribution<uint32_t>(1, 36)(random);
+                for (uint32_t frame{}; frame < frameCount; ++frame)
+                {
+                    AppendArrayElement(printOrder.Amounts, std::uniform_int_distribution<int64_t>(1, 3)(random));
+                    AppendArrayElement(printOrder.PrintPriceIds, PickUniform(catalogue.PrintPriceIds, random));
+                }
+                printOrder.Amounts += '}';
+                printOrder.PrintPriceIds += '}';
+            }
+
+            const auto orderStart = std::chrono::steady_clock::now();
+            for (uint32_t attempt{};; ++attempt)
+            {
+                auto stepStart = std::chrono::steady_clock::now();
+                std::string orderId{}, printOrderId{};
+                bool bSucceeded = ExecuteCommand(conn, s_BeginStatements[static_cast<std::size_t>(m_Desc.Isolation)], error) &&
+                                  ExecuteStatement(conn, s_OrderEntryStatements[0], {urgent, outletId.c_str(), client.c_str()}, &orderId,
+                                                   error);
+                if (bSucceeded)
+                {
+                    recordStep(EOrderEntryStep::InsertOrder, stepStart);
+                    if (serviceOrderCount > 0)
+                    {
+                        bSucceeded = ExecuteStatement(conn, s_OrderEntryStatements[1],
+                                                      {orderId.c_str(), serviceCounts.c_str(), serviceTypeIds.c_str()}, nullptr, error);
+                        if (bSucceeded) recordStep(EOrderEntryStep::InsertServiceOrders, stepStart);
+                    }
+                }
+                for (std::size_t i{}; bSucceeded && i < printOrders.size(); ++i)
+                {
+                    const auto& printOrder = printOrders[i];
+                    const std::array<const char*, 3> printOrderParams = {orderId.c_str(), printOrder.DiscountId.c_str(), nullptr};
+                    bSucceeded = ExecuteStatement(conn, s_OrderEntryStatements[2], printOrderParams, &printOrderId, error);
+                    bSucceeded = bSucceeded &&
+                                 ExecuteStatement(conn, s_OrderEntryStatements[3],
+                                                  {printOrderId.c_str(), printOrder.Amounts.c_str(), printOrder.PrintPriceIds.c_str()},
+                                                  nullptr, error);
+                    if (bSucceeded && i + 1 == printOrders.size()) recordStep(EOrderEntryStep::InsertPrintOrders, stepStart);
+                }
+                if (bSucceeded)
+                {
+                    bSucceeded = ExecuteCommand(conn, "COMMIT", error);
+                    if (bSucceeded) recordStep(EOrderEntryStep::Commit, stepStart);
+                }
+
+                if (bSucceeded)
+                {
+                    const auto orderTime = std::chrono::steady_clock::now() - orderStart;
+                    result.LatenciesMs.push_back(std::chrono::duration<double, std::milli>(orderTime).count());
+                    ++result.Committed;
+                    m_Committed.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+
+                // A failed COMMIT has ended the transaction already, the ROLLBACK is harmless then.
+                TransactionError rollbackError{};
+                ExecuteCommand(conn, "ROLLBACK", rollbackError);
+
+                const bool bDeadlock      = error.SqlState == s_DeadlockSqlState;
+                const bool bSerialization = error.SqlState == s_SerializationSqlState;
+                if (bDeadlock)
+                {
+                    ++result.Deadlocks;
+                    m_Deadlocks.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (bSerialization)
+                {
+                    ++result.SerializationFailures;
+                    m_SerializationFailures.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    // Anything else (a missing partition, a constraint) fails again the same way, it ends the run.
+                    ++result.OtherErrors;
+                    m_Errors.fetch_add(1, std::memory_order_relaxed);
+                    if (result.FirstError.empty()) result.FirstError = error.Message;
+                    m_bStopping.store(true, std::memory_order_release);
+                    Stop();
+                    break;
+                }
+
+                if (attempt >= m_Desc.MaxRetries || m_bStopping.load(std::memory_order_acquire))
+                {
+                    ++result.Abandoned;
+                    break;
+                }
+                ++result.Retries;
+            }
+        }
+
+        if (!bPrepared)
+        {
+            ++result.OtherErrors;
+            m_Errors.fetch_add(1, std::memory_order_relaxed);
+            result.FirstError = error.Message;
+            m_bStopping.store(true, std::memory_order_release);
+            Stop();
+        }
+
+        // DISCARD isn't run on reuse (it would drop the pool's cached statements too), so ours go by name.
+        for (const auto& statement : s_OrderEntryStatements)
+            ExecuteCommand(conn, (std::string("DEALLOCATE ") + statement.Name).c_str(), error);
+        PQsetnonblocking(conn, wasNonBlocking);
+    }
+
+    bool OrderEntrySimulator::SampleWaitEvents(std::vector<WaitEventSample>& waitEvents) noexcept
+    {
+        static const std::string s_Query = std::string("SELECT wait_event_type || ':' || wait_event, COUNT(*) FROM pg_stat_activity "
+                                                       "WHERE application_name = '") +
+                                           s_ApplicationName + "' AND state = 'active' AND wait_event IS NOT NULL GROUP BY 1";
+
+        const auto result = m_Connection.Execute(s_Query, EResultFormat::Binary);
+        if (!result) return false;
+
+        for (std::size_t row{}; row < result->GetRowCount(); ++row)
+        {
+            const std::string_view waitEvent = result->GetValue(row, 0);
+            auto it = std::find_if(waitEvents.begin(), waitEvents.end(),
+                                   [&](const WaitEventSample& sample) { return sample.WaitEvent == waitEvent; });
+            if (it == waitEvents.end()) it = waitEvents.insert(waitEvents.end(), WaitEventSample{.WaitEvent = std::string(waitEvent)});
+            it->SampleCount += static_cast<uint64_t>(result->GetInt64(row, 1));
+        }
+
+        return true;
+    }
+
+    void OrderEntrySimulator::Run() noexcept
+    {
+        m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+        Catalogue catalogue{};
+        bool bSucceeded = LoadCatalogue(catalogue);
+
+        std::vector<TerminalResult> results(bSucceeded ? m_Desc.TerminalCount : 0);
+        std::vector<std::thread> terminals{};
+        const auto loadStartTime = std::chrono::steady_clock::now();
+        for (uint32_t i{}; i < results.size(); ++i)
+            terminals.emplace_back(&OrderEntrySimulator::RunTerminal, this, i, std::cref(catalogue), std::ref(results[i]));
+
+        // The terminals only check the flag between transactions, the samples go on until they're all back.
+        const auto endTime = loadStartTime + m_Desc.Duration;
+        while (bSucceeded)
+        {
+            std::unique_lock lock(m_StopMutex);
+            const auto nextSampleTime = std::min(std::chrono::steady_clock::now() + m_Desc.WaitSampleInterval, endTime);
+            if (m_StopCV.wait_until(lock, nextSampleTime, [&] { return m_bStopRequested; })) break;
+            lock.unlock();
+
+            if (std::chrono::steady_clock::now() >= endTime) break;
+            if (SampleWaitEvents(m_Stats.WaitEvents)) ++m_Stats.WaitSampleCount;
+        }
+        m_bStopping.store(true, std::memory_order_release);
+
+        for (auto& terminal : terminals)
+            terminal.join();
+        const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStartTime).count();
+
+        OrderEntryStats& stats = m_Stats;
+        stats.TerminalCount    = m_Desc.TerminalCount;
+        stats.ElapsedSeconds   = elapsedSeconds;
+        std::vector<double> latencies{};
+        std::array<uint64_t, EOrderEntryStep::Count> stepCounts{};
+        for (auto& result : results)
+        {
+            stats.Committed += result.Committed;
+            stats.Deadlocks += result.Deadlocks;
+            stats.SerializationFailures += result.SerializationFailures;
+            stats.OtherErrors += result.OtherErrors;
+            stats.Retries += result.Retries;
+            stats.Abandoned += result.Abandoned;
+            if (stats.FirstError.empty()) stats.FirstError = result.FirstError;
+
+            latencies.insert(latencies.end(), result.LatenciesMs.begin(), result.LatenciesMs.end());
+            for (uint32_t step{}; step < EOrderEntryStep::Count; ++step)
+            {
+                stats.StepMeanMs[step] += result.StepTotalMs[step];
+                stepCounts[step] += result.StepCounts[step];
+            }
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        stats.OrdersPerSecond = static_cast<double>(stats.Committed) / std::max(elapsedSeconds, 0.001);
+        stats.MeanMs          = latencies.empty() ? 0.0 : std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+        stats.P50Ms           = GetPercentile(latencies, 50);
+        stats.P95Ms           = GetPercentile(latencies, 95);
+        stats.P99Ms           = GetPercentile(latencies, 99);
+        stats.MaxMs           = latencies.empty() ? 0.0 : latencies.back();
+        for (uint32_t step{}; step < EOrderEntryStep::Count; ++step)
+            stats.StepMeanMs[step] = stepCounts[step] ? stats.StepMeanMs[step] / stepCounts[step] : 0.0;
+        std::sort(stats.WaitEvents.begin(), stats.WaitEvents.end(),
+                  [](const WaitEventSample& lhs, const WaitEventSample& rhs) { return lhs.SampleCount > rhs.SampleCount; });
+
+        if (bSucceeded && stats.OtherErrors > 0)
+        {
+            m_Error    = stats.FirstError;
+            bSucceeded = false;
+        }
+
+        EQueryStatus status = bSucceeded ? EQueryStatus::Done : EQueryStatus::Failed;
+        if (bSucceeded)
+            LOG_TRACE("Order entry: {} terminals, {} orders in {:.2f} s, {} deadlocks, {} serialization failures", stats.TerminalCount,
+                      stats.Committed, elapsedSeconds, stats.Deadlocks, stats.SerializationFailures);
+        else
+            LOG_ERROR("Order entry simulation failed: {}", m_Error);
+
+        m_EndTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count(),
+                          std::memory_order_release);
+        m_Status.store(status, std::memory_order_release);
+        m_bFinished.store(true, std::memory_order_release);
+    }
+
+}  // namespace nsudb
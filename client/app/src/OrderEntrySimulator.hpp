@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    enum class EIsolationLevel : uint8_t
+    {
+        ReadCommitted = 0,
+        RepeatableRead,
+        Serializable
+    };
+
+    struct OrderEntrySimulatorDesc final
+    {
+        static constexpr uint64_t s_DefaultSeed = 20240520;
+
+        uint32_t TerminalCount{8};  // threads, each on its own connection
+        double KioskShare{0.5};     // of the terminals, the rest take orders at branches
+        uint32_t OutletCount{0};    // outlets of each type the terminals share, 0 = all; fewer means more terminals per storage
+        std::chrono::seconds Duration{std::chrono::seconds(30)};
+        EIsolationLevel Isolation{EIsolationLevel::ReadCommitted};
+        uint32_t MaxRetries{3};  // deadlocks and serialization failures are rolled back and the order is entered again
+        std::chrono::milliseconds WaitSampleInterval{100};
+        uint64_t Seed{s_DefaultSeed};
+    };
+
+    enum EOrderEntryStep : uint32_t
+    {
+        InsertOrder = 0,
+        InsertServiceOrders,  // fires the storage triggers
+        InsertPrintOrders,    // print_orders and their frames, fires the overall_price recompute
+        Commit,
+        Count
+    };
+
+    // How often a backend of the simulated terminals was seen waiting on something, e.g. Lock:transactionid.
+    struct WaitEventSample final
+    {
+        std::string WaitEvent{};
+        uint64_t SampleCount{0};
+    };
+
+    struct OrderEntryStats final
+    {
+        uint32_t TerminalCount{0};
+        double ElapsedSeconds{0.0};
+
+        uint64_t Committed{0};
+        uint64_t Deadlocks{0};              // SQLSTATE 40P01
+        uint64_t SerializationFailures{0};  // SQLSTATE 40001
+        uint64_t OtherErrors{0};            // not retried, the first one is in FirstError
+        uint64_t Retries{0};
+        uint64_t Abandoned{0};  // orders still failing after MaxRetries
+        std::string FirstError{};
+
+        // Per committed order, from the first BEGIN to the successful COMMIT, retries included.
+        double OrdersPerSecond{0.0};
+        double MeanMs{0.0};
+        double P50Ms{0.0};
+        double P95Ms{0.0};
+        double P99Ms{0.0};
+        double MaxMs{0.0};
+
+        // Mean per attempt, including the failed ones, so the step that waits on locks stands out.
+        std::array<double, EOrderEntryStep::Count> StepMeanMs{};
+
+        std::vector<WaitEventSample> WaitEvents{};  // most frequent first
+        uint64_t WaitSampleCount{0};                // samples taken, WaitEvents counts are out of this times TerminalCount
+    };
+
+    // Headless load generator for the order-entry path: TerminalCount threads play kiosks and branches, each entering orders
+    // with service orders, print orders and frames in one transaction after another on its own connection, as fast as the
+    // server lets it. That's where the storage triggers take the supplies from the outlet's storage (storage_items upserts, or
+    // ledger appends with 14-inventory-ledger.sql) and the overall_price recompute locks the order, so deadlocks, serialization
+    // failures and lock waits (pg_stat_activity, sampled) show how the schema copes with concurrent outlets. Needs a loaded
+    // database (outlets with storages, clients, prices).
+    // Runs on its own thread, everything here is safe to poll every frame.
+    struct OrderEntrySimulator final
+    {
+        // The pool needs TerminalCount + 1 connections, the extra one samples the waits.
+        OrderEntrySimulator(DatabaseConnection& connection, OrderEntrySimulatorDesc desc = {}) noexcept;
+        ~OrderEntrySimulator() noexcept;  // stops after the running transactions
+
+        OrderEntrySimulator(const OrderEntrySimulator&)            = delete;
+        OrderEntrySimulator& operator=(const OrderEntrySimulator&) = delete;
+
+        bool IsFinished() const noexcept { return m_bFinished.load(std::memory_order_acquire); }
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Guarded by IsFinished(), the threads don't touch them after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+        const OrderEntryStats& GetStats() const noexcept { return m_Stats; }
+
+        uint64_t GetCommitted() const noexcept { return m_Committed.load(std::memory_order_relaxed); }
+        uint64_t GetDeadlocks() const noexcept { return m_Deadlocks.load(std::memory_order_relaxed); }
+        uint64_t GetSerializationFailures() const noexcept { return m_SerializationFailures.load(std::memory_order_relaxed); }
+        uint64_t GetErrors() const noexcept { return m_Errors.load(std::memory_order_relaxed); }
+        float GetElapsedSeconds() const noexcept;
+
+        void Stop() noexcept;
+
+      private:
+        struct Catalogue;
+        struct TerminalResult;
+
+        DatabaseConnection& m_Connection;
+        OrderEntrySimulatorDesc m_Desc{};
+        std::string m_Error{};
+        OrderEntryStats m_Stats{};
+
+        std::chrono::steady_clock::time_point m_StartTime{};
+        std::atomic<int64_t> m_EndTimeNs{0};  // since m_StartTime
+        std::atomic<uint64_t> m_Committed{0};
+        std::atomic<uint64_t> m_Deadlocks{0};
+        std::atomic<uint64_t> m_SerializationFailures{0};
+        std::atomic<uint64_t> m_Errors{0};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bFinished{false};
+        std::atomic_bool m_bStopping{false};  // read by the terminals between transactions
+
+        std::mutex m_StopMutex{};
+        std::condition_variable m_StopCV{};
+        bool m_bStopRequested{false};  // guarded by m_StopMutex
+
+        std::thread m_Thread{};
+
+        void Run() noexcept;
+        bool LoadCatalogue(Catalogue& catalogue) noexcept;
+        void RunTerminal(uint32_t terminalIndex, const Catalogue& catalogue, TerminalResult& result) noexcept;
+        bool SampleWaitEvents(std::vector<WaitEventSample>& waitEvents) noexcept;
+    };
+
+}  // namespace nsudb
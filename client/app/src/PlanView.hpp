@@ -0,0 +1,13 @@
+#pragma once
+
+namespace nsudb
+{
+
+    struct QueryPlan;
+
+    // Collapsible tree of the plan's nodes with their self/total time, rows and buffers. Cells are shaded by self time,
+    // shared hits and shared reads, each relative to the plan's largest, so the expensive node stands out at a glance;
+    // row estimates off by QueryPlan::s_MisestimateFactor or more are highlighted. Hovering a node shows its conditions.
+    void DrawQueryPlan(const char* strId, const QueryPlan& plan) noexcept;
+
+}  // namespace nsudb
@@ -0,0 +1,51 @@
+#include "PreparedStatementCache.hpp"
+#include <Logger.hpp>
+
+#include <pgfe/pgfe.hpp>
+
+namespace nsudb
+{
+
+    namespace pgfe = dmitigr::pgfe;
+
+    PreparedStatementCache::PreparedStatementCache(std::size_t capacity) noexcept : m_Capacity(std::max<std::size_t>(capacity, 1)) {}
+
+    PreparedStatementCache::~PreparedStatementCache() noexcept = default;
+
+    pgfe::Prepared_statement& PreparedStatementCache::GetOrPrepare(pgfe::Connection& connection, const std::string& sql)
+    {
+        if (const auto it = m_Statements.find(sql); it != m_Statements.end())
+        {
+            ++m_HitCount;
+            m_Lru.splice(m_Lru.begin(), m_Lru, it->second.LruIt);
+            return *it->second.Statement;
+        }
+
+        ++m_MissCount;
+        while (m_Statements.size() >= m_Capacity)
+        {
+            const auto victimIt          = m_Statements.find(m_Lru.back());
+            const std::string victimName = victimIt->second.Statement->name();
+
+            m_Lru.pop_back();
+            m_Statements.erase(victimIt);
+            connection.unprepare(victimName);
+        }
+
+        // Name only has to be unique within the session, the text is the actual key.
+        const std::string name = "nsudb_ps_" + std::to_string(m_NameCounter++);
+        auto statement         = std::make_unique<pgfe::Prepared_statement>(connection.prepare(sql, name));
+        LOG_TRACE("Prepared statement {} ({} cached)", name, m_Statements.size() + 1);
+
+        m_Lru.push_front(sql);
+        auto& entry = m_Statements[sql] = Entry{std::move(statement), m_Lru.begin()};
+        return *entry.Statement;
+    }
+
+    void PreparedStatementCache::Clear() noexcept
+    {
+        m_Statements.clear();
+        m_Lru.clear();
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace dmitigr::pgfe
+{
+    class Connection;
+    class Prepared_statement;
+}  // namespace dmitigr::pgfe
+
+namespace nsudb
+{
+
+    // Server-side prepared statements of one connection keyed by their SQL text. Repeated runs skip parse/plan,
+    // past capacity the least recently used statement is deallocated on the server.
+    struct PreparedStatementCache final
+    {
+        static constexpr std::size_t s_DefaultCapacity = 32;
+
+        explicit PreparedStatementCache(std::size_t capacity = s_DefaultCapacity) noexcept;
+        ~PreparedStatementCache() noexcept;
+
+        PreparedStatementCache(const PreparedStatementCache&)            = delete;
+        PreparedStatementCache& operator=(const PreparedStatementCache&) = delete;
+
+        // Prepares on first use. Unlike most of the codebase this throws (pgfe errors), callers already sit in a try block.
+        dmitigr::pgfe::Prepared_statement& GetOrPrepare(dmitigr::pgfe::Connection& connection, const std::string& sql);
+
+        // Forgets everything without touching the server, for when the session was reset anyway.
+        void Clear() noexcept;
+
+        std::size_t GetSize() const noexcept { return m_Statements.size(); }
+        std::size_t GetCapacity() const noexcept { return m_Capacity; }
+        uint64_t GetHitCount() const noexcept { return m_HitCount; }
+        uint64_t GetMissCount() const noexcept { return m_MissCount; }
+
+      private:
+        struct Entry final
+        {
+            std::unique_ptr<dmitigr::pgfe::Prepared_statement> Statement{nullptr};
+            std::list<std::string>::iterator LruIt{};
+        };
+
+        std::size_t m_Capacity{s_DefaultCapacity};
+        std::unordered_map<std::string, Entry> m_Statements{};
+        std::list<std::string> m_Lru{};  // front is the most recently used SQL text
+        uint64_t m_NameCounter{0};
+        uint64_t m_HitCount{0};
+        uint64_t m_MissCount{0};
+    };
+
+}  // namespace nsudb
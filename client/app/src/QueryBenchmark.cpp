@@ -0,0 +1,212 @@
+#include "QueryBenchmark.hpp"
+#include <Logger.hpp>
+#include <QueryPlan.hpp>
+#include <ReportQueries.hpp>
+
+namespace nsudb
+{
+
+    // "#3 SELECT o.id, ..." from the statement's first line, long enough to tell cases apart in a table.
+    static std::string MakeStatementCaseName(std::size_t index, std::string_view sql) noexcept
+    {
+        static constexpr std::size_t s_MaxNameLength = 60;
+
+        std::string_view firstLine = sql.substr(0, sql.find('\n'));
+        if (firstLine.size() > s_MaxNameLength) firstLine = firstLine.substr(0, s_MaxNameLength);
+
+        return "#" + std::to_string(index + 1) + " " + std::string(firstLine);
+    }
+
+    std::optional<std::vector<QueryBenchmarkCase>> LoadQueryBenchmarkCases(const QueryBenchmarkDesc& desc) noexcept
+    {
+        std::vector<QueryBenchmarkCase> cases{};
+        if (desc.SqlFile.empty())
+        {
+            for (const auto& report : CreateReportQueries())
+                cases.emplace_back(report.Title, std::vector<std::vector<QueryStatement>>{BuildReportStatements(report)});
+        }
+        else
+        {
+            std::ifstream file(desc.SqlFile, std::ios::binary);
+            if (!file)
+            {
+                LOG_ERROR("Failed to open {}", desc.SqlFile.string());
+                return std::nullopt;
+            }
+
+            const std::string sql((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            for (auto& statement : SplitSqlStatements(sql))
+            {
+                QueryBenchmarkCase& benchmarkCase = cases.emplace_back();
+                benchmarkCase.Name                = MakeStatementCaseName(cases.size() - 1, statement);
+                benchmarkCase.Batches.emplace_back().emplace_back(QueryStatement{.Sql = std::move(statement)});
+            }
+
+            if (cases.empty())
+            {
+                LOG_ERROR("No statements in {}", desc.SqlFile.string());
+                return std::nullopt;
+            }
+        }
+
+        // Compared with the sum of the cases above it, this is what one round trip instead of N buys.
+        if (desc.bPipelineAll && cases.size() > 1)
+        {
+            QueryBenchmarkCase pipelinedCase{.Name = "all of the above, pipelined"};
+            for (const auto& benchmarkCase : cases)
+                pipelinedCase.Batches.insert(pipelinedCase.Batches.end(), benchmarkCase.Batches.begin(), benchmarkCase.Batches.end());
+
+            cases.emplace_back(std::move(pipelinedCase));
+        }
+
+        return cases;
+    }
+
+    // Nearest rank on sorted values.
+    static double GetPercentile(const std::vector<double>& sortedValues, uint32_t percentile) noexcept
+    {
+        if (sortedValues.empty()) return 0.0;
+
+        const std::size_t rank = (sortedValues.size() * percentile + 99) / 100;
+        return sortedValues[std::clamp<std::size_t>(rank, 1, sortedValues.size()) - 1];
+    }
+
+    // One run of the case, the latency in ms or nullopt with the error stored in the result.
+    static std::optional<double> RunCaseOnce(DatabaseConnection& connection, const QueryBenchmarkCase& benchmarkCase,
+                                             const QueryBenchmarkDesc& desc, QueryBenchmarkResult& result) noexcept
+    {
+        const bool bPipelined  = benchmarkCase.Batches.size() > 1;
+        const QueryHandle task = bPipelined ? connection.ExecutePipelinedAsync(benchmarkCase.Batches, nullptr, desc.ResultFormat)
+                                            : connection.ExecutePreparedAsync(benchmarkCase.Batches.front(), nullptr, desc.ResultFormat);
+
+        // Latency comes from the task's own timestamps, the polling period doesn't show up in it.
+        while (!task->IsFinished())
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        std::vector<BatchResult> batchResults{};
+        if (bPipelined)
+            batchResults = task->TakeBatchResults();
+        else
+            batchResults.emplace_back(BatchResult{.Result = task->TakeResult()});
+
+        if (task->GetStatus() != EQueryStatus::Done)
+        {
+            result.Error = task->GetError();
+            return std::nullopt;
+        }
+
+        result.RowCount  = 0;
+        result.ByteCount = 0;
+        for (const auto& batchResult : batchResults)
+        {
+            if (!batchResult.Result)
+            {
+                result.Error = batchResult.Error.empty() ? task->GetError() : batchResult.Error;
+                return std::nullopt;
+            }
+
+            result.RowCount += batchResult.Result->GetRowCount();
+            result.ByteCount += batchResult.Result->GetDataSize();
+        }
+
+        return static_cast<double>(task->GetElapsedSeconds()) * 1e3;
+    }
+
+    std::vector<QueryBenchmarkResult> RunQueryBenchmark(DatabaseConnection& connection, const std::vector<QueryBenchmarkCase>& cases,
+                                                        const QueryBenchmarkDesc& desc) noexcept
+    {
+        std::vector<QueryBenchmarkResult> results{};
+        results.reserve(cases.size());
+        for (const auto& benchmarkCase : cases)
+        {
+            QueryBenchmarkResult& result = results.emplace_back();
+            result.Name                  = benchmarkCase.Name;
+            result.LatenciesMs.reserve(desc.IterationCount);
+
+            for (uint32_t iteration{}; iteration < desc.WarmupCount + desc.IterationCount; ++iteration)
+            {
+                const auto latencyMs = RunCaseOnce(connection, benchmarkCase, desc, result);
+                if (!latencyMs)
+                {
+                    LOG_WARN("Benchmark: '{}' failed: {}", result.Name, result.Error);
+                    break;
+                }
+
+                if (iteration >= desc.WarmupCount) result.LatenciesMs.emplace_back(*latencyMs);
+            }
+
+            if (result.LatenciesMs.empty()) continue;
+
+            std::sort(result.LatenciesMs.begin(), result.LatenciesMs.end());
+            const double totalMs = std::accumulate(result.LatenciesMs.begin(), result.LatenciesMs.end(), 0.0);
+            result.MeanMs        = totalMs / result.LatenciesMs.size();
+            result.P50Ms         = GetPercentile(result.LatenciesMs, 50);
+            result.P95Ms         = GetPercentile(result.LatenciesMs, 95);
+            result.P99Ms         = GetPercentile(result.LatenciesMs, 99);
+
+            // Over the summed latency, so it is the throughput of the query itself rather than of the harness.
+            const double totalSeconds = std::max(totalMs * 1e-3, 1e-9);
+            result.RowsPerSecond      = static_cast<double>(result.RowCount) * result.LatenciesMs.size() / totalSeconds;
+            result.BytesPerSecond     = static_cast<double>(result.ByteCount) * result.LatenciesMs.size() / totalSeconds;
+        }
+
+        return results;
+    }
+
+    bool WriteQueryBenchmarkJson(const std::filesystem::path& path, const DatabaseDesc& databaseDesc, const QueryBenchmarkDesc& desc,
+                                 const std::vector<QueryBenchmarkResult>& results) noexcept
+    {
+        const bool bStdout = path == "-";
+        std::FILE* file    = bStdout ? stdout : std::fopen(path.string().c_str(), "wb");
+        if (!file)
+        {
+            LOG_ERROR("Failed to open {} for writing", path.string());
+            return false;
+        }
+
+        const auto timestamp = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+
+        std::fprintf(file, "{\n  \"label\": ");
+        WriteJsonString(file, desc.Label);
+        std::fprintf(file, ",\n  \"build\": ");
+        WriteJsonString(file, __DATE__ " " __TIME__);
+        std::fprintf(file, ",\n  \"unix_time\": %lld,\n  \"host\": ", static_cast<long long>(timestamp));
+        WriteJsonString(file, databaseDesc.HostName);
+        std::fprintf(file, ",\n  \"port\": %d,\n  \"database\": ", static_cast<int32_t>(databaseDesc.Port));
+        WriteJsonString(file, databaseDesc.Database);
+        std::fprintf(file, ",\n  \"source\": ");
+        WriteJsonString(file, desc.SqlFile.empty() ? "reports" : desc.SqlFile.string());
+        std::fprintf(file,
+                     ",\n  \"result_format\": \"%s\",\n  \"pipeline_all\": %s,\n  \"warmup\": %u,\n  \"iterations\": %u,\n"
+                     "  \"cases\": [",
+                     desc.ResultFormat == EResultFormat::Binary ? "binary" : "text", desc.bPipelineAll ? "true" : "false", desc.WarmupCount,
+                     desc.IterationCount);
+
+        for (std::size_t i{}; i < results.size(); ++i)
+        {
+            const QueryBenchmarkResult& result = results[i];
+            std::fprintf(file, "%s\n    {\n      \"name\": ", i == 0 ? "" : ",");
+            WriteJsonString(file, result.Name);
+            std::fprintf(file, ",\n      \"ok\": %s,\n      \"error\": ", result.Error.empty() ? "true" : "false");
+            WriteJsonString(file, result.Error);
+            std::fprintf(file,
+                         ",\n      \"runs\": %zu,\n      \"mean_ms\": %.4f,\n      \"p50_ms\": %.4f,\n      \"p95_ms\": %.4f,\n"
+                         "      \"p99_ms\": %.4f,\n      \"rows\": %llu,\n      \"bytes\": %llu,\n      \"rows_per_s\": %.1f,\n"
+                         "      \"bytes_per_s\": %.1f,\n      \"latencies_ms\": [",
+                         result.LatenciesMs.size(), result.MeanMs, result.P50Ms, result.P95Ms, result.P99Ms,
+                         static_cast<unsigned long long>(result.RowCount), static_cast<unsigned long long>(result.ByteCount),
+                         result.RowsPerSecond, result.BytesPerSecond);
+            for (std::size_t run{}; run < result.LatenciesMs.size(); ++run)
+                std::fprintf(file, "%s%.4f", run == 0 ? "" : ", ", result.LatenciesMs[run]);
+            std::fprintf(file, "]\n    }");
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+
+        const bool bWritten = std::ferror(file) == 0;
+        if (!bStdout) std::fclose(file);
+        if (!bWritten) LOG_ERROR("Failed to write {}", path.string());
+
+        return bWritten;
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    struct QueryBenchmarkDesc final
+    {
+        static constexpr uint32_t s_DefaultIterationCount = 20;
+
+        std::filesystem::path SqlFile{};  // statements separated by ';', every one is a case; empty runs the predefined reports
+        uint32_t IterationCount{s_DefaultIterationCount};
+        uint32_t WarmupCount{1};  // untimed runs first, they fill the prepared statement cache and the server's buffers
+        EResultFormat ResultFormat{EResultFormat::Binary};
+        std::string Label{};       // free text copied into the JSON, e.g. the commit being measured
+        bool bPipelineAll{false};  // one more case running all the others as a single DatabaseConnection::ExecutePipelinedAsync()
+    };
+
+    // One thing to time: a report (all of its statements, like the Reports window runs it) or one statement of the SQL file.
+    // A single batch runs through ExecutePreparedAsync(), several through ExecutePipelinedAsync().
+    struct QueryBenchmarkCase final
+    {
+        std::string Name{};
+        std::vector<std::vector<QueryStatement>> Batches{};
+    };
+
+    struct QueryBenchmarkResult final
+    {
+        std::string Name{};
+        std::string Error{};  // first failure (of any batch), the case isn't run any further after it
+
+        // Server round trip as the pool worker sees it (first statement sent to last row stored), queueing excluded.
+        std::vector<double> LatenciesMs{};  // successful timed runs, sorted
+        double MeanMs{0.0};
+        double P50Ms{0.0};
+        double P95Ms{0.0};
+        double P99Ms{0.0};
+
+        uint64_t RowCount{0};  // per run, taken from the last one
+        uint64_t ByteCount{0};  // QueryResult::GetDataSize() per run
+        double RowsPerSecond{0.0};
+        double BytesPerSecond{0.0};
+    };
+
+    // The predefined reports, or the statements of desc.SqlFile. nullopt (and logged) if the file can't be read.
+    std::optional<std::vector<QueryBenchmarkCase>> LoadQueryBenchmarkCases(const QueryBenchmarkDesc& desc) noexcept;
+
+    // Runs the cases one after another, every case warmup + iteration times in a row, nothing else on the connection.
+    std::vector<QueryBenchmarkResult> RunQueryBenchmark(DatabaseConnection& connection, const std::vector<QueryBenchmarkCase>& cases,
+                                                        const QueryBenchmarkDesc& desc) noexcept;
+
+    // Self-describing JSON document (settings, target, per-case statistics and raw latencies) so runs of different builds
+    // can be diffed. "-" writes to stdout.
+    bool WriteQueryBenchmarkJson(const std::filesystem::path& path, const DatabaseDesc& databaseDesc, const QueryBenchmarkDesc& desc,
+                                 const std::vector<QueryBenchmarkResult>& results) noexcept;
+
+}  // namespace nsudb
@@ -0,0 +1,317 @@
+#include "QueryPlan.hpp"
+#include <Logger.hpp>
+
+namespace nsudb
+{
+
+    // Depth-first walk of the JSON plan, one row per node in plan order (ORDER BY the path of child positions).
+    // Plan totals repeat on every row. Times and rows EXPLAIN gives per loop, times are multiplied out here.
+    static constexpr const char* s_ProfileQuery = R"(WITH RECURSIVE explained AS (SELECT explain_analyze_json($1)->0 AS doc),
+nodes AS (
+    SELECT doc->'Plan' AS node, ARRAY[]::int4[] AS path FROM explained
+    UNION ALL
+    SELECT child.node, nodes.path || child.position::int4
+    FROM nodes
+    CROSS JOIN LATERAL jsonb_array_elements(nodes.node->'Plans') WITH ORDINALITY AS child(node, position)
+)
+SELECT (SELECT (doc->>'Planning Time')::float8 FROM explained) AS planning_ms,
+       (SELECT (doc->>'Execution Time')::float8 FROM explained) AS execution_ms,
+       cardinality(path) AS depth,
+       node->>'Node Type' AS node_type,
+       COALESCE(node->>'Parent Relationship', '') AS relationship,
+       COALESCE(node->>'Join Type', '') AS join_type,
+       COALESCE(node->>'Relation Name', node->>'CTE Name', node->>'Function Name', '') AS relation,
+       COALESCE(node->>'Alias', '') AS alias,
+       COALESCE(node->>'Index Name', '') AS index_name,
+       concat_ws(E'\n',
+                 'Hash Cond: ' || (node->>'Hash Cond'),
+                 'Merge Cond: ' || (node->>'Merge Cond'),
+                 'Index Cond: ' || (node->>'Index Cond'),
+                 'Recheck Cond: ' || (node->>'Recheck Cond'),
+                 'Join Filter: ' || (node->>'Join Filter'),
+                 'Filter: ' || (node->>'Filter'),
+                 'Rows Removed by Filter: ' || (node->>'Rows Removed by Filter'),
+                 'Sort Key: ' || (SELECT string_agg(key, ', ') FROM jsonb_array_elements_text(node->'Sort Key') AS key),
+                 'Group Key: ' || (SELECT string_agg(key, ', ') FROM jsonb_array_elements_text(node->'Group Key') AS key),
+                 'Sort Method: ' || (node->>'Sort Method') || ', ' || (node->>'Sort Space Used') || ' kB ' || (node->>'Sort Space Type'),
+                 'Hash Batches: ' || (node->>'Hash Batches')) AS details,
+       COALESCE((node->>'Actual Total Time')::float8 * (node->>'Actual Loops')::float8, 0) AS total_ms,
+       COALESCE((node->>'Actual Loops')::int8, 0) AS loops,
+       COALESCE((node->>'Actual Rows')::float8, 0) AS actual_rows,
+       COALESCE((node->>'Plan Rows')::float8, 0) AS plan_rows,
+       COALESCE((node->>'Shared Hit Blocks')::int8, 0) AS shared_hit_blocks,
+       COALESCE((node->>'Shared Read Blocks')::int8, 0) AS shared_read_blocks,
+       COALESCE((node->>'Temp Read Blocks')::int8 + (node->>'Temp Written Blocks')::int8, 0) AS temp_blocks
+FROM nodes
+ORDER BY path)";
+
+    // Local to the batch's implicit transaction, a transaction may always be switched to read-only.
+    static constexpr const char* s_ReadOnlyStatement = "SELECT set_config('transaction_read_only', 'on', true)";
+
+    enum EPlanColumn : std::size_t
+    {
+        PlanningMs = 0,
+        ExecutionMs,
+        Depth,
+        NodeType,
+        Relationship,
+        JoinType,
+        Relation,
+        Alias,
+        IndexName,
+        Details,
+        TotalMs,
+        Loops,
+        ActualRows,
+        PlanRows,
+        SharedHitBlocks,
+        SharedReadBlocks,
+        TempBlocks
+    };
+
+    double PlanNode::GetEstimateFactor() const noexcept
+    {
+        if (Loops == 0) return 1.0;
+
+        // Less than one row either way is as good as one, "0 rows expected, 1 found" is no misestimate.
+        const double actualRows = std::max(ActualRows, 1.0), planRows = std::max(PlanRows, 1.0);
+        return std::max(actualRows, planRows) / std::min(actualRows, planRows);
+    }
+
+    std::size_t QueryPlan::GetMisestimateCount() const noexcept
+    {
+        return static_cast<std::size_t>(std::count_if(Nodes.begin(), Nodes.end(), [](const PlanNode& node)
+                                                      { return node.GetEstimateFactor() >= s_MisestimateFactor; }));
+    }
+
+    std::vector<std::string> SplitSqlStatements(std::string_view sql) noexcept
+    {
+        const auto isIdentifierChar = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+
+        std::vector<std::string> statements{};
+        std::size_t statementStart = 0;
+        bool bHasCode              = false;  // anything besides whitespace and comments since statementStart
+        const auto endStatement    = [&](std::size_t end)
+        {
+            std::string_view statement = sql.substr(statementStart, end - statementStart);
+            while (!statement.empty() && std::isspace(static_cast<unsigned char>(statement.front())))
+                statement.remove_prefix(1);
+            while (!statement.empty() && std::isspace(static_cast<unsigned char>(statement.back())))
+                statement.remove_suffix(1);
+
+            if (bHasCode) statements.emplace_back(statement);
+            statementStart = end + 1;
+            bHasCode       = false;
+        };
+
+        std::size_t i = 0;
+        while (i < sql.size())
+        {
+            const char c = sql[i];
+            if (c == '-' && i + 1 < sql.size() && sql[i + 1] == '-')
+            {
+                i = std::min(sql.find('\n', i), sql.size());
+                continue;
+            }
+
+            if (c == '/' && i + 1 < sql.size() && sql[i + 1] == '*')
+            {
+                // Block comments nest in PostgreSQL.
+                uint32_t depth = 0;
+                while (i + 1 < sql.size())
+                {
+                    const std::string_view pair = sql.substr(i, 2);
+                    if (pair == "/*")
+                        ++depth;
+                    else if (pair == "*/" && --depth == 0)
+                        break;
+
+                    i += pair == "/*" || pair == "*/" ? 2 : 1;
+                }
+                i = std::min(i + 2, sql.size());
+                continue;
+            }
+
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                ++i;
+                continue;
+            }
+
+            if (c == ';')
+            {
+                endStatement(i++);
+                continue;
+            }
+
+            bHasCode = true;
+            if (c == '\'' || c == '"')
+            {
+                // A doubled quote inside is just two back to back quoted runs, E'' strings also escape with a backslash.
+                const bool bBackslashEscapes = c == '\'' && i > 0 && (sql[i - 1] == 'E' || sql[i - 1] == 'e') &&
+                                               (i < 2 || !isIdentifierChar(sql[i - 2]));
+                for (++i; i < sql.size() && sql[i] != c; ++i)
+                    if (bBackslashEscapes && sql[i] == '\\') ++i;
+                ++i;
+                continue;
+            }
+
+            // $tag$ ... $tag$, the tag may be empty. $1 and friends are parameters, not quotes.
+            if (c == '$' && (i == 0 || !isIdentifierChar(sql[i - 1])) &&
+                (i + 1 == sql.size() || !std::isdigit(static_cast<unsigned char>(sql[i + 1]))))
+            {
+                std::size_t tagEnd = i + 1;
+                while (tagEnd < sql.size() && isIdentifierChar(sql[tagEnd]))
+                    ++tagEnd;
+
+                if (tagEnd < sql.size() && sql[tagEnd] == '$')
+                {
+                    const std::string_view tag = sql.substr(i, tagEnd - i + 1);
+                    const std::size_t closing  = sql.find(tag, tagEnd + 1);
+                    i                          = closing == std::string_view::npos ? sql.size() : closing + tag.size();
+                    continue;
+                }
+            }
+
+            ++i;
+        }
+        endStatement(sql.size());
+
+        return statements;
+    }
+
+    QueryPlan BuildQueryPlan(std::string sql, const QueryResult& result) noexcept
+    {
+        QueryPlan plan{};
+        plan.Sql = std::move(sql);
+        if (result.GetRowCount() == 0 || result.GetColumnCount() <= TempBlocks)
+        {
+            plan.Error = "EXPLAIN returned no plan.";
+            return plan;
+        }
+
+        plan.PlanningMilliseconds  = result.GetFloat64(0, PlanningMs);
+        plan.ExecutionMilliseconds = result.GetFloat64(0, ExecutionMs);
+
+        plan.Nodes.resize(result.GetRowCount());
+        std::vector<uint32_t> ancestors{};  // path from the root down to the previous node
+        for (std::size_t row{}; row < result.GetRowCount(); ++row)
+        {
+            PlanNode& node         = plan.Nodes[row];
+            node.Depth             = static_cast<uint32_t>(result.GetInt64(row, Depth));
+            node.Relationship      = result.GetValue(row, Relationship);
+            node.Details           = result.GetValue(row, Details);
+            node.TotalMilliseconds = result.GetFloat64(row, TotalMs);
+            node.Loops             = result.GetInt64(row, Loops);
+            node.ActualRows        = result.GetFloat64(row, ActualRows);
+            node.PlanRows          = result.GetFloat64(row, PlanRows);
+            node.SharedHitBlocks   = result.GetInt64(row, SharedHitBlocks);
+            node.SharedReadBlocks  = result.GetInt64(row, SharedReadBlocks);
+            node.TempBlocks        = result.GetInt64(row, TempBlocks);
+
+            // "Hash Join (Left) on orders o using orders_pkey", the way EXPLAIN's text format names nodes.
+            node.Label = result.GetValue(row, NodeType);
+            if (const std::string_view joinType = result.GetValue(row, JoinType); !joinType.empty() && joinType != "Inner")
+                node.Label += " (" + std::string(joinType) + ")";
+            if (const std::string_view indexName = result.GetValue(row, IndexName); !indexName.empty())
+                node.Label += " using " + std::string(indexName);
+            if (const std::string_view relation = result.GetValue(row, Relation); !relation.empty())
+            {
+                node.Label += " on " + std::string(relation);
+                if (const std::string_view alias = result.GetValue(row, Alias); !alias.empty() && alias != relation)
+                    node.Label += " " + std::string(alias);
+            }
+
+            ancestors.resize(std::min<std::size_t>(ancestors.size(), node.Depth));
+            if (!ancestors.empty()) plan.Nodes[ancestors.back()].Children.emplace_back(static_cast<uint32_t>(row));
+            ancestors.emplace_back(static_cast<uint32_t>(row));
+        }
+
+        // Inclusive to self: each node minus its direct children. Rounding (and parallel workers) can push it below 0.
+        for (auto& node : plan.Nodes)
+        {
+            node.SelfMilliseconds  = node.TotalMilliseconds;
+            int64_t childHitBlocks = 0, childReadBlocks = 0, childTempBlocks = 0;
+            for (const uint32_t child : node.Children)
+            {
+                const PlanNode& childNode = plan.Nodes[child];
+                node.SelfMilliseconds -= childNode.TotalMilliseconds;
+                childHitBlocks += result.GetInt64(child, SharedHitBlocks);
+                childReadBlocks += result.GetInt64(child, SharedReadBlocks);
+                childTempBlocks += result.GetInt64(child, TempBlocks);
+            }
+
+            node.SelfMilliseconds = std::max(node.SelfMilliseconds, 0.0);
+            node.SharedHitBlocks  = std::max<int64_t>(node.SharedHitBlocks - childHitBlocks, 0);
+            node.SharedReadBlocks = std::max<int64_t>(node.SharedReadBlocks - childReadBlocks, 0);
+            node.TempBlocks       = std::max<int64_t>(node.TempBlocks - childTempBlocks, 0);
+
+            plan.MaxSelfMilliseconds = std::max(plan.MaxSelfMilliseconds, node.SelfMilliseconds);
+            plan.MaxSharedHitBlocks  = std::max(plan.MaxSharedHitBlocks, node.SharedHitBlocks);
+            plan.MaxSharedReadBlocks = std::max(plan.MaxSharedReadBlocks, node.SharedReadBlocks);
+        }
+
+        return plan;
+    }
+
+    QueryProfiler::QueryProfiler(DatabaseConnection& connection, std::vector<std::string> statements) noexcept : m_Connection(connection)
+    {
+        std::vector<std::vector<QueryStatement>> batches{};
+        for (auto& sql : statements)
+        {
+            batches.push_back({QueryStatement{.Sql = s_ReadOnlyStatement, .bDiscardRows = true},
+                               QueryStatement{.Sql = s_ProfileQuery, .Params = {sql}}});
+            m_Plans.emplace_back().Sql = std::move(sql);
+        }
+
+        if (batches.empty())
+        {
+            m_Error     = "Nothing to profile.";
+            m_bFinished = true;
+            return;
+        }
+
+        m_Task = m_Connection.ExecutePipelinedAsync(std::move(batches));
+    }
+
+    QueryProfiler::~QueryProfiler() noexcept
+    {
+        Cancel();
+    }
+
+    void QueryProfiler::Cancel() noexcept
+    {
+        if (m_Task && !m_Task->IsFinished()) m_Connection.Cancel(m_Task);
+    }
+
+    void QueryProfiler::Poll() noexcept
+    {
+        if (m_bFinished || !m_Task->IsFinished()) return;
+
+        switch (m_Task->GetStatus())
+        {
+            case EQueryStatus::Done:
+            {
+                std::vector<BatchResult> batchResults = m_Task->TakeBatchResults();
+                for (std::size_t i{}; i < m_Plans.size() && i < batchResults.size(); ++i)
+                {
+                    if (!batchResults[i].Result)
+                    {
+                        m_Plans[i].Error = batchResults[i].Error;
+                        LOG_WARN("Profile of statement {} failed: {}", i + 1, m_Plans[i].Error);
+                        continue;
+                    }
+
+                    m_Plans[i] = BuildQueryPlan(std::move(m_Plans[i].Sql), *batchResults[i].Result);
+                }
+                break;
+            }
+            case EQueryStatus::Cancelled: m_Error = "Profile cancelled."; break;
+            default: m_Error = m_Task->GetError(); break;
+        }
+
+        m_Task      = nullptr;
+        m_bFinished = true;
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    // One node of an EXPLAIN (ANALYZE, BUFFERS) plan. Times and buffers are totals over all loops, self values exclude
+    // the children (EXPLAIN reports everything inclusive). Parallel workers count as loops, so their time adds up
+    // rather than overlapping the way wall-clock time does.
+    struct PlanNode final
+    {
+        std::string Label{};         // node type, join type, relation, alias and index as one line
+        std::string Relationship{};  // Outer/Inner/InitPlan/SubPlan..., empty for the root
+        std::string Details{};       // conditions, filters, sort/group keys, one per line
+
+        uint32_t Depth{0};
+        std::vector<uint32_t> Children{};  // indices into QueryPlan::Nodes, in plan order
+
+        double TotalMilliseconds{0.0};
+        double SelfMilliseconds{0.0};
+        double ActualRows{0.0};  // per loop, like PlanRows
+        double PlanRows{0.0};
+        int64_t Loops{0};        // 0 = never executed
+
+        int64_t SharedHitBlocks{0};  // self
+        int64_t SharedReadBlocks{0};
+        int64_t TempBlocks{0};       // read + written, self
+
+        // Actual rows over estimated rows or the inverse, whichever is larger; 1 when never executed.
+        double GetEstimateFactor() const noexcept;
+        bool IsUnderestimated() const noexcept { return ActualRows > PlanRows; }
+    };
+
+    struct QueryPlan final
+    {
+        static constexpr double s_MisestimateFactor = 10.0;  // estimates off by this much are highlighted
+
+        std::string Sql{};
+        std::string Error{};
+
+        double PlanningMilliseconds{0.0};
+        double ExecutionMilliseconds{0.0};
+        std::vector<PlanNode> Nodes{};  // depth-first, Nodes[0] is the root
+
+        // Largest self values of any node, what the viewer scales its colors to.
+        double MaxSelfMilliseconds{0.0};
+        int64_t MaxSharedHitBlocks{0};
+        int64_t MaxSharedReadBlocks{0};
+
+        std::size_t GetMisestimateCount() const noexcept;
+    };
+
+    // Statements of an SQL text split at top-level semicolons: quotes, dollar quotes and comments are skipped over,
+    // trailing semicolons dropped, statements holding nothing but comments left out.
+    std::vector<std::string> SplitSqlStatements(std::string_view sql) noexcept;
+
+    // Runs each statement under EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) through explain_analyze_json() (10-report-indexes.sql)
+    // and flattens the plan into one row per node on the server. All statements go out as one pipeline, one batch each,
+    // so they run back to back and a failing one keeps its own error. Every batch sets its transaction read-only first:
+    // ANALYZE really executes the statement and profiling an UPDATE shouldn't change anything.
+    struct QueryProfiler final
+    {
+        QueryProfiler(DatabaseConnection& connection, std::vector<std::string> statements) noexcept;
+        ~QueryProfiler() noexcept;  // cancels the task if it still runs
+
+        QueryProfiler(const QueryProfiler&)            = delete;
+        QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+        // Collects the plans once the task is done, call every frame.
+        void Poll() noexcept;
+
+        bool IsFinished() const noexcept { return m_bFinished; }
+        void Cancel() noexcept;
+
+        // Running task, for progress display. nullptr once finished.
+        const QueryHandle& GetTask() const noexcept { return m_Task; }
+
+        // One plan per statement in order, filled once finished. Failed statements have Error set and no nodes.
+        const std::vector<QueryPlan>& GetPlans() const noexcept { return m_Plans; }
+
+        // Set when the whole task failed or was cancelled rather than a single statement.
+        const std::string& GetError() const noexcept { return m_Error; }
+
+      private:
+        DatabaseConnection& m_Connection;
+        QueryHandle m_Task{nullptr};
+        std::vector<QueryPlan> m_Plans{};
+        std::string m_Error{};
+        bool m_bFinished{false};
+    };
+
+    // Plan from the rows of the profiler's flattening query.
+    QueryPlan BuildQueryPlan(std::string sql, const QueryResult& result) noexcept;
+
+}  // namespace nsudb
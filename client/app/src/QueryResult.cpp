@@ -0,0 +1,407 @@
+#include "QueryResult.hpp"
+
+#include <bit>
+#include <charconv>
+
+namespace nsudb
+{
+
+    static constexpr int64_t s_PostgresEpochDays  = 10957;  // 1970-01-01 -> 2000-01-01
+    static constexpr int64_t s_MicrosecondsPerDay = 86'400'000'000;
+
+    static constexpr auto s_PowersOf10 = []
+    {
+        std::array<int64_t, 19> powers{1};
+        for (std::size_t i = 1; i < powers.size(); ++i)
+            powers[i] = powers[i - 1] * 10;
+        return powers;
+    }();
+
+    // Zero-padded to at least `width` digits, snprintf is most of the formatting cost otherwise.
+    static char* WritePadded(char* out, uint64_t value, int32_t width) noexcept
+    {
+        char digits[24]{};
+        const auto [digitsEnd, errorCode] = std::to_chars(digits, digits + sizeof(digits), value);
+        for (int32_t i = static_cast<int32_t>(digitsEnd - digits); i < width; ++i)
+            *out++ = '0';
+
+        return std::copy(digits, digitsEnd, out);
+    }
+
+    // Proleptic Gregorian date from days since 1970-01-01, see http://howardhinnant.github.io/date_algorithms.html
+    static void CivilFromDays(int64_t days, int64_t& year, uint32_t& month, uint32_t& day) noexcept
+    {
+        days += 719468;
+        const int64_t era         = (days >= 0 ? days : days - 146096) / 146097;
+        const uint32_t dayOfEra   = static_cast<uint32_t>(days - era * 146097);
+        const uint32_t yearOfEra  = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const uint32_t dayOfYear  = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+
+        day   = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year  = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+    }
+
+    static char* FormatDate(char* out, int64_t daysSincePostgresEpoch, bool& bBeforeChrist) noexcept
+    {
+        int64_t year{};
+        uint32_t month{}, day{};
+        CivilFromDays(daysSincePostgresEpoch + s_PostgresEpochDays, year, month, day);
+
+        // There is no year 0, PostgreSQL prints 1 BC for it.
+        bBeforeChrist = year <= 0;
+        if (bBeforeChrist) year = 1 - year;
+
+        out    = WritePadded(out, static_cast<uint64_t>(year), 4);
+        *out++ = '-';
+        out    = WritePadded(out, month, 2);
+        *out++ = '-';
+        return WritePadded(out, day, 2);
+    }
+
+    static std::string_view FormatTimestamp(int64_t microseconds, bool bWithTimeZone, QueryResult::FormatBuffer& buffer) noexcept
+    {
+        if (microseconds == std::numeric_limits<int64_t>::max()) return "infinity";
+        if (microseconds == std::numeric_limits<int64_t>::min()) return "-infinity";
+
+        int64_t days      = microseconds / s_MicrosecondsPerDay;
+        int64_t timeOfDay = microseconds % s_MicrosecondsPerDay;
+        if (timeOfDay < 0)
+        {
+            timeOfDay += s_MicrosecondsPerDay;
+            --days;
+        }
+
+        bool bBeforeChrist = false;
+        char* out          = FormatDate(buffer.data(), days, bBeforeChrist);
+
+        const uint64_t seconds = static_cast<uint64_t>(timeOfDay / 1'000'000);
+        *out++                 = ' ';
+        out                    = WritePadded(out, seconds / 3600, 2);
+        *out++                 = ':';
+        out                    = WritePadded(out, seconds / 60 % 60, 2);
+        *out++                 = ':';
+        out                    = WritePadded(out, seconds % 60, 2);
+
+        // Fraction is printed with trailing zeros trimmed, the same as the server does.
+        if (int64_t fraction = timeOfDay % 1'000'000; fraction != 0)
+        {
+            int32_t digitCount = 6;
+            while (fraction % 10 == 0)
+            {
+                fraction /= 10;
+                --digitCount;
+            }
+            *out++ = '.';
+            out    = WritePadded(out, static_cast<uint64_t>(fraction), digitCount);
+        }
+
+        // Binary timestamptz is UTC on the wire and the session TimeZone isn't known here, so it's always printed in UTC
+        // (the grid labels such columns), unlike the text format, which the server renders in the session TimeZone.
+        if (bWithTimeZone) out = std::copy_n("+00", 3, out);
+        if (bBeforeChrist) out = std::copy_n(" BC", 3, out);
+
+        return std::string_view(buffer.data(), out - buffer.data());
+    }
+
+    static std::string_view FormatFloat64(double value, QueryResult::FormatBuffer& buffer) noexcept
+    {
+        if (std::isnan(value)) return "NaN";
+        if (std::isinf(value)) return value > 0 ? "Infinity" : "-Infinity";
+
+        // Shortest round-trip digits, switching to exponent notation outside [1e-4, 1e15) like the server does.
+        const double magnitude         = std::abs(value);
+        const std::chars_format format = magnitude != 0.0 && (magnitude < 1e-4 || magnitude >= 1e15) ? std::chars_format::scientific
+                                                                                                        : std::chars_format::fixed;
+        const auto [end, errorCode]    = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, format);
+        return std::string_view(buffer.data(), end - buffer.data());
+    }
+
+    static std::string_view FormatNumeric(int64_t scaledValue, uint8_t scale, QueryResult::FormatBuffer& buffer) noexcept
+    {
+        if (scale == QueryResult::s_NumericAsFloat64) return FormatFloat64(std::bit_cast<double>(scaledValue), buffer);
+
+        // Digits of |value| (as unsigned, INT64_MIN included), then the point goes in front of the last `scale` of them.
+        char digits[24]{};
+        const uint64_t magnitude          = scaledValue < 0 ? 0 - static_cast<uint64_t>(scaledValue) : static_cast<uint64_t>(scaledValue);
+        const auto [digitsEnd, errorCode] = std::to_chars(digits, digits + sizeof(digits), magnitude);
+        const int32_t digitCount          = static_cast<int32_t>(digitsEnd - digits);
+
+        char* out = buffer.data();
+        if (scaledValue < 0) *out++ = '-';
+
+        const int32_t integerDigitCount = digitCount - scale;
+        if (integerDigitCount <= 0) *out++ = '0';
+        else
+            out = std::copy(digits, digits + integerDigitCount, out);
+
+        if (scale > 0)
+        {
+            *out++ = '.';
+            for (int32_t i = integerDigitCount; i < 0; ++i)
+                *out++ = '0';
+
+            out = std::copy(digits + std::max(integerDigitCount, 0), digitsEnd, out);
+        }
+
+        return std::string_view(buffer.data(), out - buffer.data());
+    }
+
+    QueryResult::QueryResult(std::vector<std::string> columnNames) noexcept
+    {
+        SetColumnNames(std::move(columnNames));
+    }
+
+    void QueryResult::SetColumnNames(std::vector<std::string> columnNames) noexcept
+    {
+        assert(m_RowCount == 0 && "Columns can't be changed once rows are appended!");
+
+        m_ColumnNames = std::move(columnNames);
+        m_Columns.assign(m_ColumnNames.size(), Column{});
+    }
+
+    void QueryResult::SetColumnType(std::size_t column, EColumnType type) noexcept
+    {
+        assert(m_RowCount == 0 && column < m_Columns.size() && "Column types can't be changed once rows are appended!");
+
+        m_Columns[column].Type = type;
+    }
+
+    void QueryResult::Reserve(std::size_t rowCount, std::size_t bytesPerCell) noexcept
+    {
+        for (auto& column : m_Columns)
+        {
+            column.NullBitmap.reserve((rowCount + 63) / 64);
+            if (column.Type != EColumnType::Text)
+            {
+                column.Values.reserve(rowCount);
+                if (column.Type == EColumnType::Numeric) column.NumericScales.reserve(rowCount);
+                continue;
+            }
+
+            column.Arena.reserve(rowCount * bytesPerCell);
+            column.Offsets.reserve(rowCount + 1);
+        }
+    }
+
+    void QueryResult::AppendValue(std::size_t column, std::string_view value) noexcept
+    {
+        assert(column < m_Columns.size());
+
+        auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Text && col.GetCellCount() == m_RowCount && "Cell appended twice into the same row!");
+
+        col.Arena.insert(col.Arena.end(), value.begin(), value.end());
+        col.Offsets.emplace_back(col.Arena.size());
+    }
+
+    void QueryResult::AppendNull(std::size_t column) noexcept
+    {
+        assert(column < m_Columns.size());
+
+        auto& col = m_Columns[column];
+        assert(col.GetCellCount() == m_RowCount && "Cell appended twice into the same row!");
+
+        const std::size_t wordIndex = m_RowCount / 64;
+        if (col.NullBitmap.size() <= wordIndex) col.NullBitmap.resize(wordIndex + 1, 0);
+        col.NullBitmap[wordIndex] |= uint64_t{1} << (m_RowCount % 64);
+
+        // Zero-length/zero value slot keeps the storage dense.
+        if (col.Type == EColumnType::Text)
+            col.Offsets.emplace_back(col.Arena.size());
+        else
+        {
+            col.Values.emplace_back(0);
+            if (col.Type == EColumnType::Numeric) col.NumericScales.emplace_back(0);
+        }
+    }
+
+    void QueryResult::AppendInt64(std::size_t column, int64_t value) noexcept
+    {
+        assert(column < m_Columns.size());
+
+        auto& col = m_Columns[column];
+        assert(col.Type != EColumnType::Text && col.Type != EColumnType::Float64 && col.Type != EColumnType::Numeric);
+        assert(col.GetCellCount() == m_RowCount && "Cell appended twice into the same row!");
+
+        col.Values.emplace_back(value);
+    }
+
+    void QueryResult::AppendFloat64(std::size_t column, double value) noexcept
+    {
+        assert(column < m_Columns.size());
+
+        auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Float64 && col.GetCellCount() == m_RowCount && "Cell appended twice into the same row!");
+
+        col.Values.emplace_back(std::bit_cast<int64_t>(value));
+    }
+
+    void QueryResult::AppendNumeric(std::size_t column, int64_t scaledValue, uint8_t scale) noexcept
+    {
+        assert(column < m_Columns.size());
+
+        auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Numeric && col.GetCellCount() == m_RowCount && "Cell appended twice into the same row!");
+
+        col.Values.emplace_back(scaledValue);
+        col.NumericScales.emplace_back(scale);
+    }
+
+    void QueryResult::CommitRow() noexcept
+    {
+#ifndef NDEBUG
+        for (const auto& col : m_Columns)
+            assert(col.GetCellCount() == m_RowCount + 1 && "Row committed with missing cells!");
+#endif
+
+        ++m_RowCount;
+    }
+
+    bool QueryResult::IsNull(std::size_t row, std::size_t column) const noexcept
+    {
+        assert(row < m_RowCount && column < m_Columns.size());
+
+        const auto& bitmap          = m_Columns[column].NullBitmap;
+        const std::size_t wordIndex = row / 64;
+        return wordIndex < bitmap.size() && (bitmap[wordIndex] >> (row % 64)) & 1;
+    }
+
+    std::string_view QueryResult::GetValue(std::size_t row, std::size_t column) const noexcept
+    {
+        if (IsNull(row, column)) return s_NullText;
+
+        const auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Text && "Typed columns have to go through FormatValue()!");
+
+        return std::string_view(col.Arena.data() + col.Offsets[row], col.Offsets[row + 1] - col.Offsets[row]);
+    }
+
+    std::string_view QueryResult::GetColumnArena(std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Text);
+
+        return std::string_view(col.Arena.data(), col.Arena.size());
+    }
+
+    std::span<const uint64_t> QueryResult::GetColumnOffsets(std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Text);
+
+        return std::span<const uint64_t>(col.Offsets.data(), m_RowCount + 1);
+    }
+
+    std::span<const int64_t> QueryResult::GetColumnValues(std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type != EColumnType::Text);
+
+        return std::span<const int64_t>(col.Values.data(), m_RowCount);
+    }
+
+    std::span<const uint8_t> QueryResult::GetColumnNumericScales(std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type == EColumnType::Numeric);
+
+        return std::span<const uint8_t>(col.NumericScales.data(), m_RowCount);
+    }
+
+    std::string_view QueryResult::FormatValue(std::size_t row, std::size_t column, FormatBuffer& buffer) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        if (col.Type == EColumnType::Text || IsNull(row, column)) return GetValue(row, column);
+
+        const int64_t value = col.Values[row];
+        switch (col.Type)
+        {
+            case EColumnType::Bool: return value ? "t" : "f";
+            case EColumnType::Int32:
+            case EColumnType::Int64:
+            {
+                const auto [end, errorCode] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+                return std::string_view(buffer.data(), end - buffer.data());
+            }
+            case EColumnType::Float64: return FormatFloat64(std::bit_cast<double>(value), buffer);
+            case EColumnType::Numeric: return FormatNumeric(value, col.NumericScales[row], buffer);
+            case EColumnType::Date:
+            {
+                if (value == std::numeric_limits<int32_t>::max()) return "infinity";
+                if (value == std::numeric_limits<int32_t>::min()) return "-infinity";
+
+                bool bBeforeChrist = false;
+                char* out          = FormatDate(buffer.data(), value, bBeforeChrist);
+                if (bBeforeChrist) out = std::copy_n(" BC", 3, out);
+
+                return std::string_view(buffer.data(), out - buffer.data());
+            }
+            case EColumnType::Timestamp: return FormatTimestamp(value, false, buffer);
+            case EColumnType::TimestampTz: return FormatTimestamp(value, true, buffer);
+            default: break;
+        }
+
+        return {};
+    }
+
+    int64_t QueryResult::GetInt64(std::size_t row, std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type != EColumnType::Text && row < m_RowCount);
+
+        if (col.Type == EColumnType::Float64) return static_cast<int64_t>(std::bit_cast<double>(col.Values[row]));
+        if (col.Type == EColumnType::Numeric)
+        {
+            const uint8_t scale = col.NumericScales[row];
+            if (scale == s_NumericAsFloat64) return static_cast<int64_t>(std::bit_cast<double>(col.Values[row]));
+
+            return scale < s_PowersOf10.size() ? col.Values[row] / s_PowersOf10[scale] : 0;
+        }
+
+        return col.Values[row];
+    }
+
+    double QueryResult::GetFloat64(std::size_t row, std::size_t column) const noexcept
+    {
+        const auto& col = m_Columns[column];
+        assert(col.Type != EColumnType::Text && row < m_RowCount);
+
+        if (col.Type == EColumnType::Float64) return std::bit_cast<double>(col.Values[row]);
+        if (col.Type == EColumnType::Numeric)
+        {
+            const uint8_t scale = col.NumericScales[row];
+            if (scale == s_NumericAsFloat64) return std::bit_cast<double>(col.Values[row]);
+
+            return static_cast<double>(col.Values[row]) / std::pow(10.0, scale);
+        }
+
+        return static_cast<double>(col.Values[row]);
+    }
+
+    std::size_t QueryResult::GetMemoryUsage() const noexcept
+    {
+        std::size_t memoryUsage{sizeof(*this) + m_Columns.capacity() * sizeof(Column)};
+        for (const auto& col : m_Columns)
+        {
+            memoryUsage += col.Arena.capacity();
+            memoryUsage += col.Offsets.capacity() * sizeof(col.Offsets[0]);
+            memoryUsage += col.NullBitmap.capacity() * sizeof(col.NullBitmap[0]);
+            memoryUsage += col.Values.capacity() * sizeof(col.Values[0]);
+            memoryUsage += col.NumericScales.capacity();
+        }
+
+        return memoryUsage;
+    }
+
+    std::size_t QueryResult::GetDataSize() const noexcept
+    {
+        std::size_t dataSize{0};
+        for (const auto& col : m_Columns)
+            dataSize += col.Type == EColumnType::Text ? col.Arena.size() : col.Values.size() * sizeof(col.Values[0]);
+
+        return dataSize;
+    }
+
+}  // namespace nsudb
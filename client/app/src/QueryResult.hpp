@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nsudb
+{
+
+    // How a column is stored. Text columns keep the server's text (or text-like binary) bytes, the rest are decoded
+    // from binary results into fixed-width values and only turned into text when displayed.
+    enum class EColumnType : uint8_t
+    {
+        Text = 0,
+        Bool,
+        Int32,
+        Int64,
+        Float64,
+        Numeric,     // scaled int64 + per-value scale, exact up to 18 digits
+        Date,        // days since 2000-01-01
+        Timestamp,   // microseconds since 2000-01-01 00:00:00
+        TimestampTz  // same, in UTC, and formatted in UTC whatever the session TimeZone
+    };
+
+    // Column-major result store: every column keeps all of its values back to back in one arena,
+    // addressed through an offset array, NULLs are tracked in a bitmap. Rows are appended cell by cell
+    // and the whole thing costs a handful of (amortized) allocations per column instead of one per cell.
+    // Typed columns hold one 8 byte value per row instead, so they can be sorted/aggregated without parsing.
+    struct QueryResult final
+    {
+        static constexpr std::string_view s_NullText = "NULL";
+
+        // Enough for any typed value, the longest being a timestamp with microseconds or a 19 digit numeric.
+        using FormatBuffer = std::array<char, 48>;
+
+        QueryResult() noexcept = default;
+        explicit QueryResult(std::vector<std::string> columnNames) noexcept;
+        ~QueryResult() noexcept = default;
+
+        QueryResult(const QueryResult&)            = default;
+        QueryResult& operator=(const QueryResult&) = default;
+
+        QueryResult(QueryResult&&) noexcept            = default;
+        QueryResult& operator=(QueryResult&&) noexcept = default;
+
+        void SetColumnNames(std::vector<std::string> columnNames) noexcept;
+
+        // All columns start as Text, types have to be set before the first row.
+        void SetColumnType(std::size_t column, EColumnType type) noexcept;
+
+        // The server's type OID, 0 (the default) when unknown. Text-format results keep every column as Text,
+        // this is what still tells their numbers apart.
+        void SetColumnTypeOid(std::size_t column, uint32_t typeOid) noexcept { m_Columns[column].TypeOid = typeOid; }
+        uint32_t GetColumnTypeOid(std::size_t column) const noexcept { return m_Columns[column].TypeOid; }
+
+        // Optional hint, lets the builder size arenas up front when the row count is known.
+        void Reserve(std::size_t rowCount, std::size_t bytesPerCell = 16) noexcept;
+
+        // Cells of the current row are appended left to right, then CommitRow() seals it.
+        void AppendValue(std::size_t column, std::string_view value) noexcept;
+        void AppendNull(std::size_t column) noexcept;
+
+        // Typed cells: Bool/Int32/Int64/Date/Timestamp(Tz) take the integer, Float64 the double,
+        // Numeric the value scaled by 10^scale (scale == s_NumericAsFloat64 stores a double that didn't fit).
+        static constexpr uint8_t s_NumericAsFloat64 = 0xFF;
+        void AppendInt64(std::size_t column, int64_t value) noexcept;
+        void AppendFloat64(std::size_t column, double value) noexcept;
+        void AppendNumeric(std::size_t column, int64_t scaledValue, uint8_t scale) noexcept;
+        void CommitRow() noexcept;
+
+        bool IsEmpty() const noexcept { return m_RowCount == 0; }
+        std::size_t GetRowCount() const noexcept { return m_RowCount; }
+        std::size_t GetColumnCount() const noexcept { return m_ColumnNames.size(); }
+        const std::vector<std::string>& GetColumnNames() const noexcept { return m_ColumnNames; }
+        EColumnType GetColumnType(std::size_t column) const noexcept { return m_Columns[column].Type; }
+
+        bool IsNull(std::size_t row, std::size_t column) const noexcept;
+
+        // Text columns only. View into the column arena, valid as long as the result is alive and not appended to.
+        // NULL yields s_NullText.
+        std::string_view GetValue(std::size_t row, std::size_t column) const noexcept;
+
+        // Text columns only: every value back to back (NULLs are empty) and where each row's value starts,
+        // GetRowCount() + 1 offsets. Lets a scan run over the whole column at once instead of cell by cell.
+        std::string_view GetColumnArena(std::size_t column) const noexcept;
+        std::span<const uint64_t> GetColumnOffsets(std::size_t column) const noexcept;
+
+        // Typed columns only: one raw value per row (doubles bit-cast, NULLs hold 0) and, Numeric only, the scales.
+        std::span<const int64_t> GetColumnValues(std::size_t column) const noexcept;
+        std::span<const uint8_t> GetColumnNumericScales(std::size_t column) const noexcept;
+
+        // Any column, typed values are formatted into the buffer the way PostgreSQL prints them,
+        // so the view is only valid until the buffer is reused.
+        std::string_view FormatValue(std::size_t row, std::size_t column, FormatBuffer& buffer) const noexcept;
+
+        // Typed columns, numeric/date/timestamp converted to a plain number (days/microseconds for the latter).
+        int64_t GetInt64(std::size_t row, std::size_t column) const noexcept;
+        double GetFloat64(std::size_t row, std::size_t column) const noexcept;
+
+        // Bytes held by arenas, offsets and bitmaps (capacity, not size).
+        std::size_t GetMemoryUsage() const noexcept;
+
+        // Bytes of the values themselves: text as received, 8 per typed value. What throughput figures are counted in.
+        std::size_t GetDataSize() const noexcept;
+
+      private:
+        struct Column final
+        {
+            std::vector<char> Arena{};
+            std::vector<uint64_t> Offsets{0};  // value i lives in [Offsets[i], Offsets[i + 1])
+            std::vector<uint64_t> NullBitmap{};
+
+            EColumnType Type{EColumnType::Text};
+            uint32_t TypeOid{0};
+            std::vector<int64_t> Values{};         // typed columns, doubles are stored bit-cast
+            std::vector<uint8_t> NumericScales{};  // Numeric only
+
+            std::size_t GetCellCount() const noexcept { return Type == EColumnType::Text ? Offsets.size() - 1 : Values.size(); }
+        };
+
+        std::vector<std::string> m_ColumnNames{};
+        std::vector<Column> m_Columns{};
+        std::size_t m_RowCount{0};
+    };
+
+}  // namespace nsudb
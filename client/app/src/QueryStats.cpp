@@ -0,0 +1,282 @@
+#include "QueryStats.hpp"
+#include <Logger.hpp>
+
+#include <bit>
+#include <cstdlib>
+#include <new>
+
+namespace nsudb
+{
+
+#ifdef NSUDB_COUNT_ALLOCATIONS
+    static thread_local uint64_t s_ThreadAllocationCount{0};
+#endif
+
+    uint64_t GetThreadAllocationCount() noexcept
+    {
+#ifdef NSUDB_COUNT_ALLOCATIONS
+        return s_ThreadAllocationCount;
+#else
+        return 0;
+#endif
+    }
+
+}  // namespace nsudb
+
+#ifdef NSUDB_COUNT_ALLOCATIONS
+// Counting replacements, a thread-local increment on top of malloc. The array and nothrow forms call these.
+void* operator new(std::size_t size)
+{
+    ++nsudb::s_ThreadAllocationCount;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace nsudb
+{
+
+    std::size_t StatsHistogram::GetBucketIndex(uint64_t value) noexcept
+    {
+        if (value < s_LinearBucketCount) return static_cast<std::size_t>(value);
+
+        // Top bit picks the power of two, the next s_SubBucketBits bits the bucket within it.
+        const std::size_t exponent    = static_cast<std::size_t>(std::bit_width(value)) - 1;
+        const std::size_t subBucket   = static_cast<std::size_t>(value >> (exponent - s_SubBucketBits)) & ((1 << s_SubBucketBits) - 1);
+        const std::size_t bucketIndex = s_LinearBucketCount + ((exponent - 4) << s_SubBucketBits) + subBucket;
+        return std::min(bucketIndex, s_BucketCount - 1);
+    }
+
+    uint64_t StatsHistogram::GetBucketUpperBound(std::size_t bucketIndex) noexcept
+    {
+        if (bucketIndex < s_LinearBucketCount) return bucketIndex;
+
+        const std::size_t exponent  = 4 + ((bucketIndex - s_LinearBucketCount) >> s_SubBucketBits);
+        const std::size_t subBucket = (bucketIndex - s_LinearBucketCount) & ((1 << s_SubBucketBits) - 1);
+        const uint64_t bucketWidth  = uint64_t{1} << (exponent - s_SubBucketBits);
+        return (((uint64_t{1} << s_SubBucketBits) + subBucket) * bucketWidth) + bucketWidth - 1;
+    }
+
+    void StatsHistogram::Record(uint64_t value) noexcept
+    {
+        m_Buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t max = m_Max.load(std::memory_order_relaxed);
+        while (value > max && !m_Max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            ;
+    }
+
+    void StatsHistogram::Reset() noexcept
+    {
+        for (auto& bucket : m_Buckets)
+            bucket.store(0, std::memory_order_relaxed);
+
+        m_Count.store(0, std::memory_order_relaxed);
+        m_Sum.store(0, std::memory_order_relaxed);
+        m_Max.store(0, std::memory_order_relaxed);
+    }
+
+    double StatsHistogram::GetMean() const noexcept
+    {
+        const uint64_t count = GetCount();
+        return count == 0 ? 0.0 : static_cast<double>(m_Sum.load(std::memory_order_relaxed)) / count;
+    }
+
+    uint64_t StatsHistogram::GetPercentile(double percentile) const noexcept
+    {
+        // Buckets may be mid-update, so the rank is taken from their own sum rather than m_Count.
+        std::array<uint64_t, s_BucketCount> counts{};
+        uint64_t totalCount{0};
+        for (std::size_t i{}; i < s_BucketCount; ++i)
+        {
+            counts[i] = m_Buckets[i].load(std::memory_order_relaxed);
+            totalCount += counts[i];
+        }
+        if (totalCount == 0) return 0;
+
+        const double exactRank = std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(totalCount);
+        const uint64_t rank    = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(exactRank)));
+        uint64_t seenCount{0};
+        for (std::size_t i{}; i < s_BucketCount; ++i)
+        {
+            seenCount += counts[i];
+            if (seenCount >= rank) return std::min(GetBucketUpperBound(i), GetMax());
+        }
+
+        return GetMax();
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> StatsHistogram::GetBuckets() const noexcept
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> buckets{};
+        for (std::size_t i{}; i < s_BucketCount; ++i)
+        {
+            const uint64_t count = m_Buckets[i].load(std::memory_order_relaxed);
+            if (count != 0) buckets.emplace_back(GetBucketUpperBound(i), count);
+        }
+
+        return buckets;
+    }
+
+    void QueryStats::Record(QueryTiming timing) noexcept
+    {
+        for (std::size_t i{}; i < m_Histograms.size(); ++i)
+            m_Histograms[i].Record(timing.Values[i]);
+        if (!timing.bSucceeded) m_FailedCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::scoped_lock lock(m_RecentMutex);
+        if (m_Recent.size() < s_RecentCount)
+            m_Recent.emplace_back(std::move(timing));
+        else
+            m_Recent[m_NextRecentIndex] = std::move(timing);
+        m_NextRecentIndex = (m_NextRecentIndex + 1) % s_RecentCount;
+    }
+
+    void QueryStats::Reset() noexcept
+    {
+        for (auto& histogram : m_Histograms)
+            histogram.Reset();
+        m_FailedCount.store(0, std::memory_order_relaxed);
+        m_CacheHitCount.store(0, std::memory_order_relaxed);
+
+        std::scoped_lock lock(m_RecentMutex);
+        m_Recent.clear();
+        m_NextRecentIndex = 0;
+    }
+
+    std::vector<QueryTiming> QueryStats::GetSlowestRecent(std::size_t count) const noexcept
+    {
+        std::vector<QueryTiming> slowest{};
+        {
+            std::scoped_lock lock(m_RecentMutex);
+            slowest = m_Recent;
+        }
+
+        const auto byTotalTime = [](const QueryTiming& lhs, const QueryTiming& rhs)
+        { return lhs.Get(EQueryMetric::TotalTime) > rhs.Get(EQueryMetric::TotalTime); };
+        const std::size_t slowestCount = std::min(count, slowest.size());
+        std::partial_sort(slowest.begin(), slowest.begin() + slowestCount, slowest.end(), byTotalTime);
+        slowest.resize(slowestCount);
+
+        return slowest;
+    }
+
+    std::string_view QueryStats::GetMetricName(EQueryMetric metric) noexcept
+    {
+        switch (metric)
+        {
+            case EQueryMetric::QueueTime: return "queue_us";
+            case EQueryMetric::AcquireTime: return "acquire_us";
+            case EQueryMetric::ServerTime: return "server_us";
+            case EQueryMetric::TransferTime: return "transfer_us";
+            case EQueryMetric::BuildTime: return "build_us";
+            case EQueryMetric::TotalTime: return "total_us";
+            case EQueryMetric::Rows: return "rows";
+            case EQueryMetric::Bytes: return "bytes";
+            case EQueryMetric::Allocations: return "allocations";
+            default: return "unknown";
+        }
+    }
+
+    void WriteJsonString(std::FILE* file, std::string_view text) noexcept
+    {
+        std::fputc('"', file);
+        for (const char c : text)
+        {
+            switch (c)
+            {
+                case '"': std::fputs("\\\"", file); break;
+                case '\\': std::fputs("\\\\", file); break;
+                case '\n': std::fputs("\\n", file); break;
+                case '\r': std::fputs("\\r", file); break;
+                case '\t': std::fputs("\\t", file); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        std::fprintf(file, "\\u%04x", static_cast<uint32_t>(c));
+                    else
+                        std::fputc(c, file);
+            }
+        }
+        std::fputc('"', file);
+    }
+
+    bool QueryStats::WriteJson(const std::filesystem::path& path) const noexcept
+    {
+        const bool bStdout = path == "-";
+        std::FILE* file    = bStdout ? stdout : std::fopen(path.string().c_str(), "wb");
+        if (!file)
+        {
+            LOG_ERROR("Failed to open {} for writing", path.string());
+            return false;
+        }
+
+        const auto timestamp = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+        std::fprintf(file, "{\n  \"unix_time\": %lld,\n  \"failed\": %llu,\n  \"cache_hits\": %llu,\n  \"metrics\": {",
+                     static_cast<long long>(timestamp), static_cast<unsigned long long>(GetFailedCount()),
+                     static_cast<unsigned long long>(GetCacheHitCount()));
+
+        for (std::size_t i{}; i < m_Histograms.size(); ++i)
+        {
+            if (!IsMetricCollected(static_cast<EQueryMetric>(i))) continue;
+
+            const StatsHistogram& histogram = m_Histograms[i];
+            std::fprintf(file, "%s\n    \"%s\": {\n", i == 0 ? "" : ",", GetMetricName(static_cast<EQueryMetric>(i)).data());
+            std::fprintf(file,
+                         "      \"count\": %llu,\n      \"mean\": %.1f,\n      \"p50\": %llu,\n      \"p95\": %llu,\n      \"p99\": %llu,\n"
+                         "      \"max\": %llu,\n      \"buckets\": [",
+                         static_cast<unsigned long long>(histogram.GetCount()), histogram.GetMean(),
+                         static_cast<unsigned long long>(histogram.GetPercentile(50.0)),
+                         static_cast<unsigned long long>(histogram.GetPercentile(95.0)),
+                         static_cast<unsigned long long>(histogram.GetPercentile(99.0)),
+                         static_cast<unsigned long long>(histogram.GetMax()));
+
+            // [upper bound, count] pairs.
+            const auto buckets = histogram.GetBuckets();
+            for (std::size_t bucket{}; bucket < buckets.size(); ++bucket)
+                std::fprintf(file, "%s[%llu, %llu]", bucket == 0 ? "" : ", ", static_cast<unsigned long long>(buckets[bucket].first),
+                             static_cast<unsigned long long>(buckets[bucket].second));
+            std::fprintf(file, "]\n    }");
+        }
+
+        std::fprintf(file, "\n  },\n  \"recent\": [");
+        const std::vector<QueryTiming> recent = GetSlowestRecent(s_RecentCount);
+        for (std::size_t i{}; i < recent.size(); ++i)
+        {
+            const QueryTiming& timing = recent[i];
+            const auto finishTime     = std::chrono::floor<std::chrono::milliseconds>(timing.FinishTime).time_since_epoch().count();
+            std::fprintf(file, "%s\n    {\"unix_time_ms\": %lld, \"ok\": %s, \"statements\": %zu", i == 0 ? "" : ",",
+                         static_cast<long long>(finishTime), timing.bSucceeded ? "true" : "false", timing.StatementCount);
+            for (std::size_t metric{}; metric < timing.Values.size(); ++metric)
+            {
+                if (!IsMetricCollected(static_cast<EQueryMetric>(metric))) continue;
+
+                std::fprintf(file, ", \"%s\": %llu", GetMetricName(static_cast<EQueryMetric>(metric)).data(),
+                             static_cast<unsigned long long>(timing.Values[metric]));
+            }
+            std::fprintf(file, ", \"sql\": ");
+            WriteJsonString(file, timing.Sql);
+            std::fputc('}', file);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+
+        const bool bWritten = std::ferror(file) == 0;
+        if (!bStdout) std::fclose(file);
+        if (!bWritten) LOG_ERROR("Failed to write {}", path.string());
+
+        return bWritten;
+    }
+
+}  // namespace nsudb
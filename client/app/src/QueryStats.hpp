@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nsudb
+{
+
+    // Lock-free log-linear histogram of non-negative integers: exact below 16, then 8 buckets per power of two,
+    // so any percentile is off by at most 1/8 of its value. Writers never wait, readers see a consistent-enough snapshot.
+    struct StatsHistogram final
+    {
+        static constexpr std::size_t s_LinearBucketCount = 16;
+        static constexpr std::size_t s_SubBucketBits     = 3;
+        static constexpr std::size_t s_BucketCount       = s_LinearBucketCount + (64 - 4) * (1 << s_SubBucketBits);
+
+        void Record(uint64_t value) noexcept;
+        void Reset() noexcept;
+
+        uint64_t GetCount() const noexcept { return m_Count.load(std::memory_order_relaxed); }
+        uint64_t GetMax() const noexcept { return m_Max.load(std::memory_order_relaxed); }
+        double GetMean() const noexcept;
+
+        // Upper bound of the bucket holding the percentile (0..100), clamped to the largest value seen.
+        uint64_t GetPercentile(double percentile) const noexcept;
+
+        // Non-empty buckets as (upper bound, count), for dumps.
+        std::vector<std::pair<uint64_t, uint64_t>> GetBuckets() const noexcept;
+
+      private:
+        std::array<std::atomic<uint64_t>, s_BucketCount> m_Buckets{};
+        std::atomic<uint64_t> m_Count{0};
+        std::atomic<uint64_t> m_Sum{0};
+        std::atomic<uint64_t> m_Max{0};
+
+        static std::size_t GetBucketIndex(uint64_t value) noexcept;
+        static uint64_t GetBucketUpperBound(std::size_t bucketIndex) noexcept;
+    };
+
+    // What is measured per query. Times are in microseconds.
+    enum class EQueryMetric : uint8_t
+    {
+        QueueTime = 0,  // submitted -> picked up by a worker
+        AcquireTime,    // waiting for a pooled connection, connecting included
+        ServerTime,     // statements sent -> first row (or completion) back, prepare round trips included
+        TransferTime,   // first row -> last row, minus the build time
+        BuildTime,      // appending rows to the QueryResult
+        TotalTime,      // submitted -> finished
+        Rows,
+        Bytes,        // QueryResult::GetDataSize() of the result
+        Allocations,  // heap allocations made by the worker while running the query, NSUDB_COUNT_ALLOCATIONS builds only
+        Count
+    };
+
+    // Phase times of a running task, written by the worker thread only.
+    struct QueryPhaseTimes final
+    {
+        int64_t AcquireNs{0};
+        int64_t ServerNs{0};
+        int64_t TransferNs{0};
+        int64_t BuildNs{0};
+    };
+
+    // One finished query, kept in the recent list.
+    struct QueryTiming final
+    {
+        static constexpr std::size_t s_MaxSqlLength = 256;
+
+        std::string Sql{};  // first statement, cut to s_MaxSqlLength
+        std::size_t StatementCount{0};
+        std::array<uint64_t, static_cast<std::size_t>(EQueryMetric::Count)> Values{};
+        std::chrono::system_clock::time_point FinishTime{};
+        bool bSucceeded{true};
+
+        uint64_t Get(EQueryMetric metric) const noexcept { return Values[static_cast<std::size_t>(metric)]; }
+        void Set(EQueryMetric metric, uint64_t value) noexcept { Values[static_cast<std::size_t>(metric)] = value; }
+    };
+
+    // Per-connection query instrumentation: a histogram per metric and the last s_RecentCount queries.
+    // Recording costs a few relaxed atomic adds plus a short lock on the recent list, once per query.
+    struct QueryStats final
+    {
+        static constexpr std::size_t s_RecentCount = 256;
+
+        QueryStats() noexcept  = default;
+        ~QueryStats() noexcept = default;
+
+        QueryStats(const QueryStats&)            = delete;
+        QueryStats& operator=(const QueryStats&) = delete;
+
+        void Record(QueryTiming timing) noexcept;
+        void RecordCacheHit() noexcept { m_CacheHitCount.fetch_add(1, std::memory_order_relaxed); }
+        void Reset() noexcept;
+
+        const StatsHistogram& GetHistogram(EQueryMetric metric) const noexcept { return m_Histograms[static_cast<std::size_t>(metric)]; }
+        uint64_t GetFailedCount() const noexcept { return m_FailedCount.load(std::memory_order_relaxed); }
+        uint64_t GetCacheHitCount() const noexcept { return m_CacheHitCount.load(std::memory_order_relaxed); }
+
+        // Of the recent queries, the slowest first by TotalTime.
+        std::vector<QueryTiming> GetSlowestRecent(std::size_t count) const noexcept;
+
+        // Percentiles, non-empty buckets and the recent queries as JSON. "-" writes to stdout.
+        bool WriteJson(const std::filesystem::path& path) const noexcept;
+
+        static std::string_view GetMetricName(EQueryMetric metric) noexcept;
+        static bool IsTimeMetric(EQueryMetric metric) noexcept { return metric <= EQueryMetric::TotalTime; }
+
+        // Allocations are only counted in NSUDB_COUNT_ALLOCATIONS builds, the others always.
+        static bool IsMetricCollected(EQueryMetric metric) noexcept
+        {
+#ifdef NSUDB_COUNT_ALLOCATIONS
+            return true;
+#else
+            return metric != EQueryMetric::Allocations;
+#endif
+        }
+
+      private:
+        std::array<StatsHistogram, static_cast<std::size_t>(EQueryMetric::Count)> m_Histograms{};
+        std::atomic<uint64_t> m_FailedCount{0};
+        std::atomic<uint64_t> m_CacheHitCount{0};
+
+        mutable std::mutex m_RecentMutex{};
+        std::vector<QueryTiming> m_Recent{};  // ring buffer once full
+        std::size_t m_NextRecentIndex{0};
+    };
+
+    // Heap allocations made on the calling thread so far. Only counted when built with NSUDB_COUNT_ALLOCATIONS,
+    // which replaces the global operator new; always 0 otherwise.
+    uint64_t GetThreadAllocationCount() noexcept;
+
+    // Quoted and escaped JSON string.
+    void WriteJsonString(std::FILE* file, std::string_view text) noexcept;
+
+}  // namespace nsudb
@@ -0,0 +1,478 @@
+#include "ReportQueries.hpp"
+#include <Logger.hpp>
+
+namespace nsudb
+{
+
+    // Full days of [from_time, to_time] are read from the daily rollups (11-daily-rollups.sql), only the partial days at the
+    // edges from raw rows: accept_time < full_from or >= full_to. No full day in between means full_to <= full_from, then
+    // the rollup side matches nothing and the raw side everything. Days still marked in daily_rollup_dirty are read raw too,
+    // so the report never waits for refresh_daily_rollups() and sees the same snapshot on both sides.
+    static constexpr std::string_view s_RollupBounds = R"(WITH bounds AS (
+           SELECT date_trunc('day', :from_time::timestamp - INTERVAL '1 microsecond') + INTERVAL '1 day' AS full_from,
+                  date_trunc('day', :to_time::timestamp) AS full_to
+       ),
+       dirty AS (
+           SELECT DISTINCT day, outlet_id FROM daily_rollup_dirty
+       ),
+       )";
+
+    // [from_time, to_time] on the partition key of each given table (13-monthly-partitions.sql: orders by accept_time, its
+    // children by order_accept_time), continued at the indentation of a WHERE inside a CTE. The planner prunes a partitioned
+    // table only by conditions on its own key: joining a child on the parent's key doesn't carry the parent's range over,
+    // and a child without one is read in every month. The joins match the key too, so a nested loop prunes per outer row.
+    static std::string BuildAcceptTimeFilter(std::initializer_list<std::string_view> keyColumns) noexcept
+    {
+        std::string filter{};
+        for (const auto keyColumn : keyColumns)
+        {
+            if (!filter.empty()) filter += "\n             AND ";
+
+            filter += std::string(keyColumn) + " BETWEEN :from_time::timestamp AND :to_time::timestamp";
+        }
+
+        return filter;
+    }
+
+    // Report 5 for one set of outlets, given as a subquery.
+    static std::string BuildPrintedPhotosSql(std::string_view outletFilter) noexcept
+    {
+        return std::string(s_RollupBounds) + R"(printed AS (
+           SELECT r.is_urgent, r.printed_photos
+           FROM daily_print_rollups r
+           CROSS JOIN bounds b
+           WHERE r.day >= b.full_from AND r.day < b.full_to
+             AND NOT EXISTS (SELECT 1 FROM dirty d WHERE d.day = r.day AND d.outlet_id = r.outlet_id)
+             AND r.outlet_id IN ()" + std::string(outletFilter) + R"()
+           UNION ALL
+           SELECT o.is_urgent, f.amount
+           FROM frames f
+           JOIN print_orders po ON f.print_order_id = po.id AND f.order_accept_time = po.order_accept_time
+           JOIN orders o ON po.order_id = o.id AND po.order_accept_time = o.accept_time
+           CROSS JOIN bounds b
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time", "po.order_accept_time", "f.order_accept_time"}) + R"(
+             AND (o.accept_time < b.full_from OR o.accept_time >= b.full_to
+                  OR (o.accept_time::date, o.outlet_id) IN (SELECT day, outlet_id FROM dirty))
+             AND o.outlet_id IN ()" + std::string(outletFilter) + R"()
+       )
+       SELECT is_urgent, SUM(printed_photos)::bigint AS total_printed_photos
+       FROM printed
+       GROUP BY is_urgent;)";
+    }
+
+    // Report 6 for one outlet, given as a subquery. Rollup rows without films are skipped, the raw report has no such groups.
+    static std::string BuildFilmsDevelopedSql(std::string_view outletFilter) noexcept
+    {
+        return std::string(s_RollupBounds) + R"(developed AS (
+           SELECT r.is_urgent, r.film_count
+           FROM daily_service_rollups r
+           CROSS JOIN bounds b
+           WHERE r.day >= b.full_from AND r.day < b.full_to
+             AND NOT EXISTS (SELECT 1 FROM dirty d WHERE d.day = r.day AND d.outlet_id = r.outlet_id)
+             AND r.film_count > 0
+             AND r.outlet_id IN ()" + std::string(outletFilter) + R"()
+           UNION ALL
+           SELECT o.is_urgent, 1
+           FROM films f
+           JOIN service_orders so ON f.service_order_id = so.id AND f.order_accept_time = so.order_accept_time
+           JOIN orders o ON o.id = so.order_id AND o.accept_time = so.order_accept_time
+           CROSS JOIN bounds b
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time", "so.order_accept_time"}) + R"(
+             AND (o.accept_time < b.full_from OR o.accept_time >= b.full_to
+                  OR (o.accept_time::date, o.outlet_id) IN (SELECT day, outlet_id FROM dirty))
+             AND o.outlet_id IN ()" + std::string(outletFilter) + R"()
+       )
+       SELECT is_urgent, SUM(film_count)::bigint AS total_films
+       FROM developed
+       GROUP BY is_urgent;)";
+    }
+
+    std::vector<ReportQuery> CreateReportQueries() noexcept
+    {
+        // Defaults are the literals the reports used to have spliced in.
+        const ReportParam fromTime{"from_time", "2024-05-20 10:00:00"};
+        const ReportParam toTime{"to_time", "2024-05-22 16:45:00"};
+        const ReportParam yearFromTime{"from_time", "2024-01-01 10:00:00"};
+        const ReportParam yearToTime{"to_time", "2024-12-30 16:45:00"};
+
+        return {
+            // 1
+            {"1. Branches",
+             {R"(SELECT b.outlet_id, o.address, ot.name AS outlet_type
+       FROM branches b
+       JOIN outlets o ON b.outlet_id = o.id
+       JOIN outlet_types ot ON o.type_id = ot.id;)"},
+             {}},
+
+            {"1. Kiosks",
+             {R"(SELECT k.outlet_id, o.address, ot.name AS outlet_type, k.branch_id
+       FROM kiosks k
+       JOIN outlets o ON k.outlet_id = o.id
+       JOIN outlet_types ot ON o.type_id = ot.id;)"},
+             {}},
+
+            {"1. All order points",
+             {R"(SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
+       FROM outlets o
+       JOIN outlet_types ot ON o.type_id = ot.id;)"},
+             {}},
+
+            {"1. Order point count", {R"(SELECT COUNT(*) AS total_order_points FROM outlets;)"}, {}},
+
+            // 2
+            {"2. Orders per branch",
+             {R"(SELECT b.outlet_id AS branch_outlet_id,
+              COUNT(o.id) AS orders_count
+       FROM branches b
+       LEFT JOIN orders o ON o.outlet_id = b.outlet_id
+           AND )" + BuildAcceptTimeFilter({"o.accept_time"}) + R"(
+       GROUP BY b.outlet_id
+       ORDER BY b.outlet_id;)"},
+             {fromTime, toTime}},
+
+            {"2. Orders per kiosk",
+             {R"(SELECT k.outlet_id AS kiosk_outlet_id,
+              COUNT(o.id) AS orders_count
+       FROM kiosks k
+       LEFT JOIN orders o ON o.outlet_id = k.outlet_id
+           AND )" + BuildAcceptTimeFilter({"o.accept_time"}) + R"(
+       GROUP BY k.outlet_id
+       ORDER BY k.outlet_id;)"},
+             {fromTime, toTime}},
+
+            {"2. Orders total",
+             {R"(SELECT COUNT(*) AS total_orders
+       FROM orders
+       WHERE )" + BuildAcceptTimeFilter({"accept_time"}) + R"(;)"},
+             {fromTime, toTime}},
+
+            // 3
+            {"3. Orders by service and urgency",
+             {R"(WITH filtered_orders AS (
+           SELECT o.*, so.service_type_id, so.count, so.id AS service_order_id
+           FROM orders o
+           LEFT JOIN service_orders so ON o.id = so.order_id AND so.order_accept_time = o.accept_time
+               AND )" + BuildAcceptTimeFilter({"so.order_accept_time"}) + R"(
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time"}) + R"(
+             AND o.outlet_id = ANY(:outlet_ids::int[])
+       )
+       SELECT fo.service_type_id,
+              st.name AS service_name,
+              fo.is_urgent,
+              COUNT(DISTINCT fo.id) AS orders_count
+       FROM filtered_orders fo
+       LEFT JOIN service_types st ON fo.service_type_id = st.id
+       GROUP BY fo.service_type_id, st.name, fo.is_urgent
+       ORDER BY st.name, fo.is_urgent;)"},
+             {fromTime, toTime, {"outlet_ids", "{1,3}"}}},
+
+            // 4, used to go through CREATE OR REPLACE VIEW, which can't take parameters
+            {"4. Revenue by service and urgency",
+             {std::string(s_RollupBounds) + R"(service_order_sums AS (
+           SELECT r.is_urgent, r.service_type_id, r.order_revenue AS revenue
+           FROM daily_service_rollups r
+           CROSS JOIN bounds b
+           WHERE r.day >= b.full_from AND r.day < b.full_to
+             AND NOT EXISTS (SELECT 1 FROM dirty d WHERE d.day = r.day AND d.outlet_id = r.outlet_id)
+             AND r.outlet_id = ANY(:outlet_ids::int[])
+           UNION ALL
+           SELECT o.is_urgent, so.service_type_id, o.overall_price
+           FROM orders o
+           JOIN service_orders so ON o.id = so.order_id AND so.order_accept_time = o.accept_time
+           CROSS JOIN bounds b
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time", "so.order_accept_time"}) + R"(
+             AND (o.accept_time < b.full_from OR o.accept_time >= b.full_to
+                  OR (o.accept_time::date, o.outlet_id) IN (SELECT day, outlet_id FROM dirty))
+             AND o.outlet_id = ANY(:outlet_ids::int[])
+       )
+       SELECT sos.service_type_id,
+              st.name AS service_name,
+              sos.is_urgent,
+              SUM(sos.revenue) AS revenue
+       FROM service_order_sums sos
+       JOIN service_types st ON sos.service_type_id = st.id
+       GROUP BY sos.service_type_id, st.name, sos.is_urgent
+       ORDER BY st.name, sos.is_urgent;)"},
+             {fromTime, toTime, {"outlet_ids", "{1,3}"}},
+             true},
+
+            // 5
+            {"5. Printed photos (branches, kiosks, all)",
+             {BuildPrintedPhotosSql("SELECT outlet_id FROM branches"), BuildPrintedPhotosSql("SELECT outlet_id FROM kiosks"),
+              BuildPrintedPhotosSql("SELECT id FROM outlets")},
+             {yearFromTime, yearToTime},
+             true},
+
+            // 6
+            {"6. Films developed (branch, kiosk)",
+             {BuildFilmsDevelopedSql("SELECT outlet_id FROM branches WHERE outlet_id = :branch_outlet_id"),
+              BuildFilmsDevelopedSql("SELECT outlet_id FROM kiosks WHERE outlet_id = :kiosk_outlet_id")},
+             {yearFromTime, yearToTime, {"branch_outlet_id", "1"}, {"kiosk_outlet_id", "3"}},
+             true},
+
+            // 7
+            {"7. Vendor deliveries",
+             {R"(SELECT DISTINCT v.id AS vendor_id, v.name AS vendor_name,
+                      i.id AS item_id, i.name AS item_name,
+                      di.quantity, di.price, d.date
+       FROM vendors v
+       JOIN deliveries d ON d.vendor_id = v.id
+       JOIN delivery_items di ON di.delivery_id = d.id
+       JOIN items i ON i.id = di.item_id
+       WHERE d.date BETWEEN :from_time::timestamp AND :to_time::timestamp
+         AND di.quantity >= :min_quantity
+       ORDER BY v.id;)"},
+             {yearFromTime, yearToTime, {"min_quantity", "2"}}},
+
+            // 8
+            {"8. Discounted clients",
+             {R"(SELECT DISTINCT c.id AS client_id, c.full_name, c.discount,
+                      o.id AS order_id, o.overall_price, o.outlet_id
+       FROM clients c
+       JOIN orders o ON o.client_id = c.id
+       WHERE c.discount > :min_discount
+         AND o.overall_price >= :min_price
+         AND o.outlet_id = :outlet_id
+       ORDER BY c.id;)"},
+             {{"min_discount", "0"}, {"min_price", "5"}, {"outlet_id", "3"}}},
+
+            // 9, item prices apply at query time, the rollups only keep how many services were ordered
+            {"9. Revenue from items",
+             {std::string(s_RollupBounds) + R"(service_counts AS (
+           SELECT r.service_type_id, r.service_count
+           FROM daily_service_rollups r
+           CROSS JOIN bounds b
+           WHERE r.day >= b.full_from AND r.day < b.full_to
+             AND NOT EXISTS (SELECT 1 FROM dirty d WHERE d.day = r.day AND d.outlet_id = r.outlet_id)
+             AND r.outlet_id = :outlet_id::int
+           UNION ALL
+           SELECT so.service_type_id, so.count
+           FROM orders o
+           JOIN service_orders so ON so.order_id = o.id AND so.order_accept_time = o.accept_time
+           CROSS JOIN bounds b
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time", "so.order_accept_time"}) + R"(
+             AND (o.accept_time < b.full_from OR o.accept_time >= b.full_to
+                  OR (o.accept_time::date, o.outlet_id) IN (SELECT day, outlet_id FROM dirty))
+             AND o.outlet_id = :outlet_id::int
+       )
+       SELECT COALESCE(SUM(stni.count * i.price * sc.service_count), 0) AS total_revenue
+       FROM service_counts sc
+       JOIN service_types_needed_items stni ON stni.service_type_id = sc.service_type_id
+       JOIN items i ON i.id = stni.item_id;)"},
+             {fromTime, toTime, {"outlet_id", "1"}},
+             true},
+
+            // 10
+            {"10. Item demand (branch vs overall)",
+             {R"(WITH orders_in_branch AS (
+           SELECT o.id FROM orders o WHERE o.outlet_id = :outlet_id
+       ),
+       service_orders_in_branch AS (
+           SELECT so.* FROM service_orders so
+           JOIN orders_in_branch ob ON so.order_id = ob.id
+       ),
+       items_demand_in_branch AS (
+           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
+           FROM service_orders_in_branch so
+           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
+           GROUP BY stni.item_id
+       ),
+       items_demand_overall AS (
+           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
+           FROM service_orders so
+           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
+           GROUP BY stni.item_id
+       )
+       SELECT i.id AS item_id, i.name AS item_name, f.name AS firm_name,
+              COALESCE(d_branch.total_quantity, 0) AS demand_in_branch,
+              COALESCE(d_overall.total_quantity, 0) AS demand_overall
+       FROM items i
+       LEFT JOIN firms f ON i.firm_id = f.id
+       LEFT JOIN items_demand_in_branch d_branch ON i.id = d_branch.item_id
+       LEFT JOIN items_demand_overall d_overall ON i.id = d_overall.item_id
+       WHERE COALESCE(d_branch.total_quantity, 0) > 0 OR COALESCE(d_overall.total_quantity, 0) > 0
+       ORDER BY demand_overall DESC, demand_in_branch DESC;)"},
+             {{"outlet_id", "1"}}},
+
+            // 11
+            {"11. Items sold",
+             {R"(WITH filtered_orders AS (
+           SELECT o.id, o.accept_time
+           FROM orders o
+           WHERE )" + BuildAcceptTimeFilter({"o.accept_time"}) + R"(
+             AND o.outlet_id = :outlet_id
+       ),
+       service_orders_filtered AS (
+           SELECT so.*
+           FROM service_orders so
+           JOIN filtered_orders fo ON so.order_id = fo.id AND so.order_accept_time = fo.accept_time
+           WHERE )" + BuildAcceptTimeFilter({"so.order_accept_time"}) + R"(
+       ),
+       items_sold AS (
+           SELECT stni.item_id, SUM(stni.count * so.count) AS total_quantity
+           FROM service_orders_filtered so
+           JOIN service_types_needed_items stni ON so.service_type_id = stni.service_type_id
+           GROUP BY stni.item_id
+       )
+       SELECT i.id AS item_id, i.name AS item_name, f.name AS firm_name,
+              COALESCE(items_sold.total_quantity, 0) AS quantity_sold
+       FROM items i
+       LEFT JOIN firms f ON i.firm_id = f.id
+       LEFT JOIN items_sold ON i.id = items_sold.item_id
+       WHERE items_sold.total_quantity IS NOT NULL
+       ORDER BY quantity_sold DESC;)"},
+             {fromTime, toTime, {"outlet_id", "1"}}},
+
+            // 12
+            {"12. Outlets (all, then by type)",
+             {R"(SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
+       FROM outlets o
+       JOIN outlet_types ot ON o.type_id = ot.id
+       ORDER BY o.id;)",
+              R"(SELECT o.id AS outlet_id, o.address, ot.name AS outlet_type
+       FROM outlets o
+       JOIN outlet_types ot ON o.type_id = ot.id
+       WHERE ot.name = :outlet_type
+       ORDER BY o.id;)"},
+             {{"outlet_type", "kiosk"}}},
+
+            // 13
+            {"13. Current stock of an outlet",
+             {R"(SELECT st.id AS storage_id, i.id AS item_id, i.name AS item_name,
+              css.quantity, css.balance, css.pending
+       FROM storages st
+       JOIN current_storage_stock css ON css.storage_id = st.id
+       JOIN items i ON css.item_id = i.id
+       WHERE st.outlet_id = :outlet_id::int
+       ORDER BY st.id, i.id;)"},
+             {{"outlet_id", "1"}}},
+        };
+    }
+
+    static bool IsIdentifierChar(char c) noexcept
+    {
+        return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+
+    // Calls onParam(name) for every :name outside of string literals and '::' casts, the returned text replaces it.
+    template <typename Func> static std::string ReplaceNamedParams(std::string_view sql, Func&& onParam) noexcept
+    {
+        std::string out{};
+        out.reserve(sql.size());
+
+        bool bInLiteral = false;
+        for (std::size_t i{}; i < sql.size(); ++i)
+        {
+            const char c = sql[i];
+            if (c == '\'') bInLiteral = !bInLiteral;
+
+            if (bInLiteral || c != ':')
+            {
+                out += c;
+                continue;
+            }
+
+            if (i + 1 < sql.size() && sql[i + 1] == ':')
+            {
+                out += "::";
+                ++i;
+                continue;
+            }
+
+            std::size_t nameEnd = i + 1;
+            while (nameEnd < sql.size() && IsIdentifierChar(sql[nameEnd]))
+                ++nameEnd;
+
+            if (nameEnd == i + 1)
+            {
+                out += c;
+                continue;
+            }
+
+            out += onParam(sql.substr(i + 1, nameEnd - i - 1));
+            i = nameEnd - 1;
+        }
+
+        return out;
+    }
+
+    static const ReportParam* FindParam(const ReportQuery& report, std::string_view name) noexcept
+    {
+        const auto it =
+            std::find_if(report.Params.begin(), report.Params.end(), [&](const ReportParam& param) { return param.Name == name; });
+        if (it != report.Params.end()) return &*it;
+
+        LOG_WARN("Report '{}' has no parameter '{}'", report.Title, name);
+        return nullptr;
+    }
+
+    std::vector<QueryStatement> BuildReportStatements(const ReportQuery& report) noexcept
+    {
+        std::vector<QueryStatement> statements{};
+        statements.reserve(report.Statements.size());
+
+        for (const auto& sql : report.Statements)
+        {
+            // Numbered per statement: a prepared statement fails on a $n it doesn't use, since its type can't be inferred.
+            QueryStatement& statement = statements.emplace_back();
+            std::vector<std::string_view> names{};
+            const auto toPlaceholder = [&](std::string_view name) -> std::string
+            {
+                const ReportParam* param = FindParam(report, name);
+                if (!param) return ":" + std::string(name);
+
+                auto nameIt = std::find(names.begin(), names.end(), name);
+                if (nameIt == names.end())
+                {
+                    names.emplace_back(name);
+                    statement.Params.emplace_back(param->Value.c_str());  // UI edits a fixed size buffer in place
+                    nameIt = std::prev(names.end());
+                }
+
+                return "$" + std::to_string(std::distance(names.begin(), nameIt) + 1);
+            };
+
+            statement.Sql = ReplaceNamedParams(sql, toPlaceholder);
+        }
+
+        return statements;
+    }
+
+    std::vector<std::string> BuildReportSqlStatements(const ReportQuery& report) noexcept
+    {
+        const auto toLiteral = [&](std::string_view name) -> std::string
+        {
+            const ReportParam* param = FindParam(report, name);
+            if (!param) return ":" + std::string(name);
+
+            std::string literal{"'"};
+            for (const char c : std::string_view(param->Value.c_str()))
+            {
+                if (c == '\'') literal += '\'';
+                literal += c;
+            }
+            return literal + "'";
+        };
+
+        std::vector<std::string> statements{};
+        statements.reserve(report.Statements.size());
+        for (const auto& sql : report.Statements)
+            statements.emplace_back(ReplaceNamedParams(sql, toLiteral));
+
+        return statements;
+    }
+
+    std::string BuildReportSqlText(const ReportQuery& report) noexcept
+    {
+        std::string text{};
+        for (const auto& statement : BuildReportSqlStatements(report))
+        {
+            if (!text.empty()) text += "\n\n";
+
+            text += statement;
+        }
+
+        return text;
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    // Value bound wherever the report text says :Name.
+    struct ReportParam final
+    {
+        std::string Name{};
+        std::string Value{};  // text form, casts live in the SQL
+    };
+
+    // One of the predefined reports. Statements reference parameters by name, every statement is prepared on its own
+    // and gets only the parameters it actually mentions, rows of all statements form one result.
+    struct ReportQuery final
+    {
+        std::string Title{};
+        std::vector<std::string> Statements{};
+        std::vector<ReportParam> Params{};
+
+        // Reads the daily rollups. Correct without a refresh, s_RefreshRollupsSql only keeps the part read raw small.
+        bool bReadsRollups{false};
+    };
+
+    // Folds the stale days into the rollups, to be run as a task of its own next to such reports. Returns 0 right away
+    // when another session is refreshing already.
+    inline constexpr std::string_view s_RefreshRollupsSql = "SELECT refresh_daily_rollups()";
+
+    std::vector<ReportQuery> CreateReportQueries() noexcept;
+
+    // :name -> $n plus the values in $n order, ready for DatabaseConnection::ExecutePreparedAsync().
+    std::vector<QueryStatement> BuildReportStatements(const ReportQuery& report) noexcept;
+
+    // Same report with the values inlined as quoted literals, one string per statement (EXPLAIN can't take parameters).
+    std::vector<std::string> BuildReportSqlStatements(const ReportQuery& report) noexcept;
+
+    // All statements of the above joined by blank lines, for the SQL editor.
+    std::string BuildReportSqlText(const ReportQuery& report) noexcept;
+
+}  // namespace nsudb
@@ -0,0 +1,120 @@
+#include "RepricingWorker.hpp"
+#include <Logger.hpp>
+
+namespace nsudb
+{
+
+    RepricingWorker::RepricingWorker(DatabaseConnection& connection, RepricingWorkerDesc desc) noexcept
+        : m_Connection(connection), m_Desc(desc), m_StartTime(std::chrono::steady_clock::now())
+    {
+        m_Desc.BatchSize = std::clamp(m_Desc.BatchSize, 1, 100'000);
+        m_Thread         = std::thread(&RepricingWorker::Run, this);
+    }
+
+    RepricingWorker::~RepricingWorker() noexcept
+    {
+        Stop();
+        if (m_Thread.joinable()) m_Thread.join();
+    }
+
+    float RepricingWorker::GetProgress() const noexcept
+    {
+        const int64_t pendingCount = GetPendingCount();
+        if (pendingCount <= 0) return pendingCount == 0 ? 1.0f : 0.0f;
+
+        const double repricedCount = static_cast<double>(GetOrdersRepriced());
+        return static_cast<float>(repricedCount / (repricedCount + static_cast<double>(pendingCount)));
+    }
+
+    float RepricingWorker::GetElapsedSeconds() const noexcept
+    {
+        int64_t elapsedNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (elapsedNs == 0)
+            elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        return static_cast<float>(static_cast<double>(elapsedNs) * 1e-9);
+    }
+
+    float RepricingWorker::GetOrdersPerSecond() const noexcept
+    {
+        return static_cast<float>(static_cast<double>(GetOrdersRepriced()) / std::max(GetElapsedSeconds(), 0.001f));
+    }
+
+    void RepricingWorker::Stop() noexcept
+    {
+        {
+            std::scoped_lock lock(m_StopMutex);
+            m_bStopRequested = true;
+        }
+        m_StopCV.notify_all();
+    }
+
+    bool RepricingWorker::IsStopRequested() noexcept
+    {
+        std::scoped_lock lock(m_StopMutex);
+        return m_bStopRequested;
+    }
+
+    bool RepricingWorker::RefreshPendingCount() noexcept
+    {
+        const auto result = m_Connection.Execute("SELECT COUNT(*) FROM order_repricing_queue", EResultFormat::Binary);
+        if (!result || result->GetRowCount() == 0) return false;
+
+        m_PendingCount.store(result->GetInt64(0, 0), std::memory_order_relaxed);
+        return true;
+    }
+
+    void RepricingWorker::Run() noexcept
+    {
+        m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+        // Counting the queue is a scan of its own, done on a timer rather than after every batch.
+        const std::string batchQuery = "SELECT reprice_queued_orders(" + std::to_string(m_Desc.BatchSize) + ")";
+        auto lastRefreshTime         = std::chrono::steady_clock::now();
+
+        bool bSucceeded = RefreshPendingCount();
+        while (bSucceeded && !IsStopRequested())
+        {
+            const auto result = m_Connection.Execute(batchQuery, EResultFormat::Binary);
+            if (!result || result->GetRowCount() == 0)
+            {
+                bSucceeded = false;
+                break;
+            }
+
+            const int64_t dequeuedCount = result->GetInt64(0, 0);
+            if (dequeuedCount > 0)
+            {
+                m_bIdle.store(false, std::memory_order_relaxed);
+                m_OrdersRepriced.fetch_add(static_cast<uint64_t>(dequeuedCount), std::memory_order_relaxed);
+                m_BatchCount.fetch_add(1, std::memory_order_relaxed);
+
+                if (std::chrono::steady_clock::now() - lastRefreshTime >= m_Desc.PendingRefreshInterval)
+                {
+                    bSucceeded      = RefreshPendingCount();
+                    lastRefreshTime = std::chrono::steady_clock::now();
+                }
+                continue;
+            }
+
+            m_PendingCount.store(0, std::memory_order_relaxed);
+            m_bIdle.store(true, std::memory_order_relaxed);
+            if (m_Desc.bStopWhenEmpty) break;
+
+            std::unique_lock lock(m_StopMutex);
+            m_StopCV.wait_for(lock, m_Desc.IdleInterval, [&] { return m_bStopRequested; });
+        }
+
+        // Execute() already logged the server's message.
+        if (!bSucceeded) m_Error = "Repricing batch failed, see the log for details.";
+
+        const EQueryStatus status = !bSucceeded ? EQueryStatus::Failed : IsStopRequested() ? EQueryStatus::Cancelled : EQueryStatus::Done;
+        LOG_TRACE("Repricing: {} orders in {} batches, {:.2f} s", GetOrdersRepriced(), GetBatchCount(), GetElapsedSeconds());
+
+        m_EndTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count(),
+                          std::memory_order_release);
+        m_Status.store(status, std::memory_order_release);
+        m_bFinished.store(true, std::memory_order_release);
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    struct RepricingWorkerDesc final
+    {
+        static constexpr int32_t s_DefaultBatchSize = 500;
+
+        int32_t BatchSize{s_DefaultBatchSize};                           // orders per reprice_queued_orders() call
+        std::chrono::milliseconds IdleInterval{std::chrono::seconds(1)};  // queue polling period once it's drained
+        std::chrono::milliseconds PendingRefreshInterval{std::chrono::milliseconds(500)};
+        bool bStopWhenEmpty{false};  // one-shot drain instead of following the queue
+    };
+
+    // Drains order_repricing_queue (09-repricing-queue.sql) in batches, every batch is one reprice_queued_orders() call
+    // and its own transaction, so a discount change never waits for the repricing and a stop loses nothing.
+    // Runs on its own thread over the pool, everything here is safe to poll every frame.
+    struct RepricingWorker final
+    {
+        RepricingWorker(DatabaseConnection& connection, RepricingWorkerDesc desc = {}) noexcept;
+        ~RepricingWorker() noexcept;  // stops after the running batch
+
+        RepricingWorker(const RepricingWorker&)            = delete;
+        RepricingWorker& operator=(const RepricingWorker&) = delete;
+
+        bool IsFinished() const noexcept { return m_bFinished.load(std::memory_order_acquire); }
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Guarded by IsFinished(), the worker thread doesn't touch it after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+
+        // Queue is drained and the worker waits for new entries.
+        bool IsIdle() const noexcept { return m_bIdle.load(std::memory_order_relaxed); }
+
+        uint64_t GetOrdersRepriced() const noexcept { return m_OrdersRepriced.load(std::memory_order_relaxed); }
+        uint64_t GetBatchCount() const noexcept { return m_BatchCount.load(std::memory_order_relaxed); }
+
+        // Queue length as of the last refresh, -1 until the first one.
+        int64_t GetPendingCount() const noexcept { return m_PendingCount.load(std::memory_order_relaxed); }
+        float GetProgress() const noexcept;  // repriced / (repriced + pending) since start
+        float GetElapsedSeconds() const noexcept;
+        float GetOrdersPerSecond() const noexcept;
+
+        void Stop() noexcept;
+
+      private:
+        DatabaseConnection& m_Connection;
+        RepricingWorkerDesc m_Desc{};
+        std::string m_Error{};
+
+        std::chrono::steady_clock::time_point m_StartTime{};
+        std::atomic<int64_t> m_EndTimeNs{0};  // since m_StartTime
+        std::atomic<uint64_t> m_OrdersRepriced{0};
+        std::atomic<uint64_t> m_BatchCount{0};
+        std::atomic<int64_t> m_PendingCount{-1};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bIdle{false};
+        std::atomic_bool m_bFinished{false};
+
+        std::mutex m_StopMutex{};
+        std::condition_variable m_StopCV{};
+        bool m_bStopRequested{false};  // guarded by m_StopMutex
+
+        std::thread m_Thread{};
+
+        void Run() noexcept;
+        bool RefreshPendingCount() noexcept;
+        bool IsStopRequested() noexcept;
+    };
+
+}  // namespace nsudb
@@ -0,0 +1,539 @@
+#include "ResultCache.hpp"
+#include <Database.hpp>
+#include <Logger.hpp>
+
+#include <libpq-fe.h>
+
+#include <span>
+
+namespace nsudb
+{
+
+    static constexpr std::string_view s_NotifyChannel = "table_changed";
+
+    // What a statement means for the cache, decided by its leading keyword (the main statement's for WITH).
+    enum class EStatementKind : uint8_t
+    {
+        Read = 0,     // may be cached
+        Uncacheable,  // doesn't change data, but the result depends on the session or the statement takes locks
+        Write         // may change data: running it drops the whole cache, its result is never stored
+    };
+
+    // Statement heads that don't change data. Anything not listed here or as a query head counts as a write.
+    static constexpr std::string_view s_SessionHeads[] = {
+        "begin",      "start",      "commit", "end",      "rollback", "abort", "savepoint", "release", "set",   "reset",  "show", "discard",
+        "prepare",    "deallocate", "listen", "unlisten", "notify",   "load",  "checkpoint", "declare", "fetch", "move",  "close", "lock"};
+
+    // Heads of the statements a CTE may hold that change data.
+    static constexpr std::string_view s_DataModifyingHeads[] = {"insert", "update", "delete", "merge"};
+
+    // Read-only, but the result depends on the session or on when it runs.
+    static constexpr std::string_view s_UncacheableWords[] = {
+        "information_schema", "now", "random", "setseed", "clock_timestamp", "timeofday", "statement_timestamp",
+        "transaction_timestamp", "current_date", "current_time", "current_timestamp", "localtime", "localtimestamp", "current_user",
+        "session_user", "current_role", "user", "current_setting", "nextval", "currval", "lastval", "setval", "gen_random_uuid"};
+
+    static bool IsSqlWordChar(const char c) noexcept
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    // Lowercases the SQL outside of literals and quoted identifiers, drops comments, collapses whitespace and the trailing ';',
+    // so the same query typed differently shares an entry. Words are collected along the way. False for SQL the scanner doesn't
+    // follow reliably (dollar quoting, E'' strings with backslash escapes), such queries aren't cached.
+    static bool NormalizeSql(std::string_view sql, std::string& normalized, std::vector<std::string>& words) noexcept
+    {
+        const auto appendSpace = [&]
+        {
+            if (!normalized.empty() && normalized.back() != ' ') normalized.push_back(' ');
+        };
+
+        normalized.reserve(normalized.size() + sql.size());
+        std::size_t i{0};
+        while (i < sql.size())
+        {
+            const char c    = sql[i];
+            const char next = i + 1 < sql.size() ? sql[i + 1] : '\0';
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                appendSpace();
+                ++i;
+            }
+            else if (c == '-' && next == '-')
+            {
+                i = std::min(sql.find('\n', i), sql.size());
+                appendSpace();
+            }
+            else if (c == '/' && next == '*')
+            {
+                const std::size_t commentEnd = sql.find("*/", i + 2);
+                i                            = commentEnd == std::string_view::npos ? sql.size() : commentEnd + 2;
+                appendSpace();
+            }
+            else if (c == '\'' || c == '"')
+            {
+                // Verbatim up to the closing quote, a doubled one is an escaped quote.
+                const std::size_t begin = i++;
+                while (i < sql.size())
+                {
+                    if (sql[i++] != c) continue;
+                    if (i < sql.size() && sql[i] == c)
+                        ++i;
+                    else
+                        break;
+                }
+                normalized.append(sql.substr(begin, i - begin));
+
+                // Quoted identifiers keep their case, so do relation names created with them.
+                if (c == '"' && i - begin >= 2) words.emplace_back(sql.substr(begin + 1, i - begin - 2));
+            }
+            else if (c == '$')
+            {
+                if (!std::isdigit(static_cast<unsigned char>(next))) return false;
+
+                const std::size_t begin = i++;
+                while (i < sql.size() && std::isdigit(static_cast<unsigned char>(sql[i])))
+                    ++i;
+                normalized.append(sql.substr(begin, i - begin));
+            }
+            else if (IsSqlWordChar(c) && !std::isdigit(static_cast<unsigned char>(c)))
+            {
+                std::string word{};
+                while (i < sql.size() && IsSqlWordChar(sql[i]))
+                    word.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(sql[i++]))));
+
+                if (word == "e" && i < sql.size() && sql[i] == '\'') return false;
+
+                normalized.append(word);
+                words.emplace_back(std::move(word));
+            }
+            else
+            {
+                normalized.push_back(c);
+                ++i;
+            }
+        }
+
+        while (!normalized.empty() && (normalized.back() == ' ' || normalized.back() == ';'))
+            normalized.pop_back();
+
+        return true;
+    }
+
+    struct SqlToken final
+    {
+        std::string_view Text{};  // a word, "(", ")" or ","
+        int Depth{0};             // parentheses around it, a parenthesis counts as outside of itself
+    };
+
+    // Words and parentheses of SQL from NormalizeSql, literals, quoted identifiers and other punctuation skipped.
+    static std::vector<SqlToken> TokenizeNormalizedSql(std::string_view normalized) noexcept
+    {
+        std::vector<SqlToken> tokens{};
+        int depth{0};
+        std::size_t i{0};
+        while (i < normalized.size())
+        {
+            const char c = normalized[i];
+            if (c == '\'' || c == '"')
+            {
+                // Normalizing kept literals verbatim, a doubled quote inside one reads as closing and reopening it.
+                const std::size_t closeQuote = normalized.find(c, i + 1);
+                i                            = closeQuote == std::string_view::npos ? normalized.size() : closeQuote + 1;
+            }
+            else if (c == '(')
+                tokens.push_back(SqlToken{.Text = normalized.substr(i++, 1), .Depth = depth++});
+            else if (c == ')')
+                tokens.push_back(SqlToken{.Text = normalized.substr(i++, 1), .Depth = --depth});
+            else if (c == ',')
+                tokens.push_back(SqlToken{.Text = normalized.substr(i++, 1), .Depth = depth});
+            else if (IsSqlWordChar(c))
+            {
+                const std::size_t begin = i;
+                while (i < normalized.size() && IsSqlWordChar(normalized[i]))
+                    ++i;
+                tokens.push_back(SqlToken{.Text = normalized.substr(begin, i - begin), .Depth = depth});
+            }
+            else
+                ++i;
+        }
+
+        return tokens;
+    }
+
+    // SELECT ... INTO creates a table, SELECT ... FOR UPDATE/SHARE locks rows the cache would skip.
+    static EStatementKind ClassifyQuery(std::span<const SqlToken> tokens) noexcept
+    {
+        EStatementKind kind = EStatementKind::Read;
+        for (std::size_t i{}; i < tokens.size(); ++i)
+        {
+            if (tokens[i].Text == "into") return EStatementKind::Write;
+
+            const std::string_view next = i + 1 < tokens.size() ? tokens[i + 1].Text : std::string_view{};
+            if (tokens[i].Text == "for" && (next == "update" || next == "share" || next == "no" || next == "key"))
+                kind = EStatementKind::Uncacheable;
+        }
+
+        return kind;
+    }
+
+    static EStatementKind ClassifyStatement(std::span<const SqlToken> tokens) noexcept
+    {
+        // "(SELECT ...) UNION ..." starts with its parenthesis.
+        std::size_t headIndex{0};
+        while (headIndex < tokens.size() && tokens[headIndex].Text == "(")
+            ++headIndex;
+        if (headIndex == tokens.size()) return EStatementKind::Read;
+
+        const std::string_view head = tokens[headIndex].Text;
+        if (head == "select" || head == "values" || head == "table") return ClassifyQuery(tokens);
+        if (std::ranges::find(s_SessionHeads, head) != std::end(s_SessionHeads)) return EStatementKind::Uncacheable;
+
+        if (head == "explain")
+        {
+            // Only EXPLAIN ANALYZE runs the statement. Options are bare words or a parenthesized list before it.
+            bool bAnalyze{false};
+            std::size_t i = headIndex + 1;
+            for (; i < tokens.size(); ++i)
+            {
+                const SqlToken& token = tokens[i];
+                if (token.Text == "analyze" || token.Text == "analyse")
+                    bAnalyze = true;
+                else if (token.Depth == 0 && token.Text != "verbose" && token.Text != "(" && token.Text != ")" && token.Text != ",")
+                    break;
+            }
+
+            const EStatementKind explainedKind = ClassifyStatement(tokens.subspan(i));
+            return bAnalyze && explainedKind == EStatementKind::Write ? EStatementKind::Write : EStatementKind::Uncacheable;
+        }
+
+        if (head != "with") return EStatementKind::Write;
+
+        // A CTE body is the first word after an opening parenthesis. Subqueries can't start with these heads anyway.
+        for (std::size_t i = headIndex + 1; i + 1 < tokens.size(); ++i)
+        {
+            if (tokens[i].Text == "(" && std::ranges::find(s_DataModifyingHeads, tokens[i + 1].Text) != std::end(s_DataModifyingHeads))
+                return EStatementKind::Write;
+        }
+
+        // The main statement follows the closing parenthesis of the last CTE, column lists are followed by AS.
+        bool bAfterParenthesis{false};
+        for (std::size_t i = headIndex + 1; i < tokens.size(); ++i)
+        {
+            const SqlToken& token = tokens[i];
+            if (token.Depth != 0) continue;
+
+            if (token.Text == ")")
+                bAfterParenthesis = true;
+            else if (bAfterParenthesis && (token.Text == "select" || token.Text == "values" || token.Text == "table"))
+                return ClassifyQuery(tokens.subspan(i));
+            else if (bAfterParenthesis && std::ranges::find(s_DataModifyingHeads, token.Text) != std::end(s_DataModifyingHeads))
+                return EStatementKind::Write;
+        }
+
+        return EStatementKind::Write;
+    }
+
+    // Length-prefixed so neither SQL nor parameters can forge a separator.
+    static void AppendKeyPart(std::string& key, std::string_view part) noexcept
+    {
+        key.append(std::to_string(part.size()));
+        key.push_back(':');
+        key.append(part);
+    }
+
+    ResultCache::ResultCache(const DatabaseDesc& databaseDesc, ResultCacheDesc desc) noexcept : m_DatabaseDesc(databaseDesc), m_Desc(desc)
+    {
+        m_Listener = std::thread(&ResultCache::ListenerLoop, this);
+    }
+
+    ResultCache::~ResultCache() noexcept
+    {
+        {
+            std::scoped_lock lock(m_StopMutex);
+            m_bStopRequested = true;
+        }
+        m_StopCV.notify_all();
+
+        if (m_Listener.joinable()) m_Listener.join();
+    }
+
+    bool ResultCache::WaitForStop(std::chrono::milliseconds timeout) noexcept
+    {
+        std::unique_lock lock(m_StopMutex);
+        return m_StopCV.wait_for(lock, timeout, [&] { return m_bStopRequested; });
+    }
+
+    // Every relation of the public schema and whether it has the notify trigger, false on failure.
+    static bool LoadRelations(PGconn* conn, std::unordered_set<std::string>& relations,
+                              std::unordered_set<std::string>& notifiedTables) noexcept
+    {
+        static constexpr const char* s_RelationsSql = "SELECT c.relname, c.relname IN (SELECT table_name FROM notified_tables) "
+                                                      "FROM pg_class c JOIN pg_namespace n ON n.oid = c.relnamespace "
+                                                      "WHERE n.nspname = 'public' AND c.relkind IN ('r', 'p', 'v', 'm', 'f')";
+
+        PGresult* pgResult = PQexec(conn, s_RelationsSql);
+        const bool bLoaded = PQresultStatus(pgResult) == PGRES_TUPLES_OK;
+        if (bLoaded)
+        {
+            for (int row{}; row < PQntuples(pgResult); ++row)
+            {
+                std::string relation = PQgetvalue(pgResult, row, 0);
+                if (*PQgetvalue(pgResult, row, 1) == 't') notifiedTables.emplace(relation);
+                relations.emplace(std::move(relation));
+            }
+        }
+        else
+            LOG_ERROR("Result cache: failed to load relations: {}", PQresultErrorMessage(pgResult));
+
+        PQclear(pgResult);
+        return bLoaded;
+    }
+
+    void ResultCache::ListenerLoop() noexcept
+    {
+        static constexpr std::chrono::milliseconds s_MinReconnectBackoff{250};
+        static constexpr std::chrono::milliseconds s_MaxReconnectBackoff{std::chrono::seconds(8)};
+
+        const std::string port = std::to_string(m_DatabaseDesc.Port);
+        const char* keywords[] = {"host", "port", "dbname", "user", "password", "connect_timeout", nullptr};
+        const char* values[]   = {m_DatabaseDesc.HostName.c_str(),
+                                  port.c_str(),
+                                  m_DatabaseDesc.Database.c_str(),
+                                  m_DatabaseDesc.Username.c_str(),
+                                  m_DatabaseDesc.Password.c_str(),
+                                  "5",
+                                  nullptr};
+
+        std::chrono::milliseconds reconnectBackoff{0};
+        while (!WaitForStop(reconnectBackoff))
+        {
+            reconnectBackoff = std::clamp(reconnectBackoff * 2, s_MinReconnectBackoff, s_MaxReconnectBackoff);
+
+            std::unique_ptr<PGconn, decltype(&PQfinish)> connection(PQconnectdbParams(keywords, values, 0), &PQfinish);
+            PGconn* conn = connection.get();
+            if (PQstatus(conn) != CONNECTION_OK)
+            {
+                LOG_WARN("Result cache: listener failed to connect ({}ms backoff): {}", reconnectBackoff.count(), PQerrorMessage(conn));
+                continue;
+            }
+
+            PGresult* listenResult = PQexec(conn, (std::string("LISTEN ") + s_NotifyChannel.data()).c_str());
+            const bool bListening  = PQresultStatus(listenResult) == PGRES_COMMAND_OK;
+            PQclear(listenResult);
+
+            std::unordered_set<std::string> relations{};
+            std::unordered_set<std::string> notifiedTables{};
+            if (!bListening || !LoadRelations(conn, relations, notifiedTables))
+            {
+                LOG_WARN("Result cache: listener setup failed ({}ms backoff): {}", reconnectBackoff.count(), PQerrorMessage(conn));
+                continue;
+            }
+
+            // Changes made while nobody listened are unknown, so nothing cached before survives.
+            InvalidateAll();
+            LOG_TRACE("Result cache: listening on {}, {} tables watched", s_NotifyChannel, notifiedTables.size());
+            {
+                std::scoped_lock lock(m_Mutex);
+                m_Relations      = std::move(relations);
+                m_NotifiedTables = std::move(notifiedTables);
+                m_bListening     = true;
+            }
+            reconnectBackoff = std::chrono::milliseconds(0);
+
+            auto nextRelationRefresh = std::chrono::steady_clock::now() + m_Desc.RelationRefreshInterval;
+            bool bConnected          = true;
+            while (bConnected && !WaitForStop(m_Desc.PollInterval))
+            {
+                bConnected = PQconsumeInput(conn) == 1;
+                while (PGnotify* notify = PQnotifies(conn))
+                {
+                    InvalidateTable(notify->extra);
+                    PQfreemem(notify);
+                }
+                if (!bConnected || std::chrono::steady_clock::now() < nextRelationRefresh) continue;
+
+                // Tables created (or given the trigger) since connecting, a table that lost its trigger drops everything.
+                relations.clear();
+                notifiedTables.clear();
+                bConnected = LoadRelations(conn, relations, notifiedTables);
+                if (bConnected)
+                {
+                    bool bLostTrigger{false};
+                    {
+                        std::scoped_lock lock(m_Mutex);
+                        bLostTrigger = std::ranges::any_of(m_NotifiedTables, [&](const std::string& table)
+                                                           { return !notifiedTables.contains(table); });
+                        m_Relations      = std::move(relations);
+                        m_NotifiedTables = std::move(notifiedTables);
+                    }
+                    if (bLostTrigger) InvalidateAll();
+                }
+                nextRelationRefresh = std::chrono::steady_clock::now() + m_Desc.RelationRefreshInterval;
+            }
+
+            {
+                std::scoped_lock lock(m_Mutex);
+                m_bListening = false;
+            }
+            InvalidateAll();
+
+            if (!bConnected) LOG_WARN("Result cache: listener connection lost, cache disabled until it's back: {}", PQerrorMessage(conn));
+        }
+    }
+
+    ResultCacheKey ResultCache::MakeKey(const std::vector<QueryStatement>& statements, bool bPrepared,
+                                        EResultFormat resultFormat) const noexcept
+    {
+        ResultCacheKey key{};
+
+        std::string cacheKey{};
+        cacheKey.push_back(bPrepared ? 'P' : 'S');
+        cacheKey.push_back(resultFormat == EResultFormat::Binary ? 'B' : 'T');
+
+        bool bCacheable = true;
+        std::vector<std::string> words{};
+        for (const auto& statement : statements)
+        {
+            std::string normalized{};
+            if (!NormalizeSql(statement.Sql, normalized, words))
+            {
+                // Unreadable SQL may as well write.
+                key.bWrites = true;
+                return key;
+            }
+
+            const EStatementKind kind = ClassifyStatement(TokenizeNormalizedSql(normalized));
+            if (kind == EStatementKind::Write)
+            {
+                key.bWrites = true;
+                return key;
+            }
+            if (kind == EStatementKind::Uncacheable) bCacheable = false;
+
+            AppendKeyPart(cacheKey, normalized);
+            cacheKey.push_back(statement.bDiscardRows ? 'D' : 'R');
+            cacheKey.append(std::to_string(statement.Params.size()));
+            for (const auto& param : statement.Params)
+                AppendKeyPart(cacheKey, param);
+        }
+
+        for (const auto& word : words)
+        {
+            if (word.starts_with("pg_") || std::ranges::find(s_UncacheableWords, word) != std::end(s_UncacheableWords)) bCacheable = false;
+        }
+        if (!bCacheable) return key;
+
+        std::scoped_lock lock(m_Mutex);
+        if (!m_bListening || m_Desc.MemoryBudget == 0) return key;
+
+        // Column names and functions aren't relations, unknown words are skipped. A relation without the trigger
+        // would never invalidate its entries, so it rules the query out.
+        for (const auto& word : words)
+        {
+            if (!m_Relations.contains(word)) continue;
+            if (!m_NotifiedTables.contains(word)) return key;
+            if (std::ranges::find(key.Tables, word) != key.Tables.end()) continue;
+
+            const auto generationIt = m_TableGenerations.find(word);
+            key.Tables.emplace_back(word);
+            key.TableGenerations.push_back(generationIt != m_TableGenerations.end() ? generationIt->second : 0);
+        }
+        if (key.Tables.empty()) return key;
+
+        key.Key        = std::move(cacheKey);
+        key.Generation = m_Generation;
+        return key;
+    }
+
+    std::shared_ptr<const QueryResult> ResultCache::Find(const ResultCacheKey& key) noexcept
+    {
+        if (key.Key.empty()) return nullptr;
+
+        std::scoped_lock lock(m_Mutex);
+        const auto entryIt = m_Entries.find(key.Key);
+        if (entryIt == m_Entries.end())
+        {
+            ++m_MissCount;
+            return nullptr;
+        }
+
+        ++m_HitCount;
+        m_Lru.splice(m_Lru.begin(), m_Lru, entryIt->second.LruIt);
+        return entryIt->second.Result;
+    }
+
+    void ResultCache::Insert(const ResultCacheKey& key, std::shared_ptr<const QueryResult> result) noexcept
+    {
+        if (key.Key.empty() || !result) return;
+
+        const std::size_t memoryUsage = result->GetMemoryUsage() + key.Key.size();
+        if (memoryUsage > m_Desc.MemoryBudget) return;
+
+        std::scoped_lock lock(m_Mutex);
+
+        // A table it read changed while it ran, the result may already be stale. Changes to other tables don't matter.
+        if (key.Generation != m_Generation || !m_bListening) return;
+        for (std::size_t i{}; i < key.Tables.size(); ++i)
+        {
+            const auto generationIt = m_TableGenerations.find(key.Tables[i]);
+            if ((generationIt != m_TableGenerations.end() ? generationIt->second : 0) != key.TableGenerations[i]) return;
+        }
+
+        if (const auto entryIt = m_Entries.find(key.Key); entryIt != m_Entries.end()) EraseUnlocked(entryIt);
+
+        while (m_MemoryUsage + memoryUsage > m_Desc.MemoryBudget && !m_Lru.empty())
+            EraseUnlocked(m_Entries.find(m_Lru.back()));
+
+        m_Lru.emplace_front(key.Key);
+        m_Entries.emplace(key.Key,
+                          Entry{.Result = std::move(result), .Tables = key.Tables, .MemoryUsage = memoryUsage, .LruIt = m_Lru.begin()});
+        m_MemoryUsage += memoryUsage;
+    }
+
+    void ResultCache::EraseUnlocked(std::unordered_map<std::string, Entry>::iterator entryIt) noexcept
+    {
+        m_MemoryUsage -= entryIt->second.MemoryUsage;
+        m_Lru.erase(entryIt->second.LruIt);
+        m_Entries.erase(entryIt);
+    }
+
+    void ResultCache::InvalidateTable(std::string_view tableName) noexcept
+    {
+        std::scoped_lock lock(m_Mutex);
+        ++m_TableGenerations[std::string(tableName)];
+        ++m_InvalidationCount;
+
+        for (auto entryIt = m_Entries.begin(); entryIt != m_Entries.end();)
+        {
+            const auto nextIt = std::next(entryIt);
+            if (std::ranges::find(entryIt->second.Tables, tableName) != entryIt->second.Tables.end()) EraseUnlocked(entryIt);
+            entryIt = nextIt;
+        }
+
+        LOG_TRACE("Result cache: {} changed, {} results left", tableName, m_Entries.size());
+    }
+
+    void ResultCache::InvalidateAll() noexcept
+    {
+        std::scoped_lock lock(m_Mutex);
+        ++m_Generation;
+        ++m_InvalidationCount;
+
+        m_Entries.clear();
+        m_Lru.clear();
+        m_MemoryUsage = 0;
+    }
+
+    ResultCache::Stats ResultCache::GetStats() const noexcept
+    {
+        std::scoped_lock lock(m_Mutex);
+        return Stats{.EntryCount        = m_Entries.size(),
+                     .MemoryUsage       = m_MemoryUsage,
+                     .HitCount          = m_HitCount,
+                     .MissCount         = m_MissCount,
+                     .InvalidationCount = m_InvalidationCount,
+                     .bListening        = m_bListening};
+    }
+
+}  // namespace nsudb
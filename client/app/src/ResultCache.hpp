@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <ConnectionPool.hpp>
+#include <QueryResult.hpp>
+
+namespace nsudb
+{
+
+    struct QueryStatement;
+    enum class EResultFormat : uint8_t;
+
+    struct ResultCacheDesc final
+    {
+        static constexpr std::size_t s_DefaultMemoryBudget = 256ull << 20;
+
+        std::size_t MemoryBudget{0};  // QueryResult::GetMemoryUsage() summed over all entries, 0 disables the cache
+        std::chrono::milliseconds PollInterval{50};  // how often the listener looks for notifications
+        std::chrono::milliseconds RelationRefreshInterval{std::chrono::seconds(30)};  // picks up tables created meanwhile
+    };
+
+    // What a task means for the cache, decided once when it's submitted.
+    struct ResultCacheKey final
+    {
+        std::string Key{};                         // empty: the result isn't cacheable
+        std::vector<std::string> Tables{};         // tables the statements read, all of them watched
+        std::vector<uint64_t> TableGenerations{};  // changes to each of Tables so far, a result that ran into one isn't stored
+        uint64_t Generation{0};                    // cache-wide invalidations (own writes, reconnects) so far, same
+        bool bWrites{false};                       // may modify data, everything cached goes once it succeeds
+    };
+
+    // Results of read-only queries keyed by their normalized SQL, bound parameters and result format, LRU within a memory budget.
+    // A listener connection keeps LISTEN table_changed (12-change-notify.sql) and drops the entries that read a table as soon as
+    // the server reports a change to it. Only queries whose every relation has the notify trigger are cached, functions they call
+    // are assumed to read nothing else, and nothing is served while the listener is disconnected. Thread safe.
+    // Order-entry tables have no trigger (see 12-change-notify.sql), so reports over orders and their children always go to
+    // the server, as do TABLES pane pages, which are cursor fetches on a session. What is cached are reads of reference tables.
+    struct ResultCache final
+    {
+        struct Stats final
+        {
+            std::size_t EntryCount{0};
+            std::size_t MemoryUsage{0};
+            uint64_t HitCount{0};
+            uint64_t MissCount{0};
+            uint64_t InvalidationCount{0};
+            bool bListening{false};
+        };
+
+        ResultCache(const DatabaseDesc& databaseDesc, ResultCacheDesc desc) noexcept;
+        ~ResultCache() noexcept;
+
+        ResultCache(const ResultCache&)            = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        ResultCacheKey MakeKey(const std::vector<QueryStatement>& statements, bool bPrepared, EResultFormat resultFormat) const noexcept;
+
+        // Shared with the entry, which stays for the next caller.
+        std::shared_ptr<const QueryResult> Find(const ResultCacheKey& key) noexcept;
+        void Insert(const ResultCacheKey& key, std::shared_ptr<const QueryResult> result) noexcept;
+
+        void InvalidateTable(std::string_view tableName) noexcept;
+        void InvalidateAll() noexcept;
+
+        Stats GetStats() const noexcept;
+
+      private:
+        struct Entry final
+        {
+            std::shared_ptr<const QueryResult> Result{nullptr};
+            std::vector<std::string> Tables{};
+            std::size_t MemoryUsage{0};
+            std::list<std::string>::iterator LruIt{};
+        };
+
+        DatabaseDesc m_DatabaseDesc{};
+        ResultCacheDesc m_Desc{};
+
+        mutable std::mutex m_Mutex{};
+        std::unordered_map<std::string, Entry> m_Entries{};
+        std::list<std::string> m_Lru{};  // front is the most recently used key
+        std::size_t m_MemoryUsage{0};
+        uint64_t m_Generation{0};
+        std::unordered_map<std::string, uint64_t> m_TableGenerations{};  // bumped by every notification about the table
+        uint64_t m_HitCount{0};
+        uint64_t m_MissCount{0};
+        uint64_t m_InvalidationCount{0};
+        std::unordered_set<std::string> m_Relations{};       // every relation of the public schema
+        std::unordered_set<std::string> m_NotifiedTables{};  // the ones with the notify trigger
+        bool m_bListening{false};
+
+        std::mutex m_StopMutex{};
+        std::condition_variable m_StopCV{};
+        bool m_bStopRequested{false};  // guarded by m_StopMutex
+
+        std::thread m_Listener{};
+
+        void ListenerLoop() noexcept;
+        bool WaitForStop(std::chrono::milliseconds timeout) noexcept;
+        void EraseUnlocked(std::unordered_map<std::string, Entry>::iterator entryIt) noexcept;
+    };
+
+}  // namespace nsudb
@@ -0,0 +1,244 @@
+#include "ResultCursor.hpp"
+#include <Logger.hpp>
+
+namespace nsudb
+{
+
+    static std::string TrimQuery(const std::string& query) noexcept
+    {
+        // DECLARE ... FOR <query> doesn't accept the trailing semicolon people usually type.
+        std::size_t end = query.find_last_not_of(" \t\r\n;");
+        if (end == std::string::npos) return {};
+
+        const std::size_t begin = query.find_first_not_of(" \t\r\n");
+        return query.substr(begin, end - begin + 1);
+    }
+
+    ResultCursor::ResultCursor(DatabaseConnection& connection, const std::string& query, std::size_t pageSize,
+                               std::size_t maxCachedPages) noexcept
+        : m_Connection(connection), m_Query(TrimQuery(query)), m_PageSize(std::max<std::size_t>(pageSize, 1)),
+          m_MaxCachedPages(std::max<std::size_t>(maxCachedPages, 2))
+    {
+        static std::atomic<uint32_t> s_CursorCounter{0};
+        m_Name = "nsudb_cursor_" + std::to_string(s_CursorCounter.fetch_add(1, std::memory_order_relaxed));
+
+        Open(true);
+
+        // Only plans the query, on another pooled connection alongside the first page. count(*) would run it all.
+        m_EstimateTask = m_Connection.ExecuteAsync("EXPLAIN (FORMAT JSON) " + m_Query);
+    }
+
+    ResultCursor::~ResultCursor() noexcept
+    {
+        for (const auto& [pageIndex, task] : m_PendingPages)
+            m_Connection.Cancel(task);
+
+        if (m_EstimateTask) m_Connection.Cancel(m_EstimateTask);
+        if (m_OpenTask) m_Connection.Cancel(m_OpenTask);
+
+        // No CLOSE needed, the pool rolls the transaction back (and the cursor with it) when the session is released.
+    }
+
+    void ResultCursor::Open(bool bFetchFirstPage) noexcept
+    {
+        // Cursor lives in one session, the transaction stays open between page fetches until the session is released.
+        // WITH HOLD would outlive it, but only by running the whole query to completion at DECLARE.
+        std::vector<std::string> statements{"BEGIN READ ONLY", "DECLARE " + m_Name + " SCROLL CURSOR FOR " + m_Query};
+        if (bFetchFirstPage) statements.emplace_back("FETCH FORWARD " + std::to_string(m_PageSize) + " FROM " + m_Name);
+
+        m_Session       = m_Connection.OpenSession();
+        m_OpenTask      = m_Connection.ExecuteAsync(std::move(statements), m_Session);
+        m_LastFetchTime = std::chrono::steady_clock::now();
+        m_bSuspended    = false;
+    }
+
+    void ResultCursor::Suspend() noexcept
+    {
+        if (!m_bOpened || m_bSuspended) return;
+
+        for (const auto& [pageIndex, task] : m_PendingPages)
+            m_Connection.Cancel(task);
+        m_PendingPages.clear();
+
+        if (m_OpenTask) m_Connection.Cancel(m_OpenTask);
+        m_OpenTask = nullptr;
+
+        // Same as destruction, the pool rolls the transaction back when the session is released.
+        m_Session    = nullptr;
+        m_bSuspended = true;
+        LOG_TRACE("Cursor {}: suspended, {} pages stay cached", m_Name, m_Pages.size());
+    }
+
+    void ResultCursor::Update() noexcept
+    {
+        if (m_OpenTask && m_OpenTask->IsFinished())
+        {
+            if (m_OpenTask->GetStatus() == EQueryStatus::Done)
+            {
+                auto firstPage = m_OpenTask->TakeResult();
+
+                // A re-open fetches nothing itself, the pages it was opened for are queued right behind it.
+                if (firstPage && !m_bOpened)
+                {
+                    m_ColumnNames = firstPage->GetColumnNames();
+                    NarrowRowCount(0, firstPage->GetRowCount());
+                    InsertPage(0, std::move(firstPage));
+                }
+                m_bOpened = true;
+            }
+            else
+                m_Error = m_OpenTask->GetError().empty() ? "Failed to open cursor." : m_OpenTask->GetError();
+
+            m_OpenTask = nullptr;
+        }
+
+        if (m_EstimateTask && m_EstimateTask->IsFinished())
+        {
+            // The root node comes first in the JSON plan, its children only after its own fields.
+            static constexpr std::string_view s_PlanRowsKey = "\"Plan Rows\": ";
+            const auto planResult                           = m_EstimateTask->TakeResult();
+
+            const std::string plan = planResult && !planResult->IsEmpty() ? std::string(planResult->GetValue(0, 0)) : std::string{};
+
+            if (const std::size_t keyPos = plan.find(s_PlanRowsKey); keyPos != std::string::npos)
+            {
+                m_EstimatedRowCount = static_cast<std::size_t>(std::strtod(plan.c_str() + keyPos + s_PlanRowsKey.size(), nullptr));
+                if (!IsRowCountKnown() && m_MinRowCount >= m_EstimatedRowCount) m_EstimatedRowCount = m_MinRowCount + m_PageSize;
+            }
+            else
+                LOG_WARN("Cursor {}: row estimate unavailable - {}", m_Name, m_EstimateTask->GetError());
+
+            m_EstimateTask = nullptr;
+        }
+
+        for (auto it = m_PendingPages.begin(); it != m_PendingPages.end();)
+        {
+            auto& [pageIndex, task] = *it;
+            if (!task->IsFinished())
+            {
+                ++it;
+                continue;
+            }
+
+            if (task->GetStatus() == EQueryStatus::Done)
+            {
+                if (auto rows = task->TakeResult(); rows)
+                {
+                    NarrowRowCount(pageIndex, rows->GetRowCount());
+                    InsertPage(pageIndex, std::move(rows));
+                }
+                m_LastFetchTime = std::chrono::steady_clock::now();
+            }
+            else if (task->GetStatus() == EQueryStatus::Failed)
+                m_Error = task->GetError();
+
+            it = m_PendingPages.erase(it);
+        }
+
+        if (!m_OpenTask && m_PendingPages.empty() && std::chrono::steady_clock::now() - m_LastFetchTime >= s_IdleTimeout) Suspend();
+    }
+
+    void ResultCursor::RequestRows(std::size_t firstRow, std::size_t lastRow) noexcept
+    {
+        if (!m_bOpened || HasFailed() || firstRow >= lastRow) return;
+
+        const std::size_t firstPage = firstRow / m_PageSize;
+        const std::size_t lastPage  = (lastRow - 1) / m_PageSize;
+
+        if (m_bSuspended)
+        {
+            bool bAllCached = true;
+            for (std::size_t pageIndex = firstPage; pageIndex <= lastPage && bAllCached; ++pageIndex)
+                bAllCached = m_Pages.contains(pageIndex);
+
+            if (!bAllCached)
+            {
+                LOG_TRACE("Cursor {}: re-opening at row {}", m_Name, firstRow);
+                m_Pages.clear();
+                m_Lru.clear();
+                Open(false);
+            }
+        }
+
+        // Whatever got scrolled past before the worker picked it up isn't worth fetching anymore.
+        for (const auto& [pageIndex, task] : m_PendingPages)
+        {
+            if ((pageIndex < firstPage || pageIndex > lastPage) && task->GetStatus() == EQueryStatus::Pending)
+                m_Connection.Cancel(task);
+        }
+
+        for (std::size_t pageIndex = firstPage; pageIndex <= lastPage; ++pageIndex)
+        {
+            if (const auto pageIt = m_Pages.find(pageIndex); pageIt != m_Pages.end())
+            {
+                m_Lru.splice(m_Lru.begin(), m_Lru, pageIt->second.LruIt);
+                continue;
+            }
+
+            if (m_PendingPages.contains(pageIndex)) continue;
+
+            // MOVE ABSOLUTE n leaves the cursor on the n-th row (1-based), FETCH then starts right after it.
+            const std::size_t startRow = pageIndex * m_PageSize;
+            m_PendingPages[pageIndex]  = m_Connection.ExecuteAsync(
+                std::vector<std::string>{
+                    "MOVE ABSOLUTE " + std::to_string(startRow) + " IN " + m_Name,
+                    "FETCH FORWARD " + std::to_string(m_PageSize) + " FROM " + m_Name,
+                },
+                m_Session);
+            m_LastFetchTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::optional<std::string_view> ResultCursor::GetValue(std::size_t row, std::size_t column) const noexcept
+    {
+        const auto pageIt = m_Pages.find(row / m_PageSize);
+        if (pageIt == m_Pages.end()) return std::nullopt;
+
+        const auto& rows            = *pageIt->second.Rows;
+        const std::size_t rowInPage = row % m_PageSize;
+        if (rowInPage >= rows.GetRowCount() || column >= rows.GetColumnCount()) return std::nullopt;
+
+        return rows.GetValue(rowInPage, column);
+    }
+
+    void ResultCursor::NarrowRowCount(std::size_t pageIndex, std::size_t rowCount) noexcept
+    {
+        const std::size_t startRow = pageIndex * m_PageSize;
+        if (rowCount < m_PageSize && (rowCount != 0 || pageIndex == 0))
+        {
+            m_MinRowCount = m_MaxRowCount = startRow + rowCount;
+            return;
+        }
+
+        // Scrolled past the end on an overestimate, the page before it settles the count.
+        if (rowCount == 0)
+        {
+            m_MaxRowCount = std::min(m_MaxRowCount, startRow);
+            return;
+        }
+
+        // A full page reaching the estimate means the planner guessed low, keep the next page within reach.
+        m_MinRowCount = std::max(m_MinRowCount, startRow + rowCount);
+        if (m_MinRowCount >= m_EstimatedRowCount) m_EstimatedRowCount = m_MinRowCount + m_PageSize;
+    }
+
+    void ResultCursor::InsertPage(std::size_t pageIndex, std::shared_ptr<const QueryResult> rows) noexcept
+    {
+        if (const auto pageIt = m_Pages.find(pageIndex); pageIt != m_Pages.end())
+        {
+            m_Lru.erase(pageIt->second.LruIt);
+            m_Pages.erase(pageIt);
+        }
+
+        // Pages the user scrolled away from the longest time ago go first, visible ones were just touched.
+        while (m_Pages.size() >= m_MaxCachedPages && !m_Lru.empty())
+        {
+            m_Pages.erase(m_Lru.back());
+            m_Lru.pop_back();
+        }
+
+        m_Lru.push_front(pageIndex);
+        m_Pages[pageIndex] = Page{std::move(rows), m_Lru.begin()};
+    }
+
+}  // namespace nsudb
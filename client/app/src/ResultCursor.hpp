@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <list>
+
+#include <Database.hpp>
+
+namespace nsudb
+{
+
+    // Pages through a query with a server-side SCROLL cursor inside a read-only transaction kept open on one pinned session.
+    // The executor produces rows as pages are fetched, so the first page doesn't wait for the whole query, though jumping
+    // to row n runs it up to row n. Only a bounded LRU of pages lives on the client, so browsing a multi-million row table
+    // costs the same client memory as browsing a 100 row one. The open transaction holds back vacuum, so it is ended once
+    // no page was fetched for s_IdleTimeout (or on Suspend()) and begun again at the first page that isn't cached.
+    // All fetches go through the connection's workers on one pinned session, nothing here blocks the caller.
+    struct ResultCursor final
+    {
+        static constexpr std::size_t s_DefaultPageSize       = 256;
+        static constexpr std::size_t s_DefaultMaxCachedPages = 16;
+        static constexpr std::chrono::seconds s_IdleTimeout{30};
+
+        ResultCursor(DatabaseConnection& connection, const std::string& query, std::size_t pageSize = s_DefaultPageSize,
+                     std::size_t maxCachedPages = s_DefaultMaxCachedPages) noexcept;
+        ~ResultCursor() noexcept;
+
+        ResultCursor(const ResultCursor&)            = delete;
+        ResultCursor& operator=(const ResultCursor&) = delete;
+
+        // Collects finished fetches and suspends an idle cursor, call once per frame before reading rows.
+        void Update() noexcept;
+
+        // Requests every page overlapping [firstRow, lastRow) that isn't cached yet, marks them as recently used
+        // and drops still queued fetches that went out of view. A suspended cursor is re-opened for a missing page: the new
+        // transaction sees a new snapshot, so the pages cached from the old one are dropped and fetched again.
+        void RequestRows(std::size_t firstRow, std::size_t lastRow) noexcept;
+
+        // Ends the transaction (the server-side cursor goes with it) and hands the session back to the pool. Cached pages stay
+        // readable. Does nothing before the first page is in.
+        void Suspend() noexcept;
+
+        bool IsOpen() const noexcept { return m_bOpened; }
+        bool IsSuspended() const noexcept { return m_bSuspended; }
+        bool HasFailed() const noexcept { return !m_Error.empty(); }
+        const std::string& GetError() const noexcept { return m_Error; }
+
+        // The planner's estimate narrowed by the pages seen so far, exact once a page came back short.
+        std::size_t GetRowCount() const noexcept { return std::clamp(m_EstimatedRowCount, m_MinRowCount, m_MaxRowCount); }
+        bool IsRowCountKnown() const noexcept { return m_MinRowCount == m_MaxRowCount; }
+        const std::vector<std::string>& GetColumnNames() const noexcept { return m_ColumnNames; }
+
+        bool IsFetching() const noexcept { return m_OpenTask || !m_PendingPages.empty(); }
+        std::size_t GetCachedPageCount() const noexcept { return m_Pages.size(); }
+        std::size_t GetPageSize() const noexcept { return m_PageSize; }
+
+        // std::nullopt while the page holding the row is not loaded yet.
+        std::optional<std::string_view> GetValue(std::size_t row, std::size_t column) const noexcept;
+
+      private:
+        struct Page final
+        {
+            std::shared_ptr<const QueryResult> Rows{nullptr};
+            std::list<std::size_t>::iterator LruIt{};
+        };
+
+        DatabaseConnection& m_Connection;
+        SessionHandle m_Session{nullptr};
+        std::string m_Name{};
+        std::string m_Query{};
+        std::size_t m_PageSize{s_DefaultPageSize};
+        std::size_t m_MaxCachedPages{s_DefaultMaxCachedPages};
+
+        QueryHandle m_OpenTask{nullptr};
+        QueryHandle m_EstimateTask{nullptr};
+        std::unordered_map<std::size_t, QueryHandle> m_PendingPages{};
+
+        std::unordered_map<std::size_t, Page> m_Pages{};
+        std::list<std::size_t> m_Lru{};  // front is the most recently used page
+
+        std::vector<std::string> m_ColumnNames{};
+        std::size_t m_EstimatedRowCount{0};
+        std::size_t m_MinRowCount{0};  // rows up to the end of the furthest page seen
+        std::size_t m_MaxRowCount{std::numeric_limits<std::size_t>::max()};
+        std::string m_Error{};
+        std::chrono::steady_clock::time_point m_LastFetchTime{};  // of the last page request or arrival, for the idle timeout
+        bool m_bOpened{false};
+        bool m_bSuspended{false};
+
+        void Open(bool bFetchFirstPage) noexcept;
+        void InsertPage(std::size_t pageIndex, std::shared_ptr<const QueryResult> rows) noexcept;
+        void NarrowRowCount(std::size_t pageIndex, std::size_t rowCount) noexcept;
+    };
+
+}  // namespace nsudb
@@ -0,0 +1,567 @@
+#include "ResultExport.hpp"
+#include <Logger.hpp>
+
+#include <bit>
+#include <cstring>
+
+#include <pgfe/pgfe.hpp>
+#include <libpq-fe.h>
+
+namespace nsudb
+{
+
+    static_assert(std::endian::native == std::endian::little, "Columnar files are written straight from memory as little-endian.");
+
+    // Output file with one big buffer of our own and none underneath: small pieces (CSV cells, bitmaps) are collected,
+    // anything at least as large as the buffer (column arenas and value arrays often are) goes to the OS as is.
+    // Everything lands in Path + ".part", Commit() renames it over Path, destroying an uncommitted writer deletes it.
+    // The first failed write is remembered and every later one skipped, so callers only check now and then.
+    struct ExportFileWriter final
+    {
+        ExportFileWriter(const std::filesystem::path& path, std::size_t bufferSize, std::atomic<uint64_t>* bytesWritten = nullptr) noexcept
+            : m_Path(path), m_PartPath(path.string() + ".part"), m_BytesWritten(bytesWritten)
+        {
+            std::error_code errorCode{};
+            if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), errorCode);
+
+            m_Buffer.resize(bufferSize);
+            m_Stream.rdbuf()->pubsetbuf(nullptr, 0);  // before open(), otherwise it's implementation-defined
+            m_Stream.open(m_PartPath, std::ios::binary | std::ios::trunc);
+            if (!m_Stream) m_Error = "Failed to create " + m_PartPath.string();
+        }
+
+        ~ExportFileWriter() noexcept
+        {
+            if (m_bCommitted) return;
+
+            m_Stream.close();
+            std::error_code errorCode{};
+            std::filesystem::remove(m_PartPath, errorCode);
+        }
+
+        ExportFileWriter(const ExportFileWriter&)            = delete;
+        ExportFileWriter& operator=(const ExportFileWriter&) = delete;
+
+        bool HasFailed() const noexcept { return !m_Error.empty(); }
+        const std::string& GetError() const noexcept { return m_Error; }
+
+        // Bytes handed to Write() so far, the file offset the next piece will end up at.
+        uint64_t GetOffset() const noexcept { return m_Offset; }
+
+        void Write(std::string_view bytes) noexcept
+        {
+            m_Offset += bytes.size();
+            if (HasFailed()) return;
+
+            if (m_BufferUsed + bytes.size() <= m_Buffer.size())
+            {
+                std::memcpy(m_Buffer.data() + m_BufferUsed, bytes.data(), bytes.size());
+                m_BufferUsed += bytes.size();
+                return;
+            }
+
+            Flush();
+            if (bytes.size() >= m_Buffer.size())
+                WriteThrough(bytes);
+            else
+            {
+                std::memcpy(m_Buffer.data(), bytes.data(), bytes.size());
+                m_BufferUsed = bytes.size();
+            }
+        }
+
+        void Write(char c) noexcept { Write(std::string_view(&c, 1)); }
+
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        void WritePod(const T& value) noexcept
+        {
+            Write(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)));
+        }
+
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        void WriteSpan(std::span<const T> values) noexcept
+        {
+            Write(std::string_view(reinterpret_cast<const char*>(values.data()), values.size_bytes()));
+        }
+
+        bool Commit() noexcept
+        {
+            Flush();
+            m_Stream.close();
+            if (!HasFailed() && m_Stream.fail()) m_Error = "Failed to write " + m_PartPath.string();
+            if (HasFailed()) return false;
+
+            // Replaces an existing file, MSVC's rename() does MOVEFILE_REPLACE_EXISTING like POSIX rename(2).
+            std::error_code errorCode{};
+            std::filesystem::rename(m_PartPath, m_Path, errorCode);
+            if (errorCode)
+            {
+                m_Error = "Failed to rename " + m_PartPath.string() + " to " + m_Path.string() + ": " + errorCode.message();
+                return false;
+            }
+
+            m_bCommitted = true;
+            return true;
+        }
+
+      private:
+        std::filesystem::path m_Path{};
+        std::filesystem::path m_PartPath{};
+        std::ofstream m_Stream{};
+        std::vector<char> m_Buffer{};
+        std::size_t m_BufferUsed{0};
+        uint64_t m_Offset{0};
+        std::atomic<uint64_t>* m_BytesWritten{nullptr};
+        std::string m_Error{};
+        bool m_bCommitted{false};
+
+        void Flush() noexcept
+        {
+            if (m_BufferUsed == 0 || HasFailed()) return;
+
+            WriteThrough(std::string_view(m_Buffer.data(), m_BufferUsed));
+            m_BufferUsed = 0;
+        }
+
+        void WriteThrough(std::string_view bytes) noexcept
+        {
+            if (!m_Stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+            {
+                m_Error = "Failed to write " + m_PartPath.string() + " (disk full?)";
+                return;
+            }
+
+            if (m_BytesWritten) m_BytesWritten->fetch_add(bytes.size(), std::memory_order_relaxed);
+        }
+    };
+
+    struct RowGroupEntry final
+    {
+        uint64_t Offset{0};
+        uint32_t RowCount{0};
+    };
+
+    static std::string TrimErrorMessage(const char* message) noexcept
+    {
+        std::string error = message ? message : "";
+        while (!error.empty() && (error.back() == '\n' || error.back() == '\r'))
+            error.pop_back();
+
+        return error;
+    }
+
+    static bool ExecuteCommand(PGconn* conn, const std::string& sql, std::string& error) noexcept
+    {
+        PGresult* result            = PQexec(conn, sql.c_str());
+        const ExecStatusType status = PQresultStatus(result);
+        const bool bSucceeded       = status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+        if (!bSucceeded) error = result ? TrimErrorMessage(PQresultErrorMessage(result)) : TrimErrorMessage(PQerrorMessage(conn));
+
+        PQclear(result);
+        return bSucceeded;
+    }
+
+    // The query goes inside COPY (...) / DECLARE ... FOR, where a trailing semicolon is a syntax error.
+    static std::string TrimQuery(std::string_view query) noexcept
+    {
+        const auto isTrimmed = [](char c) { return c == ';' || std::isspace(static_cast<unsigned char>(c)); };
+        while (!query.empty() && isTrimmed(query.back()))
+            query.remove_suffix(1);
+        while (!query.empty() && std::isspace(static_cast<unsigned char>(query.front())))
+            query.remove_prefix(1);
+
+        return std::string(query);
+    }
+
+    // Same quoting as COPY ... (FORMAT csv): only when needed, and always for the empty string so it stays apart from NULL.
+    static void WriteCsvField(ExportFileWriter& writer, std::string_view value) noexcept
+    {
+        if (!value.empty() && value.find_first_of(",\"\r\n") == std::string_view::npos)
+        {
+            writer.Write(value);
+            return;
+        }
+
+        writer.Write('"');
+        for (std::size_t quote = value.find('"'); quote != std::string_view::npos; quote = value.find('"'))
+        {
+            writer.Write(value.substr(0, quote + 1));
+            writer.Write('"');
+            value.remove_prefix(quote + 1);
+        }
+        writer.Write(value);
+        writer.Write('"');
+    }
+
+    static void WriteCsvHeader(ExportFileWriter& writer, const QueryResult& result) noexcept
+    {
+        for (std::size_t column{}; column < result.GetColumnCount(); ++column)
+        {
+            if (column > 0) writer.Write(',');
+            WriteCsvField(writer, result.GetColumnNames()[column]);
+        }
+        writer.Write('\n');
+    }
+
+    static void WriteCsvRows(ExportFileWriter& writer, const QueryResult& result, std::size_t firstRow, std::size_t lastRow) noexcept
+    {
+        const std::size_t columnCount = result.GetColumnCount();
+        QueryResult::FormatBuffer buffer{};
+        for (std::size_t row = firstRow; row < lastRow && !writer.HasFailed(); ++row)
+        {
+            for (std::size_t column{}; column < columnCount; ++column)
+            {
+                if (column > 0) writer.Write(',');
+                if (result.IsNull(row, column)) continue;
+
+                if (result.GetColumnType(column) == EColumnType::Text)
+                    WriteCsvField(writer, result.GetValue(row, column));
+                else
+                    writer.Write(result.FormatValue(row, column, buffer));  // digits, dates and t/f, nothing to quote
+            }
+            writer.Write('\n');
+        }
+    }
+
+    // Rows [firstRow, lastRow) of every column, laid out as ResultExport.hpp describes. Text offsets are rebased to the group
+    // (as they are for a group starting at row 0), value arenas and typed arrays are written straight from the result.
+    static void WriteRowGroup(ExportFileWriter& writer, const QueryResult& result, std::size_t firstRow, std::size_t lastRow,
+                              std::vector<RowGroupEntry>& groups) noexcept
+    {
+        const std::size_t rowCount = lastRow - firstRow;
+        groups.emplace_back(writer.GetOffset(), static_cast<uint32_t>(rowCount));
+
+        std::vector<uint8_t> nullBitmap((rowCount + 7) / 8);
+        std::vector<uint64_t> rebasedOffsets{};
+        for (std::size_t column{}; column < result.GetColumnCount(); ++column)
+        {
+            std::fill(nullBitmap.begin(), nullBitmap.end(), uint8_t{0});
+            for (std::size_t i{}; i < rowCount; ++i)
+                if (result.IsNull(firstRow + i, column)) nullBitmap[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            writer.WriteSpan(std::span<const uint8_t>(nullBitmap));
+
+            if (result.GetColumnType(column) == EColumnType::Text)
+            {
+                const std::span<const uint64_t> offsets = result.GetColumnOffsets(column).subspan(firstRow, rowCount + 1);
+                if (offsets.front() == 0)
+                    writer.WriteSpan(offsets);
+                else
+                {
+                    rebasedOffsets.resize(offsets.size());
+                    std::transform(offsets.begin(), offsets.end(), rebasedOffsets.begin(),
+                                   [base = offsets.front()](uint64_t offset) { return offset - base; });
+                    writer.WriteSpan(std::span<const uint64_t>(rebasedOffsets));
+                }
+
+                writer.Write(result.GetColumnArena(column).substr(offsets.front(), offsets.back() - offsets.front()));
+                continue;
+            }
+
+            writer.WriteSpan(result.GetColumnValues(column).subspan(firstRow, rowCount));
+            if (result.GetColumnType(column) == EColumnType::Numeric)
+                writer.WriteSpan(result.GetColumnNumericScales(column).subspan(firstRow, rowCount));
+        }
+    }
+
+    // Schema from any result with the right columns, rows are not looked at.
+    static void WriteColumnarFooter(ExportFileWriter& writer, const QueryResult& schema, const std::vector<RowGroupEntry>& groups,
+                                    uint64_t totalRowCount) noexcept
+    {
+        const uint64_t footerOffset = writer.GetOffset();
+
+        writer.WritePod(static_cast<uint32_t>(schema.GetColumnCount()));
+        for (std::size_t column{}; column < schema.GetColumnCount(); ++column)
+        {
+            const std::string& name = schema.GetColumnNames()[column];
+            writer.WritePod(static_cast<uint16_t>(name.size()));
+            writer.Write(name);
+            writer.WritePod(static_cast<uint8_t>(schema.GetColumnType(column)));
+        }
+
+        writer.WritePod(static_cast<uint32_t>(groups.size()));
+        for (const auto& group : groups)
+        {
+            writer.WritePod(group.Offset);
+            writer.WritePod(group.RowCount);
+        }
+        writer.WritePod(totalRowCount);
+
+        writer.WritePod(static_cast<uint32_t>(writer.GetOffset() - footerOffset));
+        writer.Write(s_ColumnarMagic);
+    }
+
+    QueryExporter::QueryExporter(DatabaseConnection& connection, std::string query, ExportDesc desc) noexcept
+        : m_Connection(&connection), m_Query(TrimQuery(query)), m_Desc(std::move(desc)), m_StartTime(std::chrono::steady_clock::now())
+    {
+        Start(m_Query.empty() ? "Nothing to export, the query is empty." : "");
+    }
+
+    QueryExporter::QueryExporter(std::shared_ptr<const QueryResult> result, ExportDesc desc) noexcept
+        : m_Result(std::move(result)), m_Desc(std::move(desc)), m_StartTime(std::chrono::steady_clock::now())
+    {
+        Start(!m_Result || m_Result->GetColumnCount() == 0 ? "Nothing to export, there is no loaded result." : "");
+    }
+
+    void QueryExporter::Start(std::string_view sourceError) noexcept
+    {
+        m_Desc.BufferSize   = std::clamp<std::size_t>(m_Desc.BufferSize, 64 * 1024, 256 * 1024 * 1024);
+        m_Desc.RowGroupSize = std::clamp<std::size_t>(m_Desc.RowGroupSize, 1024, 1024 * 1024);
+
+        if (!sourceError.empty() || m_Desc.Path.empty())
+        {
+            m_Error = sourceError.empty() ? "No output path." : std::string(sourceError);
+            LOG_ERROR("Export: {}", m_Error);
+            m_Status.store(EQueryStatus::Failed, std::memory_order_release);
+            m_bFinished.store(true, std::memory_order_release);
+            return;
+        }
+
+        m_Thread = std::thread(&QueryExporter::Run, this);
+    }
+
+    QueryExporter::~QueryExporter() noexcept
+    {
+        Cancel();
+        if (m_Thread.joinable()) m_Thread.join();
+    }
+
+    float QueryExporter::GetElapsedSeconds() const noexcept
+    {
+        int64_t elapsedNs = m_EndTimeNs.load(std::memory_order_acquire);
+        if (elapsedNs == 0)
+            elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        return static_cast<float>(static_cast<double>(elapsedNs) * 1e-9);
+    }
+
+    void QueryExporter::Cancel() noexcept
+    {
+        if (IsFinished()) return;
+
+        // The cursor and loaded-result loops check the flag between row groups, the request stops a COPY or a FETCH the server
+        // is busy with.
+        std::scoped_lock lock(m_CancelMutex);
+        m_bCancelRequested.store(true, std::memory_order_release);
+        if (!m_CancelHandle) return;
+
+        char errorBuffer[256]{};
+        if (!PQcancel(m_CancelHandle, errorBuffer, sizeof(errorBuffer))) LOG_WARN("Failed to send cancel request: {}", errorBuffer);
+    }
+
+    void QueryExporter::Run() noexcept
+    {
+        m_Status.store(EQueryStatus::Running, std::memory_order_release);
+
+        bool bSucceeded = false;
+        ExportFileWriter writer(m_Desc.Path, m_Desc.BufferSize, &m_BytesWritten);
+        if (writer.HasFailed())
+            m_Error = writer.GetError();
+        else if (m_Result)
+            bSucceeded = ExportLoaded(writer);
+        else if (PooledConnection connection = m_Connection->AcquireConnection(); connection)
+        {
+            {
+                std::scoped_lock lock(m_CancelMutex);
+                m_CancelHandle = connection.GetCancelHandle();
+            }
+
+            // Same as the bulk loader: blocking libpq calls on the pooled handle, pgfe runs it non-blocking.
+            PGconn* conn                 = connection->native_handle();
+            const int32_t wasNonBlocking = PQisnonblocking(conn);
+            PQsetnonblocking(conn, 0);
+
+            bSucceeded = m_Desc.Format == EExportFormat::Csv ? ExportCsv(conn, writer) : ExportColumnar(conn, writer);
+
+            PQsetnonblocking(conn, wasNonBlocking);
+
+            std::scoped_lock lock(m_CancelMutex);
+            m_CancelHandle = nullptr;
+        }
+        else
+            m_Error = "No database connection available.";
+
+        if (bSucceeded && !writer.Commit())
+        {
+            m_Error    = writer.GetError();
+            bSucceeded = false;
+        }
+
+        EQueryStatus status = bSucceeded ? EQueryStatus::Done : EQueryStatus::Failed;
+        if (!bSucceeded && m_bCancelRequested.load(std::memory_order_acquire))
+        {
+            status  = EQueryStatus::Cancelled;
+            m_Error = "Export cancelled, the partial file was deleted.";
+        }
+
+        if (bSucceeded)
+            LOG_TRACE("Export: {} rows, {} bytes to {} in {:.2f} s", GetRowsWritten(), GetBytesWritten(), m_Desc.Path.string(),
+                      GetElapsedSeconds());
+        else
+            LOG_ERROR("Export failed: {}", m_Error);
+
+        m_EndTimeNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_StartTime).count(),
+                          std::memory_order_release);
+        m_Status.store(status, std::memory_order_release);
+        m_bFinished.store(true, std::memory_order_release);
+    }
+
+    bool QueryExporter::ExportLoaded(ExportFileWriter& writer) noexcept
+    {
+        const QueryResult& result      = *m_Result;
+        const std::size_t rowCount     = result.GetRowCount();
+        const std::size_t rowGroupSize = m_Desc.RowGroupSize;
+
+        std::vector<RowGroupEntry> groups{};
+        if (m_Desc.Format == EExportFormat::Csv)
+            WriteCsvHeader(writer, result);
+        else
+            writer.Write(s_ColumnarMagic);
+
+        for (std::size_t firstRow{}; firstRow < rowCount && !writer.HasFailed(); firstRow += rowGroupSize)
+        {
+            if (m_bCancelRequested.load(std::memory_order_acquire)) return false;
+
+            const std::size_t lastRow = std::min(firstRow + rowGroupSize, rowCount);
+            if (m_Desc.Format == EExportFormat::Csv)
+                WriteCsvRows(writer, result, firstRow, lastRow);
+            else
+                WriteRowGroup(writer, result, firstRow, lastRow, groups);
+            m_RowsWritten.store(lastRow, std::memory_order_relaxed);
+        }
+
+        if (m_Desc.Format == EExportFormat::Columnar) WriteColumnarFooter(writer, result, groups, rowCount);
+
+        if (writer.HasFailed())
+        {
+            m_Error = writer.GetError();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool QueryExporter::ExportCsv(PGconn* conn, ExportFileWriter& writer) noexcept
+    {
+        // The server formats the CSV, rows arrive in libpq's buffer and are written from there, never parsed or rebuilt.
+        const std::string copyStatement = "COPY (" + m_Query + ") TO STDOUT (FORMAT csv, HEADER)";
+        PGresult* copyResult            = PQexec(conn, copyStatement.c_str());
+        if (PQresultStatus(copyResult) != PGRES_COPY_OUT)
+        {
+            m_Error = TrimErrorMessage(copyResult ? PQresultErrorMessage(copyResult) : PQerrorMessage(conn));
+            PQclear(copyResult);
+            return false;
+        }
+        PQclear(copyResult);
+
+        // One row per call, -1 once the COPY is done, -2 on a broken connection.
+        bool bHeader     = true;
+        int32_t rowBytes = 0;
+        char* row        = nullptr;
+        while ((rowBytes = PQgetCopyData(conn, &row, 0)) > 0)
+        {
+            const bool bWriteFailed = writer.HasFailed();
+            writer.Write(std::string_view(row, static_cast<std::size_t>(rowBytes)));
+            PQfreemem(row);
+
+            if (bHeader)
+                bHeader = false;
+            else
+                m_RowsWritten.fetch_add(1, std::memory_order_relaxed);
+
+            // There's no aborting a COPY OUT from the client, the server has to be told to stop sending.
+            if (!bWriteFailed && writer.HasFailed())
+            {
+                std::scoped_lock lock(m_CancelMutex);
+                char errorBuffer[256]{};
+                if (m_CancelHandle && !PQcancel(m_CancelHandle, errorBuffer, sizeof(errorBuffer)))
+                    LOG_WARN("Failed to send cancel request: {}", errorBuffer);
+            }
+        }
+
+        bool bSucceeded = rowBytes == -1;
+        if (!bSucceeded) m_Error = TrimErrorMessage(PQerrorMessage(conn));
+        while (PGresult* result = PQgetResult(conn))
+        {
+            if (PQresultStatus(result) != PGRES_COMMAND_OK && bSucceeded)
+            {
+                m_Error    = TrimErrorMessage(PQresultErrorMessage(result));
+                bSucceeded = false;
+            }
+            PQclear(result);
+        }
+
+        if (writer.HasFailed())
+        {
+            m_Error    = writer.GetError();
+            bSucceeded = false;
+        }
+
+        return bSucceeded;
+    }
+
+    bool QueryExporter::ExportColumnar(PGconn* conn, ExportFileWriter& writer) noexcept
+    {
+        // A NO SCROLL cursor lets the executor stream instead of materializing, one binary FETCH per row group keeps
+        // at most one group on the client however large the result is.
+        const auto exportInTransaction = [&]() -> bool
+        {
+            if (!ExecuteCommand(conn, "BEGIN READ ONLY", m_Error) ||
+                !ExecuteCommand(conn, "DECLARE nsudb_export NO SCROLL CURSOR FOR " + m_Query, m_Error))
+                return false;
+
+            writer.Write(s_ColumnarMagic);
+
+            const std::string fetchStatement = "FETCH FORWARD " + std::to_string(m_Desc.RowGroupSize) + " FROM nsudb_export";
+            std::vector<RowGroupEntry> groups{};
+            uint64_t totalRowCount = 0;
+            while (true)
+            {
+                if (m_bCancelRequested.load(std::memory_order_acquire)) return false;
+
+                PGresult* pgResult = PQexecParams(conn, fetchStatement.c_str(), 0, nullptr, nullptr, nullptr, nullptr, 1);
+                if (PQresultStatus(pgResult) != PGRES_TUPLES_OK)
+                {
+                    m_Error = TrimErrorMessage(pgResult ? PQresultErrorMessage(pgResult) : PQerrorMessage(conn));
+                    PQclear(pgResult);
+                    return false;
+                }
+
+                // Even an empty FETCH carries the columns, the last one (always short) supplies the footer's schema.
+                QueryResult batch{};
+                const std::size_t rowCount = AppendResultRows(pgResult, true, batch);
+                PQclear(pgResult);
+
+                if (rowCount > 0) WriteRowGroup(writer, batch, 0, rowCount, groups);
+                totalRowCount += rowCount;
+                m_RowsWritten.store(totalRowCount, std::memory_order_relaxed);
+
+                if (writer.HasFailed())
+                {
+                    m_Error = writer.GetError();
+                    return false;
+                }
+
+                if (rowCount < m_Desc.RowGroupSize)
+                {
+                    WriteColumnarFooter(writer, batch, groups, totalRowCount);
+                    break;
+                }
+            }
+
+            return ExecuteCommand(conn, "CLOSE nsudb_export", m_Error) && ExecuteCommand(conn, "COMMIT", m_Error);
+        };
+
+        const bool bSucceeded = exportInTransaction();
+        if (!bSucceeded)
+        {
+            std::string rollbackError{};
+            if (PQtransactionStatus(conn) != PQTRANS_IDLE && !ExecuteCommand(conn, "ROLLBACK", rollbackError))
+                LOG_WARN("Export: rollback failed: {}", rollbackError);
+        }
+
+        return bSucceeded;
+    }
+
+}  // namespace nsudb
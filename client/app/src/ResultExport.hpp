@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Database.hpp>
+
+struct pg_conn;
+
+namespace nsudb
+{
+
+    struct ExportFileWriter;
+
+    enum class EExportFormat : uint8_t
+    {
+        Csv = 0,  // RFC 4180 like COPY ... (FORMAT csv, HEADER) writes it: NULL is an empty field, an empty string ""
+        Columnar
+    };
+
+    // Columnar files, all integers little-endian:
+    //   "NSUCOL01"
+    //   row groups, every column of a group back to back:
+    //     null bitmap, (rows + 7) / 8 bytes, bit i of byte i / 8 set = row i is NULL
+    //     Text:  uint64 offsets[rows + 1] from 0, then the value bytes
+    //     typed: int64 values[rows] as QueryResult stores them, Numeric followed by uint8 scales[rows]
+    //   footer: uint32 column count, per column uint16 name length, name, uint8 EColumnType;
+    //           uint32 row group count, per group uint64 file offset and uint32 row count; uint64 total rows
+    //   uint32 footer length, "NSUCOL01"
+    // so a reader finds the schema and every row group from the end of the file, like Parquet, and can skip columns.
+    inline constexpr std::string_view s_ColumnarMagic = "NSUCOL01";
+
+    struct ExportDesc final
+    {
+        static constexpr std::size_t s_DefaultBufferSize   = 4 << 20;
+        static constexpr std::size_t s_DefaultRowGroupSize = 64 * 1024;
+
+        std::filesystem::path Path{};
+        EExportFormat Format{EExportFormat::Csv};
+        std::size_t BufferSize{s_DefaultBufferSize};      // bytes collected before each write, larger pieces skip the buffer
+        std::size_t RowGroupSize{s_DefaultRowGroupSize};  // rows per FETCH, per columnar row group and per progress step
+    };
+
+    // Writes results to disk on its own thread. Output goes to Path + ".part" first and is only renamed over Path once complete.
+    // A query is streamed from the server on a pooled connection, in constant memory however many rows it returns: CSV is
+    // COPY (query) TO STDOUT written as it arrives, columnar a NO SCROLL cursor fetched in binary, one row group per FETCH.
+    // The query must be a single SELECT (or anything COPY/DECLARE accepts). A loaded result is written straight from its
+    // column arenas, no per-cell strings, and is kept alive until the export is done. Safe to poll every frame.
+    struct QueryExporter final
+    {
+        QueryExporter(DatabaseConnection& connection, std::string query, ExportDesc desc) noexcept;
+        QueryExporter(std::shared_ptr<const QueryResult> result, ExportDesc desc) noexcept;
+        ~QueryExporter() noexcept;  // cancels a running export and waits for it
+
+        QueryExporter(const QueryExporter&)            = delete;
+        QueryExporter& operator=(const QueryExporter&) = delete;
+
+        bool IsFinished() const noexcept { return m_bFinished.load(std::memory_order_acquire); }
+        EQueryStatus GetStatus() const noexcept { return m_Status.load(std::memory_order_acquire); }
+
+        // Guarded by IsFinished(), the export thread doesn't touch it after completion.
+        const std::string& GetError() const noexcept { return m_Error; }
+        const ExportDesc& GetDesc() const noexcept { return m_Desc; }
+
+        uint64_t GetRowsWritten() const noexcept { return m_RowsWritten.load(std::memory_order_relaxed); }
+        uint64_t GetBytesWritten() const noexcept { return m_BytesWritten.load(std::memory_order_relaxed); }
+        float GetElapsedSeconds() const noexcept;
+
+        // Stops the server side too, the partial file is deleted.
+        void Cancel() noexcept;
+
+      private:
+        DatabaseConnection* m_Connection{nullptr};     // query exports only
+        std::shared_ptr<const QueryResult> m_Result{};  // loaded-result exports only
+        std::string m_Query{};
+        ExportDesc m_Desc{};
+        std::string m_Error{};
+
+        std::chrono::steady_clock::time_point m_StartTime{};
+        std::atomic<int64_t> m_EndTimeNs{0};  // since m_StartTime
+        std::atomic<uint64_t> m_RowsWritten{0};
+        std::atomic<uint64_t> m_BytesWritten{0};
+        std::atomic<EQueryStatus> m_Status{EQueryStatus::Pending};
+        std::atomic_bool m_bCancelRequested{false};
+        std::atomic_bool m_bFinished{false};
+
+        std::mutex m_CancelMutex{};
+        pg_cancel* m_CancelHandle{nullptr};  // guarded by m_CancelMutex, set while the connection is checked out
+
+        std::thread m_Thread{};
+
+        void Start(std::string_view sourceError) noexcept;
+        void Run() noexcept;
+        bool ExportLoaded(ExportFileWriter& writer) noexcept;
+        bool ExportCsv(pg_conn* conn, ExportFileWriter& writer) noexcept;
+        bool ExportColumnar(pg_conn* conn, ExportFileWriter& writer) noexcept;
+    };
+
+}  // namespace nsudb
@@ -0,0 +1,352 @@
+#include "ResultSearch.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define NSUDB_SEARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC emits any intrinsic it is given, GCC/Clang only inside functions compiled for the instruction set.
+#if defined(NSUDB_SEARCH_X86) && defined(__GNUC__)
+#define NSUDB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NSUDB_TARGET_AVX2
+#endif
+
+namespace nsudb
+{
+
+    static constexpr std::size_t s_SearchChunkRows = 64 * 1024;  // rows per parallel task
+
+    static char ToLowerAscii(char c) noexcept
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Uppercase basic Cyrillic letters are 0xD0 followed by 0x80..0xAF, the second byte's row picks the lowercase:
+    // U+0410..U+041F 0xD0 0x90..0x9F -> 0xD0 0xB0..0xBF, U+0420..U+042F 0xD0 0xA0..0xAF -> 0xD1 0x80..0x8F,
+    // U+0400..U+040F (YO included) 0xD0 0x80..0x8F -> 0xD1 0x90..0x9F. Anything else is left alone.
+    static void ToLowerCyrillic(uint8_t& lead, uint8_t& next) noexcept
+    {
+        if (lead != 0xD0 || next < 0x80 || next > 0xAF) return;
+
+        if (next >= 0x90 && next <= 0x9F)
+            next += 0x20;
+        else
+        {
+            lead = 0xD1;
+            next = next >= 0xA0 ? next - 0x20 : next + 0x10;
+        }
+    }
+
+    // Lowercase basic Cyrillic letter, the forms a pattern holds after lowercasing.
+    static bool IsLowerCyrillic(uint8_t lead, uint8_t next) noexcept
+    {
+        return (lead == 0xD0 && next >= 0xB0 && next <= 0xBF) || (lead == 0xD1 && next >= 0x80 && next <= 0x9F);
+    }
+
+    ESearchKernel GetFastestSearchKernel() noexcept
+    {
+        static const ESearchKernel s_Kernel = []()
+        {
+#if defined(NSUDB_SEARCH_X86) && defined(_MSC_VER)
+            // AVX2 needs the CPU bit (leaf 7, EBX bit 5) and the OS saving YMM state (OSXSAVE, then XCR0 bits 1-2).
+            int cpuInfo[4]{};
+            __cpuid(cpuInfo, 1);
+            const bool bOsSavesYmm = (cpuInfo[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(cpuInfo, 7, 0);
+            return bOsSavesYmm && (cpuInfo[1] & (1 << 5)) ? ESearchKernel::Avx2 : ESearchKernel::Sse2;
+#elif defined(NSUDB_SEARCH_X86)
+            return __builtin_cpu_supports("avx2") ? ESearchKernel::Avx2 : ESearchKernel::Sse2;
+#else
+            return ESearchKernel::Scalar;
+#endif
+        }();
+
+        return s_Kernel;
+    }
+
+    const char* GetSearchKernelName(ESearchKernel kernel) noexcept
+    {
+        switch (kernel)
+        {
+            case ESearchKernel::Sse2: return "SSE2";
+            case ESearchKernel::Avx2: return "AVX2";
+            default: return "scalar";
+        }
+    }
+
+    TextSearcher::TextSearcher(std::string_view pattern, bool bCaseSensitive, ESearchKernel kernel) noexcept
+        : m_Pattern(pattern), m_bCaseSensitive(bCaseSensitive), m_Kernel(kernel)
+    {
+#if !defined(NSUDB_SEARCH_X86)
+        m_Kernel = ESearchKernel::Scalar;
+#endif
+        if (m_Pattern.empty()) return;
+
+        if (!m_bCaseSensitive)
+        {
+            for (std::size_t i{}; i < m_Pattern.size(); ++i)
+            {
+                if (static_cast<uint8_t>(m_Pattern[i]) != 0xD0 || i + 1 == m_Pattern.size())
+                {
+                    m_Pattern[i] = ToLowerAscii(m_Pattern[i]);
+                    continue;
+                }
+
+                uint8_t lead = 0xD0;
+                uint8_t next = static_cast<uint8_t>(m_Pattern[i + 1]);
+                ToLowerCyrillic(lead, next);
+                m_Pattern[i]   = static_cast<char>(lead);
+                m_Pattern[++i] = static_cast<char>(next);
+            }
+
+            const std::size_t size = m_Pattern.size();
+            const auto at          = [&](std::size_t i) { return static_cast<uint8_t>(m_Pattern[i]); };
+            if (at(0) >= 'a' && at(0) <= 'z')
+                m_FirstFoldMask = 0x20;
+            else if (size >= 2 && IsLowerCyrillic(at(0), at(1)))
+                m_FirstFoldMask = 0x01;
+
+            if (at(size - 1) >= 'a' && at(size - 1) <= 'z')
+                m_LastFoldMask = 0x20;
+            else if (size >= 2 && IsLowerCyrillic(at(size - 2), at(size - 1)))
+                m_LastFoldMask = at(size - 2) == 0xD1 && at(size - 1) >= 0x90 ? 0x10 : 0x20;
+        }
+
+        m_FirstByte = static_cast<char>(m_Pattern.front() | m_FirstFoldMask);
+        m_LastByte  = static_cast<char>(m_Pattern.back() | m_LastFoldMask);
+    }
+
+    bool TextSearcher::IsMatchAt(const char* text) const noexcept
+    {
+        if (m_bCaseSensitive) return std::memcmp(text, m_Pattern.data(), m_Pattern.size()) == 0;
+
+        for (std::size_t i{}; i < m_Pattern.size(); ++i)
+        {
+            if (static_cast<uint8_t>(text[i]) != 0xD0 || i + 1 == m_Pattern.size())
+            {
+                if (ToLowerAscii(text[i]) != m_Pattern[i]) return false;
+                continue;
+            }
+
+            uint8_t lead = 0xD0;
+            uint8_t next = static_cast<uint8_t>(text[i + 1]);
+            ToLowerCyrillic(lead, next);
+            if (lead != static_cast<uint8_t>(m_Pattern[i]) || next != static_cast<uint8_t>(m_Pattern[i + 1])) return false;
+            ++i;
+        }
+
+        return true;
+    }
+
+    std::size_t TextSearcher::Find(std::string_view text, std::size_t from) const noexcept
+    {
+        if (m_Pattern.empty()) return from <= text.size() ? from : std::string_view::npos;
+        if (from > text.size() || text.size() - from < m_Pattern.size()) return std::string_view::npos;
+
+        switch (m_Kernel)
+        {
+            case ESearchKernel::Sse2: return FindSse2(text, from);
+            case ESearchKernel::Avx2: return FindAvx2(text, from);
+            default: return FindScalar(text, from);
+        }
+    }
+
+    std::size_t TextSearcher::FindScalar(std::string_view text, std::size_t from) const noexcept
+    {
+        for (std::size_t i = from; i + m_Pattern.size() <= text.size(); ++i)
+            if (static_cast<char>(text[i] | m_FirstFoldMask) == m_FirstByte && IsMatchAt(text.data() + i)) return i;
+
+        return std::string_view::npos;
+    }
+
+#if defined(NSUDB_SEARCH_X86)
+
+    // Blocks of starting positions: a lane passes when both its first-byte and its last-byte candidate match,
+    // the survivors are verified in full. Whatever is left past the last full block goes through FindScalar().
+    std::size_t TextSearcher::FindSse2(std::string_view text, std::size_t from) const noexcept
+    {
+        const std::size_t patternSize = m_Pattern.size();
+        const std::size_t startCount  = text.size() - patternSize + 1;  // positions a match can start at
+
+        const __m128i first     = _mm_set1_epi8(m_FirstByte);
+        const __m128i last      = _mm_set1_epi8(m_LastByte);
+        const __m128i firstFold = _mm_set1_epi8(static_cast<char>(m_FirstFoldMask));
+        const __m128i lastFold  = _mm_set1_epi8(static_cast<char>(m_LastFoldMask));
+
+        std::size_t i = from;
+        for (; i + 16 <= startCount; i += 16)
+        {
+            const __m128i blockFirst = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i)), firstFold);
+            const __m128i blockLast =
+                _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + patternSize - 1)), lastFold);
+
+            uint32_t mask = static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+            for (; mask != 0; mask &= mask - 1)
+            {
+                const std::size_t position = i + static_cast<std::size_t>(std::countr_zero(mask));
+                if (IsMatchAt(text.data() + position)) return position;
+            }
+        }
+
+        return FindScalar(text, i);
+    }
+
+    NSUDB_TARGET_AVX2 std::size_t TextSearcher::FindAvx2(std::string_view text, std::size_t from) const noexcept
+    {
+        const std::size_t patternSize = m_Pattern.size();
+        const std::size_t startCount  = text.size() - patternSize + 1;
+
+        const __m256i first     = _mm256_set1_epi8(m_FirstByte);
+        const __m256i last      = _mm256_set1_epi8(m_LastByte);
+        const __m256i firstFold = _mm256_set1_epi8(static_cast<char>(m_FirstFoldMask));
+        const __m256i lastFold  = _mm256_set1_epi8(static_cast<char>(m_LastFoldMask));
+
+        std::size_t i = from;
+        for (; i + 32 <= startCount; i += 32)
+        {
+            const __m256i blockFirst =
+                _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i)), firstFold);
+            const __m256i blockLast =
+                _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + patternSize - 1)), lastFold);
+
+            uint32_t mask = static_cast<uint32_t>(
+                _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+            for (; mask != 0; mask &= mask - 1)
+            {
+                const std::size_t position = i + static_cast<std::size_t>(std::countr_zero(mask));
+                if (IsMatchAt(text.data() + position)) return position;
+            }
+        }
+
+        return FindScalar(text, i);
+    }
+
+#else
+
+    std::size_t TextSearcher::FindSse2(std::string_view text, std::size_t from) const noexcept
+    {
+        return FindScalar(text, from);
+    }
+
+    std::size_t TextSearcher::FindAvx2(std::string_view text, std::size_t from) const noexcept
+    {
+        return FindScalar(text, from);
+    }
+
+#endif
+
+    static bool CellContains(const QueryResult& result, const TextSearcher& searcher, std::size_t row, std::size_t column,
+                             QueryResult::FormatBuffer& formatBuffer) noexcept
+    {
+        return !result.IsNull(row, column) && searcher.Find(result.FormatValue(row, column, formatBuffer)) != std::string_view::npos;
+    }
+
+    // Typed values print from a small alphabet: a pattern with anything else in it can't match and the column
+    // isn't formatted at all, which is most of the cost of searching a typed column.
+    static bool CanMatchTypedColumn(EColumnType columnType, const TextSearcher& searcher) noexcept
+    {
+        std::string_view alphabet{};
+        switch (columnType)
+        {
+            case EColumnType::Text: return true;
+            case EColumnType::Bool: alphabet = "tf"; break;
+            case EColumnType::Int32:
+            case EColumnType::Int64: alphabet = "0123456789-"; break;
+            default: alphabet = "0123456789-+.: eEinfityINFaNBC"; break;  // infinity, NaN, 1e+20, BC dates
+        }
+
+        return std::ranges::all_of(searcher.GetPattern(), [&](const char c) { return alphabet.find(c) != std::string_view::npos; });
+    }
+
+    struct SearchTask final
+    {
+        std::size_t Column{0};
+        std::size_t FirstRow{0};
+        std::size_t LastRow{0};  // exclusive
+        std::vector<SearchMatch> Matches{};
+    };
+
+    static void RunSearchTask(const QueryResult& result, const TextSearcher& searcher, SearchTask& task) noexcept
+    {
+        const std::size_t column = task.Column;
+        if (result.GetColumnType(column) != EColumnType::Text)
+        {
+            QueryResult::FormatBuffer formatBuffer{};
+            for (std::size_t row = task.FirstRow; row < task.LastRow; ++row)
+                if (CellContains(result, searcher, row, column, formatBuffer))
+                    task.Matches.emplace_back(SearchMatch{.Row = static_cast<uint32_t>(row), .Column = static_cast<uint32_t>(column)});
+            return;
+        }
+
+        // The chunk's cells are one contiguous run of the arena: scan it in one go, map every hit back to its row and
+        // drop hits straddling two cells. Either way the scan goes on from the next row, one match per cell is enough.
+        const std::span<const uint64_t> offsets = result.GetColumnOffsets(column);
+        const std::string_view text             = result.GetColumnArena(column).substr(0, offsets[task.LastRow]);
+
+        std::size_t position = offsets[task.FirstRow];
+        std::size_t row      = task.FirstRow;
+        while ((position = searcher.Find(text, position)) != std::string_view::npos)
+        {
+            row = static_cast<std::size_t>(std::upper_bound(offsets.begin() + row + 1, offsets.begin() + task.LastRow + 1, position) -
+                                           offsets.begin()) -
+                  1;
+            if (position + searcher.GetPattern().size() <= offsets[row + 1])
+                task.Matches.emplace_back(SearchMatch{.Row = static_cast<uint32_t>(row), .Column = static_cast<uint32_t>(column)});
+
+            if (++row >= task.LastRow) break;
+            position = offsets[row];
+        }
+    }
+
+    std::vector<SearchMatch> FindInResult(const QueryResult& result, const TextSearcher& searcher) noexcept
+    {
+        if (searcher.GetPattern().empty()) return {};
+
+        std::vector<SearchTask> tasks{};
+        for (std::size_t column{}; column < result.GetColumnCount(); ++column)
+        {
+            if (!CanMatchTypedColumn(result.GetColumnType(column), searcher)) continue;
+
+            for (std::size_t firstRow{}; firstRow < result.GetRowCount(); firstRow += s_SearchChunkRows)
+            {
+                const std::size_t lastRow = std::min(firstRow + s_SearchChunkRows, result.GetRowCount());
+                tasks.emplace_back(SearchTask{.Column = column, .FirstRow = firstRow, .LastRow = lastRow});
+            }
+        }
+
+        std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](SearchTask& task) { RunSearchTask(result, searcher, task); });
+
+        std::vector<SearchMatch> matches{};
+        for (const auto& task : tasks)
+            matches.insert(matches.end(), task.Matches.begin(), task.Matches.end());
+        std::sort(std::execution::par, matches.begin(), matches.end());
+
+        return matches;
+    }
+
+    std::vector<SearchMatch> RefineSearchMatches(const QueryResult& result, const TextSearcher& searcher,
+                                                 const std::vector<SearchMatch>& candidates) noexcept
+    {
+        if (searcher.GetPattern().empty()) return {};
+
+        std::vector<SearchMatch> matches(candidates.size());
+        const auto matchesEnd = std::copy_if(std::execution::par, candidates.begin(), candidates.end(), matches.begin(),
+                                             [&](const SearchMatch& candidate)
+                                             {
+                                                 QueryResult::FormatBuffer formatBuffer{};
+                                                 return CellContains(result, searcher, candidate.Row, candidate.Column, formatBuffer);
+                                             });
+        matches.erase(matchesEnd, matches.end());
+
+        return matches;
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <QueryResult.hpp>
+
+namespace nsudb
+{
+
+    // Instruction sets the substring scan can run on, picked once at runtime from what the CPU reports.
+    enum class ESearchKernel : uint8_t
+    {
+        Scalar = 0,
+        Sse2,  // 16 bytes per step, every x64 CPU has it
+        Avx2   // 32 bytes per step
+    };
+
+    ESearchKernel GetFastestSearchKernel() noexcept;
+    const char* GetSearchKernelName(ESearchKernel kernel) noexcept;
+
+    // Substring search over UTF-8, case-insensitive for ASCII and basic Cyrillic letters (U+0400..U+044F, the names in
+    // this database) unless asked otherwise. The vector kernels compare the pattern's first and last byte against a whole
+    // block of positions at once and only verify the rest where both match, so most of the text is never looked at byte by byte.
+    struct TextSearcher final
+    {
+        explicit TextSearcher(std::string_view pattern, bool bCaseSensitive = false,
+                              ESearchKernel kernel = GetFastestSearchKernel()) noexcept;
+
+        // Offset of the first match at or after from, std::string_view::npos if there is none.
+        std::size_t Find(std::string_view text, std::size_t from = 0) const noexcept;
+
+        const std::string& GetPattern() const noexcept { return m_Pattern; }
+        bool IsCaseSensitive() const noexcept { return m_bCaseSensitive; }
+
+      private:
+        std::string m_Pattern{};  // lowercased unless case-sensitive
+        bool m_bCaseSensitive{false};
+        ESearchKernel m_Kernel{ESearchKernel::Scalar};
+
+        // Bits ORed into a text byte before comparing it with the first/last pattern byte (ORed the same way), so both
+        // cases of a letter pass: 0x20 for ASCII letters and most Cyrillic second bytes, 0x10 for the U+0450 row, 0x01 for
+        // Cyrillic lead bytes (0xD0/0xD1), 0 for anything else. Other bytes folding onto them only cost a verification.
+        uint8_t m_FirstFoldMask{0};
+        uint8_t m_LastFoldMask{0};
+        char m_FirstByte{0};
+        char m_LastByte{0};
+
+        bool IsMatchAt(const char* text) const noexcept;
+        std::size_t FindScalar(std::string_view text, std::size_t from) const noexcept;
+        std::size_t FindSse2(std::string_view text, std::size_t from) const noexcept;
+        std::size_t FindAvx2(std::string_view text, std::size_t from) const noexcept;
+    };
+
+    struct SearchMatch final
+    {
+        uint32_t Row{0};
+        uint32_t Column{0};
+
+        auto operator<=>(const SearchMatch&) const noexcept = default;
+    };
+
+    // Every cell containing the pattern, sorted by row then column. Text columns are scanned as one arena per chunk of
+    // rows, typed ones formatted the way the grid prints them; chunks run with std::execution::par. NULLs never match.
+    std::vector<SearchMatch> FindInResult(const QueryResult& result, const TextSearcher& searcher) noexcept;
+
+    // Only the given cells are checked, for a pattern that contains the one candidates were found with:
+    // typing further into the find box narrows the previous matches instead of rescanning everything.
+    std::vector<SearchMatch> RefineSearchMatches(const QueryResult& result, const TextSearcher& searcher,
+                                                 const std::vector<SearchMatch>& candidates) noexcept;
+
+}  // namespace nsudb
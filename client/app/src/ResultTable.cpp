@@ -0,0 +1,352 @@
+#include "ResultTable.hpp"
+
+#include <imgui.h>
+
+#include <QueryResult.hpp>
+#include <ResultCursor.hpp>
+
+namespace nsudb
+{
+
+    // What the grid body gets clipped to, decided once the headers are in.
+    struct ClippedRows final
+    {
+        std::size_t RowCount{0};
+        std::optional<std::size_t> ScrollToRow{};  // brought into view this frame
+    };
+
+    // Common body of both grids, TValueGetter returns std::optional<std::string_view> (nullopt = not loaded yet),
+    // TOnHeaders may submit frozenRowCount - 1 more rows under the header and returns the ClippedRows,
+    // TOnVisibleRows gets the clipper range before the rows are submitted, TOnCell(row, col) runs before a cell's text.
+    template <typename TOnHeaders, typename TValueGetter, typename TOnVisibleRows, typename TOnCell>
+    static void DrawClippedTable(const char* strId, const std::vector<std::string>& columnNames, const std::vector<float>& columnWidths,
+                                 int frozenRowCount, ImGuiTableFlags tableFlags, float height, TOnHeaders&& onHeaders,
+                                 TValueGetter&& getValue, TOnVisibleRows&& onVisibleRows, TOnCell&& onCell) noexcept
+    {
+        if (columnNames.empty() || !ImGui::BeginTable(strId, static_cast<int>(columnNames.size()), tableFlags, ImVec2(0.0f, height)))
+            return;
+
+        ImGui::TableSetupScrollFreeze(0, frozenRowCount);  // keep the header visible
+        for (std::size_t col{}; col < columnNames.size(); ++col)
+            ImGui::TableSetupColumn(columnNames[col].c_str(), ImGuiTableColumnFlags_WidthFixed, columnWidths[col]);
+        ImGui::TableHeadersRow();
+        const ClippedRows clippedRows = onHeaders();
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(clippedRows.RowCount));
+        if (clippedRows.ScrollToRow) clipper.IncludeItemByIndex(static_cast<int>(*clippedRows.ScrollToRow));
+        while (clipper.Step())
+        {
+            onVisibleRows(static_cast<std::size_t>(clipper.DisplayStart), static_cast<std::size_t>(clipper.DisplayEnd));
+
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                ImGui::TableNextRow();
+                if (clippedRows.ScrollToRow == static_cast<std::size_t>(row)) ImGui::SetScrollHereY(0.5f);
+                for (std::size_t col{}; col < columnNames.size(); ++col)
+                {
+                    // Hidden/clipped columns don't need their text laid out.
+                    if (!ImGui::TableSetColumnIndex(static_cast<int>(col))) continue;
+
+                    onCell(static_cast<std::size_t>(row), col);
+
+                    if (const std::optional<std::string_view> value = getValue(static_cast<std::size_t>(row), col); value)
+                        ImGui::TextUnformatted(value->data(), value->data() + value->size());
+                    else
+                        ImGui::TextDisabled("...");
+                }
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    template <typename TValueGetter>
+    void ResultTable::MeasureColumns(const std::vector<std::string>& columnNames, std::size_t sampleRowCount,
+                                     TValueGetter&& getValue) noexcept
+    {
+        const ImGuiStyle& style   = ImGui::GetStyle();
+        const float cellPaddingX  = style.CellPadding.x * 2.0f;
+        const float headerPadding = style.ItemInnerSpacing.x + ImGui::GetFontSize();  // room for the sort arrow
+
+        m_ColumnWidths.assign(columnNames.size(), 0.0f);
+        for (std::size_t col{}; col < columnNames.size(); ++col)
+        {
+            float width = ImGui::CalcTextSize(columnNames[col].c_str()).x + headerPadding;
+            for (std::size_t row{}; row < sampleRowCount; ++row)
+            {
+                if (const std::optional<std::string_view> value = getValue(row, col); value)
+                    width = std::max(width, ImGui::CalcTextSize(value->data(), value->data() + value->size()).x);
+            }
+
+            m_ColumnWidths[col] = std::min(width + cellPaddingX, s_MaxInitialColumnWidth);
+        }
+    }
+
+    void ResultTable::Reset() noexcept
+    {
+        m_ColumnWidths.clear();
+        m_HeaderLabels.clear();
+        ++m_Generation;
+
+        m_View.Reset();
+        m_FilterBuffers.clear();
+        m_Sorts.clear();
+        m_bViewDirty     = true;
+        m_FilterEditTime = -1.0;
+        m_GroupColumn    = -1;
+        m_GroupedResult.reset();
+        m_GroupedTable.reset();
+
+        m_FindBuffer = {};
+        m_FindPattern.clear();
+        m_FindMatches.clear();
+        m_FindHitRows.clear();
+        m_FindHitIndex   = 0;
+        m_bFindHitsDirty = false;
+        m_bScrollToHit   = false;
+    }
+
+    void ResultTable::UpdateFind(const QueryResult& result) noexcept
+    {
+        const std::string_view pattern(m_FindBuffer.data());
+        if (pattern == m_FindPattern) return;
+
+        // A longer pattern containing the previous one can only match cells that matched before.
+        const auto startTime = std::chrono::steady_clock::now();
+        const TextSearcher searcher(pattern);
+        if (!m_FindPattern.empty() && pattern.find(m_FindPattern) != std::string_view::npos)
+            m_FindMatches = RefineSearchMatches(result, searcher, m_FindMatches);
+        else
+            m_FindMatches = FindInResult(result, searcher);
+        m_FindMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        m_FindPattern    = pattern;
+        m_FindHitIndex   = 0;
+        m_bFindHitsDirty = true;
+        m_bScrollToHit   = true;
+    }
+
+    void ResultTable::StepFindHit(bool bBackwards) noexcept
+    {
+        if (m_FindHitRows.empty()) return;
+
+        m_FindHitIndex = bBackwards ? (m_FindHitIndex + m_FindHitRows.size() - 1) % m_FindHitRows.size()
+                                    : (m_FindHitIndex + 1) % m_FindHitRows.size();
+        m_bScrollToHit = true;
+    }
+
+    void ResultTable::DrawGrid(const char* strId, const QueryResult& result, ImGuiTableFlags tableFlags, float height) noexcept
+    {
+        // Typed (binary) columns are formatted only for the cells that actually get drawn or measured.
+        QueryResult::FormatBuffer formatBuffer{};
+        const auto getValue = [&](std::size_t row, std::size_t col) -> std::optional<std::string_view>
+        { return result.FormatValue(m_View.GetSourceRow(row), col, formatBuffer); };
+
+        if (m_FilterBuffers.size() != result.GetColumnCount())
+        {
+            m_FilterBuffers.assign(result.GetColumnCount(), {});
+            m_bViewDirty = true;
+        }
+
+        const auto onHeaders = [&]() -> ClippedRows
+        {
+            if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsDirty)
+            {
+                m_Sorts.clear();
+                for (int i{}; i < sortSpecs->SpecsCount; ++i)
+                {
+                    const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[i];
+                    m_Sorts.emplace_back(ColumnSort{.Column    = static_cast<std::size_t>(spec.ColumnIndex),
+                                                    .Direction = spec.SortDirection == ImGuiSortDirection_Descending
+                                                                     ? ESortDirection::Descending
+                                                                     : ESortDirection::Ascending});
+                }
+                sortSpecs->SpecsDirty = false;
+                m_bViewDirty          = true;
+            }
+
+            ImGui::TableNextRow();
+            for (std::size_t col{}; col < m_FilterBuffers.size(); ++col)
+            {
+                if (!ImGui::TableSetColumnIndex(static_cast<int>(col))) continue;
+
+                ImGui::PushID(static_cast<int>(col));
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                if (ImGui::InputTextWithHint("##Filter", "filter", m_FilterBuffers[col].data(), m_FilterBuffers[col].size()))
+                    m_FilterEditTime = ImGui::GetTime();
+                if (ImGui::IsItemDeactivatedAfterEdit()) m_bViewDirty = true;
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("text: contains, case-insensitive\n=x  !=x  <x  <=x  >x  >=x: compare as the column's type\n"
+                                      "null, !null");
+                ImGui::PopID();
+            }
+
+            if (m_FilterEditTime >= 0.0 && (m_View.GetUpdateMilliseconds() < s_ImmediateFilterMilliseconds ||
+                                             ImGui::GetTime() - m_FilterEditTime >= s_FilterDebounceSeconds))
+                m_bViewDirty = true;
+
+            // Rebuilt before any row is drawn, so a header click (or a keystroke on a fast view) shows up in the same frame.
+            if (m_bViewDirty)
+            {
+                std::vector<ColumnFilter> filters{};
+                for (std::size_t col{}; col < m_FilterBuffers.size(); ++col)
+                    if (auto filter = ParseColumnFilter(col, m_FilterBuffers[col].data()); filter) filters.emplace_back(std::move(*filter));
+
+                m_View.Update(result, filters, m_Sorts);
+                m_bViewDirty     = false;
+                m_FilterEditTime = -1.0;
+                m_bFindHitsDirty = true;
+
+                if (m_GroupColumn >= 0)
+                {
+                    m_GroupedResult = m_View.Group(result, static_cast<std::size_t>(m_GroupColumn), m_GroupAggregate);
+                    if (!m_GroupedTable) m_GroupedTable = std::make_unique<ResultTable>();
+                    m_GroupedTable->Reset();
+                }
+            }
+
+            // Hits follow the view order, so stepping through them goes down the grid as displayed.
+            if (m_bFindHitsDirty)
+            {
+                m_FindHitRows.clear();
+                if (!m_FindMatches.empty())
+                {
+                    std::vector<uint8_t> bMatchedRows(result.GetRowCount(), 0);
+                    for (const SearchMatch& match : m_FindMatches)
+                        bMatchedRows[match.Row] = 1;
+                    for (std::size_t row{}; row < m_View.GetRowCount(); ++row)
+                        if (bMatchedRows[m_View.GetSourceRow(row)]) m_FindHitRows.emplace_back(row);
+                }
+
+                m_FindHitIndex   = std::min(m_FindHitIndex, m_FindHitRows.empty() ? 0 : m_FindHitRows.size() - 1);
+                m_bFindHitsDirty = false;
+            }
+
+            ClippedRows clippedRows{.RowCount = m_View.GetRowCount()};
+            if (m_bScrollToHit && !m_FindHitRows.empty()) clippedRows.ScrollToRow = m_FindHitRows[m_FindHitIndex];
+            m_bScrollToHit = false;
+
+            return clippedRows;
+        };
+
+        // Matching cells get a background, the ones on the current hit's row a stronger one.
+        const ImU32 matchColor      = ImGui::GetColorU32(ImVec4(0.9f, 0.7f, 0.1f, 0.25f));
+        const ImU32 currentHitColor = ImGui::GetColorU32(ImVec4(0.9f, 0.7f, 0.1f, 0.6f));
+        const auto onCell           = [&](std::size_t row, std::size_t col)
+        {
+            if (m_FindMatches.empty()) return;
+
+            const SearchMatch cell{.Row = static_cast<uint32_t>(m_View.GetSourceRow(row)), .Column = static_cast<uint32_t>(col)};
+            if (!std::binary_search(m_FindMatches.begin(), m_FindMatches.end(), cell)) return;
+
+            const bool bCurrentHit = !m_FindHitRows.empty() && m_FindHitRows[m_FindHitIndex] == row;
+            ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, bCurrentHit ? currentHitColor : matchColor);
+        };
+
+        if (m_HeaderLabels.size() != result.GetColumnCount())
+        {
+            // Binary timestamptz is shown in UTC, a text result of the same query would be in the session TimeZone.
+            m_HeaderLabels = result.GetColumnNames();
+            for (std::size_t col{}; col < m_HeaderLabels.size(); ++col)
+                if (result.GetColumnType(col) == EColumnType::TimestampTz) m_HeaderLabels[col] += " (UTC)";
+
+            MeasureColumns(m_HeaderLabels, std::min(result.GetRowCount(), s_WidthSampleRows),
+                           [&](std::size_t row, std::size_t col) -> std::optional<std::string_view>
+                           { return result.FormatValue(row, col, formatBuffer); });
+        }
+
+        ImGui::PushID(static_cast<int>(m_Generation));
+        DrawClippedTable(strId, m_HeaderLabels, m_ColumnWidths, 2,
+                         tableFlags | ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_SortTristate, height,
+                         onHeaders, getValue, [](std::size_t, std::size_t) {}, onCell);
+        ImGui::PopID();
+    }
+
+    void ResultTable::Draw(const char* strId, const QueryResult& result, ImGuiTableFlags tableFlags) noexcept
+    {
+        static constexpr const char* s_AggregateNames[] = {"count", "sum", "avg", "min", "max"};
+
+        ImGui::PushID(strId);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10.0f);
+        const char* groupPreview = m_GroupColumn >= 0 ? result.GetColumnNames()[m_GroupColumn].c_str() : "(none)";
+        if (ImGui::BeginCombo("Group by", groupPreview))
+        {
+            for (int32_t col = -1; col < static_cast<int32_t>(result.GetColumnCount()); ++col)
+            {
+                if (!ImGui::Selectable(col >= 0 ? result.GetColumnNames()[col].c_str() : "(none)", col == m_GroupColumn)) continue;
+
+                m_GroupColumn = col;
+                m_bViewDirty  = true;
+                if (col < 0) m_GroupedResult.reset();
+            }
+            ImGui::EndCombo();
+        }
+
+        if (m_GroupColumn >= 0)
+        {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5.0f);
+            int aggregate = static_cast<int>(m_GroupAggregate);
+            if (ImGui::Combo("##Aggregate", &aggregate, s_AggregateNames, IM_ARRAYSIZE(s_AggregateNames)))
+            {
+                m_GroupAggregate = static_cast<EAggregate>(aggregate);
+                m_bViewDirty     = true;
+            }
+        }
+
+        ImGui::SameLine();
+        ImGui::TextDisabled("%zu of %zu rows, view %.2f ms", m_View.GetRowCount(), result.GetRowCount(), m_View.GetUpdateMilliseconds());
+
+        // Find: searched on every change of the text, Enter/Shift+Enter or the arrows step through the hits.
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 12.0f);
+        if (ImGui::InputTextWithHint("##Find", "find in results", m_FindBuffer.data(), m_FindBuffer.size(),
+                                     ImGuiInputTextFlags_EnterReturnsTrue))
+        {
+            StepFindHit(ImGui::GetIO().KeyShift);
+            ImGui::SetKeyboardFocusHere(-1);  // Enter would otherwise leave the box
+        }
+        UpdateFind(result);
+
+        ImGui::SameLine();
+        if (ImGui::ArrowButton("##FindPrevious", ImGuiDir_Up)) StepFindHit(true);
+        ImGui::SameLine();
+        if (ImGui::ArrowButton("##FindNext", ImGuiDir_Down)) StepFindHit(false);
+        ImGui::SameLine();
+        if (!m_FindPattern.empty())
+            ImGui::TextDisabled("%zu / %zu rows, %zu cells, %.2f ms (%s)", m_FindHitRows.empty() ? 0 : m_FindHitIndex + 1,
+                                m_FindHitRows.size(), m_FindMatches.size(), m_FindMilliseconds,
+                                GetSearchKernelName(GetFastestSearchKernel()));
+        else
+            ImGui::NewLine();
+        ImGui::PopID();
+
+        // Grouped: the rows stay on top (their filters pick what gets grouped), the groups below.
+        const bool bGrouped = m_GroupColumn >= 0 && m_GroupedResult && m_GroupedTable;
+        DrawGrid(strId, result, tableFlags, bGrouped ? ImGui::GetContentRegionAvail().y * 0.5f : 0.0f);
+        if (bGrouped)
+        {
+            ImGui::PushID(strId);
+            m_GroupedTable->DrawGrid("##Grouped", *m_GroupedResult, tableFlags, 0.0f);
+            ImGui::PopID();
+        }
+    }
+
+    void ResultTable::Draw(const char* strId, ResultCursor& cursor, ImGuiTableFlags tableFlags) noexcept
+    {
+        const auto getValue = [&](std::size_t row, std::size_t col) { return cursor.GetValue(row, col); };
+
+        // Cursor only knows its columns once the first page arrived, which is also what gets measured.
+        if (m_ColumnWidths.size() != cursor.GetColumnNames().size())
+            MeasureColumns(cursor.GetColumnNames(), std::min({cursor.GetRowCount(), cursor.GetPageSize(), s_WidthSampleRows}), getValue);
+
+        // Rows past the loaded pages are unknown, so the server-side cursor is neither sorted nor filtered here.
+        ImGui::PushID(static_cast<int>(m_Generation));
+        DrawClippedTable(strId, cursor.GetColumnNames(), m_ColumnWidths, 1, tableFlags, 0.0f,
+                         [&]() { return ClippedRows{.RowCount = cursor.GetRowCount()}; }, getValue,
+                         [&](std::size_t firstRow, std::size_t lastRow) { cursor.RequestRows(firstRow, lastRow); },
+                         [](std::size_t, std::size_t) {});
+        ImGui::PopID();
+    }
+
+}  // namespace nsudb
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ResultSearch.hpp>
+#include <ResultView.hpp>
+
+typedef int ImGuiTableFlags;
+
+namespace nsudb
+{
+
+    struct QueryResult;
+    struct ResultCursor;
+
+    // Virtualized grid shared by the SQL result pane and the table browser. Only rows inside the scroll window
+    // are submitted (ImGuiListClipper), column widths are measured once per result instead of every frame,
+    // so per-frame cost doesn't depend on the result size.
+    // Loaded results can be sorted (header clicks, shift for more columns), filtered (row under the header) and
+    // grouped client-side, all through a ResultView so the result itself is never copied or reordered.
+    // The find box highlights matching cells and steps through the rows holding them (Enter / Shift+Enter).
+    struct ResultTable final
+    {
+        static constexpr std::size_t s_WidthSampleRows = 256;  // rows measured when sizing columns
+        static constexpr float s_MaxInitialColumnWidth = 400.0f;
+
+        static constexpr std::size_t s_FilterBufferSize = 64;
+
+        // Views that update faster than this refilter on every keystroke, slower ones once typing pauses for s_FilterDebounceSeconds
+        // (or the filter box loses focus), so a large result doesn't stall every frame of typing.
+        static constexpr float s_ImmediateFilterMilliseconds = 4.0f;
+        static constexpr double s_FilterDebounceSeconds      = 0.3;
+
+        // Drops cached column widths and the sort/filter/group/find state, call whenever the displayed result gets replaced.
+        void Reset() noexcept;
+
+        void Draw(const char* strId, const QueryResult& result, ImGuiTableFlags tableFlags) noexcept;
+
+        // Also requests the cursor pages that became visible.
+        void Draw(const char* strId, ResultCursor& cursor, ImGuiTableFlags tableFlags) noexcept;
+
+      private:
+        std::vector<float> m_ColumnWidths{};
+        std::vector<std::string> m_HeaderLabels{};  // column names of the loaded result, binary timestamptz ones marked (UTC)
+        uint32_t m_Generation{0};                   // new ImGui ID per result, so the fresh widths (and scroll) actually get applied
+
+        ResultView m_View{};
+        std::vector<std::array<char, s_FilterBufferSize>> m_FilterBuffers{};
+        std::vector<ColumnSort> m_Sorts{};
+        bool m_bViewDirty{true};         // filters or sorts changed, the view gets rebuilt before rows are drawn
+        double m_FilterEditTime{-1.0};  // ImGui::GetTime() of the last filter edit not applied yet, negative when none
+
+        int32_t m_GroupColumn{-1};  // -1 = not grouped
+        EAggregate m_GroupAggregate{EAggregate::Sum};
+        std::optional<QueryResult> m_GroupedResult{};
+        std::unique_ptr<ResultTable> m_GroupedTable{};  // the grouped result is a sortable/filterable grid of its own
+
+        std::array<char, s_FilterBufferSize> m_FindBuffer{};
+        std::string m_FindPattern{};              // what m_FindMatches were searched for
+        std::vector<SearchMatch> m_FindMatches{};  // sorted by (row, column) of the result
+        std::vector<std::size_t> m_FindHitRows{};  // view rows holding a match, in view order
+        std::size_t m_FindHitIndex{0};
+        bool m_bFindHitsDirty{false};  // matches or view changed, m_FindHitRows get rebuilt with the view
+        bool m_bScrollToHit{false};
+        float m_FindMilliseconds{0.0f};
+
+        void UpdateFind(const QueryResult& result) noexcept;
+        void StepFindHit(bool bBackwards) noexcept;
+
+        template <typename TValueGetter>
+        void MeasureColumns(const std::vector<std::string>& columnNames, std::size_t sampleRowCount, TValueGetter&& getValue) noexcept;
+
+        // Sortable, filterable grid over m_View, height 0 fills the available space.
+        void DrawGrid(const char* strId, const QueryResult& result, ImGuiTableFlags tableFlags, float height) noexcept;
+    };
+
+}  // namespace nsudb
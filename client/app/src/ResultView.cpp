@@ -0,0 +1,544 @@
+#include "ResultView.hpp"
+#include <BinaryFormat.hpp>
+#include <ResultSearch.hpp>
+
+#include <bit>
+#include <charconv>
+
+namespace nsudb
+{
+
+    using EKeyKind = ResultView::EKeyKind;
+
+    static constexpr int64_t s_PostgresEpochDays  = 10957;  // 1970-01-01 -> 2000-01-01
+    static constexpr int64_t s_MicrosecondsPerDay = 86'400'000'000;
+
+    static std::string_view TrimWhitespace(std::string_view text) noexcept
+    {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+            text.remove_prefix(1);
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+            text.remove_suffix(1);
+
+        return text;
+    }
+
+    // Finite numbers only, from_chars would take "inf" and "nan" too.
+    static std::optional<double> ParseReal(std::string_view text) noexcept
+    {
+        double value{0.0};
+        const auto [end, errorCode] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (errorCode != std::errc{} || end != text.data() + text.size() || text.empty() || !std::isfinite(value)) return std::nullopt;
+
+        return value;
+    }
+
+    static std::optional<int64_t> ParseInteger(std::string_view text) noexcept
+    {
+        int64_t value{0};
+        const auto [end, errorCode] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (errorCode != std::errc{} || end != text.data() + text.size() || text.empty()) return std::nullopt;
+
+        return value;
+    }
+
+    // Days since 1970-01-01 from a proleptic Gregorian date, see http://howardhinnant.github.io/date_algorithms.html
+    static int64_t DaysFromCivil(int64_t year, uint32_t month, uint32_t day) noexcept
+    {
+        year -= month <= 2;
+        const int64_t era        = (year >= 0 ? year : year - 399) / 400;
+        const uint32_t yearOfEra = static_cast<uint32_t>(year - era * 400);
+        const uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const uint32_t dayOfEra  = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+    }
+
+    // "YYYY-MM-DD[ HH:MM[:SS[.ffffff]]]" as microseconds since 2000-01-01, how the grid prints timestamps (time zone suffix ignored).
+    static std::optional<int64_t> ParseTimestamp(std::string_view text) noexcept
+    {
+        const auto readNumber = [&](std::size_t offset, std::size_t length) -> std::optional<int64_t>
+        { return offset + length <= text.size() ? ParseInteger(text.substr(offset, length)) : std::nullopt; };
+
+        const auto year  = readNumber(0, 4);
+        const auto month = readNumber(5, 2);
+        const auto day   = readNumber(8, 2);
+        if (!year || !month || !day || text[4] != '-' || text[7] != '-' || *month < 1 || *month > 12 || *day < 1 || *day > 31)
+            return std::nullopt;
+
+        int64_t microseconds = (DaysFromCivil(*year, static_cast<uint32_t>(*month), static_cast<uint32_t>(*day)) - s_PostgresEpochDays) *
+                               s_MicrosecondsPerDay;
+        if (text.size() <= 10) return microseconds;
+
+        const auto hours   = readNumber(11, 2);
+        const auto minutes = readNumber(14, 2);
+        if (!hours || !minutes || text[13] != ':') return std::nullopt;
+        microseconds += (*hours * 60 + *minutes) * 60'000'000;
+
+        if (text.size() >= 19 && text[16] == ':')
+        {
+            const auto seconds = readNumber(17, 2);
+            if (!seconds) return std::nullopt;
+            microseconds += *seconds * 1'000'000;
+
+            // Fraction digits past the sixth are dropped, missing ones count as zeros.
+            if (text.size() > 20 && text[19] == '.')
+            {
+                int64_t fraction{0};
+                std::size_t digitCount{0};
+                for (std::size_t i = 20; i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])); ++i, ++digitCount)
+                    if (digitCount < 6) fraction = fraction * 10 + (text[i] - '0');
+                for (; digitCount < 6; ++digitCount)
+                    fraction *= 10;
+                microseconds += fraction;
+            }
+        }
+
+        return microseconds;
+    }
+
+    // Operand in the column's int64 representation, see QueryResult::GetInt64().
+    static std::optional<int64_t> ParseIntegerOperand(EColumnType columnType, std::string_view operand) noexcept
+    {
+        switch (columnType)
+        {
+            case EColumnType::Bool:
+                if (operand == "t" || operand == "true") return 1;
+                if (operand == "f" || operand == "false") return 0;
+                return std::nullopt;
+            case EColumnType::Date:
+            {
+                const auto microseconds = ParseTimestamp(operand.substr(0, 10));
+                return microseconds ? std::optional<int64_t>(*microseconds / s_MicrosecondsPerDay) : std::nullopt;
+            }
+            case EColumnType::Timestamp:
+            case EColumnType::TimestampTz: return ParseTimestamp(operand);
+            default: return ParseInteger(operand);
+        }
+    }
+
+    std::optional<ColumnFilter> ParseColumnFilter(std::size_t column, std::string_view expression) noexcept
+    {
+        expression = TrimWhitespace(expression);
+        if (expression.empty()) return std::nullopt;
+
+        std::string lowercase(expression);
+        std::ranges::transform(lowercase, lowercase.begin(),
+                               [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        if (lowercase == "null") return ColumnFilter{.Column = column, .Op = EFilterOp::IsNull};
+        if (lowercase == "!null" || lowercase == "not null") return ColumnFilter{.Column = column, .Op = EFilterOp::IsNotNull};
+
+        // Longer prefixes first, "<=" must not be taken for "<".
+        static constexpr std::pair<std::string_view, EFilterOp> s_Prefixes[] = {
+            {">=", EFilterOp::GreaterOrEqual}, {"<=", EFilterOp::LessOrEqual}, {"!=", EFilterOp::NotEqual}, {"<>", EFilterOp::NotEqual},
+            {"=", EFilterOp::Equal},           {"<", EFilterOp::Less},         {">", EFilterOp::Greater}};
+        for (const auto& [prefix, op] : s_Prefixes)
+        {
+            if (!expression.starts_with(prefix)) continue;
+
+            return ColumnFilter{.Column = column, .Op = op, .Operand = std::string(TrimWhitespace(expression.substr(prefix.size())))};
+        }
+
+        return ColumnFilter{.Column = column, .Op = EFilterOp::Contains, .Operand = std::move(lowercase)};
+    }
+
+    void ResultView::Reset() noexcept
+    {
+        m_Rows.clear();
+        m_ColumnKinds.clear();
+        m_UpdateMilliseconds = 0.0f;
+    }
+
+    EKeyKind ResultView::GetColumnKind(const QueryResult& result, std::size_t column) noexcept
+    {
+        if (m_ColumnKinds.size() != result.GetColumnCount()) m_ColumnKinds.assign(result.GetColumnCount(), std::nullopt);
+        if (m_ColumnKinds[column]) return *m_ColumnKinds[column];
+
+        EKeyKind kind = EKeyKind::Integer;
+        switch (result.GetColumnType(column))
+        {
+            case EColumnType::Float64:
+            case EColumnType::Numeric: kind = EKeyKind::Real; break;
+            case EColumnType::Text:
+                // Plain SQL comes back as text, numbers still sort as numbers when the server says they are. Text that only
+                // happens to look numeric ("007", phone numbers) stays text.
+                kind = BinaryFormat::IsNumericType(result.GetColumnTypeOid(column)) ? EKeyKind::Real : EKeyKind::Text;
+                break;
+            default: break;
+        }
+
+        m_ColumnKinds[column] = kind;
+        return kind;
+    }
+
+    // Text values are numbers the server printed, its special values included. NaN sorts above everything, as in PostgreSQL.
+    static double GetRealValue(const QueryResult& result, std::size_t row, std::size_t column) noexcept
+    {
+        if (result.GetColumnType(column) != EColumnType::Text) return result.GetFloat64(row, column);
+
+        const std::string_view text = result.GetValue(row, column);
+        if (const auto value = ParseReal(text); value) return *value;
+        if (text == "Infinity") return std::numeric_limits<double>::infinity();
+        if (text == "-Infinity") return -std::numeric_limits<double>::infinity();
+        if (text == "NaN") return std::numeric_limits<double>::quiet_NaN();
+
+        return 0.0;
+    }
+
+    // Integer and (non-float) numeric cells as value * 10^-scale, nullopt for anything else.
+    static std::optional<std::pair<int64_t, uint8_t>> GetScaledValue(const QueryResult& result, std::size_t row,
+                                                                     std::size_t column) noexcept
+    {
+        switch (result.GetColumnType(column))
+        {
+            case EColumnType::Int32:
+            case EColumnType::Int64: return std::pair{result.GetInt64(row, column), uint8_t{0}};
+            case EColumnType::Numeric:
+            {
+                const uint8_t scale = result.GetColumnNumericScales(column)[row];
+                if (scale == QueryResult::s_NumericAsFloat64) return std::nullopt;
+
+                return std::pair{result.GetColumnValues(column)[row], scale};
+            }
+            default: return std::nullopt;
+        }
+    }
+
+    static bool MultiplyBy10(int64_t& value) noexcept
+    {
+        if (value > std::numeric_limits<int64_t>::max() / 10 || value < std::numeric_limits<int64_t>::min() / 10) return false;
+
+        value *= 10;
+        return true;
+    }
+
+    // sum += value, both scaled, at the larger of the two scales. False (sum left undefined) once it doesn't fit an int64.
+    static bool AddScaled(int64_t& sum, uint8_t& sumScale, int64_t value, uint8_t scale) noexcept
+    {
+        for (; sumScale < scale; ++sumScale)
+            if (!MultiplyBy10(sum)) return false;
+        for (; scale < sumScale; ++scale)
+            if (!MultiplyBy10(value)) return false;
+
+        if ((value > 0 && sum > std::numeric_limits<int64_t>::max() - value) ||
+            (value < 0 && sum < std::numeric_limits<int64_t>::min() - value))
+            return false;
+
+        sum += value;
+        return true;
+    }
+
+    // Unsigned keys ordered like the values: sign bit flipped for integers, all bits of negative doubles.
+    static uint64_t GetIntegerKey(int64_t value) noexcept
+    {
+        return static_cast<uint64_t>(value) ^ (uint64_t{1} << 63);
+    }
+
+    static uint64_t GetRealKey(double value) noexcept
+    {
+        const uint64_t bits = std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value);  // -0 equal to 0
+        return (bits >> 63) ? ~bits : bits | (uint64_t{1} << 63);
+    }
+
+    // First 8 bytes big-endian, zero padded: orders like memcmp up to the first tie.
+    static uint64_t GetTextPrefixKey(std::string_view text) noexcept
+    {
+        uint64_t key{0};
+        for (std::size_t i{}; i < sizeof(key); ++i)
+            key = (key << 8) | (i < text.size() ? static_cast<unsigned char>(text[i]) : 0u);
+
+        return key;
+    }
+
+    struct SortEntry final
+    {
+        uint64_t Key{0};
+        uint32_t Position{0};  // in the order before this pass, the final tie-break keeps passes stable
+        uint32_t Row{0};
+    };
+
+    static void SortRows(const QueryResult& result, std::vector<uint32_t>& rows, const ColumnSort& sort, EKeyKind kind) noexcept
+    {
+        const std::size_t column = sort.Column;
+        const bool bDescending   = sort.Direction == ESortDirection::Descending;
+
+        // NULLs don't take part, they go after (before, descending) the sorted values.
+        const auto nullsBegin = std::stable_partition(std::execution::par, rows.begin(), rows.end(),
+                                                      [&](const uint32_t row) { return !result.IsNull(row, column); });
+
+        std::vector<SortEntry> entries(static_cast<std::size_t>(nullsBegin - rows.begin()));
+        for (std::size_t i{}; i < entries.size(); ++i)
+        {
+            entries[i].Position = static_cast<uint32_t>(i);
+            entries[i].Row      = rows[i];
+        }
+
+        std::for_each(std::execution::par, entries.begin(), entries.end(),
+                      [&](SortEntry& entry)
+                      {
+                          switch (kind)
+                          {
+                              case EKeyKind::Integer: entry.Key = GetIntegerKey(result.GetInt64(entry.Row, column)); break;
+                              case EKeyKind::Real: entry.Key = GetRealKey(GetRealValue(result, entry.Row, column)); break;
+                              case EKeyKind::Text: entry.Key = GetTextPrefixKey(result.GetValue(entry.Row, column)); break;
+                          }
+                          if (bDescending) entry.Key = ~entry.Key;
+                      });
+
+        std::sort(std::execution::par, entries.begin(), entries.end(),
+                  [&](const SortEntry& lhs, const SortEntry& rhs)
+                  {
+                      if (lhs.Key != rhs.Key) return lhs.Key < rhs.Key;
+                      if (kind == EKeyKind::Text)
+                      {
+                          const int order = result.GetValue(lhs.Row, column).compare(result.GetValue(rhs.Row, column));
+                          if (order != 0) return bDescending ? order > 0 : order < 0;
+                      }
+
+                      return lhs.Position < rhs.Position;
+                  });
+
+        for (std::size_t i{}; i < entries.size(); ++i)
+            rows[i] = entries[i].Row;
+
+        if (bDescending) std::rotate(rows.begin(), nullsBegin, rows.end());
+    }
+
+    // Filter with its operand converted once to the column's representation.
+    struct CompiledFilter final
+    {
+        ColumnFilter Filter{};
+        EKeyKind Kind{EKeyKind::Text};
+        std::optional<TextSearcher> Searcher{};  // Contains only, folds case the way the find box does
+        bool bTyped{false};  // operand parsed for Kind, otherwise the displayed text is compared
+        int64_t IntegerOperand{0};
+        double RealOperand{0.0};
+    };
+
+    static bool MatchesFilter(const QueryResult& result, std::size_t row, const CompiledFilter& compiled) noexcept
+    {
+        const ColumnFilter& filter = compiled.Filter;
+        const bool bNull           = result.IsNull(row, filter.Column);
+        if (filter.Op == EFilterOp::IsNull) return bNull;
+        if (filter.Op == EFilterOp::IsNotNull || bNull) return !bNull && filter.Op == EFilterOp::IsNotNull;
+
+        QueryResult::FormatBuffer formatBuffer{};
+        if (filter.Op == EFilterOp::Contains)
+            return compiled.Searcher->Find(result.FormatValue(row, filter.Column, formatBuffer)) != std::string_view::npos;
+
+        std::strong_ordering order = std::strong_ordering::equal;
+        if (compiled.bTyped && compiled.Kind == EKeyKind::Integer)
+            order = result.GetInt64(row, filter.Column) <=> compiled.IntegerOperand;
+        else if (compiled.bTyped && compiled.Kind == EKeyKind::Real)
+            order = GetRealKey(GetRealValue(result, row, filter.Column)) <=> GetRealKey(compiled.RealOperand);
+        else
+            order = result.FormatValue(row, filter.Column, formatBuffer).compare(filter.Operand) <=> 0;
+
+        switch (filter.Op)
+        {
+            case EFilterOp::Equal: return order == 0;
+            case EFilterOp::NotEqual: return order != 0;
+            case EFilterOp::Less: return order < 0;
+            case EFilterOp::LessOrEqual: return order <= 0;
+            case EFilterOp::Greater: return order > 0;
+            case EFilterOp::GreaterOrEqual: return order >= 0;
+            default: return true;
+        }
+    }
+
+    void ResultView::Update(const QueryResult& result, const std::vector<ColumnFilter>& filters,
+                            const std::vector<ColumnSort>& sorts) noexcept
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+
+        std::vector<uint32_t> allRows(result.GetRowCount());
+        std::iota(allRows.begin(), allRows.end(), 0u);
+
+        std::vector<CompiledFilter> compiledFilters{};
+        for (const auto& filter : filters)
+        {
+            if (filter.Column >= result.GetColumnCount()) continue;
+
+            CompiledFilter& compiled = compiledFilters.emplace_back(CompiledFilter{.Filter = filter});
+            compiled.Kind            = GetColumnKind(result, filter.Column);
+            if (filter.Op == EFilterOp::Contains)
+                compiled.Searcher.emplace(filter.Operand);
+            else if (compiled.Kind == EKeyKind::Integer)
+            {
+                const auto operand      = ParseIntegerOperand(result.GetColumnType(filter.Column), filter.Operand);
+                compiled.bTyped         = operand.has_value();
+                compiled.IntegerOperand = operand.value_or(0);
+            }
+            else if (compiled.Kind == EKeyKind::Real)
+            {
+                const auto operand   = ParseReal(filter.Operand);
+                compiled.bTyped      = operand.has_value();
+                compiled.RealOperand = operand.value_or(0.0);
+            }
+        }
+
+        if (compiledFilters.empty())
+            m_Rows = std::move(allRows);
+        else
+        {
+            m_Rows.resize(allRows.size());
+            const auto rowsEnd = std::copy_if(std::execution::par, allRows.begin(), allRows.end(), m_Rows.begin(),
+                                              [&](const uint32_t row)
+                                              {
+                                                  return std::ranges::all_of(compiledFilters, [&](const CompiledFilter& compiled)
+                                                                             { return MatchesFilter(result, row, compiled); });
+                                              });
+            m_Rows.erase(rowsEnd, m_Rows.end());
+        }
+
+        // Least significant key first, every pass is stable so the earlier ones break its ties.
+        for (auto sortIt = sorts.rbegin(); sortIt != sorts.rend(); ++sortIt)
+            if (sortIt->Column < result.GetColumnCount()) SortRows(result, m_Rows, *sortIt, GetColumnKind(result, sortIt->Column));
+
+        m_UpdateMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    QueryResult ResultView::Group(const QueryResult& result, std::size_t groupColumn, EAggregate aggregate) noexcept
+    {
+        const EKeyKind groupKind = GetColumnKind(result, groupColumn);
+
+        // Sorted by the group column, equal values end up next to each other and the groups come out in value order.
+        std::vector<uint32_t> rows = m_Rows;
+        SortRows(result, rows, ColumnSort{.Column = groupColumn}, groupKind);
+
+        const auto isSameGroup = [&](const uint32_t lhs, const uint32_t rhs)
+        {
+            const bool bLhsNull = result.IsNull(lhs, groupColumn);
+            if (bLhsNull || result.IsNull(rhs, groupColumn)) return bLhsNull == result.IsNull(rhs, groupColumn);
+
+            switch (groupKind)
+            {
+                case EKeyKind::Integer: return result.GetInt64(lhs, groupColumn) == result.GetInt64(rhs, groupColumn);
+                case EKeyKind::Real: return GetRealValue(result, lhs, groupColumn) == GetRealValue(result, rhs, groupColumn);
+                default: return result.GetValue(lhs, groupColumn) == result.GetValue(rhs, groupColumn);
+            }
+        };
+
+        std::vector<std::size_t> groupStarts{};
+        for (std::size_t i{}; i < rows.size(); ++i)
+            if (i == 0 || !isSameGroup(rows[i - 1], rows[i])) groupStarts.emplace_back(i);
+        groupStarts.emplace_back(rows.size());
+
+        // Integer columns are summed too, bools/dates/timestamps are not.
+        std::vector<std::size_t> aggregatedColumns{};
+        std::vector<bool> exactColumns{};  // integer and numeric, aggregated as scaled int64 instead of double
+        for (std::size_t column{}; aggregate != EAggregate::Count && column < result.GetColumnCount(); ++column)
+        {
+            const EColumnType columnType = result.GetColumnType(column);
+            if (column != groupColumn && (GetColumnKind(result, column) == EKeyKind::Real || columnType == EColumnType::Int32 ||
+                                          columnType == EColumnType::Int64))
+            {
+                aggregatedColumns.emplace_back(column);
+                exactColumns.emplace_back(columnType == EColumnType::Int32 || columnType == EColumnType::Int64 ||
+                                          columnType == EColumnType::Numeric);
+            }
+        }
+
+        static constexpr std::string_view s_AggregateNames[] = {"count", "sum", "avg", "min", "max"};
+        std::vector<std::string> columnNames{result.GetColumnNames()[groupColumn], "count"};
+        for (const std::size_t column : aggregatedColumns)
+            columnNames.emplace_back(std::string(s_AggregateNames[static_cast<std::size_t>(aggregate)]) + "(" +
+                                     result.GetColumnNames()[column] + ")");
+
+        // Exact while every value and the running sum fit a scaled int64 (min/max keep the chosen cell's own value),
+        // otherwise the double. Float numerics and overflows turn a group's aggregate approximate, not wrong.
+        struct GroupAggregate final
+        {
+            double Real{0.0};
+            int64_t Scaled{0};
+            uint8_t Scale{0};
+            bool bExact{false};
+        };
+
+        // Groups are independent, each one fills its own slots.
+        const std::size_t groupCount = groupStarts.size() - 1;
+        std::vector<std::optional<GroupAggregate>> aggregates(groupCount * aggregatedColumns.size());
+        std::vector<std::size_t> groupIndices(groupCount);
+        std::iota(groupIndices.begin(), groupIndices.end(), std::size_t{0});
+        std::for_each(std::execution::par, groupIndices.begin(), groupIndices.end(),
+                      [&](const std::size_t group)
+                      {
+                          for (std::size_t i{}; i < aggregatedColumns.size(); ++i)
+                          {
+                              const std::size_t column = aggregatedColumns[i];
+                              std::size_t valueCount{0};
+                              GroupAggregate accumulator{.bExact = exactColumns[i]};
+                              for (std::size_t rowIndex = groupStarts[group]; rowIndex < groupStarts[group + 1]; ++rowIndex)
+                              {
+                                  const uint32_t row = rows[rowIndex];
+                                  if (result.IsNull(row, column)) continue;
+
+                                  const double value = GetRealValue(result, row, column);
+                                  const auto scaled  = exactColumns[i] ? GetScaledValue(result, row, column) : std::nullopt;
+                                  if (aggregate == EAggregate::Min || aggregate == EAggregate::Max)
+                                  {
+                                      const bool bBetter =
+                                          aggregate == EAggregate::Min ? value < accumulator.Real : value > accumulator.Real;
+                                      if (valueCount == 0 || bBetter)
+                                      {
+                                          accumulator.Real   = value;
+                                          accumulator.bExact = scaled.has_value();
+                                          if (scaled) std::tie(accumulator.Scaled, accumulator.Scale) = *scaled;
+                                      }
+                                  }
+                                  else
+                                  {
+                                      accumulator.Real += value;
+                                      accumulator.bExact = accumulator.bExact && scaled &&
+                                                           AddScaled(accumulator.Scaled, accumulator.Scale, scaled->first, scaled->second);
+                                  }
+                                  ++valueCount;
+                              }
+
+                              if (valueCount == 0) continue;  // SQL aggregates of no values are NULL
+                              if (aggregate == EAggregate::Avg)
+                              {
+                                  if (accumulator.bExact)
+                                      accumulator.Real = static_cast<double>(accumulator.Scaled) / std::pow(10.0, accumulator.Scale);
+                                  accumulator.Real /= static_cast<double>(valueCount);
+                              }
+                              aggregates[group * aggregatedColumns.size() + i] = accumulator;
+                          }
+                      });
+
+        // Sums, minimums and maximums of integer and numeric columns come out as numeric, averages as double.
+        QueryResult grouped(std::move(columnNames));
+        grouped.SetColumnTypeOid(0, result.GetColumnTypeOid(groupColumn));
+        grouped.SetColumnType(1, EColumnType::Int64);
+        for (std::size_t i{}; i < aggregatedColumns.size(); ++i)
+            grouped.SetColumnType(2 + i, exactColumns[i] && aggregate != EAggregate::Avg ? EColumnType::Numeric : EColumnType::Float64);
+        grouped.Reserve(groupCount);
+
+        QueryResult::FormatBuffer formatBuffer{};
+        for (std::size_t group{}; group < groupCount; ++group)
+        {
+            const uint32_t firstRow = rows[groupStarts[group]];
+            if (result.IsNull(firstRow, groupColumn))
+                grouped.AppendNull(0);
+            else
+                grouped.AppendValue(0, result.FormatValue(firstRow, groupColumn, formatBuffer));
+
+            grouped.AppendInt64(1, static_cast<int64_t>(groupStarts[group + 1] - groupStarts[group]));
+            for (std::size_t i{}; i < aggregatedColumns.size(); ++i)
+            {
+                const auto& value = aggregates[group * aggregatedColumns.size() + i];
+                if (!value)
+                    grouped.AppendNull(2 + i);
+                else if (grouped.GetColumnType(2 + i) == EColumnType::Float64)
+                    grouped.AppendFloat64(2 + i, value->Real);
+                else if (value->bExact)
+                    grouped.AppendNumeric(2 + i, value->Scaled, value->Scale);
+                else
+                    grouped.AppendNumeric(2 + i, std::bit_cast<int64_t>(value->Real), QueryResult::s_NumericAsFloat64);
+            }
+            grouped.CommitRow();
+        }
+
+        return grouped;
+    }
+
+}  // namespace nsudb
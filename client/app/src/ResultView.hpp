@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <QueryResult.hpp>
+
+namespace nsudb
+{
+
+    enum class ESortDirection : uint8_t
+    {
+        Ascending = 0,  // NULLs last, like PostgreSQL
+        Descending      // NULLs first
+    };
+
+    struct ColumnSort final
+    {
+        std::size_t Column{0};
+        ESortDirection Direction{ESortDirection::Ascending};
+    };
+
+    enum class EFilterOp : uint8_t
+    {
+        Contains = 0,  // case-insensitive substring of the displayed text
+        Equal,
+        NotEqual,
+        Less,
+        LessOrEqual,
+        Greater,
+        GreaterOrEqual,
+        IsNull,
+        IsNotNull
+    };
+
+    // Comparisons follow the column: numbers (text columns included when the server typed them numeric) as numbers, dates and
+    // timestamps typed as the grid prints them, everything else as text. NULL matches nothing but IsNull, as in SQL.
+    struct ColumnFilter final
+    {
+        std::size_t Column{0};
+        EFilterOp Op{EFilterOp::Contains};
+        std::string Operand{};
+    };
+
+    // "=x", "!=x" ("<>x"), "<x", "<=x", ">x", ">=x", "null", "!null", anything else is Contains. nullopt for a blank expression.
+    std::optional<ColumnFilter> ParseColumnFilter(std::size_t column, std::string_view expression) noexcept;
+
+    enum class EAggregate : uint8_t
+    {
+        Count = 0,
+        Sum,
+        Avg,
+        Min,
+        Max
+    };
+
+    // Rows of a QueryResult in display order, as a permutation of row indices: filtering and sorting never copy or touch
+    // the result itself. Sorts go over order-preserving 8 byte keys (text by its first 8 bytes, ties compared in full)
+    // with std::execution::par, so a million rows re-sort within a frame.
+    struct ResultView final
+    {
+        // All rows in result order again, column kinds are re-detected on the next update.
+        void Reset() noexcept;
+
+        // Rows matching every filter, sorted by the sorts (first one is the primary key). Ties keep result order.
+        void Update(const QueryResult& result, const std::vector<ColumnFilter>& filters, const std::vector<ColumnSort>& sorts) noexcept;
+
+        std::size_t GetRowCount() const noexcept { return m_Rows.size(); }
+        std::size_t GetSourceRow(std::size_t row) const noexcept { return m_Rows[row]; }
+        float GetUpdateMilliseconds() const noexcept { return m_UpdateMilliseconds; }
+
+        // One row per distinct groupColumn value among the view's rows, in value order: the value, count and, unless the
+        // aggregate is Count, the aggregate of every numeric column. NULLs are skipped by aggregates and form a group of their own.
+        // Integer and numeric columns are summed exactly (as scaled int64) as long as the sum fits.
+        QueryResult Group(const QueryResult& result, std::size_t groupColumn, EAggregate aggregate) noexcept;
+
+        // How a column compares, decided once per result.
+        enum class EKeyKind : uint8_t
+        {
+            Integer = 0,  // bool, integers, dates, timestamps: exact int64
+            Real,         // float, numeric and text columns of a numeric server type
+            Text
+        };
+
+      private:
+        std::vector<uint32_t> m_Rows{};
+        std::vector<std::optional<EKeyKind>> m_ColumnKinds{};  // detected on first use
+        float m_UpdateMilliseconds{0.0f};
+
+        EKeyKind GetColumnKind(const QueryResult& result, std::size_t column) noexcept;
+    };
+
+}  // namespace nsudb
@@ -1,9 +1,649 @@
 #include <Application.hpp>
+#include <Benchmarks.hpp>
+#include <BulkLoader.hpp>
+#include <ConnectionPool.hpp>
+#include <DataGenerator.hpp>
+#include <IndexAdvisor.hpp>
+#include <InventoryCompactor.hpp>
+#include <Logger.hpp>
+#include <OrderEntrySimulator.hpp>
+#include <QueryBenchmark.hpp>
+#include <RepricingWorker.hpp>
+#include <ResultExport.hpp>
+
+// host port database user, in that order starting at args[0]. The password isn't taken on the command line, where other users
+// see it in the process list: libpq reads it from PGPASSWORD or the password file (~/.pgpass, %APPDATA%\postgresql\pgpass.conf).
+static nsudb::DatabaseDesc ParseDatabaseDesc(char** args) noexcept
+{
+    return nsudb::DatabaseDesc{.HostName = args[0], .Database = args[2], .Username = args[3], .Port = std::strtol(args[1], nullptr, 10)};
+}
+
+// Common part of the headless modes that work against the database: the logger, a connection to host port database user
+// at argv[2..5], the connect check and its message. run gets the connected connection and returns the exit code.
+static int RunHeadless(char** argv, const nsudb::ConnectionPoolDesc& poolDesc,
+                       const std::function<int(nsudb::DatabaseConnection&, const nsudb::DatabaseDesc&)>& run,
+                       const spdlog::level::level_enum logLevel = spdlog::level::trace) noexcept
+{
+    using namespace nsudb;
+
+    const DatabaseDesc databaseDesc = ParseDatabaseDesc(argv + 2);
+
+    Logger::Init();
+    Logger::GetLogger()->set_level(logLevel);
+
+    int exitCode = 1;
+    {
+        DatabaseConnection connection(databaseDesc, poolDesc);
+        if (connection.TryConnectIfNotConnected())
+            exitCode = run(connection, databaseDesc);
+        else
+            std::fprintf(stderr, "failed to connect to %s:%d/%s\n", databaseDesc.HostName.c_str(), static_cast<int32_t>(databaseDesc.Port),
+                         databaseDesc.Database.c_str());
+    }
+    Logger::Shutdown();
+
+    return exitCode;
+}
+
+// Polls a background task twice a second, printing its progress line, until it finishes.
+// False if it failed, the error is printed as "<action> failed: ...".
+template <typename TTask, typename TPrintProgress>
+static bool WaitForTask(const TTask& task, const char* action, TPrintProgress&& printProgress) noexcept
+{
+    while (!task.IsFinished())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (task.IsFinished()) break;
+
+        printProgress();
+        std::fflush(stdout);
+    }
+
+    if (task.GetStatus() == nsudb::EQueryStatus::Done) return true;
+
+    std::fprintf(stderr, "\n%s failed: %s\n", action, task.GetError().c_str());
+    return false;
+}
+
+static void PrintLoadProgress(const nsudb::BulkLoader& loader) noexcept
+{
+    std::printf("\r%-28s %6.1f%% %12llu rows %8.1f s", loader.IsRecomputing() ? "(recomputing)" : loader.GetCurrentTableName().c_str(),
+                loader.GetProgress() * 100.0f, static_cast<unsigned long long>(loader.GetRowsLoaded()), loader.GetElapsedSeconds());
+}
+
+// db_runner --import-csv host port database user [--defer-triggers] path...
+static int RunCsvImport(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 7)
+    {
+        std::fprintf(stderr, "usage: %s --import-csv host port database user [--defer-triggers] path...\n", argv[0]);
+        return 1;
+    }
+
+    BulkLoadDesc loadDesc{};
+    for (int i = 6; i < argc; ++i)
+    {
+        if (std::string_view(argv[i]) == "--defer-triggers")
+            loadDesc.bDeferTriggers = true;
+        else
+            loadDesc.Paths.emplace_back(argv[i]);
+    }
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            BulkLoader loader(connection, std::move(loadDesc));
+            if (!WaitForTask(loader, "import", [&] { PrintLoadProgress(loader); })) return 1;
+
+            const double sentMiB = static_cast<double>(loader.GetBytesSent()) / (1024.0 * 1024.0);
+            std::printf("\nloaded %llu rows (%.1f MiB) from %zu files in %.2f s, set-based recompute %.2f s\n",
+                        static_cast<unsigned long long>(loader.GetRowsLoaded()), sentMiB, loader.GetFiles().size(),
+                        loader.GetElapsedSeconds(), loader.GetRecomputeSeconds());
+            return 0;
+        });
+}
+
+// --seed N and --threads N of the generator modes, true if args[i] was one of them.
+static bool ParseGeneratorOption(int argc, char** argv, int& i, nsudb::DataGeneratorDesc& generatorDesc) noexcept
+{
+    const std::string_view argument(argv[i]);
+    if (i + 1 >= argc) return false;
+
+    if (argument == "--seed")
+        generatorDesc.Seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (argument == "--threads")
+        generatorDesc.ThreadCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    else
+        return false;
+
+    return true;
+}
+
+// db_runner --generate-csv directory scale [--seed N] [--threads N]
+// Writes every table as <directory>/<table>.csv, the same files for the same seed and scale.
+static int RunCsvGeneration(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 4)
+    {
+        std::fprintf(stderr, "usage: %s --generate-csv directory scale [--seed N] [--threads N]\n", argv[0]);
+        return 1;
+    }
+
+    DataGeneratorDesc generatorDesc{.ScaleFactor = std::strtod(argv[3], nullptr)};
+    for (int i = 4; i < argc; ++i)
+        if (!ParseGeneratorOption(argc, argv, i, generatorDesc)) std::fprintf(stderr, "ignoring %s\n", argv[i]);
+
+    Logger::Init();
+    int exitCode = 1;
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        DataGenerator generator(generatorDesc);
+
+        std::string error{};
+        auto result = std::async(std::launch::async, [&] { return generator.WriteCsvFiles(argv[2], error); });
+        while (result.wait_for(std::chrono::milliseconds(500)) != std::future_status::ready)
+        {
+            std::printf("\r%-28s %6.1f%% %12llu rows", std::string(generator.GetTables()[generator.GetCurrentTableIndex()].Name).c_str(),
+                        100.0 * static_cast<double>(generator.GetRowsGenerated()) / static_cast<double>(generator.GetTotalRows()),
+                        static_cast<unsigned long long>(generator.GetRowsGenerated()));
+            std::fflush(stdout);
+        }
+
+        if (result.get())
+        {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            std::printf("\ngenerated %llu rows in %zu files in %.2f s\n", static_cast<unsigned long long>(generator.GetRowsGenerated()),
+                        generator.GetTables().size(), seconds);
+            exitCode = 0;
+        }
+        else
+            std::fprintf(stderr, "\ngeneration failed: %s\n", error.c_str());
+    }
+    Logger::Shutdown();
+
+    return exitCode;
+}
+
+// db_runner --generate host port database user scale [--seed N] [--threads N] [--defer-triggers]
+// Same data as --generate-csv, COPYed into an empty schema as it's produced, no files in between.
+static int RunGeneration(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 7)
+    {
+        std::fprintf(stderr, "usage: %s --generate host port database user scale [--seed N] [--threads N] [--defer-triggers]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    DataGeneratorDesc generatorDesc{.ScaleFactor = std::strtod(argv[6], nullptr)};
+    BulkLoadDesc loadDesc{};
+    for (int i = 7; i < argc; ++i)
+    {
+        if (std::string_view(argv[i]) == "--defer-triggers")
+            loadDesc.bDeferTriggers = true;
+        else if (!ParseGeneratorOption(argc, argv, i, generatorDesc))
+            std::fprintf(stderr, "ignoring %s\n", argv[i]);
+    }
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            DataGenerator generator(generatorDesc);
+            loadDesc.Streams = generator.CreateLoadStreams();
+
+            BulkLoader loader(connection, std::move(loadDesc));
+            if (!WaitForTask(loader, "generation", [&] { PrintLoadProgress(loader); })) return 1;
+
+            const double sentMiB = static_cast<double>(loader.GetBytesSent()) / (1024.0 * 1024.0);
+            std::printf("\ngenerated and loaded %llu rows (%.1f MiB) into %zu tables in %.2f s\n",
+                        static_cast<unsigned long long>(loader.GetRowsLoaded()), sentMiB, loader.GetFiles().size(),
+                        loader.GetElapsedSeconds());
+            return 0;
+        });
+}
+
+// db_runner --export host port database user csv|columnar path query
+// Streams the query's rows to path in constant memory, however many there are.
+static int RunExport(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    const std::string_view format = argc > 6 ? argv[6] : "";
+    if (argc < 9 || (format != "csv" && format != "columnar"))
+    {
+        std::fprintf(stderr, "usage: %s --export host port database user csv|columnar path query\n", argv[0]);
+        return 1;
+    }
+
+    ExportDesc exportDesc{};
+    exportDesc.Format = format == "csv" ? EExportFormat::Csv : EExportFormat::Columnar;
+    exportDesc.Path   = argv[7];
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            QueryExporter exporter(connection, argv[8], std::move(exportDesc));
+            const bool bExported = WaitForTask(exporter, "export",
+                                               [&]
+                                               {
+                                                   std::printf("\r%12llu rows %10.1f MiB %8.1f s",
+                                                               static_cast<unsigned long long>(exporter.GetRowsWritten()),
+                                                               static_cast<double>(exporter.GetBytesWritten()) / (1024.0 * 1024.0),
+                                                               exporter.GetElapsedSeconds());
+                                               });
+            if (!bExported) return 1;
+
+            const double writtenMiB = static_cast<double>(exporter.GetBytesWritten()) / (1024.0 * 1024.0);
+            std::printf("\nexported %llu rows (%.1f MiB) to %s in %.2f s, %.1f MiB/s\n",
+                        static_cast<unsigned long long>(exporter.GetRowsWritten()), writtenMiB, argv[7],
+                        exporter.GetElapsedSeconds(), writtenMiB / std::max(exporter.GetElapsedSeconds(), 0.001f));
+            return 0;
+        });
+}
+
+// db_runner --reprice host port database user [--batch-size N] [--follow]
+// Drains order_repricing_queue and exits, --follow keeps polling it like a service.
+static int RunRepricing(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr, "usage: %s --reprice host port database user [--batch-size N] [--follow]\n", argv[0]);
+        return 1;
+    }
+
+    RepricingWorkerDesc workerDesc{.bStopWhenEmpty = true};
+    for (int i = 6; i < argc; ++i)
+    {
+        const std::string_view argument(argv[i]);
+        if (argument == "--follow")
+            workerDesc.bStopWhenEmpty = false;
+        else if (argument == "--batch-size" && i + 1 < argc)
+            workerDesc.BatchSize = static_cast<int32_t>(std::strtol(argv[++i], nullptr, 10));
+    }
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            RepricingWorker worker(connection, workerDesc);
+            const bool bRepriced = WaitForTask(worker, "repricing",
+                                               [&]
+                                               {
+                                                   std::printf("\r%12llu orders repriced %10lld pending %10.1f orders/s%s",
+                                                               static_cast<unsigned long long>(worker.GetOrdersRepriced()),
+                                                               static_cast<long long>(worker.GetPendingCount()),
+                                                               worker.GetOrdersPerSecond(), worker.IsIdle() ? " (idle)" : "");
+                                               });
+            if (!bRepriced) return 1;
+
+            std::printf("\nrepriced %llu orders in %llu batches, %.2f s\n",
+                        static_cast<unsigned long long>(worker.GetOrdersRepriced()),
+                        static_cast<unsigned long long>(worker.GetBatchCount()), worker.GetElapsedSeconds());
+            return 0;
+        });
+}
+
+// db_runner --simulate-orders host port database user [--terminals 1,2,4,8] [--duration seconds] [--outlets N]
+//                               [--kiosk-share F] [--isolation read-committed|repeatable-read|serializable] [--retries N]
+// One simulation per terminal count, one line each, so the point where more terminals stop adding orders per second shows up.
+static int RunOrderEntrySimulation(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr,
+                     "usage: %s --simulate-orders host port database user [--terminals 1,2,4,8] [--duration seconds] "
+                     "[--outlets N] [--kiosk-share F] [--isolation read-committed|repeatable-read|serializable] [--retries N]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    OrderEntrySimulatorDesc simulatorDesc{};
+    std::vector<uint32_t> terminalCounts{};
+    for (int i = 6; i < argc; ++i)
+    {
+        const std::string_view argument(argv[i]);
+        const bool bHasValue = i + 1 < argc;
+        if (argument == "--terminals" && bHasValue)
+        {
+            for (const auto count : std::views::split(std::string_view(argv[++i]), ','))
+            {
+                const std::string countText(count.begin(), count.end());
+                terminalCounts.push_back(std::max(static_cast<uint32_t>(std::strtoul(countText.c_str(), nullptr, 10)), 1u));
+            }
+        }
+        else if (argument == "--duration" && bHasValue)
+            simulatorDesc.Duration = std::chrono::seconds(std::max(std::strtol(argv[++i], nullptr, 10), 1l));
+        else if (argument == "--outlets" && bHasValue)
+            simulatorDesc.OutletCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--kiosk-share" && bHasValue)
+            simulatorDesc.KioskShare = std::strtod(argv[++i], nullptr);
+        else if (argument == "--retries" && bHasValue)
+            simulatorDesc.MaxRetries = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--isolation" && bHasValue)
+        {
+            const std::string_view isolation(argv[++i]);
+            simulatorDesc.Isolation = isolation == "serializable"      ? EIsolationLevel::Serializable
+                                      : isolation == "repeatable-read" ? EIsolationLevel::RepeatableRead
+                                                                       : EIsolationLevel::ReadCommitted;
+        }
+        else
+            std::fprintf(stderr, "ignoring %s\n", argv[i]);
+    }
+    if (terminalCounts.empty()) terminalCounts.push_back(simulatorDesc.TerminalCount);
+
+    // A connection per terminal and one for sampling pg_stat_activity.
+    const uint32_t maxTerminalCount = *std::max_element(terminalCounts.begin(), terminalCounts.end());
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = maxTerminalCount + 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            std::printf("%9s %10s %9s %9s %9s %9s %9s %9s %9s %9s  %s\n", "terminals", "orders/s", "mean ms", "p50 ms", "p95 ms", "p99 ms",
+                        "deadlock", "serializ", "retries", "abandoned", "top waits (share of terminal samples)");
+            for (const uint32_t terminalCount : terminalCounts)
+            {
+                simulatorDesc.TerminalCount = terminalCount;
+                OrderEntrySimulator simulator(connection, simulatorDesc);
+                const bool bSimulated = WaitForTask(simulator, "simulation",
+                                                    [&]
+                                                    {
+                                                        std::printf("\r%9u %10.1f %8.1f s %9llu %9llu", terminalCount,
+                                                                    static_cast<double>(simulator.GetCommitted()) /
+                                                                        std::max(simulator.GetElapsedSeconds(), 0.001f),
+                                                                    simulator.GetElapsedSeconds(),
+                                                                    static_cast<unsigned long long>(simulator.GetDeadlocks()),
+                                                                    static_cast<unsigned long long>(simulator.GetSerializationFailures()));
+                                                    });
+                if (!bSimulated) return 1;
+
+                const OrderEntryStats& stats = simulator.GetStats();
+                std::string waits{};
+                const double sampleSlots = static_cast<double>(std::max<uint64_t>(stats.WaitSampleCount * stats.TerminalCount, 1));
+                for (std::size_t i{}; i < std::min<std::size_t>(stats.WaitEvents.size(), 3); ++i)
+                {
+                    const double share = 100.0 * static_cast<double>(stats.WaitEvents[i].SampleCount) / sampleSlots;
+                    waits += (i ? ", " : "") + stats.WaitEvents[i].WaitEvent + " " + std::to_string(static_cast<int32_t>(share)) + "%";
+                }
+
+                std::printf("\r%9u %10.1f %9.2f %9.2f %9.2f %9.2f %9llu %9llu %9llu %9llu  %s\n", stats.TerminalCount,
+                            stats.OrdersPerSecond, stats.MeanMs, stats.P50Ms, stats.P95Ms, stats.P99Ms,
+                            static_cast<unsigned long long>(stats.Deadlocks), static_cast<unsigned long long>(stats.SerializationFailures),
+                            static_cast<unsigned long long>(stats.Retries), static_cast<unsigned long long>(stats.Abandoned),
+                            waits.empty() ? "-" : waits.c_str());
+                std::printf("%9s step means: order %.2f ms, service orders %.2f ms, print orders %.2f ms, commit %.2f ms\n", "",
+                            stats.StepMeanMs[EOrderEntryStep::InsertOrder], stats.StepMeanMs[EOrderEntryStep::InsertServiceOrders],
+                            stats.StepMeanMs[EOrderEntryStep::InsertPrintOrders], stats.StepMeanMs[EOrderEntryStep::Commit]);
+            }
+            return 0;
+        });
+}
+
+// db_runner --create-partitions host port database user [months_ahead]
+// Creates the monthly partitions of orders and its children (13-monthly-partitions.sql) up to months_ahead past the current one.
+// Partitions aren't created on the fly by inserts, a scheduler is expected to run this ahead of time.
+static int RunPartitionMaintenance(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr, "usage: %s --create-partitions host port database user [months_ahead]\n", argv[0]);
+        return 1;
+    }
+
+    const int32_t monthsAhead = argc > 6 ? std::max(static_cast<int32_t>(std::strtol(argv[6], nullptr, 10)), 0) : 3;
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            const std::string query = "SELECT create_order_partitions(LOCALTIMESTAMP, LOCALTIMESTAMP + make_interval(months => " +
+                                      std::to_string(monthsAhead) + "))::bigint";
+            const auto result       = connection.Execute(query, EResultFormat::Binary);
+            if (!result || result->GetRowCount() == 0)
+            {
+                std::fprintf(stderr, "failed to create partitions, see the log\n");
+                return 1;
+            }
+
+            std::printf("created %lld partitions, %d months ahead covered\n", static_cast<long long>(result->GetInt64(0, 0)),
+                        monthsAhead);
+            return 0;
+        });
+}
+
+// db_runner --compact-inventory host port database user [--batch-size N] [--follow]
+// Folds the inventory ledger into storage_items until it's empty (14-inventory-ledger.sql), --follow keeps polling it
+// like a service.
+static int RunInventoryCompaction(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr, "usage: %s --compact-inventory host port database user [--batch-size N] [--follow]\n", argv[0]);
+        return 1;
+    }
+
+    InventoryCompactorDesc compactorDesc{.bStopWhenEmpty = true};
+    for (int i = 6; i < argc; ++i)
+    {
+        const std::string_view argument(argv[i]);
+        if (argument == "--follow")
+            compactorDesc.bStopWhenEmpty = false;
+        else if (argument == "--batch-size" && i + 1 < argc)
+            compactorDesc.BatchSize = static_cast<int32_t>(std::strtol(argv[++i], nullptr, 10));
+    }
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            InventoryCompactor compactor(connection, compactorDesc);
+            const bool bCompacted = WaitForTask(compactor, "compaction",
+                                                [&]
+                                                {
+                                                    std::printf("\r%12llu movements folded in %llu batches %10.1f movements/s%s",
+                                                                static_cast<unsigned long long>(compactor.GetMovementsFolded()),
+                                                                static_cast<unsigned long long>(compactor.GetBatchCount()),
+                                                                compactor.GetMovementsPerSecond(), compactor.IsIdle() ? " (idle)" : "");
+                                                });
+            if (!bCompacted) return 1;
+
+            std::printf("\nfolded %llu movements in %llu batches, %.2f s\n",
+                        static_cast<unsigned long long>(compactor.GetMovementsFolded()),
+                        static_cast<unsigned long long>(compactor.GetBatchCount()), compactor.GetElapsedSeconds());
+            return 0;
+        });
+}
+
+// db_runner --index-advisor host port database user [min_scanned_rows]
+// EXPLAIN ANALYZE of every predefined report, prints the seq scans and the proposed CREATE INDEX script.
+static int RunIndexAdvisor(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr, "usage: %s --index-advisor host port database user [min_scanned_rows]\n", argv[0]);
+        return 1;
+    }
+
+    IndexAdvisorDesc advisorDesc{};
+    if (argc > 6) advisorDesc.MinScannedRows = std::strtoll(argv[6], nullptr, 10);
+
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc&)
+        {
+            IndexAdvisor advisor(connection, CreateReportQueries(), advisorDesc);
+            while (!advisor.IsFinished())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                advisor.Poll();
+            }
+
+            int exitCode = 0;
+            for (const auto& report : advisor.GetReports())
+            {
+                if (report.Status != EQueryStatus::Done)
+                {
+                    std::printf("%-45s failed: %s\n", report.Title.c_str(), report.Error.c_str());
+                    exitCode = 1;
+                    continue;
+                }
+
+                std::printf("%-45s %10.2f ms %10lld hit %10lld read\n", report.Title.c_str(), report.ExecutionMilliseconds,
+                            static_cast<long long>(report.SharedHitBlocks), static_cast<long long>(report.SharedReadBlocks));
+                for (const auto& scan : report.SeqScans)
+                    std::printf("    %s seq scan on %s %s: %lld rows, %lld removed, %.2f ms%s%s\n", scan.bFlagged ? "!" : " ",
+                                scan.Relation.c_str(), scan.Alias.c_str(), static_cast<long long>(scan.RowsReturned),
+                                static_cast<long long>(scan.RowsRemoved), scan.ScanMilliseconds, scan.Filter.empty() ? "" : ", filter ",
+                                scan.Filter.c_str());
+            }
+
+            const std::string script = advisor.BuildSuggestionScript();
+            std::printf("\n%s\n", script.empty() ? "-- no index suggestions" : script.c_str());
+            return exitCode;
+        });
+}
+
+// db_runner --headless host port database user [--file queries.sql] [--iterations N] [--warmup N] [--text]
+//                                                         [--pipeline] [--json out.json] [--label text]
+// Times the predefined reports (or every statement of the file) without a window, prints latency percentiles and throughput
+// and optionally writes them as JSON. --pipeline adds all cases as one pipelined task. Exits with 1 if any case failed.
+static int RunHeadlessBenchmark(int argc, char** argv) noexcept
+{
+    using namespace nsudb;
+
+    if (argc < 6)
+    {
+        std::fprintf(stderr,
+                     "usage: %s --headless host port database user [--file queries.sql] [--iterations N] [--warmup N] [--text] "
+                     "[--pipeline] [--json out.json] [--label text]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    QueryBenchmarkDesc benchmarkDesc{};
+    std::filesystem::path jsonPath{};
+    for (int i = 6; i < argc; ++i)
+    {
+        const std::string_view argument(argv[i]);
+        const bool bHasValue = i + 1 < argc;
+        if (argument == "--text")
+            benchmarkDesc.ResultFormat = EResultFormat::Text;
+        else if (argument == "--pipeline")
+            benchmarkDesc.bPipelineAll = true;
+        else if (argument == "--file" && bHasValue)
+            benchmarkDesc.SqlFile = argv[++i];
+        else if (argument == "--iterations" && bHasValue)
+            benchmarkDesc.IterationCount = std::max(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+        else if (argument == "--warmup" && bHasValue)
+            benchmarkDesc.WarmupCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--json" && bHasValue)
+            jsonPath = argv[++i];
+        else if (argument == "--label" && bHasValue)
+            benchmarkDesc.Label = argv[++i];
+    }
+
+    // Warnings only, no per-query trace lines in the output.
+    return RunHeadless(
+        argv, ConnectionPoolDesc{.MinConnections = 1, .MaxConnections = 1},
+        [&](DatabaseConnection& connection, const DatabaseDesc& databaseDesc)
+        {
+            const auto cases = LoadQueryBenchmarkCases(benchmarkDesc);
+            if (!cases) return 1;
+
+            const auto results = RunQueryBenchmark(connection, *cases, benchmarkDesc);
+
+            int exitCode = 0;
+            std::printf("%-45s %10s %10s %10s %10s %10s %14s %12s\n", "case", "mean ms", "p50 ms", "p95 ms", "p99 ms", "rows", "rows/s",
+                        "MiB/s");
+            for (const auto& result : results)
+            {
+                if (!result.Error.empty())
+                {
+                    std::printf("%-45s failed: %s\n", result.Name.c_str(), result.Error.c_str());
+                    exitCode = 1;
+                    continue;
+                }
+
+                std::printf("%-45s %10.3f %10.3f %10.3f %10.3f %10llu %14.0f %12.2f\n", result.Name.c_str(), result.MeanMs, result.P50Ms,
+                            result.P95Ms, result.P99Ms, static_cast<unsigned long long>(result.RowCount), result.RowsPerSecond,
+                            result.BytesPerSecond / (1024.0 * 1024.0));
+            }
+
+            if (!jsonPath.empty() && !WriteQueryBenchmarkJson(jsonPath, databaseDesc, benchmarkDesc, results)) exitCode = 1;
+            return exitCode;
+        },
+        spdlog::level::warn);
+}
 
 int main(int argc, char** argv)
 {
     using namespace nsudb;
 
+    // Bulk import runs headless too, for loading the generated datasets on a server without a display.
+    if (argc > 1 && std::string_view(argv[1]) == "--import-csv") return RunCsvImport(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--generate-csv") return RunCsvGeneration(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--generate") return RunGeneration(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--export") return RunExport(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--reprice") return RunRepricing(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--simulate-orders") return RunOrderEntrySimulation(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--create-partitions") return RunPartitionMaintenance(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--compact-inventory") return RunInventoryCompaction(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--index-advisor") return RunIndexAdvisor(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--headless") return RunHeadlessBenchmark(argc, argv);
+
+    // Microbenchmarks don't need a window, so they run before any GLFW/Vulkan setup.
+    if (argc > 1 && std::string_view(argv[1]) == "--bench-result-store")
+    {
+        const std::size_t rowCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+        Benchmarks::RunResultStoreBenchmark(rowCount);
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--bench-result-search")
+    {
+        const std::size_t rowCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+        Benchmarks::RunResultSearchBenchmark(rowCount);
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--bench-result-table")
+    {
+        Benchmarks::RunResultTableBenchmark();
+        return 0;
+    }
+
+    // --bench-result-format [rows] [host port database user [iterations]]
+    if (argc > 1 && std::string_view(argv[1]) == "--bench-result-format")
+    {
+        const std::size_t rowCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+
+        std::optional<DatabaseDesc> databaseDesc{std::nullopt};
+        if (argc > 6)
+            databaseDesc =
+                DatabaseDesc{.HostName = argv[3], .Database = argv[5], .Username = argv[6], .Port = std::strtol(argv[4], nullptr, 10)};
+        const uint32_t iterationCount = argc > 7 ? static_cast<uint32_t>(std::strtoul(argv[7], nullptr, 10)) : 5;
+
+        Benchmarks::RunResultFormatBenchmark(rowCount, databaseDesc ? &*databaseDesc : nullptr, iterationCount);
+        return 0;
+    }
+
     auto app = std::make_unique<Application>();
     app->Run();
 
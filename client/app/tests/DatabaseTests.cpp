@@ -0,0 +1,182 @@
+#include "TestRunner.hpp"
+#include <BinaryFormat.hpp>
+#include <Database.hpp>
+
+#include <bit>
+
+#include <libpq-fe.h>
+
+using namespace nsudb;
+
+// Synthetic libpq results: PQmakeEmptyPGresult() and friends build what the server would have sent, no connection needed.
+struct TestPgResult final
+{
+    struct Field final
+    {
+        const char* Name{nullptr};
+        uint32_t TypeOid{0};
+    };
+
+    TestPgResult(std::initializer_list<Field> fields, bool bBinary) : m_Result(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK))
+    {
+        std::vector<PGresAttDesc> attributes{};
+        for (const Field& field : fields)
+            attributes.push_back(PGresAttDesc{.name      = const_cast<char*>(field.Name),
+                                              .tableid   = 0,
+                                              .columnid  = 0,
+                                              .format    = bBinary ? 1 : 0,
+                                              .typid     = field.TypeOid,
+                                              .typlen    = -1,
+                                              .atttypmod = -1});
+        PQsetResultAttrs(m_Result, static_cast<int>(attributes.size()), attributes.data());
+    }
+    ~TestPgResult() { PQclear(m_Result); }
+
+    TestPgResult(const TestPgResult&)            = delete;
+    TestPgResult& operator=(const TestPgResult&) = delete;
+
+    // std::nullopt is NULL.
+    void SetValue(int row, int field, std::optional<std::string_view> bytes)
+    {
+        PQsetvalue(m_Result, row, field, bytes ? const_cast<char*>(bytes->data()) : nullptr, bytes ? static_cast<int>(bytes->size()) : -1);
+    }
+
+    const PGresult* Get() const noexcept { return m_Result; }
+
+  private:
+    PGresult* m_Result{nullptr};
+};
+
+// Network byte order, the way binary results carry integers.
+template <typename T> static std::string BigEndian(T value)
+{
+    std::string bytes(sizeof(T), '\0');
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (std::size_t i = sizeof(T); i-- > 0; bits >>= 8)
+        bytes[i] = static_cast<char>(bits & 0xFF);
+
+    return bytes;
+}
+
+// numeric: ndigits, weight, sign, dscale, then base-10000 digits.
+static std::string NumericBytes(int16_t weight, uint16_t sign, int16_t displayScale, std::initializer_list<int16_t> digits)
+{
+    std::string bytes =
+        BigEndian<int16_t>(static_cast<int16_t>(digits.size())) + BigEndian(weight) + BigEndian(sign) + BigEndian(displayScale);
+    for (const int16_t digit : digits)
+        bytes += BigEndian(digit);
+
+    return bytes;
+}
+
+static std::string_view Format(const QueryResult& result, std::size_t row, std::size_t column, QueryResult::FormatBuffer& buffer)
+{
+    return result.FormatValue(row, column, buffer);
+}
+
+NSUDB_TEST(AppendResultRowsDecodesBinary)
+{
+    using namespace BinaryFormat;
+
+    TestPgResult pgResult({{"flag", Bool},
+                           {"small", Int2},
+                           {"count", Int4},
+                           {"big", Int8},
+                           {"ratio", Float8},
+                           {"amount", Numeric},
+                           {"day", Date},
+                           {"at", Timestamp},
+                           {"name", Text},
+                           {"id", Uuid},
+                           {"real", Float4},
+                           {"point", 600}},
+                          true);
+
+    // 2024-02-29 is day 8825 since 2000-01-01, 13:45:30.25 that day in microseconds on top.
+    static constexpr int32_t s_Day             = 8825;
+    static constexpr int64_t s_DayMicroseconds = int64_t{s_Day} * 86'400'000'000;
+    static constexpr int64_t s_Timestamp       = s_DayMicroseconds + ((13 * 60 + 45) * 60 + 30) * int64_t{1'000'000} + 250'000;
+
+    pgResult.SetValue(0, 0, std::string(1, '\1'));
+    pgResult.SetValue(0, 1, BigEndian<int16_t>(-12));
+    pgResult.SetValue(0, 2, BigEndian<int32_t>(2'000'000'000));
+    pgResult.SetValue(0, 3, BigEndian<int64_t>(-9'000'000'000'000));
+    pgResult.SetValue(0, 4, BigEndian(std::bit_cast<uint64_t>(2.5)));
+    pgResult.SetValue(0, 5, NumericBytes(1, 0, 2, {1, 2345, 6700}));  // 12345.67
+    pgResult.SetValue(0, 6, BigEndian(s_Day));
+    pgResult.SetValue(0, 7, BigEndian(s_Timestamp));
+    pgResult.SetValue(0, 8, "Ёлка, \"quoted\"");
+    pgResult.SetValue(0, 9, std::string("\x01\x23\x45\x67\x89\xab\xcd\xef\x01\x23\x45\x67\x89\xab\xcd\xef", 16));
+    pgResult.SetValue(0, 10, BigEndian(std::bit_cast<uint32_t>(1.5f)));
+    pgResult.SetValue(0, 11, std::string("\x00\xff", 2));
+    for (int field{}; field < 12; ++field)
+        pgResult.SetValue(1, field, std::nullopt);
+    pgResult.SetValue(2, 0, std::string(1, '\0'));
+    pgResult.SetValue(2, 5, NumericBytes(-1, 0x4000, 2, {500}));  // -0.05
+    pgResult.SetValue(2, 6, BigEndian<int32_t>(-1));
+    pgResult.SetValue(3, 5, NumericBytes(7, 0, 0, {1}));  // 10^28 doesn't fit into int64 and becomes a double
+    pgResult.SetValue(3, 2, std::string(2, '\0'));        // short fixed-width value, not something to decode
+
+    QueryResult result{};
+    NSUDB_CHECK_EQ(AppendResultRows(pgResult.Get(), true, result), std::size_t{4});
+    NSUDB_CHECK_EQ(result.GetRowCount(), std::size_t{4});
+    NSUDB_CHECK(result.GetColumnNames() == std::vector<std::string>({"flag", "small", "count", "big", "ratio", "amount", "day", "at",
+                                                                         "name", "id", "real", "point"}));
+
+    const EColumnType expectedTypes[] = {EColumnType::Bool,    EColumnType::Int32, EColumnType::Int32, EColumnType::Int64,
+                                         EColumnType::Float64, EColumnType::Numeric, EColumnType::Date, EColumnType::Timestamp,
+                                         EColumnType::Text,    EColumnType::Text,  EColumnType::Text,  EColumnType::Text};
+    for (std::size_t column{}; column < std::size(expectedTypes); ++column)
+        NSUDB_CHECK_EQ(result.GetColumnType(column), expectedTypes[column]);
+    NSUDB_CHECK_EQ(result.GetColumnTypeOid(5), uint32_t{Numeric});
+
+    QueryResult::FormatBuffer buffer{};
+    NSUDB_CHECK_EQ(Format(result, 0, 0, buffer), "t");
+    NSUDB_CHECK_EQ(Format(result, 0, 1, buffer), "-12");
+    NSUDB_CHECK_EQ(Format(result, 0, 2, buffer), "2000000000");
+    NSUDB_CHECK_EQ(Format(result, 0, 3, buffer), "-9000000000000");
+    NSUDB_CHECK_EQ(result.GetFloat64(0, 4), 2.5);
+    NSUDB_CHECK_EQ(Format(result, 0, 5, buffer), "12345.67");
+    NSUDB_CHECK_EQ(Format(result, 0, 6, buffer), "2024-02-29");
+    NSUDB_CHECK_EQ(Format(result, 0, 7, buffer), "2024-02-29 13:45:30.25");
+    NSUDB_CHECK_EQ(result.GetValue(0, 8), "Ёлка, \"quoted\"");
+    NSUDB_CHECK_EQ(result.GetValue(0, 9), "01234567-89ab-cdef-0123-456789abcdef");
+    NSUDB_CHECK_EQ(result.GetValue(0, 10), "1.5");
+    NSUDB_CHECK_EQ(result.GetValue(0, 11), "\\x00ff");
+
+    for (std::size_t column{}; column < result.GetColumnCount(); ++column)
+        NSUDB_CHECK(result.IsNull(1, column));
+
+    NSUDB_CHECK_EQ(Format(result, 2, 0, buffer), "f");
+    NSUDB_CHECK_EQ(Format(result, 2, 5, buffer), "-0.05");
+    NSUDB_CHECK_EQ(Format(result, 2, 6, buffer), "1999-12-31");
+    NSUDB_CHECK_EQ(result.GetFloat64(3, 5), 1e28);
+    NSUDB_CHECK(result.IsNull(3, 2));
+}
+
+NSUDB_TEST(AppendResultRowsKeepsTextAndAppends)
+{
+    TestPgResult first({{"id", BinaryFormat::Int4}, {"name", BinaryFormat::Text}}, false);
+    first.SetValue(0, 0, "7");
+    first.SetValue(0, 1, "seven");
+
+    TestPgResult second({{"id", BinaryFormat::Int4}, {"name", BinaryFormat::Text}}, false);
+    second.SetValue(0, 0, "8");
+    second.SetValue(0, 1, std::nullopt);
+    second.SetValue(1, 0, "9");
+    second.SetValue(1, 1, "");
+
+    // Text results keep every column as text, the type OID still tells the numbers apart.
+    QueryResult result{};
+    NSUDB_CHECK_EQ(AppendResultRows(first.Get(), false, result), std::size_t{1});
+    NSUDB_CHECK_EQ(AppendResultRows(second.Get(), false, result), std::size_t{2});
+    NSUDB_CHECK_EQ(result.GetRowCount(), std::size_t{3});
+    NSUDB_CHECK_EQ(result.GetColumnType(0), EColumnType::Text);
+    NSUDB_CHECK_EQ(result.GetColumnTypeOid(0), uint32_t{BinaryFormat::Int4});
+    NSUDB_CHECK_EQ(result.GetValue(0, 0), "7");
+    NSUDB_CHECK_EQ(result.GetValue(2, 0), "9");
+    NSUDB_CHECK_EQ(result.GetValue(0, 1), "seven");
+    NSUDB_CHECK(result.IsNull(1, 1));
+    NSUDB_CHECK(!result.IsNull(2, 1));
+    NSUDB_CHECK_EQ(result.GetValue(2, 1), "");
+}
@@ -0,0 +1,48 @@
+#include "TestRunner.hpp"
+#include <QueryPlan.hpp>
+
+using namespace nsudb;
+
+static void CheckSplit(std::string_view sql, const std::vector<std::string>& expected)
+{
+    const std::vector<std::string> statements = SplitSqlStatements(sql);
+    NSUDB_CHECK_EQ(statements.size(), expected.size());
+    for (std::size_t i{}; i < std::min(statements.size(), expected.size()); ++i)
+        NSUDB_CHECK_EQ(statements[i], expected[i]);
+}
+
+NSUDB_TEST(SplitSqlStatementsAtTopLevelSemicolons)
+{
+    CheckSplit("SELECT 1; SELECT 2;\n  SELECT 3  ", {"SELECT 1", "SELECT 2", "SELECT 3"});
+    CheckSplit("SELECT 1;;;", {"SELECT 1"});
+    CheckSplit("", {});
+    CheckSplit(" ;\n; ", {});
+}
+
+NSUDB_TEST(SplitSqlStatementsSkipsQuotes)
+{
+    CheckSplit("SELECT 'a;b', \"c;d\"; SELECT 'it''s;'", {"SELECT 'a;b', \"c;d\"", "SELECT 'it''s;'"});
+    CheckSplit("SELECT E'\\';'; SELECT 2", {"SELECT E'\\';'", "SELECT 2"});
+
+    // Only E'' strings escape with a backslash, here the quote after it ends the string.
+    CheckSplit("SELECT '\\'; SELECT 2", {"SELECT '\\'", "SELECT 2"});
+}
+
+NSUDB_TEST(SplitSqlStatementsSkipsDollarQuotes)
+{
+    CheckSplit("CREATE FUNCTION f() RETURNS INT AS $$ BEGIN RETURN 1; END; $$ LANGUAGE plpgsql; SELECT f()",
+               {"CREATE FUNCTION f() RETURNS INT AS $$ BEGIN RETURN 1; END; $$ LANGUAGE plpgsql", "SELECT f()"});
+    CheckSplit("SELECT $body$ ; $$ ; $body$; SELECT 2", {"SELECT $body$ ; $$ ; $body$", "SELECT 2"});
+
+    // Parameters aren't quotes.
+    CheckSplit("SELECT $1; SELECT $2", {"SELECT $1", "SELECT $2"});
+}
+
+NSUDB_TEST(SplitSqlStatementsSkipsComments)
+{
+    CheckSplit("SELECT 1 -- not here;\n; SELECT 2", {"SELECT 1 -- not here;", "SELECT 2"});
+    CheckSplit("SELECT /* a; /* nested; */ still; */ 1; SELECT 2", {"SELECT /* a; /* nested; */ still; */ 1", "SELECT 2"});
+
+    // Statements of nothing but comments are left out.
+    CheckSplit("-- header\n; /* block */ ; SELECT 1; -- trailer", {"SELECT 1"});
+}
@@ -0,0 +1,64 @@
+#include "TestRunner.hpp"
+#include <ResultExport.hpp>
+
+#include <fstream>
+#include <iterator>
+
+using namespace nsudb;
+
+static std::string ExportLoaded(std::shared_ptr<const QueryResult> result, const std::filesystem::path& path, std::size_t rowGroupSize)
+{
+    {
+        QueryExporter exporter(std::move(result), ExportDesc{.Path = path, .Format = EExportFormat::Csv, .RowGroupSize = rowGroupSize});
+        while (!exporter.IsFinished())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        NSUDB_CHECK_EQ(exporter.GetStatus(), EQueryStatus::Done);
+        NSUDB_CHECK_EQ(exporter.GetError(), std::string_view());
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+
+    return contents;
+}
+
+NSUDB_TEST(CsvExportQuotesLikeCopy)
+{
+    auto result = std::make_shared<QueryResult>(std::vector<std::string>{"id", "note, quoted", "amount"});
+    result->SetColumnType(0, EColumnType::Int64);
+    result->SetColumnType(2, EColumnType::Numeric);
+
+    const auto appendRow = [&](std::optional<int64_t> id, std::optional<std::string_view> note, int64_t amount, uint8_t scale)
+    {
+        id ? result->AppendInt64(0, *id) : result->AppendNull(0);
+        note ? result->AppendValue(1, *note) : result->AppendNull(1);
+        result->AppendNumeric(2, amount, scale);
+        result->CommitRow();
+    };
+    appendRow(1, "plain", 150, 2);
+    appendRow(2, "has,comma", -3, 0);
+    appendRow(std::nullopt, "say \"hi\"", 0, 0);
+    appendRow(4, "", 5, 1);  // the empty string is quoted, NULL isn't
+    appendRow(5, std::nullopt, 5, 1);
+    appendRow(6, "line\nbreak\r", 1, 3);
+    appendRow(7, "\"", 1, 0);
+
+    const std::string expected = "id,\"note, quoted\",amount\n"
+                                 "1,plain,1.50\n"
+                                 "2,\"has,comma\",-3\n"
+                                 ",\"say \"\"hi\"\"\",0\n"
+                                 "4,\"\",0.5\n"
+                                 "5,,0.5\n"
+                                 "6,\"line\nbreak\r\",0.001\n"
+                                 "7,\"\"\"\",1\n";
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "nsudb_tests_export.csv";
+
+    // Row groups split the rows without changing the output.
+    NSUDB_CHECK_EQ(ExportLoaded(result, path, 3), expected);
+    NSUDB_CHECK_EQ(ExportLoaded(result, path, ExportDesc::s_DefaultRowGroupSize), expected);
+    NSUDB_CHECK(!std::filesystem::exists(path.string() + ".part"));
+}
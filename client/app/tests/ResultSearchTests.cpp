@@ -0,0 +1,116 @@
+#include "TestRunner.hpp"
+#include <ResultSearch.hpp>
+
+#include <random>
+
+using namespace nsudb;
+
+// Every kernel this CPU can run, Scalar first.
+static std::vector<ESearchKernel> GetAvailableKernels()
+{
+    std::vector<ESearchKernel> kernels{};
+    for (uint8_t kernel{}; kernel <= static_cast<uint8_t>(GetFastestSearchKernel()); ++kernel)
+        kernels.push_back(static_cast<ESearchKernel>(kernel));
+
+    return kernels;
+}
+
+// Every match offset, stepping one byte past each.
+static std::vector<std::size_t> FindAll(const TextSearcher& searcher, std::string_view text)
+{
+    std::vector<std::size_t> offsets{};
+    for (std::size_t offset = searcher.Find(text); offset != std::string_view::npos; offset = searcher.Find(text, offset + 1))
+        offsets.push_back(offset);
+
+    return offsets;
+}
+
+NSUDB_TEST(TextSearcherFoldsCase)
+{
+    for (const ESearchKernel kernel : GetAvailableKernels())
+    {
+        const TextSearcher ascii("hello", false, kernel);
+        NSUDB_CHECK_EQ(ascii.Find("say HeLLo there"), std::size_t{4});
+        NSUDB_CHECK_EQ(ascii.Find("say HeLLo there", 5), std::string_view::npos);
+
+        const TextSearcher cyrillic("ПЁТР", false, kernel);
+        NSUDB_CHECK_EQ(cyrillic.Find("Иван пётр"), std::string_view("Иван ").size());
+
+        const TextSearcher caseSensitive("Hello", true, kernel);
+        NSUDB_CHECK_EQ(caseSensitive.Find("hello Hello"), std::size_t{6});
+
+        const TextSearcher longPattern("a pattern longer than a whole avx2 block", false, kernel);
+        NSUDB_CHECK_EQ(longPattern.Find("... A PATTERN longer than a whole AVX2 block"), std::size_t{4});
+        NSUDB_CHECK_EQ(longPattern.Find("a pattern longer than a whole avx2 bloc"), std::string_view::npos);
+    }
+}
+
+NSUDB_TEST(TextSearcherKernelsMatchScalar)
+{
+    // Letters of both cases in both alphabets, so the fold masks get exercised, and a small alphabet so matches are common.
+    static constexpr std::string_view s_Pieces[] = {"a", "A", "b", "B", " ", "1", "я", "Я", "ё", "Ё", "ж", "Ж", "п", "П"};
+
+    std::mt19937 random(12345);
+    const auto makeText = [&](std::size_t pieceCount)
+    {
+        std::string text{};
+        for (std::size_t i{}; i < pieceCount; ++i)
+            text += s_Pieces[random() % std::size(s_Pieces)];
+        return text;
+    };
+
+    const std::vector<ESearchKernel> kernels = GetAvailableKernels();
+    for (uint32_t iteration{}; iteration < 2000; ++iteration)
+    {
+        // Lengths around the 16/32 byte blocks, so every tail path runs.
+        const std::string text    = makeText(random() % 80);
+        const std::string pattern = makeText(1 + random() % 4);
+        const bool bCaseSensitive = random() % 4 == 0;
+
+        const std::vector<std::size_t> expected = FindAll(TextSearcher(pattern, bCaseSensitive, ESearchKernel::Scalar), text);
+        for (const ESearchKernel kernel : kernels)
+        {
+            const std::vector<std::size_t> offsets = FindAll(TextSearcher(pattern, bCaseSensitive, kernel), text);
+            if (offsets == expected) continue;
+
+            NSUDB_CHECK(offsets == expected);
+            std::fprintf(stderr, "  kernel %s, pattern \"%s\", text \"%s\"\n", GetSearchKernelName(kernel), pattern.c_str(), text.c_str());
+            return;
+        }
+    }
+}
+
+NSUDB_TEST(FindInResultMatchesCellByCell)
+{
+    QueryResult result({"id", "name"});
+    result.SetColumnType(0, EColumnType::Int64);
+    std::mt19937 random(777);
+    for (uint32_t row{}; row < 5000; ++row)
+    {
+        result.AppendInt64(0, static_cast<int64_t>(random() % 100000));
+        if (row % 7 == 0)
+            result.AppendNull(1);
+        else
+            result.AppendValue(1, row % 3 == 0 ? "Bob Smith" : row % 3 == 1 ? "Алиса Bobrova" : "carol 42");
+        result.CommitRow();
+    }
+
+    for (const std::string_view pattern : {"bob", "42", "АЛИСА", "null", "x"})
+    {
+        const TextSearcher searcher(pattern);
+
+        std::vector<SearchMatch> expected{};
+        QueryResult::FormatBuffer buffer{};
+        for (uint32_t row{}; row < result.GetRowCount(); ++row)
+            for (uint32_t column{}; column < result.GetColumnCount(); ++column)
+                if (!result.IsNull(row, column) && searcher.Find(result.FormatValue(row, column, buffer)) != std::string_view::npos)
+                    expected.push_back({row, column});
+
+        NSUDB_CHECK(FindInResult(result, searcher) == expected);
+    }
+
+    // Narrowing keeps exactly the cells a full search for the longer pattern finds.
+    const std::vector<SearchMatch> candidates = FindInResult(result, TextSearcher("bo"));
+    const TextSearcher narrower("bobr");
+    NSUDB_CHECK(RefineSearchMatches(result, narrower, candidates) == FindInResult(result, narrower));
+}
@@ -0,0 +1,159 @@
+#include "TestRunner.hpp"
+#include <BinaryFormat.hpp>
+#include <ResultView.hpp>
+
+using namespace nsudb;
+
+// id | name | price | quantity (text the server typed numeric)
+//  3 | Bob     | 10.50 | 10
+//  1 | alice   | NULL  | 9
+//  2 | Алексей | 2.5   | 100
+// NULL | bobby | 10.5  | NULL
+//  5 | Bob     | -1    | 9
+static QueryResult MakeResult()
+{
+    QueryResult result({"id", "name", "price", "quantity"});
+    result.SetColumnType(0, EColumnType::Int64);
+    result.SetColumnType(2, EColumnType::Numeric);
+    result.SetColumnTypeOid(3, BinaryFormat::Int4);
+
+    struct Row final
+    {
+        std::optional<int64_t> Id{};
+        std::string_view Name{};
+        std::optional<std::pair<int64_t, uint8_t>> Price{};
+        std::optional<std::string_view> Quantity{};
+    };
+    const Row rows[] = {{3, "Bob", std::pair<int64_t, uint8_t>{1050, 2}, "10"},
+                        {1, "alice", std::nullopt, "9"},
+                        {2, "Алексей", std::pair<int64_t, uint8_t>{25, 1}, "100"},
+                        {std::nullopt, "bobby", std::pair<int64_t, uint8_t>{105, 1}, std::nullopt},
+                        {5, "Bob", std::pair<int64_t, uint8_t>{-1, 0}, "9"}};
+    for (const Row& row : rows)
+    {
+        row.Id ? result.AppendInt64(0, *row.Id) : result.AppendNull(0);
+        result.AppendValue(1, row.Name);
+        row.Price ? result.AppendNumeric(2, row.Price->first, row.Price->second) : result.AppendNull(2);
+        row.Quantity ? result.AppendValue(3, *row.Quantity) : result.AppendNull(3);
+        result.CommitRow();
+    }
+
+    return result;
+}
+
+static std::vector<uint32_t> GetViewRows(const QueryResult& result, const std::vector<ColumnFilter>& filters,
+                                         const std::vector<ColumnSort>& sorts)
+{
+    ResultView view{};
+    view.Update(result, filters, sorts);
+
+    std::vector<uint32_t> rows(view.GetRowCount());
+    for (std::size_t i{}; i < rows.size(); ++i)
+        rows[i] = static_cast<uint32_t>(view.GetSourceRow(i));
+
+    return rows;
+}
+
+static ColumnFilter Filter(std::size_t column, std::string_view expression)
+{
+    return ParseColumnFilter(column, expression).value_or(ColumnFilter{});
+}
+
+NSUDB_TEST(ParseColumnFilterOperators)
+{
+    const auto check = [](std::string_view expression, EFilterOp op, std::string_view operand)
+    {
+        const auto filter = ParseColumnFilter(2, expression);
+        NSUDB_CHECK(filter.has_value());
+        if (!filter) return;
+
+        NSUDB_CHECK_EQ(filter->Column, std::size_t{2});
+        NSUDB_CHECK_EQ(filter->Op, op);
+        NSUDB_CHECK_EQ(filter->Operand, operand);
+    };
+
+    check(">= 5", EFilterOp::GreaterOrEqual, "5");
+    check("<=5", EFilterOp::LessOrEqual, "5");
+    check("<5", EFilterOp::Less, "5");
+    check(">5", EFilterOp::Greater, "5");
+    check("=Bob", EFilterOp::Equal, "Bob");
+    check("!=x", EFilterOp::NotEqual, "x");
+    check("<>x", EFilterOp::NotEqual, "x");
+    check(" NULL ", EFilterOp::IsNull, "");
+    check("!null", EFilterOp::IsNotNull, "");
+    check("not null", EFilterOp::IsNotNull, "");
+    check("  BoB ", EFilterOp::Contains, "bob");
+
+    NSUDB_CHECK(!ParseColumnFilter(0, "   ").has_value());
+}
+
+NSUDB_TEST(ResultViewFilters)
+{
+    const QueryResult result = MakeResult();
+    using Rows = std::vector<uint32_t>;
+
+    NSUDB_CHECK(GetViewRows(result, {}, {}) == Rows({0, 1, 2, 3, 4}));
+
+    // Contains folds ASCII and Cyrillic case.
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "bOb")}, {}) == Rows({0, 3, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "алЕКС")}, {}) == Rows({2}));
+
+    // Typed columns compare as numbers, NULL matches nothing but IsNull.
+    NSUDB_CHECK(GetViewRows(result, {Filter(0, ">2")}, {}) == Rows({0, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(0, "!=3")}, {}) == Rows({1, 2, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(0, "null")}, {}) == Rows({3}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(2, "!null")}, {}) == Rows({0, 2, 3, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(2, "=10.5")}, {}) == Rows({0, 3}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(2, "<0")}, {}) == Rows({4}));
+
+    // A text column of a numeric server type compares as numbers too: as text "100" < "9".
+    NSUDB_CHECK(GetViewRows(result, {Filter(3, "<10")}, {}) == Rows({1, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(3, ">=10")}, {}) == Rows({0, 2}));
+
+    // Text columns compare as text.
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "=Bob")}, {}) == Rows({0, 4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "<b")}, {}) == Rows({0, 1, 4}));
+
+    // Every filter has to match.
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "bob"), Filter(0, ">=4")}, {}) == Rows({4}));
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "bob"), Filter(1, "alice")}, {}).empty());
+}
+
+NSUDB_TEST(ResultViewSorts)
+{
+    const QueryResult result = MakeResult();
+    using Rows = std::vector<uint32_t>;
+
+    // NULLs last ascending and first descending, like PostgreSQL.
+    NSUDB_CHECK(GetViewRows(result, {}, {{0, ESortDirection::Ascending}}) == Rows({1, 2, 0, 4, 3}));
+    NSUDB_CHECK(GetViewRows(result, {}, {{0, ESortDirection::Descending}}) == Rows({3, 4, 0, 2, 1}));
+
+    // Numeric values of different scales compare by value, equal ones keep result order.
+    NSUDB_CHECK(GetViewRows(result, {}, {{2, ESortDirection::Ascending}}) == Rows({4, 2, 0, 3, 1}));
+    NSUDB_CHECK(GetViewRows(result, {}, {{3, ESortDirection::Ascending}}) == Rows({1, 4, 0, 2, 3}));
+
+    // Text sorts bytewise, ties keep result order.
+    NSUDB_CHECK(GetViewRows(result, {}, {{1, ESortDirection::Ascending}}) == Rows({0, 4, 1, 3, 2}));
+    NSUDB_CHECK(GetViewRows(result, {}, {{1, ESortDirection::Descending}}) == Rows({2, 3, 1, 0, 4}));
+
+    // The first sort is the primary key.
+    NSUDB_CHECK(GetViewRows(result, {}, {{1, ESortDirection::Ascending}, {0, ESortDirection::Descending}}) == Rows({4, 0, 1, 3, 2}));
+
+    // Filter and sort together.
+    NSUDB_CHECK(GetViewRows(result, {Filter(1, "bob")}, {{2, ESortDirection::Descending}}) == Rows({0, 3, 4}));
+}
+
+NSUDB_TEST(ResultViewSortsTextPastPrefixKey)
+{
+    // Sort keys hold the first 8 bytes, values equal that far are compared in full.
+    QueryResult result({"name"});
+    for (const std::string_view name : {"prefix__b", "prefix__", "prefix__a", "prefix_", "prefix__ab"})
+    {
+        result.AppendValue(0, name);
+        result.CommitRow();
+    }
+
+    using Rows = std::vector<uint32_t>;
+    NSUDB_CHECK(GetViewRows(result, {}, {{0, ESortDirection::Ascending}}) == Rows({3, 1, 2, 4, 0}));
+    NSUDB_CHECK(GetViewRows(result, {}, {{0, ESortDirection::Descending}}) == Rows({0, 4, 2, 1, 3}));
+}
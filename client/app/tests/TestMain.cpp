@@ -0,0 +1,53 @@
+#include "TestRunner.hpp"
+#include <Logger.hpp>
+
+namespace nsudb::Tests
+{
+
+    static std::size_t s_FailureCount{0};
+
+    std::vector<TestCase>& GetTestCases() noexcept
+    {
+        static std::vector<TestCase> s_TestCases{};
+        return s_TestCases;
+    }
+
+    void ReportFailure(const char* file, int line, std::string_view expression, const std::string& details) noexcept
+    {
+        ++s_FailureCount;
+        std::fprintf(stderr, "%s:%d: check failed: %.*s%s%s\n", file, line, static_cast<int>(expression.size()), expression.data(),
+                     details.empty() ? "" : ", ", details.c_str());
+    }
+
+}  // namespace nsudb::Tests
+
+// db_runner_tests [name_filter]: runs every case whose name contains the filter, all of them without one.
+int main(int argc, char** argv)
+{
+    using namespace nsudb;
+
+    // Units under test log their warnings, synchronously so nothing is lost on exit.
+    Logger::Init(LoggerDesc{.bAsync = false});
+    Logger::GetLogger()->set_level(spdlog::level::err);
+
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+    std::size_t runCount{0};
+    std::size_t failedCaseCount{0};
+    for (const Tests::TestCase& testCase : Tests::GetTestCases())
+    {
+        if (testCase.Name.find(filter) == std::string_view::npos) continue;
+
+        const std::size_t failureCount = Tests::s_FailureCount;
+        testCase.Function();
+        ++runCount;
+
+        const bool bPassed = Tests::s_FailureCount == failureCount;
+        if (!bPassed) ++failedCaseCount;
+        std::printf("[%s] %.*s\n", bPassed ? "  OK  " : "FAILED", static_cast<int>(testCase.Name.size()), testCase.Name.data());
+    }
+
+    std::printf("%zu of %zu cases passed\n", runCount - failedCaseCount, runCount);
+    Logger::Shutdown();
+
+    return failedCaseCount == 0 && runCount > 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace nsudb
+{
+
+    // Minimal self-registering test cases: NSUDB_TEST(Name) { ... } anywhere in the test sources, NSUDB_CHECK inside it.
+    // A failed check is reported and the case goes on, the runner exits with 1 if any check failed.
+    namespace Tests
+    {
+        struct TestCase final
+        {
+            std::string_view Name{};
+            void (*Function)(){nullptr};
+        };
+
+        std::vector<TestCase>& GetTestCases() noexcept;
+        void ReportFailure(const char* file, int line, std::string_view expression, const std::string& details = {}) noexcept;
+
+        struct TestRegistrar final
+        {
+            TestRegistrar(std::string_view name, void (*function)()) noexcept { GetTestCases().push_back({name, function}); }
+        };
+
+        template <typename T> std::string ToTestString(const T& value)
+        {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                return "\"" + std::string(std::string_view(value)) + "\"";
+            else if constexpr (std::is_enum_v<T>)
+                return std::to_string(static_cast<int64_t>(value));
+            else
+                return std::to_string(value);
+        }
+    }  // namespace Tests
+
+}  // namespace nsudb
+
+#define NSUDB_TEST(name)                                                    \
+    static void name();                                                     \
+    static const nsudb::Tests::TestRegistrar s_##name##Registrar(#name, &name); \
+    static void name()
+
+#define NSUDB_CHECK(expression) \
+    ((expression) ? void(0) : nsudb::Tests::ReportFailure(__FILE__, __LINE__, #expression))
+
+#define NSUDB_CHECK_EQ(lhs, rhs)                                                                                             \
+    do                                                                                                                       \
+    {                                                                                                                        \
+        const auto& lhsValue = (lhs);                                                                                        \
+        const auto& rhsValue = (rhs);                                                                                        \
+        if (!(lhsValue == rhsValue))                                                                                         \
+            nsudb::Tests::ReportFailure(__FILE__, __LINE__, #lhs " == " #rhs,                                                \
+                                        nsudb::Tests::ToTestString(lhsValue) + " vs " + nsudb::Tests::ToTestString(rhsValue)); \
+    } while (false)
@@ -0,0 +1,37 @@
+-- pgbench: прием заказа с двумя услугами и заказом печати на 36 кадров в одной транзакции.
+-- Сравнение построчных и операторных триггеров пересчета overall_price (порт из docker-compose.yml):
+--
+--   psql -h localhost -p 5431 -U postgres -d photo_center_db -f database/pgbench/row-level-price-triggers.sql
+--   pgbench -h localhost -p 5431 -U postgres -n -c 8 -j 4 -T 60 -f database/pgbench/order-insert.sql photo_center_db
+--
+--   psql -h localhost -p 5431 -U postgres -d photo_center_db -f database/sql_scripts/08-statement-triggers.sql
+--   pgbench -h localhost -p 5431 -U postgres -n -c 8 -j 4 -T 60 -f database/pgbench/order-insert.sql photo_center_db
+--
+-- Построчные триггеры пересчитывают заказ 40 раз за транзакцию (2 услуги, заказ печати, 36 кадров),
+-- операторные - 3 раза. Сравнивать tps и latency average. Диапазоны id соответствуют database/data.
+--
+-- Так же сравниваются построчные триггеры склада и журнал движений (14-inventory-ledger.sql):
+-- database/pgbench/row-level-storage-triggers.sql, затем повторный запуск 14-inventory-ledger.sql.
+-- С журналом заказы одной точки не ждут друг друга на строках storage_items.
+
+\set outlet_id random(1, 5)
+\set client_id random(1, 5)
+\set service_type_id random(1, 5)
+\set print_discount_id random(1, 4)
+\set print_price_id random(1, 4)
+
+-- Дочерние таблицы секционированы по времени приема заказа (13-monthly-partitions.sql) и получают его явно.
+-- LOCALTIMESTAMP не меняется до конца транзакции, поэтому у заказа и всех его строк время одно.
+BEGIN;
+INSERT INTO orders (accept_time, overall_price, is_urgent, outlet_id, client_id)
+VALUES (LOCALTIMESTAMP, 0, FALSE, :outlet_id, :client_id)
+RETURNING id AS order_id \gset
+INSERT INTO service_orders (count, order_id, order_accept_time, service_type_id)
+VALUES (1, :order_id, LOCALTIMESTAMP, :service_type_id), (2, :order_id, LOCALTIMESTAMP, :service_type_id % 5 + 1);
+INSERT INTO print_orders (order_id, order_accept_time, print_discount_id)
+VALUES (:order_id, LOCALTIMESTAMP, :print_discount_id)
+RETURNING id AS print_order_id \gset
+INSERT INTO frames (amount, frame_number, print_order_id, order_accept_time, print_price_id)
+SELECT 1 + n % 3, n, :print_order_id, LOCALTIMESTAMP, :print_price_id
+FROM generate_series(1, 36) AS n;
+END;
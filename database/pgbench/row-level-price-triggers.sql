@@ -0,0 +1,30 @@
+-- Возвращает построчные триггеры пересчета overall_price из 05-create-triggers.sql вместо операторных
+-- из 08-statement-triggers.sql. Только для замеров order-insert.sql; обратно - повторный запуск 08-statement-triggers.sql.
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_insert ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_service_orders_update ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_service_orders_delete ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_print_orders_insert ON print_orders;
+DROP TRIGGER IF EXISTS trg_after_print_orders_update ON print_orders;
+DROP TRIGGER IF EXISTS trg_after_print_orders_delete ON print_orders;
+DROP TRIGGER IF EXISTS trg_after_frames_insert ON frames;
+DROP TRIGGER IF EXISTS trg_after_frames_update ON frames;
+DROP TRIGGER IF EXISTS trg_after_frames_delete ON frames;
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_change ON service_orders;
+CREATE TRIGGER trg_after_service_orders_change
+AFTER INSERT OR UPDATE OR DELETE ON service_orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_recalculate_order_overall_price();
+
+DROP TRIGGER IF EXISTS trg_after_print_orders_change ON print_orders;
+CREATE TRIGGER trg_after_print_orders_change
+AFTER INSERT OR UPDATE OR DELETE ON print_orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_recalculate_order_overall_price();
+
+DROP TRIGGER IF EXISTS trg_after_frames_change ON frames;
+CREATE TRIGGER trg_after_frames_change
+AFTER INSERT OR UPDATE OR DELETE ON frames
+FOR EACH ROW
+EXECUTE FUNCTION trg_recalculate_order_overall_price();
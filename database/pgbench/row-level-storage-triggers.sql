@@ -0,0 +1,31 @@
+-- Возвращает построчные триггеры склада из 05-create-triggers.sql вместо журнала движений
+-- из 14-inventory-ledger.sql. Только для замеров order-insert.sql и db_runner --simulate-orders;
+-- обратно - повторный запуск 14-inventory-ledger.sql, он же пересчитывает storage_totals.
+-- Несвернутые движения перед этим стоит свернуть: db_runner --compact-inventory.
+
+DROP TRIGGER IF EXISTS trg_after_delivery_items_change ON delivery_items;
+DROP TRIGGER IF EXISTS trg_after_delivery_items_update ON delivery_items;
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_use ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_update ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_delivery_items_delete ON delivery_items;
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_delete ON service_orders;
+DROP TRIGGER IF EXISTS trg_before_orders_delete_reverse_items ON orders;
+DROP TRIGGER IF EXISTS trg_after_storage_items_insert ON storage_items;
+DROP TRIGGER IF EXISTS trg_after_storage_items_update ON storage_items;
+DROP TRIGGER IF EXISTS trg_after_storage_items_delete ON storage_items;
+
+CREATE TRIGGER trg_after_delivery_items_change
+AFTER INSERT OR UPDATE ON delivery_items
+FOR EACH ROW
+EXECUTE FUNCTION trg_update_storage_quantity();
+
+CREATE TRIGGER trg_after_service_orders_items_use
+AFTER INSERT OR UPDATE ON service_orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_update_storage_quantity();
+
+DROP TRIGGER IF EXISTS trg_before_storage_items_insert_update ON storage_items;
+CREATE TRIGGER trg_before_storage_items_insert_update
+BEFORE INSERT OR UPDATE ON storage_items
+FOR EACH ROW
+EXECUTE FUNCTION trg_check_storage_capacity();
@@ -1,5 +1,14 @@
 \connect photo_center_db
 
+-- Имя таблицы, на которой определен триггер. Построчный триггер секционированной таблицы (13-monthly-partitions.sql)
+-- срабатывает на секции, и TG_TABLE_NAME содержит имя секции, а не таблицы
+CREATE OR REPLACE FUNCTION trigger_table_name(
+    p_relid OID
+)
+RETURNS NAME AS $$
+    SELECT relname FROM pg_class WHERE oid = COALESCE(pg_partition_root(p_relid), p_relid);
+$$ LANGUAGE sql STABLE;
+
 -- Функция для пересчета overall_price в таблице orders
 CREATE OR REPLACE FUNCTION trg_recalculate_order_overall_price()
 RETURNS TRIGGER AS $$
@@ -14,15 +23,16 @@ DECLARE
     v_is_film_bought_in_outlet BOOLEAN;
     v_film_service_order_id INT;
     v_film_code VARCHAR(255);
+    v_table_name NAME := trigger_table_name(TG_RELID);
 BEGIN
     -- Определяем order_id в зависимости от таблицы, вызвавшей триггер
-    IF TG_TABLE_NAME = 'service_orders' THEN
+    IF v_table_name = 'service_orders' THEN
         v_order_id := COALESCE(NEW.order_id, OLD.order_id);
-    ELSIF TG_TABLE_NAME = 'print_orders' THEN
+    ELSIF v_table_name = 'print_orders' THEN
         v_order_id := COALESCE(NEW.order_id, OLD.order_id);
-    ELSIF TG_TABLE_NAME = 'frames' THEN
+    ELSIF v_table_name = 'frames' THEN
         SELECT po.order_id INTO v_order_id FROM print_orders po WHERE po.id = COALESCE(NEW.print_order_id, OLD.print_order_id);
-    ELSIF TG_TABLE_NAME = 'clients' THEN
+    ELSIF v_table_name = 'clients' THEN
         -- Для клиентов, нам нужно найти все их заказы и пересчитать overall_price
         -- Это может быть дорого для большого количества заказов.
         -- Для демонстрации, мы пересчитываем только для одного заказа,
@@ -33,7 +43,7 @@ BEGIN
             END LOOP;
         END IF;
         RETURN NEW;
-    ELSIF TG_TABLE_NAME = 'print_discounts' THEN
+    ELSIF v_table_name = 'print_discounts' THEN
         -- Для скидок на печать, нужно найти все заказы, использующие эту скидку
         IF TG_OP = 'UPDATE' AND OLD.discount IS DISTINCT FROM NEW.discount THEN
             FOR v_order_id IN (SELECT po.order_id FROM print_orders po WHERE po.print_discount_id = NEW.id) LOOP
@@ -182,8 +192,21 @@ DECLARE
     v_item_id INT;
     v_quantity_change INT;
     v_order_outlet_id INT;
+    v_table_name NAME := trigger_table_name(TG_RELID);
 BEGIN
-    IF TG_TABLE_NAME = 'delivery_items' THEN
+    -- Изменение, не затрагивающее товар и количество, склад не трогает. Так, смена orders.accept_time каскадом
+    -- обновляет order_accept_time в service_orders (13-monthly-partitions.sql), и без этой проверки расход списался бы повторно
+    IF TG_OP = 'UPDATE' THEN
+        IF v_table_name = 'delivery_items' THEN
+            IF (NEW.quantity, NEW.item_id, NEW.delivery_id) IS NOT DISTINCT FROM (OLD.quantity, OLD.item_id, OLD.delivery_id) THEN
+                RETURN NEW;
+            END IF;
+        ELSIF (NEW.count, NEW.service_type_id, NEW.order_id) IS NOT DISTINCT FROM (OLD.count, OLD.service_type_id, OLD.order_id) THEN
+            RETURN NEW;
+        END IF;
+    END IF;
+
+    IF v_table_name = 'delivery_items' THEN
         -- Поступление товаров
         SELECT d.storage_id INTO v_storage_id FROM deliveries d WHERE d.id = NEW.delivery_id;
         v_item_id := NEW.item_id;
@@ -194,7 +217,7 @@ BEGIN
         ON CONFLICT (item_id, storage_id) DO UPDATE 
         SET quantity = storage_items.quantity + EXCLUDED.quantity;
 
-    ELSIF TG_TABLE_NAME = 'service_orders' THEN
+    ELSIF v_table_name = 'service_orders' THEN
         -- Использование товаров для услуг
         -- Определяем storage_id, связанный с outlet_id заказа
         SELECT o.outlet_id INTO v_order_outlet_id FROM orders o WHERE o.id = NEW.order_id;
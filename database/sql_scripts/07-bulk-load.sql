@@ -0,0 +1,135 @@
+\connect photo_center_db
+
+-- Функции для массовой загрузки (db_runner --import-csv).
+-- Во время COPY построчные триггеры пересчета цены и склада отключаются,
+-- а их эффект применяется одним проходом по всем загруженным строкам.
+
+-- Пересчет overall_price сразу для набора заказов.
+-- Та же формула, что и в trg_recalculate_order_overall_price_for_order, но одним UPDATE.
+-- Покупка пленки в точке определяется как в sp_check_film_bought_in_outlet (items.name = films.code).
+-- Дочерние таблицы соединяются с заказом по паре (id, время) из 13-monthly-partitions.sql: по одному id поиск проходит
+-- индексы всех секций, а по паре планировщик оставляет только секцию месяца заказа.
+CREATE OR REPLACE FUNCTION recalculate_order_overall_prices(
+    p_order_ids INT[]
+)
+RETURNS INT AS $$
+DECLARE
+    v_updated_count INT;
+BEGIN
+    WITH target_orders AS (
+        SELECT o.id, o.accept_time, o.is_urgent, o.outlet_id, c.discount AS client_discount
+        FROM orders o
+        JOIN clients c ON o.client_id = c.id
+        WHERE o.id = ANY(p_order_ids)
+    ),
+    service_totals AS (
+        SELECT so.order_id, SUM(so.count * st.price * CASE WHEN t.is_urgent THEN 2.0 ELSE 1.0 END) AS total
+        FROM target_orders t
+        JOIN service_orders so ON so.order_id = t.id AND so.order_accept_time = t.accept_time
+        JOIN service_types st ON so.service_type_id = st.id
+        GROUP BY so.order_id
+    ),
+    -- Проявка пленки, купленной в той же точке, бесплатна
+    film_refunds AS (
+        SELECT so.order_id, SUM(st.price) AS total
+        FROM target_orders t
+        JOIN service_orders so ON so.order_id = t.id AND so.order_accept_time = t.accept_time
+        JOIN service_types st ON so.service_type_id = st.id AND st.name = 'Проявка пленки'
+        JOIN films f ON f.service_order_id = so.id
+        WHERE EXISTS (
+            SELECT 1
+            FROM delivery_items di
+            JOIN deliveries d ON di.delivery_id = d.id
+            JOIN storages s ON d.storage_id = s.id
+            JOIN items i ON di.item_id = i.id
+            WHERE s.outlet_id = t.outlet_id
+              AND i.name = f.code
+        )
+        GROUP BY so.order_id
+    ),
+    print_totals AS (
+        SELECT po.order_id, SUM(
+            f.amount * pp.price * (1 - COALESCE(pd.discount, 0) / 100.0) * (1 - COALESCE(t.client_discount, 0) / 100.0)
+        ) AS total
+        FROM target_orders t
+        JOIN print_orders po ON po.order_id = t.id AND po.order_accept_time = t.accept_time
+        JOIN frames f ON po.id = f.print_order_id AND f.order_accept_time = po.order_accept_time
+        JOIN print_prices pp ON f.print_price_id = pp.id
+        LEFT JOIN print_discounts pd ON po.print_discount_id = pd.id
+        GROUP BY po.order_id
+    )
+    UPDATE orders o
+    SET overall_price = COALESCE(s.total, 0) - COALESCE(r.total, 0) + COALESCE(p.total, 0)
+    FROM target_orders t
+    LEFT JOIN service_totals s ON s.order_id = t.id
+    LEFT JOIN film_refunds r ON r.order_id = t.id
+    LEFT JOIN print_totals p ON p.order_id = t.id
+    WHERE o.id = t.id AND o.accept_time = t.accept_time;
+
+    GET DIAGNOSTICS v_updated_count = ROW_COUNT;
+    RETURN v_updated_count;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Поступление товаров по набору delivery_items, аналог trg_update_storage_quantity для delivery_items
+CREATE OR REPLACE FUNCTION apply_delivery_items_to_storage(
+    p_delivery_item_ids INT[]
+)
+RETURNS VOID AS $$
+BEGIN
+    INSERT INTO storage_items (quantity, item_id, storage_id)
+    SELECT SUM(di.quantity), di.item_id, d.storage_id
+    FROM delivery_items di
+    JOIN deliveries d ON di.delivery_id = d.id
+    WHERE di.id = ANY(p_delivery_item_ids)
+    GROUP BY di.item_id, d.storage_id
+    ON CONFLICT (item_id, storage_id) DO UPDATE
+    SET quantity = storage_items.quantity + EXCLUDED.quantity;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Расход товаров набором service_orders: склад точки заказа, товар, количество
+CREATE OR REPLACE FUNCTION service_orders_storage_usage(
+    p_service_order_ids INT[]
+)
+RETURNS TABLE (storage_id INT, item_id INT, quantity BIGINT) AS $$
+    SELECT s.id, stni.item_id, SUM(stni.count * so.count)
+    FROM service_orders so
+    JOIN orders o ON so.order_id = o.id
+    JOIN LATERAL (
+        SELECT MIN(st.id) AS id FROM storages st WHERE st.outlet_id = o.outlet_id
+    ) s ON TRUE
+    JOIN service_types_needed_items stni ON stni.service_type_id = so.service_type_id
+    WHERE so.id = ANY(p_service_order_ids)
+    GROUP BY s.id, stni.item_id;
+$$ LANGUAGE sql STABLE;
+
+-- Аналог trg_update_storage_quantity для service_orders
+CREATE OR REPLACE FUNCTION apply_service_orders_to_storage(
+    p_service_order_ids INT[]
+)
+RETURNS VOID AS $$
+DECLARE
+    v_outlet_id INT;
+BEGIN
+    SELECT o.outlet_id INTO v_outlet_id
+    FROM service_orders so
+    JOIN orders o ON so.order_id = o.id
+    WHERE so.id = ANY(p_service_order_ids)
+      AND NOT EXISTS (SELECT 1 FROM storages s WHERE s.outlet_id = o.outlet_id)
+    LIMIT 1;
+
+    IF FOUND THEN
+        RAISE EXCEPTION 'Не найдено хранилище для торговой точки заказа ID: %', v_outlet_id;
+    END IF;
+
+    UPDATE storage_items si
+    SET quantity = si.quantity - u.quantity
+    FROM service_orders_storage_usage(p_service_order_ids) u
+    WHERE si.item_id = u.item_id AND si.storage_id = u.storage_id;
+
+    DELETE FROM storage_items si
+    USING service_orders_storage_usage(p_service_order_ids) u
+    WHERE si.item_id = u.item_id AND si.storage_id = u.storage_id AND si.quantity <= 0;
+END;
+$$ LANGUAGE plpgsql;
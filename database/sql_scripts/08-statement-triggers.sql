@@ -0,0 +1,127 @@
+\connect photo_center_db
+
+-- Пересчет overall_price триггерами уровня оператора.
+-- Построчные триггеры trg_after_*_change пересчитывали заказ после каждой вставленной строки:
+-- заказ печати на 36 кадров пересчитывался 36 раз. Здесь триггер срабатывает один раз на оператор,
+-- собирает затронутые заказы из таблиц переходов и пересчитывает их одним UPDATE
+-- (recalculate_order_overall_prices из 07-bulk-load.sql).
+-- Скрипт можно выполнять повторно; database/pgbench/row-level-price-triggers.sql возвращает старые триггеры для сравнения.
+
+CREATE OR REPLACE FUNCTION trg_recalculate_order_overall_prices()
+RETURNS TRIGGER AS $$
+DECLARE
+    v_old_ids INT[];
+    v_new_ids INT[];
+    v_order_ids INT[];
+BEGIN
+    -- Таблицы переходов доступны только для своих событий, поэтому обращаемся к ним по TG_OP
+    IF TG_TABLE_NAME = 'frames' THEN
+        IF TG_OP IN ('UPDATE', 'DELETE') THEN
+            SELECT array_agg(print_order_id) INTO v_old_ids FROM old_rows;
+        END IF;
+        IF TG_OP IN ('INSERT', 'UPDATE') THEN
+            SELECT array_agg(print_order_id) INTO v_new_ids FROM new_rows;
+        END IF;
+
+        SELECT array_agg(DISTINCT po.order_id ORDER BY po.order_id)
+        INTO v_order_ids
+        FROM print_orders po
+        WHERE po.id = ANY(v_old_ids || v_new_ids);
+    ELSE
+        -- service_orders и print_orders ссылаются на заказ напрямую
+        IF TG_OP IN ('UPDATE', 'DELETE') THEN
+            SELECT array_agg(order_id) INTO v_old_ids FROM old_rows;
+        END IF;
+        IF TG_OP IN ('INSERT', 'UPDATE') THEN
+            SELECT array_agg(order_id) INTO v_new_ids FROM new_rows;
+        END IF;
+
+        SELECT array_agg(DISTINCT id ORDER BY id)
+        INTO v_order_ids
+        FROM unnest(v_old_ids || v_new_ids) AS id;
+    END IF;
+
+    IF v_order_ids IS NULL THEN
+        RETURN NULL;
+    END IF;
+
+    -- Блокируем заказы в порядке id, чтобы параллельные транзакции не попадали во взаимоблокировку
+    PERFORM 1 FROM orders WHERE id = ANY(v_order_ids) ORDER BY id FOR UPDATE;
+    PERFORM recalculate_order_overall_prices(v_order_ids);
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Старые построчные триггеры
+DROP TRIGGER IF EXISTS trg_after_service_orders_change ON service_orders;
+DROP TRIGGER IF EXISTS trg_after_print_orders_change ON print_orders;
+DROP TRIGGER IF EXISTS trg_after_frames_change ON frames;
+
+-- Таблицы переходов задаются для каждого события отдельно: у INSERT нет OLD TABLE, у DELETE нет NEW TABLE
+
+-- Триггеры AFTER INSERT, UPDATE, DELETE на service_orders
+DROP TRIGGER IF EXISTS trg_after_service_orders_insert ON service_orders;
+CREATE TRIGGER trg_after_service_orders_insert
+AFTER INSERT ON service_orders
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_update ON service_orders;
+CREATE TRIGGER trg_after_service_orders_update
+AFTER UPDATE ON service_orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_delete ON service_orders;
+CREATE TRIGGER trg_after_service_orders_delete
+AFTER DELETE ON service_orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+-- Триггеры AFTER INSERT, UPDATE, DELETE на print_orders
+DROP TRIGGER IF EXISTS trg_after_print_orders_insert ON print_orders;
+CREATE TRIGGER trg_after_print_orders_insert
+AFTER INSERT ON print_orders
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_print_orders_update ON print_orders;
+CREATE TRIGGER trg_after_print_orders_update
+AFTER UPDATE ON print_orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_print_orders_delete ON print_orders;
+CREATE TRIGGER trg_after_print_orders_delete
+AFTER DELETE ON print_orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+-- Триггеры AFTER INSERT, UPDATE, DELETE на frames
+DROP TRIGGER IF EXISTS trg_after_frames_insert ON frames;
+CREATE TRIGGER trg_after_frames_insert
+AFTER INSERT ON frames
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_frames_update ON frames;
+CREATE TRIGGER trg_after_frames_update
+AFTER UPDATE ON frames
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
+
+DROP TRIGGER IF EXISTS trg_after_frames_delete ON frames;
+CREATE TRIGGER trg_after_frames_delete
+AFTER DELETE ON frames
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_recalculate_order_overall_prices();
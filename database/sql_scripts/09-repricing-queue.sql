@@ -0,0 +1,98 @@
+\connect photo_center_db
+
+-- Очередь пересчета overall_price.
+-- Изменение скидки клиента или скидки на печать раньше пересчитывало все затронутые заказы прямо в UPDATE,
+-- по одному вызову trg_recalculate_order_overall_price_for_order на заказ. Теперь триггеры только ставят
+-- заказы в очередь, а пересчет пачками выполняет db_runner --reprice (или окно Repricing в клиенте).
+
+CREATE TABLE IF NOT EXISTS order_repricing_queue (
+    order_id INT PRIMARY KEY,
+    enqueued_at TIMESTAMP NOT NULL DEFAULT NOW(),
+    CONSTRAINT fk_order_repricing_queue_order FOREIGN KEY (order_id)
+        REFERENCES orders(id) ON DELETE CASCADE
+);
+
+-- order_repricing_queue (R для Employee, CRUD для Manager: скидки меняет и очередь обрабатывает менеджер)
+GRANT SELECT ON TABLE order_repricing_queue TO employee;
+GRANT SELECT, INSERT, UPDATE, DELETE ON TABLE order_repricing_queue TO manager;
+
+-- Постановка заказов в очередь после изменения скидок.
+-- Для таблиц переходов нельзя указать UPDATE OF discount, поэтому изменившиеся строки отбираются сравнением old_rows и new_rows.
+CREATE OR REPLACE FUNCTION trg_enqueue_order_repricing()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_TABLE_NAME = 'clients' THEN
+        INSERT INTO order_repricing_queue (order_id)
+        SELECT o.id
+        FROM new_rows n
+        JOIN old_rows od ON od.id = n.id
+        JOIN orders o ON o.client_id = n.id
+        WHERE n.discount IS DISTINCT FROM od.discount
+        ON CONFLICT (order_id) DO NOTHING;
+    ELSIF TG_TABLE_NAME = 'print_discounts' THEN
+        INSERT INTO order_repricing_queue (order_id)
+        SELECT DISTINCT po.order_id
+        FROM new_rows n
+        JOIN old_rows od ON od.id = n.id
+        JOIN print_orders po ON po.print_discount_id = n.id
+        WHERE n.discount IS DISTINCT FROM od.discount
+        ON CONFLICT (order_id) DO NOTHING;
+    END IF;
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Пересчет очередной пачки заказов. Возвращает число взятых из очереди заказов, 0 - очередь пуста.
+-- SKIP LOCKED позволяет запускать несколько обработчиков одновременно.
+CREATE OR REPLACE FUNCTION reprice_queued_orders(
+    p_batch_size INT
+)
+RETURNS INT AS $$
+DECLARE
+    v_order_ids INT[];
+BEGIN
+    WITH batch AS (
+        DELETE FROM order_repricing_queue q
+        WHERE q.order_id IN (
+            SELECT order_id
+            FROM order_repricing_queue
+            ORDER BY order_id
+            LIMIT p_batch_size
+            FOR UPDATE SKIP LOCKED
+        )
+        RETURNING q.order_id
+    )
+    SELECT array_agg(order_id ORDER BY order_id) INTO v_order_ids FROM batch;
+
+    IF v_order_ids IS NULL THEN
+        RETURN 0;
+    END IF;
+
+    -- Тот же порядок блокировок, что и в trg_recalculate_order_overall_prices
+    PERFORM 1 FROM orders WHERE id = ANY(v_order_ids) ORDER BY id FOR UPDATE;
+    PERFORM recalculate_order_overall_prices(v_order_ids);
+
+    RETURN array_length(v_order_ids, 1);
+END;
+$$ LANGUAGE plpgsql;
+
+-- Старые построчные триггеры, пересчитывавшие заказы синхронно
+DROP TRIGGER IF EXISTS trg_after_clients_discount_change ON clients;
+DROP TRIGGER IF EXISTS trg_after_print_discounts_change ON print_discounts;
+
+-- Триггер AFTER UPDATE на clients для изменения скидок клиентов
+DROP TRIGGER IF EXISTS trg_after_clients_discount_enqueue ON clients;
+CREATE TRIGGER trg_after_clients_discount_enqueue
+AFTER UPDATE ON clients
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_enqueue_order_repricing();
+
+-- Триггер AFTER UPDATE на print_discounts для изменения скидок на печать
+DROP TRIGGER IF EXISTS trg_after_print_discounts_enqueue ON print_discounts;
+CREATE TRIGGER trg_after_print_discounts_enqueue
+AFTER UPDATE ON print_discounts
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_enqueue_order_repricing();
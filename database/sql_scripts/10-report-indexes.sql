@@ -0,0 +1,93 @@
+\connect photo_center_db
+
+-- Индексы для отчетов из database/sql_queries (и ReportQueries.cpp в клиенте).
+-- В 03-create-tables.sql есть только первичные ключи: отчеты соединяют таблицы по внешним ключам без индексов
+-- и фильтруют orders.accept_time, поэтому на больших данных каждый отчет - последовательные сканирования.
+-- INCLUDE-столбцы покрывают то, что отчеты и пересчет overall_price читают из строки, чтобы хватало index-only scan.
+-- Предложения по индексам для текущих данных показывает окно Index Advisor клиента.
+
+-- orders: отчеты 3, 4, 8, 9, 10, 11 - точка приема и (кроме 8, 10) интервал accept_time
+CREATE INDEX IF NOT EXISTS idx_orders_outlet_accept_time
+    ON orders (outlet_id, accept_time)
+    INCLUDE (id, is_urgent, overall_price, client_id);
+
+-- orders: отчеты 2 и 5 - только интервал accept_time.
+-- Заказы добавляются в порядке времени приема, BRIN на порядки меньше B-дерева и хорошо отсекает страницы.
+CREATE INDEX IF NOT EXISTS idx_orders_accept_time_brin
+    ON orders USING brin (accept_time) WITH (pages_per_range = 32);
+
+-- orders.client_id: отчет 8 и постановка заказов клиента в очередь пересчета (09-repricing-queue.sql)
+CREATE INDEX IF NOT EXISTS idx_orders_client_id
+    ON orders (client_id);
+
+-- service_orders.order_id: отчеты 3, 4, 9, 10, 11 и пересчет overall_price
+CREATE INDEX IF NOT EXISTS idx_service_orders_order_id
+    ON service_orders (order_id)
+    INCLUDE (service_type_id, count);
+
+-- print_orders.order_id: отчет 5 и пересчет overall_price
+CREATE INDEX IF NOT EXISTS idx_print_orders_order_id
+    ON print_orders (order_id)
+    INCLUDE (id, print_discount_id);
+
+-- print_orders.print_discount_id: постановка в очередь пересчета при изменении скидки на печать
+CREATE INDEX IF NOT EXISTS idx_print_orders_print_discount_id
+    ON print_orders (print_discount_id);
+
+-- frames.print_order_id: отчет 5 (SUM(amount)) и пересчет overall_price
+CREATE INDEX IF NOT EXISTS idx_frames_print_order_id
+    ON frames (print_order_id)
+    INCLUDE (amount, print_price_id);
+
+-- films.service_order_id: отчет 6
+CREATE INDEX IF NOT EXISTS idx_films_service_order_id
+    ON films (service_order_id);
+
+-- deliveries: отчет 7 - интервал date, поставки тоже добавляются по времени
+CREATE INDEX IF NOT EXISTS idx_deliveries_date_brin
+    ON deliveries USING brin (date);
+
+-- delivery_items.delivery_id: отчет 7
+CREATE INDEX IF NOT EXISTS idx_delivery_items_delivery_id
+    ON delivery_items (delivery_id)
+    INCLUDE (item_id, quantity, price);
+
+-- service_types_needed_items: первичный ключ начинается с item_id, отчеты 9, 10, 11 соединяют по service_type_id
+CREATE INDEX IF NOT EXISTS idx_stni_service_type_id
+    ON service_types_needed_items (service_type_id)
+    INCLUDE (item_id, count);
+
+-- storages.outlet_id: склад точки приема в trg_update_storage_quantity и apply_service_orders_to_storage
+CREATE INDEX IF NOT EXISTS idx_storages_outlet_id
+    ON storages (outlet_id);
+
+-- План запроса с EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) для Index Advisor.
+-- Запрос выполняется, поэтому функция нужна только для SELECT-отчетов; выполняется с правами вызывающего.
+-- EXPLAIN идет в подтранзакции в режиме только для чтения: INSERT, UPDATE, DELETE и изменяющие данные функции в переданном
+-- тексте завершатся ошибкой. Подтранзакция всегда откатывается, вместе с ней и этот режим, так что транзакция вызывающего
+-- остается такой, какой была. Вызывать ее может только manager.
+CREATE OR REPLACE FUNCTION explain_analyze_json(
+    p_query TEXT
+)
+RETURNS JSONB AS $$
+DECLARE
+    v_plan JSON;
+BEGIN
+    -- Откат подтранзакции не трогает значения переменных, план остается в v_plan
+    BEGIN
+        PERFORM set_config('transaction_read_only', 'on', true);
+        EXECUTE 'EXPLAIN (ANALYZE, BUFFERS, FORMAT JSON) ' || p_query INTO v_plan;
+        RAISE EXCEPTION USING ERRCODE = 'NSUXP';
+    EXCEPTION
+        WHEN SQLSTATE 'NSUXP' THEN
+            NULL;
+    END;
+
+    RETURN v_plan::jsonb;
+END;
+$$ LANGUAGE plpgsql;
+
+REVOKE EXECUTE ON FUNCTION explain_analyze_json(TEXT) FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION explain_analyze_json(TEXT) TO manager;
+
+ANALYZE orders, service_orders, print_orders, frames, films, deliveries, delivery_items, service_types_needed_items, storages;
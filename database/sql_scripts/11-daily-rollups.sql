@@ -0,0 +1,299 @@
+\connect photo_center_db
+
+-- Дневные свертки для отчетов 4, 5, 6 и 9.
+-- Отчеты за период читают готовые суммы по полным дням, а сырые данные - только для неполных дней на краях интервала
+-- (ReportQueries.cpp). Триггеры на путях записи лишь отмечают затронутые пары (день, точка приема) в daily_rollup_dirty.
+-- Отмеченные дни отчет тоже читает из сырых данных, так что свертки не обязаны быть свежими и отчет ничего не пишет.
+-- Пересчет отмеченных пар выполняет refresh_daily_rollups() короткой отдельной транзакцией: клиент запускает ее
+-- рядом с отчетом, чтобы сырых дней оставалось немного.
+
+-- Отчеты 4, 6, 9: строки service_orders по дню приема заказа, точке, срочности и типу услуги
+CREATE TABLE IF NOT EXISTS daily_service_rollups (
+    day DATE NOT NULL,
+    outlet_id INT NOT NULL,
+    is_urgent BOOLEAN NOT NULL,
+    service_type_id INT NOT NULL,
+    service_order_rows BIGINT NOT NULL,     -- число строк service_orders
+    service_count BIGINT NOT NULL,          -- SUM(service_orders.count), отчет 9
+    order_revenue NUMERIC(14, 2) NOT NULL,  -- SUM(orders.overall_price) по строкам service_orders, как считает отчет 4
+    film_count BIGINT NOT NULL,             -- пленки этих строк, отчет 6
+    PRIMARY KEY (day, outlet_id, is_urgent, service_type_id)
+);
+
+-- Отчет 5: напечатанные кадры; у заказов печати нет типа услуги
+CREATE TABLE IF NOT EXISTS daily_print_rollups (
+    day DATE NOT NULL,
+    outlet_id INT NOT NULL,
+    is_urgent BOOLEAN NOT NULL,
+    printed_photos BIGINT NOT NULL,
+    PRIMARY KEY (day, outlet_id, is_urgent)
+);
+
+-- Журнал устаревших корзин. Без уникального ключа намеренно: строка незавершенной транзакции не видна
+-- refresh_daily_rollups() и переживает ее, поэтому изменения, зафиксированные позже, не теряются. По той же причине
+-- повтор отметки пропускается только внутри своей транзакции: отметку другой транзакции может удалить пересчет,
+-- который изменений этой транзакции еще не видит.
+CREATE TABLE IF NOT EXISTS daily_rollup_dirty (
+    day DATE NOT NULL,
+    outlet_id INT NOT NULL
+);
+
+-- Проверка повторной отметки и исключение отмеченных корзин в отчетах
+CREATE INDEX IF NOT EXISTS idx_daily_rollup_dirty_day_outlet
+ON daily_rollup_dirty (day, outlet_id);
+
+-- daily_*_rollups (R для Employee и Manager), отметки пишут триггеры от имени пишущей роли, отчеты читают их
+GRANT SELECT ON TABLE daily_service_rollups, daily_print_rollups TO employee, manager;
+GRANT SELECT, INSERT ON TABLE daily_rollup_dirty TO employee, manager;
+
+-- Отметка затронутых корзин, триггер уровня оператора для orders, service_orders, films, print_orders и frames
+CREATE OR REPLACE FUNCTION trg_mark_daily_rollups_dirty()
+RETURNS TRIGGER AS $$
+DECLARE
+    v_old_ids INT[];
+    v_new_ids INT[];
+    v_order_ids INT[];
+    v_days DATE[];
+    v_outlet_ids INT[];
+BEGIN
+    IF TG_TABLE_NAME = 'orders' THEN
+        IF TG_OP = 'DELETE' THEN
+            SELECT array_agg(accept_time::date), array_agg(outlet_id)
+            INTO v_days, v_outlet_ids
+            FROM old_rows;
+        ELSE
+            -- Старая и новая корзины, если изменилось что-то, что попадает в свертки
+            SELECT array_agg(b.day), array_agg(b.outlet_id)
+            INTO v_days, v_outlet_ids
+            FROM old_rows od
+            JOIN new_rows n ON n.id = od.id
+            CROSS JOIN LATERAL (
+                VALUES (od.accept_time::date, od.outlet_id), (n.accept_time::date, n.outlet_id)
+            ) AS b(day, outlet_id)
+            WHERE (n.accept_time, n.outlet_id, n.is_urgent, n.overall_price)
+                IS DISTINCT FROM (od.accept_time, od.outlet_id, od.is_urgent, od.overall_price);
+        END IF;
+    ELSE
+        -- Дочерние таблицы: сначала ключ родителя, затем заказы
+        IF TG_TABLE_NAME IN ('service_orders', 'print_orders') THEN
+            IF TG_OP IN ('UPDATE', 'DELETE') THEN
+                SELECT array_agg(order_id) INTO v_old_ids FROM old_rows;
+            END IF;
+            IF TG_OP IN ('INSERT', 'UPDATE') THEN
+                SELECT array_agg(order_id) INTO v_new_ids FROM new_rows;
+            END IF;
+            v_order_ids := v_old_ids || v_new_ids;
+        ELSIF TG_TABLE_NAME = 'films' THEN
+            IF TG_OP IN ('UPDATE', 'DELETE') THEN
+                SELECT array_agg(service_order_id) INTO v_old_ids FROM old_rows;
+            END IF;
+            IF TG_OP IN ('INSERT', 'UPDATE') THEN
+                SELECT array_agg(service_order_id) INTO v_new_ids FROM new_rows;
+            END IF;
+            SELECT array_agg(so.order_id) INTO v_order_ids FROM service_orders so WHERE so.id = ANY(v_old_ids || v_new_ids);
+        ELSIF TG_TABLE_NAME = 'frames' THEN
+            IF TG_OP IN ('UPDATE', 'DELETE') THEN
+                SELECT array_agg(print_order_id) INTO v_old_ids FROM old_rows;
+            END IF;
+            IF TG_OP IN ('INSERT', 'UPDATE') THEN
+                SELECT array_agg(print_order_id) INTO v_new_ids FROM new_rows;
+            END IF;
+            SELECT array_agg(po.order_id) INTO v_order_ids FROM print_orders po WHERE po.id = ANY(v_old_ids || v_new_ids);
+        END IF;
+
+        -- Каскадно удаленные заказы уже отметил триггер на orders
+        SELECT array_agg(o.accept_time::date), array_agg(o.outlet_id)
+        INTO v_days, v_outlet_ids
+        FROM orders o
+        WHERE o.id = ANY(v_order_ids);
+    END IF;
+
+    -- Корзина, уже отмеченная этой же транзакцией, второй строки не получает: прием заказа отмечает одну корзину
+    -- каждым своим оператором
+    INSERT INTO daily_rollup_dirty (day, outlet_id)
+    SELECT DISTINCT b.day, b.outlet_id
+    FROM unnest(v_days, v_outlet_ids) AS b(day, outlet_id)
+    WHERE NOT EXISTS (
+        SELECT 1
+        FROM daily_rollup_dirty d
+        WHERE d.day = b.day AND d.outlet_id = b.outlet_id AND d.xmin = pg_current_xact_id()::xid
+    );
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Пересчет отмеченных корзин из сырых данных. Возвращает число пересчитанных пар (день, точка приема),
+-- 0 - если пересчет уже идет в другом сеансе: отмеченные им корзины он и пересчитает, а новые дождутся следующего вызова.
+-- Вызывается отдельной транзакцией, а не внутри отчета, чтобы блокировка держалась только на время пересчета.
+-- SECURITY DEFINER: клиенты вызывают ее от имени любой роли, а писать в свертки может только владелец.
+-- Дочерние таблицы соединяются с заказом и по ключу секционирования, если он уже есть (13-monthly-partitions.sql):
+-- тогда планировщик оставляет только секцию месяца заказа. Без него функция работает и до секционирования.
+CREATE OR REPLACE FUNCTION refresh_daily_rollups()
+RETURNS INT AS $$
+DECLARE
+    v_days DATE[];
+    v_outlet_ids INT[];
+    v_partitioned BOOLEAN;
+BEGIN
+    -- Два одновременных пересчета иначе могут пересчитать одну корзину и нарушить первичный ключ
+    IF NOT pg_try_advisory_xact_lock(hashtext('refresh_daily_rollups')) THEN
+        RETURN 0;
+    END IF;
+
+    WITH dirty AS (
+        DELETE FROM daily_rollup_dirty
+        RETURNING day, outlet_id
+    )
+    SELECT array_agg(day), array_agg(outlet_id)
+    INTO v_days, v_outlet_ids
+    FROM (SELECT DISTINCT day, outlet_id FROM dirty) AS d;
+
+    IF v_days IS NULL THEN
+        RETURN 0;
+    END IF;
+
+    DELETE FROM daily_service_rollups r
+    USING unnest(v_days, v_outlet_ids) AS b(day, outlet_id)
+    WHERE r.day = b.day AND r.outlet_id = b.outlet_id;
+
+    DELETE FROM daily_print_rollups r
+    USING unnest(v_days, v_outlet_ids) AS b(day, outlet_id)
+    WHERE r.day = b.day AND r.outlet_id = b.outlet_id;
+
+    SELECT EXISTS (
+        SELECT 1 FROM pg_attribute
+        WHERE attrelid = 'service_orders'::regclass AND attname = 'order_accept_time' AND NOT attisdropped
+    ) INTO v_partitioned;
+
+    EXECUTE format($sql$
+        INSERT INTO daily_service_rollups (
+            day, outlet_id, is_urgent, service_type_id, service_order_rows, service_count, order_revenue, film_count
+        )
+        SELECT b.day, b.outlet_id, o.is_urgent, so.service_type_id,
+               COUNT(*), SUM(so.count), SUM(o.overall_price), SUM(fc.film_count)
+        FROM unnest($1, $2) AS b(day, outlet_id)
+        JOIN orders o ON o.outlet_id = b.outlet_id AND o.accept_time >= b.day AND o.accept_time < b.day + 1
+        JOIN service_orders so ON so.order_id = o.id%s
+        CROSS JOIN LATERAL (SELECT COUNT(*) AS film_count FROM films f WHERE f.service_order_id = so.id) AS fc
+        GROUP BY b.day, b.outlet_id, o.is_urgent, so.service_type_id
+    $sql$, CASE WHEN v_partitioned THEN ' AND so.order_accept_time = o.accept_time' ELSE '' END)
+    USING v_days, v_outlet_ids;
+
+    EXECUTE format($sql$
+        INSERT INTO daily_print_rollups (day, outlet_id, is_urgent, printed_photos)
+        SELECT b.day, b.outlet_id, o.is_urgent, SUM(f.amount)
+        FROM unnest($1, $2) AS b(day, outlet_id)
+        JOIN orders o ON o.outlet_id = b.outlet_id AND o.accept_time >= b.day AND o.accept_time < b.day + 1
+        JOIN print_orders po ON po.order_id = o.id%s
+        JOIN frames f ON f.print_order_id = po.id%s
+        GROUP BY b.day, b.outlet_id, o.is_urgent
+    $sql$, CASE WHEN v_partitioned THEN ' AND po.order_accept_time = o.accept_time' ELSE '' END,
+           CASE WHEN v_partitioned THEN ' AND f.order_accept_time = po.order_accept_time' ELSE '' END)
+    USING v_days, v_outlet_ids;
+
+    RETURN array_length(v_days, 1);
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Триггеры отметки на orders: UPDATE и DELETE, новый заказ без строк в свертки не попадает
+DROP TRIGGER IF EXISTS trg_after_orders_update_rollup ON orders;
+CREATE TRIGGER trg_after_orders_update_rollup
+AFTER UPDATE ON orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_orders_delete_rollup ON orders;
+CREATE TRIGGER trg_after_orders_delete_rollup
+AFTER DELETE ON orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+-- Триггеры отметки на service_orders
+DROP TRIGGER IF EXISTS trg_after_service_orders_insert_rollup ON service_orders;
+CREATE TRIGGER trg_after_service_orders_insert_rollup
+AFTER INSERT ON service_orders
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_update_rollup ON service_orders;
+CREATE TRIGGER trg_after_service_orders_update_rollup
+AFTER UPDATE ON service_orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_delete_rollup ON service_orders;
+CREATE TRIGGER trg_after_service_orders_delete_rollup
+AFTER DELETE ON service_orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+-- Триггеры отметки на films
+DROP TRIGGER IF EXISTS trg_after_films_insert_rollup ON films;
+CREATE TRIGGER trg_after_films_insert_rollup
+AFTER INSERT ON films
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_films_update_rollup ON films;
+CREATE TRIGGER trg_after_films_update_rollup
+AFTER UPDATE ON films
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_films_delete_rollup ON films;
+CREATE TRIGGER trg_after_films_delete_rollup
+AFTER DELETE ON films
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+-- Триггеры отметки на frames
+DROP TRIGGER IF EXISTS trg_after_frames_insert_rollup ON frames;
+CREATE TRIGGER trg_after_frames_insert_rollup
+AFTER INSERT ON frames
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_frames_update_rollup ON frames;
+CREATE TRIGGER trg_after_frames_update_rollup
+AFTER UPDATE ON frames
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_frames_delete_rollup ON frames;
+CREATE TRIGGER trg_after_frames_delete_rollup
+AFTER DELETE ON frames
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+-- print_orders: перенос в другой заказ и удаление (новый заказ печати без кадров ничего не меняет)
+DROP TRIGGER IF EXISTS trg_after_print_orders_update_rollup ON print_orders;
+CREATE TRIGGER trg_after_print_orders_update_rollup
+AFTER UPDATE ON print_orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+DROP TRIGGER IF EXISTS trg_after_print_orders_delete_rollup ON print_orders;
+CREATE TRIGGER trg_after_print_orders_delete_rollup
+AFTER DELETE ON print_orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_mark_daily_rollups_dirty();
+
+-- Начальное заполнение по всем существующим заказам, повторный запуск (13-monthly-partitions.sql) пересчитывает все заново
+INSERT INTO daily_rollup_dirty (day, outlet_id)
+SELECT DISTINCT accept_time::date, outlet_id FROM orders;
+
+SELECT refresh_daily_rollups();
@@ -0,0 +1,60 @@
+\connect photo_center_db
+
+-- Уведомления об изменении таблиц для клиентского кэша результатов запросов.
+-- После каждого изменяющего оператора в канал table_changed уходит имя таблицы. Клиент держит LISTEN table_changed
+-- и выбрасывает из кэша результаты, которые читали эту таблицу. Одинаковые уведомления в одной транзакции
+-- сервер отправляет один раз, так что пакетная загрузка не порождает поток сообщений.
+
+CREATE OR REPLACE FUNCTION notify_table_changed()
+RETURNS TRIGGER AS $$
+BEGIN
+    PERFORM pg_notify('table_changed', TG_TABLE_NAME);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Триггер на каждую таблицу схемы public, кроме:
+-- * служебных таблиц сводок (11-daily-rollups.sql): refresh_daily_rollups() выполняется при каждом отчете и трогает их
+--   даже без изменений, а сами сводки меняются только вслед за исходными таблицами;
+-- * таблиц приема заказов, в которые пишут все терминалы одновременно. pg_notify при COMMIT берет общую для сервера
+--   блокировку очереди уведомлений, и с триггером на них транзакции приема заказа шли бы строго по одной
+--   (ожидания видны в db_runner --simulate-orders). Запросы к этим таблицам клиент не кэширует и всегда читает с сервера;
+--   кэшируются справочники (точки, клиенты, цены, товары), которые меняются редко.
+-- Клиент кэширует только запросы, все таблицы которых имеют этот триггер. Для новых таблиц скрипт нужно перезапустить.
+-- Секции (13-monthly-partitions.sql) пропускаются: триггер уровня оператора на секционированной таблице
+-- срабатывает при изменении любой ее секции, а новые секции появляются без перезапуска скрипта.
+DO $$
+DECLARE
+    t RECORD;
+BEGIN
+    FOR t IN
+        SELECT c.relname AS tablename
+        FROM pg_class c
+        JOIN pg_namespace n ON n.oid = c.relnamespace
+        WHERE n.nspname = 'public'
+          AND c.relkind IN ('r', 'p')
+          AND NOT c.relispartition
+    LOOP
+        EXECUTE format('DROP TRIGGER IF EXISTS %I ON %I', 'trg_notify_' || t.tablename || '_changed', t.tablename);
+        CONTINUE WHEN t.tablename IN ('daily_service_rollups', 'daily_print_rollups', 'daily_rollup_dirty',
+                                      'orders', 'service_orders', 'print_orders', 'frames', 'films',
+                                      'film_development_orders', 'inventory_movements');
+        EXECUTE format('CREATE TRIGGER %I
+                        AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON %I
+                        FOR EACH STATEMENT
+                        EXECUTE FUNCTION notify_table_changed()',
+                       'trg_notify_' || t.tablename || '_changed', t.tablename);
+    END LOOP;
+END;
+$$;
+
+-- Таблицы, изменения которых отслеживаются: клиент читает этот список при подключении слушателя.
+CREATE OR REPLACE VIEW notified_tables AS
+SELECT DISTINCT c.relname::TEXT AS table_name
+FROM pg_trigger tg
+JOIN pg_class c ON c.oid = tg.tgrelid
+JOIN pg_namespace n ON n.oid = c.relnamespace
+WHERE n.nspname = 'public'
+  AND tg.tgfoid = 'notify_table_changed'::regproc;
+
+GRANT SELECT ON TABLE notified_tables TO employee, manager, vendor;
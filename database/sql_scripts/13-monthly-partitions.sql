@@ -0,0 +1,342 @@
+\connect photo_center_db
+
+-- Помесячное секционирование orders и его тяжелых дочерних таблиц service_orders, print_orders и frames.
+-- Отчеты выбирают заказы за интервал accept_time, а таблицы растут без конца. С секциями по месяцу приема заказа
+-- планировщик отбрасывает все месяцы вне интервала, если условие на ключ есть у каждой таблицы запроса
+-- (ReportQueries.cpp добавляет их сам): недельный отчет читает одну-две секции вместо всей истории.
+--
+-- Ключ секционирования обязан входить в первичный ключ и во внешние ключи, которые ссылаются на таблицу. Поэтому:
+-- * первичный ключ orders - (id, accept_time), дочерние таблицы хранят время приема своего заказа в order_accept_time
+--   и ссылаются на родителя парой (id, время). Уникальность одного id база больше не проверяет: значения по умолчанию
+--   из последовательности не повторяются, но явно переданный id (загрузка CSV) может совпасть с id заказа другого времени.
+--   Поиск по одному id (films, order_repricing_queue, триггеры 05) берет первую найденную строку;
+-- * изменение orders.accept_time переносит заказ в секцию нового месяца, дочерние строки переезжают вслед
+--   по ON UPDATE CASCADE, а trg_update_storage_quantity() такое изменение пропускает и расход повторно не списывает;
+-- * recalculate_order_overall_prices() и refresh_daily_rollups() соединяют дочерние таблицы с заказом по паре (id, время),
+--   чтобы планировщик оставлял только секцию месяца заказа;
+-- * films и film_development_orders не секционированы, но ссылаются на service_orders и тоже получают order_accept_time,
+--   его заполняет триггер;
+-- * секция выбирается до BEFORE-триггеров, поэтому строка дочерней таблицы без order_accept_time (ключ NULL) попадает
+--   в секцию DEFAULT. Ее триггер берет время у родительской строки и вставляет строку заново через секционированную
+--   таблицу, а исходную вставку пропускает. Прежние INSERT без order_accept_time работают, но RETURNING для такой строки
+--   ничего не возвращает, и в число вставленных строк она не входит. Строка вставляется отдельным оператором и ищет
+--   родителя по одному id во всех секциях, поэтому массовые загрузки передают ключ сами (db_runner --import-csv
+--   для файлов без этого столбца берет время у родителя);
+-- * order_repricing_queue больше не ссылается на orders: reprice_queued_orders() пропускает удаленные заказы.
+--
+-- Секции создает create_order_partitions(): здесь - для всех имеющихся данных и на год вперед, при массовой загрузке -
+-- для месяцев загружаемых заказов, дальше - db_runner --create-partitions из планировщика задач раз в месяц.
+-- Заказ месяца без секции попадает в секцию DEFAULT и остается там, пока секция его месяца не будет создана:
+-- create_order_partitions() переносит такие строки в новую секцию сама.
+
+-- Секции всех четырех таблиц для месяцев с p_from по p_to включительно. Возвращает число созданных секций.
+-- SECURITY DEFINER: создает секции от имени владельца таблиц. Вызывать ее может только manager (загрузка CSV,
+-- db_runner --create-partitions), интервал ограничен 20 годами и не дальше 5 лет вперед.
+CREATE OR REPLACE FUNCTION create_order_partitions(
+    p_from TIMESTAMP,
+    p_to TIMESTAMP
+)
+RETURNS INT AS $$
+DECLARE
+    v_tables CONSTANT TEXT[] := ARRAY['orders', 'service_orders', 'print_orders', 'frames'];
+    v_month TIMESTAMP := date_trunc('month', p_from);
+    v_table TEXT;
+    v_key TEXT;
+    v_partition TEXT;
+    v_moved TEXT;
+    v_has_default_rows BOOLEAN;
+    v_created_count INT := 0;
+BEGIN
+    IF p_to >= v_month + INTERVAL '240 months' OR p_to > LOCALTIMESTAMP + INTERVAL '5 years' THEN
+        RAISE EXCEPTION 'Недопустимый интервал секций: % - %', p_from, p_to USING ERRCODE = 'invalid_parameter_value';
+    END IF;
+
+    WHILE v_month <= p_to LOOP
+        -- Строки месяца, попавшие в DEFAULT раньше, не дают присоединить секцию: они переносятся во временные таблицы
+        -- и возвращаются после создания секций. Триггеры и внешние ключи на это время отключены
+        -- (session_replication_role = replica): строки не меняются, только переезжают в другую секцию.
+        -- Дочерние строки месяца есть в DEFAULT, только если там есть их заказ.
+        SELECT EXISTS (
+            SELECT 1 FROM orders_default WHERE accept_time >= v_month AND accept_time < v_month + INTERVAL '1 month'
+        ) INTO v_has_default_rows;
+
+        IF v_has_default_rows THEN
+            PERFORM set_config('session_replication_role', 'replica', true);
+            FOREACH v_table IN ARRAY v_tables LOOP
+                v_key := CASE v_table WHEN 'orders' THEN 'accept_time' ELSE 'order_accept_time' END;
+                v_moved := v_table || '_moved_from_default';
+                -- Вставки в DEFAULT до конца транзакции ждут, иначе новая строка месяца помешала бы присоединению
+                EXECUTE format('LOCK TABLE %I IN EXCLUSIVE MODE', v_table || '_default');
+                EXECUTE format('CREATE TEMP TABLE %I (LIKE %I) ON COMMIT DROP', v_moved, v_table);
+                EXECUTE format('WITH moved AS (DELETE FROM %I WHERE %I >= %L AND %I < %L RETURNING *) INSERT INTO %I SELECT * FROM moved',
+                               v_table || '_default', v_key, v_month, v_key, v_month + INTERVAL '1 month', v_moved);
+            END LOOP;
+        END IF;
+
+        FOREACH v_table IN ARRAY v_tables LOOP
+            v_partition := format('%s_%s', v_table, to_char(v_month, 'YYYY_MM'));
+            CONTINUE WHEN to_regclass(v_partition) IS NOT NULL;
+
+            -- Отдельная таблица и ATTACH PARTITION вместо CREATE TABLE ... PARTITION OF: присоединение берет
+            -- SHARE UPDATE EXCLUSIVE и не останавливает чтение и запись остальных секций.
+            -- Индексы, внешние ключи и построчные триггеры секция получает от таблицы при присоединении.
+            EXECUTE format('CREATE TABLE %I (LIKE %I INCLUDING DEFAULTS)', v_partition, v_table);
+            EXECUTE format('ALTER TABLE %I ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+                           v_table, v_partition, v_month, v_month + INTERVAL '1 month');
+            v_created_count := v_created_count + 1;
+        END LOOP;
+
+        IF v_has_default_rows THEN
+            FOREACH v_table IN ARRAY v_tables LOOP
+                v_moved := v_table || '_moved_from_default';
+                EXECUTE format('INSERT INTO %I SELECT * FROM %I', v_table, v_moved);
+                EXECUTE format('DROP TABLE %I', v_moved);
+            END LOOP;
+            PERFORM set_config('session_replication_role', 'origin', true);
+        END IF;
+
+        v_month := v_month + INTERVAL '1 month';
+    END LOOP;
+
+    RETURN v_created_count;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+REVOKE EXECUTE ON FUNCTION create_order_partitions(TIMESTAMP, TIMESTAMP) FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION create_order_partitions(TIMESTAMP, TIMESTAMP) TO manager;
+
+-- Перенос данных в секционированные таблицы одной транзакцией
+BEGIN;
+
+-- Последовательности id переходят к новым таблицам, старые таблицы удаляются вместе со всем, что на них ссылается
+ALTER SEQUENCE orders_id_seq OWNED BY NONE;
+ALTER SEQUENCE service_orders_id_seq OWNED BY NONE;
+ALTER SEQUENCE print_orders_id_seq OWNED BY NONE;
+ALTER SEQUENCE frames_id_seq OWNED BY NONE;
+
+-- Имена индексов первичных ключей нужны новым таблицам
+ALTER INDEX orders_pkey RENAME TO orders_unpartitioned_pkey;
+ALTER INDEX service_orders_pkey RENAME TO service_orders_unpartitioned_pkey;
+ALTER INDEX print_orders_pkey RENAME TO print_orders_unpartitioned_pkey;
+ALTER INDEX frames_pkey RENAME TO frames_unpartitioned_pkey;
+
+ALTER TABLE orders RENAME TO orders_unpartitioned;
+ALTER TABLE service_orders RENAME TO service_orders_unpartitioned;
+ALTER TABLE print_orders RENAME TO print_orders_unpartitioned;
+ALTER TABLE frames RENAME TO frames_unpartitioned;
+
+-- Заказы
+CREATE TABLE orders (
+    id INT NOT NULL DEFAULT nextval('orders_id_seq'),
+    accept_time TIMESTAMP NOT NULL DEFAULT NOW(),
+    overall_price NUMERIC(10, 2) NOT NULL,
+    is_urgent BOOLEAN NOT NULL,
+    outlet_id INT NOT NULL,
+    client_id INT NOT NULL,
+    PRIMARY KEY (id, accept_time),
+    CONSTRAINT fk_order_outlet FOREIGN KEY (outlet_id)
+        REFERENCES outlets(id) ON DELETE CASCADE,
+    CONSTRAINT fk_order_client FOREIGN KEY (client_id)
+        REFERENCES clients(id) ON DELETE CASCADE
+) PARTITION BY RANGE (accept_time);
+
+-- Заказы на печать
+CREATE TABLE print_orders (
+    id INT NOT NULL DEFAULT nextval('print_orders_id_seq'),
+    order_id INT NOT NULL,
+    order_accept_time TIMESTAMP NOT NULL,
+    print_discount_id INT NOT NULL,
+    PRIMARY KEY (id, order_accept_time),
+    CONSTRAINT fk_print_order_order FOREIGN KEY (order_id, order_accept_time)
+        REFERENCES orders(id, accept_time) ON DELETE CASCADE ON UPDATE CASCADE,
+    CONSTRAINT fk_print_order_discount FOREIGN KEY (print_discount_id)
+        REFERENCES print_discounts(id) ON DELETE CASCADE
+) PARTITION BY RANGE (order_accept_time);
+
+-- Заказы услуг
+CREATE TABLE service_orders (
+    id INT NOT NULL DEFAULT nextval('service_orders_id_seq'),
+    count INT NOT NULL,
+    order_id INT NOT NULL,
+    order_accept_time TIMESTAMP NOT NULL,
+    service_type_id INT NOT NULL,
+    PRIMARY KEY (id, order_accept_time),
+    CONSTRAINT fk_service_order_order FOREIGN KEY (order_id, order_accept_time)
+        REFERENCES orders(id, accept_time) ON DELETE CASCADE ON UPDATE CASCADE,
+    CONSTRAINT fk_service_order_service_type FOREIGN KEY (service_type_id)
+        REFERENCES service_types(id) ON DELETE CASCADE
+) PARTITION BY RANGE (order_accept_time);
+
+-- Кадры
+CREATE TABLE frames (
+    id INT NOT NULL DEFAULT nextval('frames_id_seq'),
+    amount INT NOT NULL,
+    frame_number INT NOT NULL,
+    print_order_id INT NOT NULL,
+    order_accept_time TIMESTAMP NOT NULL,
+    print_price_id INT NOT NULL,
+    PRIMARY KEY (id, order_accept_time),
+    CONSTRAINT fk_frame_print_order FOREIGN KEY (print_order_id, order_accept_time)
+        REFERENCES print_orders(id, order_accept_time) ON UPDATE CASCADE,
+    CONSTRAINT fk_frame_print_price FOREIGN KEY (print_price_id)
+        REFERENCES print_prices(id)
+) PARTITION BY RANGE (order_accept_time);
+
+-- Строки месяцев без своей секции, см. create_order_partitions()
+CREATE TABLE orders_default PARTITION OF orders DEFAULT;
+CREATE TABLE print_orders_default PARTITION OF print_orders DEFAULT;
+CREATE TABLE service_orders_default PARTITION OF service_orders DEFAULT;
+CREATE TABLE frames_default PARTITION OF frames DEFAULT;
+
+ALTER SEQUENCE orders_id_seq OWNED BY orders.id;
+ALTER SEQUENCE service_orders_id_seq OWNED BY service_orders.id;
+ALTER SEQUENCE print_orders_id_seq OWNED BY print_orders.id;
+ALTER SEQUENCE frames_id_seq OWNED BY frames.id;
+
+SELECT create_order_partitions(
+    COALESCE(MIN(accept_time), LOCALTIMESTAMP),
+    GREATEST(MAX(accept_time), LOCALTIMESTAMP + INTERVAL '12 months')
+)
+FROM orders_unpartitioned;
+
+-- Триггеров на новых таблицах еще нет: данные переносятся как есть, без пересчета цен и расхода со склада
+INSERT INTO orders (id, accept_time, overall_price, is_urgent, outlet_id, client_id)
+SELECT id, accept_time, overall_price, is_urgent, outlet_id, client_id
+FROM orders_unpartitioned;
+
+INSERT INTO print_orders (id, order_id, order_accept_time, print_discount_id)
+SELECT po.id, po.order_id, o.accept_time, po.print_discount_id
+FROM print_orders_unpartitioned po
+JOIN orders_unpartitioned o ON o.id = po.order_id;
+
+INSERT INTO service_orders (id, count, order_id, order_accept_time, service_type_id)
+SELECT so.id, so.count, so.order_id, o.accept_time, so.service_type_id
+FROM service_orders_unpartitioned so
+JOIN orders_unpartitioned o ON o.id = so.order_id;
+
+INSERT INTO frames (id, amount, frame_number, print_order_id, order_accept_time, print_price_id)
+SELECT f.id, f.amount, f.frame_number, f.print_order_id, o.accept_time, f.print_price_id
+FROM frames_unpartitioned f
+JOIN print_orders_unpartitioned po ON po.id = f.print_order_id
+JOIN orders_unpartitioned o ON o.id = po.order_id;
+
+ALTER TABLE films ADD COLUMN order_accept_time TIMESTAMP;
+ALTER TABLE film_development_orders ADD COLUMN order_accept_time TIMESTAMP;
+
+UPDATE films f
+SET order_accept_time = so.order_accept_time
+FROM service_orders so
+WHERE so.id = f.service_order_id;
+
+UPDATE film_development_orders fdo
+SET order_accept_time = so.order_accept_time
+FROM service_orders so
+WHERE so.id = fdo.service_order_id;
+
+-- Вместе с внешними ключами films, film_development_orders и order_repricing_queue и всеми триггерами старых таблиц
+DROP TABLE frames_unpartitioned, print_orders_unpartitioned, service_orders_unpartitioned, orders_unpartitioned CASCADE;
+
+ALTER TABLE films
+    ALTER COLUMN order_accept_time SET NOT NULL,
+    ADD CONSTRAINT fk_film_service_order FOREIGN KEY (service_order_id, order_accept_time)
+        REFERENCES service_orders(id, order_accept_time) ON DELETE CASCADE ON UPDATE CASCADE;
+
+ALTER TABLE film_development_orders
+    ALTER COLUMN order_accept_time SET NOT NULL,
+    ADD CONSTRAINT fk_film_dev_service_order FOREIGN KEY (service_order_id, order_accept_time)
+        REFERENCES service_orders(id, order_accept_time) ON DELETE CASCADE ON UPDATE CASCADE;
+
+-- films и film_development_orders не секционированы, время приема заказа им подставляет триггер,
+-- так что вставка по-прежнему указывает только service_order_id.
+-- Каскадное обновление order_accept_time триггер не вызывает: UPDATE OF срабатывает только на service_order_id.
+CREATE OR REPLACE FUNCTION trg_fill_service_order_accept_time()
+RETURNS TRIGGER AS $$
+BEGIN
+    SELECT so.order_accept_time INTO NEW.order_accept_time
+    FROM service_orders so
+    WHERE so.id = NEW.service_order_id;
+
+    IF NOT FOUND THEN
+        RAISE EXCEPTION 'Не найден заказ услуги ID: %', NEW.service_order_id USING ERRCODE = 'foreign_key_violation';
+    END IF;
+
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER trg_before_films_fill_accept_time
+BEFORE INSERT OR UPDATE OF service_order_id ON films
+FOR EACH ROW
+EXECUTE FUNCTION trg_fill_service_order_accept_time();
+
+CREATE TRIGGER trg_before_film_development_orders_fill_accept_time
+BEFORE INSERT OR UPDATE OF service_order_id ON film_development_orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_fill_service_order_accept_time();
+
+-- Строка дочерней таблицы без order_accept_time попадает в секцию DEFAULT. Время берется у родительской строки,
+-- и строка вставляется заново через секционированную таблицу, которая направит ее в секцию месяца; исходная вставка
+-- пропускается. Строка с order_accept_time остается в DEFAULT: секции ее месяца еще нет.
+CREATE OR REPLACE FUNCTION trg_route_to_order_month()
+RETURNS TRIGGER AS $$
+DECLARE
+    v_table_name NAME := trigger_table_name(TG_RELID);
+BEGIN
+    IF NEW.order_accept_time IS NOT NULL THEN
+        RETURN NEW;
+    END IF;
+
+    IF v_table_name = 'frames' THEN
+        SELECT po.order_accept_time INTO NEW.order_accept_time FROM print_orders po WHERE po.id = NEW.print_order_id;
+    ELSE
+        SELECT o.accept_time INTO NEW.order_accept_time FROM orders o WHERE o.id = NEW.order_id;
+    END IF;
+
+    IF NEW.order_accept_time IS NULL THEN
+        RAISE EXCEPTION 'Не найден заказ для строки % ID: %', v_table_name, NEW.id USING ERRCODE = 'foreign_key_violation';
+    END IF;
+
+    EXECUTE format('INSERT INTO %I SELECT ($1).*', v_table_name) USING NEW;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER trg_before_print_orders_default_route
+BEFORE INSERT ON print_orders_default
+FOR EACH ROW
+EXECUTE FUNCTION trg_route_to_order_month();
+
+CREATE TRIGGER trg_before_service_orders_default_route
+BEFORE INSERT ON service_orders_default
+FOR EACH ROW
+EXECUTE FUNCTION trg_route_to_order_month();
+
+CREATE TRIGGER trg_before_frames_default_route
+BEFORE INSERT ON frames_default
+FOR EACH ROW
+EXECUTE FUNCTION trg_route_to_order_month();
+
+-- Построчные триггеры из 05-create-triggers.sql, оставшиеся после 08-statement-triggers.sql.
+-- Они срабатывают на секциях, поэтому функции определяют таблицу через trigger_table_name(), а не TG_TABLE_NAME
+CREATE TRIGGER trg_after_service_orders_items_use
+AFTER INSERT OR UPDATE ON service_orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_update_storage_quantity();
+
+CREATE TRIGGER trg_before_orders_insert_update_urgent
+BEFORE INSERT OR UPDATE OF is_urgent, outlet_id ON orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_enforce_urgent_orders_at_branches();
+
+-- Права из 04-init-roles.sql. Доступ к секциям проверяется по правам секционированной таблицы
+GRANT SELECT, INSERT ON TABLE orders, service_orders, print_orders, frames TO employee;
+GRANT SELECT, INSERT, UPDATE, DELETE ON TABLE orders, service_orders, print_orders, frames TO manager;
+
+COMMIT;
+
+-- Триггеры, индексы и уведомления новых таблиц - повторным запуском скриптов, которые их создают.
+-- Триггеры уровня оператора определены на секционированных таблицах, в них TG_TABLE_NAME - имя самой таблицы
+\ir 08-statement-triggers.sql
+\ir 10-report-indexes.sql
+\ir 11-daily-rollups.sql
+\ir 12-change-notify.sql
@@ -0,0 +1,508 @@
+\connect photo_center_db
+
+-- Журнал движения товаров вместо обновления storage_items при каждом приеме заказа.
+-- Построчный trg_update_storage_quantity() обновлял строку storage_items (товар, склад) на каждую вставку service_orders
+-- и delivery_items, а trg_check_storage_capacity() суммировал весь склад на каждое изменение storage_items. Заказы всех
+-- терминалов точки упирались в одни и те же строки склада (db_runner --simulate-orders показывает ожидания Lock:tuple).
+--
+-- Теперь:
+-- * service_orders и delivery_items только дописывают строки в inventory_movements, никого не блокируя;
+-- * storage_items - остатки на момент последней свертки журнала. Сворачивает compact_inventory_movements(),
+--   ее запускает db_runner --compact-inventory из планировщика задач или вручную;
+-- * текущий остаток - остаток плюс несвернутые движения, представление current_storage_stock. Это обычное чтение
+--   MVCC, оно не ждет пишущих и не мешает им;
+-- * емкость склада проверяется по storage_totals - сумме остатков склада и всех несвернутых движений, то есть по текущему
+--   остатку. Расход уменьшает ее сразу. Строка склада разбита на слоты: поставки пишут в слот 0 и проверяют емкость
+--   по сумме слотов, а расход - в слот своего сеанса, так что прием заказов на разных терминалах не ждет друг друга
+--   и поставок.
+--
+-- Изменение строки service_orders или delivery_items проводится сторно старой строки и проводкой новой:
+-- построчный триггер проводил новое количество еще раз целиком. Удаление проводится сторно.
+-- Скрипт можно выполнять повторно; database/pgbench/row-level-storage-triggers.sql возвращает старые триггеры для сравнения.
+
+BEGIN;
+
+CREATE TABLE IF NOT EXISTS inventory_movements (
+    id BIGSERIAL PRIMARY KEY,
+    storage_id INT NOT NULL,
+    item_id INT NOT NULL,
+    quantity INT NOT NULL,  -- поступление положительное, расход отрицательный
+    source_table TEXT NOT NULL,  -- 'delivery_items' или 'service_orders'
+    source_id INT NOT NULL,
+    created_at TIMESTAMP NOT NULL DEFAULT NOW(),
+    CONSTRAINT fk_inventory_movement_storage FOREIGN KEY (storage_id)
+        REFERENCES storages(id),
+    CONSTRAINT fk_inventory_movement_item FOREIGN KEY (item_id)
+        REFERENCES items(id)
+);
+
+-- Несвернутые движения склада для current_storage_stock
+CREATE INDEX IF NOT EXISTS idx_inventory_movements_storage_item
+    ON inventory_movements (storage_id, item_id);
+
+-- Изменения склада до конца скрипта ждут: storage_totals пересоздается и заполняется заново в конце
+LOCK TABLE storage_items, inventory_movements IN SHARE ROW EXCLUSIVE MODE;
+
+-- Сумма storage_items склада плюс несвернутые движения по слотам, текущий остаток склада - сумма его строк.
+-- Слот 0 - увеличения с проверкой емкости, слоты 1..8 - остальные изменения, слот выбирается по сеансу
+DROP TABLE IF EXISTS storage_totals;
+CREATE TABLE storage_totals (
+    storage_id INT NOT NULL,
+    slot SMALLINT NOT NULL,
+    quantity BIGINT NOT NULL DEFAULT 0,
+    PRIMARY KEY (storage_id, slot),
+    CONSTRAINT fk_storage_total_storage FOREIGN KEY (storage_id)
+        REFERENCES storages(id) ON DELETE CASCADE
+);
+
+-- inventory_movements, storage_totals (R для Vendor, Employee, Manager).
+-- Пишут в них только функции ниже (SECURITY DEFINER): заказы принимает employee, у которого нет прав на склад
+GRANT SELECT ON TABLE inventory_movements, storage_totals TO vendor, employee, manager;
+
+-- Транзакции, в которых идет свертка журнала. Пишет в таблицу только compact_inventory_movements(), прав на нее
+-- ни у кого нет: в отличие от параметра сеанса, пропуск обновления storage_totals нельзя включить снаружи
+CREATE UNLOGGED TABLE IF NOT EXISTS inventory_compaction_xacts (
+    xact_id xid8 PRIMARY KEY
+);
+
+-- Прибавляет к storage_totals изменения по складам. Если p_check_capacity, увеличения идут в слот 0 и проверяется
+-- емкость складов, сумма которых выросла: строка слота 0 заблокирована до конца транзакции, так что одновременные
+-- поставки на склад проверяются по очереди, а незафиксированный расход других сеансов не виден и делает проверку
+-- только строже. Остальные изменения идут в слот сеанса без проверки: расход и сторно не переполняют склад.
+-- Склады идут в порядке id, чтобы одновременные изменения нескольких складов не взаимоблокировались.
+-- Вызывать ее могут только функции этого скрипта.
+DROP FUNCTION IF EXISTS add_to_storage_totals(INT[], BIGINT[]);
+CREATE OR REPLACE FUNCTION add_to_storage_totals(
+    p_storage_ids INT[],
+    p_quantities BIGINT[],
+    p_check_capacity BOOLEAN
+)
+RETURNS VOID AS $$
+DECLARE
+    v_storage_id INT;
+    v_storage_capacity INT;
+    v_new_total_quantity BIGINT;
+BEGIN
+    INSERT INTO storage_totals (storage_id, slot, quantity)
+    SELECT c.storage_id,
+           CASE WHEN p_check_capacity AND c.quantity > 0 THEN 0 ELSE 1 + pg_backend_pid() % 8 END,
+           c.quantity
+    FROM unnest(p_storage_ids, p_quantities) AS c(storage_id, quantity)
+    WHERE c.quantity <> 0
+    ORDER BY c.storage_id
+    ON CONFLICT (storage_id, slot) DO UPDATE
+    SET quantity = storage_totals.quantity + EXCLUDED.quantity;
+
+    IF NOT p_check_capacity THEN
+        RETURN;
+    END IF;
+
+    SELECT s.id, s.capacity, t.quantity
+    INTO v_storage_id, v_storage_capacity, v_new_total_quantity
+    FROM unnest(p_storage_ids, p_quantities) AS c(storage_id, quantity)
+    JOIN storages s ON s.id = c.storage_id
+    CROSS JOIN LATERAL (
+        SELECT SUM(st.quantity) AS quantity FROM storage_totals st WHERE st.storage_id = c.storage_id
+    ) t
+    WHERE c.quantity > 0 AND t.quantity > s.capacity
+    LIMIT 1;
+
+    IF FOUND THEN
+        RAISE EXCEPTION 'Превышена емкость склада (ID: %). Допустимая емкость: %, текущая + новое количество: %', v_storage_id, v_storage_capacity, v_new_total_quantity;
+    END IF;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+REVOKE EXECUTE ON FUNCTION add_to_storage_totals(INT[], BIGINT[], BOOLEAN) FROM PUBLIC;
+
+-- Поддержание storage_totals по таблицам переходов storage_items и inventory_movements.
+-- Заменяет построчный trg_check_storage_capacity(), который суммировал склад на каждое изменение storage_items.
+-- Емкость проверяют поставки и изменения storage_items, расход услуг идет без проверки.
+-- Свертка (ее транзакция есть в inventory_compaction_xacts) лишь переносит движения в storage_items и сумму не меняет:
+-- ее изменения пропускаются, удаленные ею отрицательные остатки compact_inventory_movements() учитывает сама
+CREATE OR REPLACE FUNCTION trg_update_storage_totals()
+RETURNS TRIGGER AS $$
+DECLARE
+    v_storage_ids INT[];
+    v_quantities BIGINT[];
+    v_unchecked_storage_ids INT[];
+    v_unchecked_quantities BIGINT[];
+BEGIN
+    IF EXISTS (SELECT 1 FROM inventory_compaction_xacts WHERE xact_id = pg_current_xact_id()) THEN
+        RETURN NULL;
+    END IF;
+
+    IF TG_TABLE_NAME = 'storage_items' THEN
+        IF TG_OP = 'INSERT' THEN
+            SELECT array_agg(storage_id), array_agg(quantity) INTO v_storage_ids, v_quantities
+            FROM (SELECT storage_id, SUM(quantity) AS quantity FROM new_rows GROUP BY storage_id) c;
+        ELSIF TG_OP = 'UPDATE' THEN
+            SELECT array_agg(storage_id), array_agg(quantity) INTO v_storage_ids, v_quantities
+            FROM (
+                SELECT storage_id, SUM(quantity) AS quantity
+                FROM (
+                    SELECT storage_id, quantity FROM new_rows
+                    UNION ALL
+                    SELECT storage_id, -quantity FROM old_rows
+                ) d
+                GROUP BY storage_id
+            ) c;
+        ELSE
+            SELECT array_agg(storage_id), array_agg(quantity) INTO v_storage_ids, v_quantities
+            FROM (SELECT storage_id, -SUM(quantity) AS quantity FROM old_rows GROUP BY storage_id) c;
+        END IF;
+    ELSIF TG_OP = 'INSERT' THEN
+        -- Поставки проверяются, расход и сторно нет
+        SELECT array_agg(storage_id) FILTER (WHERE is_delivery), array_agg(quantity) FILTER (WHERE is_delivery),
+               array_agg(storage_id) FILTER (WHERE NOT is_delivery), array_agg(quantity) FILTER (WHERE NOT is_delivery)
+        INTO v_storage_ids, v_quantities, v_unchecked_storage_ids, v_unchecked_quantities
+        FROM (
+            SELECT storage_id, source_table = 'delivery_items' AS is_delivery, SUM(quantity) AS quantity
+            FROM new_rows
+            GROUP BY 1, 2
+        ) c;
+    ELSE
+        -- Удаление движений вне свертки
+        SELECT array_agg(storage_id), array_agg(quantity) INTO v_unchecked_storage_ids, v_unchecked_quantities
+        FROM (SELECT storage_id, -SUM(quantity) AS quantity FROM old_rows GROUP BY storage_id) c;
+    END IF;
+
+    IF v_storage_ids IS NOT NULL THEN
+        PERFORM add_to_storage_totals(v_storage_ids, v_quantities, TRUE);
+    END IF;
+    IF v_unchecked_storage_ids IS NOT NULL THEN
+        PERFORM add_to_storage_totals(v_unchecked_storage_ids, v_unchecked_quantities, FALSE);
+    END IF;
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Проводки по набору delivery_items, замена версии из 07-bulk-load.sql.
+-- SECURITY DEFINER: вызывают триггеры от имени любой роли и массовая загрузка
+CREATE OR REPLACE FUNCTION apply_delivery_items_to_storage(
+    p_delivery_item_ids INT[]
+)
+RETURNS VOID AS $$
+BEGIN
+    INSERT INTO inventory_movements (storage_id, item_id, quantity, source_table, source_id)
+    SELECT d.storage_id, di.item_id, di.quantity, 'delivery_items', di.id
+    FROM delivery_items di
+    JOIN deliveries d ON di.delivery_id = d.id
+    WHERE di.id = ANY(p_delivery_item_ids) AND di.quantity <> 0
+    ORDER BY di.id;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Проводки расхода по набору service_orders, замена версии из 07-bulk-load.sql
+CREATE OR REPLACE FUNCTION apply_service_orders_to_storage(
+    p_service_order_ids INT[]
+)
+RETURNS VOID AS $$
+DECLARE
+    v_outlet_id INT;
+BEGIN
+    SELECT o.outlet_id INTO v_outlet_id
+    FROM service_orders so
+    JOIN orders o ON so.order_id = o.id AND so.order_accept_time = o.accept_time
+    WHERE so.id = ANY(p_service_order_ids)
+      AND NOT EXISTS (SELECT 1 FROM storages s WHERE s.outlet_id = o.outlet_id)
+    LIMIT 1;
+
+    IF FOUND THEN
+        RAISE EXCEPTION 'Не найдено хранилище для торговой точки заказа ID: %', v_outlet_id;
+    END IF;
+
+    INSERT INTO inventory_movements (storage_id, item_id, quantity, source_table, source_id)
+    SELECT s.id, stni.item_id, -SUM(stni.count * so.count)::INT, 'service_orders', so.id
+    FROM service_orders so
+    JOIN orders o ON so.order_id = o.id AND so.order_accept_time = o.accept_time
+    JOIN LATERAL (
+        SELECT MIN(st.id) AS id FROM storages st WHERE st.outlet_id = o.outlet_id
+    ) s ON TRUE
+    JOIN service_types_needed_items stni ON stni.service_type_id = so.service_type_id
+    WHERE so.id = ANY(p_service_order_ids)
+    GROUP BY so.id, s.id, stni.item_id
+    HAVING SUM(stni.count * so.count) <> 0
+    ORDER BY so.id;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Проводки по вставленным, измененным и удаленным delivery_items и service_orders.
+-- Вставка проводится теми же функциями, что и отложенные триггеры массовой загрузки (BulkLoader.cpp).
+-- Изменение сторнирует старую строку по old_rows (ее значений в таблице уже нет) и проводит новую. Строки, у которых
+-- количество и товар не менялись, пропускаются: для таблиц переходов нельзя указать UPDATE OF.
+-- Удаление только сторнирует. Услуги, удаленные каскадом вместе с заказом, сторнирует trg_reverse_order_service_movements():
+-- здесь заказа уже нет, и по нему не найти склад
+CREATE OR REPLACE FUNCTION trg_post_inventory_movements()
+RETURNS TRIGGER AS $$
+DECLARE
+    v_ids INT[];
+BEGIN
+    IF TG_TABLE_NAME = 'delivery_items' THEN
+        IF TG_OP = 'INSERT' THEN
+            v_ids := ARRAY(SELECT id FROM new_rows);
+        ELSE
+            IF TG_OP = 'UPDATE' THEN
+                v_ids := ARRAY(
+                    SELECT n.id
+                    FROM new_rows n
+                    JOIN old_rows od ON od.id = n.id
+                    WHERE (n.quantity, n.item_id, n.delivery_id) IS DISTINCT FROM (od.quantity, od.item_id, od.delivery_id)
+                );
+            ELSE
+                v_ids := ARRAY(SELECT id FROM old_rows);
+            END IF;
+
+            INSERT INTO inventory_movements (storage_id, item_id, quantity, source_table, source_id)
+            SELECT d.storage_id, od.item_id, -od.quantity, 'delivery_items', od.id
+            FROM old_rows od
+            JOIN deliveries d ON od.delivery_id = d.id
+            WHERE od.id = ANY(v_ids) AND od.quantity <> 0
+            ORDER BY od.id;
+        END IF;
+
+        IF TG_OP <> 'DELETE' THEN
+            PERFORM apply_delivery_items_to_storage(v_ids);
+        END IF;
+    ELSIF TG_TABLE_NAME = 'service_orders' THEN
+        IF TG_OP = 'INSERT' THEN
+            v_ids := ARRAY(SELECT id FROM new_rows);
+        ELSE
+            IF TG_OP = 'UPDATE' THEN
+                v_ids := ARRAY(
+                    SELECT n.id
+                    FROM new_rows n
+                    JOIN old_rows od ON od.id = n.id
+                    WHERE (n.count, n.service_type_id, n.order_id) IS DISTINCT FROM (od.count, od.service_type_id, od.order_id)
+                );
+            ELSE
+                v_ids := ARRAY(SELECT id FROM old_rows);
+            END IF;
+
+            INSERT INTO inventory_movements (storage_id, item_id, quantity, source_table, source_id)
+            SELECT s.id, stni.item_id, SUM(stni.count * od.count)::INT, 'service_orders', od.id
+            FROM old_rows od
+            JOIN orders o ON od.order_id = o.id AND od.order_accept_time = o.accept_time
+            JOIN LATERAL (
+                SELECT MIN(st.id) AS id FROM storages st WHERE st.outlet_id = o.outlet_id
+            ) s ON TRUE
+            JOIN service_types_needed_items stni ON stni.service_type_id = od.service_type_id
+            WHERE od.id = ANY(v_ids) AND s.id IS NOT NULL
+            GROUP BY od.id, s.id, stni.item_id
+            HAVING SUM(stni.count * od.count) <> 0
+            ORDER BY od.id;
+        END IF;
+
+        IF TG_OP <> 'DELETE' THEN
+            PERFORM apply_service_orders_to_storage(v_ids);
+        END IF;
+    END IF;
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Сторно расхода услуг удаляемого заказа, пока он еще виден: его service_orders удаляются каскадом уже без него
+CREATE OR REPLACE FUNCTION trg_reverse_order_service_movements()
+RETURNS TRIGGER AS $$
+BEGIN
+    INSERT INTO inventory_movements (storage_id, item_id, quantity, source_table, source_id)
+    SELECT s.id, stni.item_id, SUM(stni.count * so.count)::INT, 'service_orders', so.id
+    FROM service_orders so
+    JOIN LATERAL (
+        SELECT MIN(st.id) AS id FROM storages st WHERE st.outlet_id = OLD.outlet_id
+    ) s ON TRUE
+    JOIN service_types_needed_items stni ON stni.service_type_id = so.service_type_id
+    WHERE so.order_id = OLD.id AND so.order_accept_time = OLD.accept_time AND s.id IS NOT NULL
+    GROUP BY so.id, s.id, stni.item_id
+    HAVING SUM(stni.count * so.count) <> 0
+    ORDER BY so.id;
+
+    RETURN OLD;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Свертка очередной пачки движений в storage_items. Возвращает число свернутых движений, 0 - журнал пуст.
+-- SKIP LOCKED позволяет запускать несколько сверток одновременно, строки storage_items обновляются в порядке ключа,
+-- поэтому свертки не взаимоблокируются. Строки с остатком 0 и меньше удаляются, как и раньше.
+-- На время свертки ее транзакция записана в inventory_compaction_xacts, и триггеры storage_totals ее пропускают:
+-- перенос движений в storage_items сумму склада не меняет. Меняет ее только удаление отрицательных остатков, его
+-- разница проводится здесь же
+CREATE OR REPLACE FUNCTION compact_inventory_movements(
+    p_batch_size INT
+)
+RETURNS INT AS $$
+DECLARE
+    v_movement_count INT;
+    v_storage_ids INT[];
+    v_item_ids INT[];
+    v_removed_storage_ids INT[];
+    v_removed_quantities BIGINT[];
+BEGIN
+    INSERT INTO inventory_compaction_xacts (xact_id) VALUES (pg_current_xact_id());
+
+    WITH batch AS (
+        DELETE FROM inventory_movements m
+        WHERE m.id IN (
+            SELECT id
+            FROM inventory_movements
+            ORDER BY id
+            LIMIT p_batch_size
+            FOR UPDATE SKIP LOCKED
+        )
+        RETURNING m.storage_id, m.item_id, m.quantity
+    ),
+    folded AS (
+        SELECT storage_id, item_id, SUM(quantity)::INT AS quantity
+        FROM batch
+        GROUP BY storage_id, item_id
+    ),
+    upserted AS (
+        INSERT INTO storage_items (quantity, item_id, storage_id)
+        SELECT quantity, item_id, storage_id
+        FROM folded
+        ORDER BY item_id, storage_id
+        ON CONFLICT (item_id, storage_id) DO UPDATE
+        SET quantity = storage_items.quantity + EXCLUDED.quantity
+        RETURNING storage_id, item_id
+    )
+    SELECT (SELECT COUNT(*) FROM batch), array_agg(storage_id), array_agg(item_id)
+    INTO v_movement_count, v_storage_ids, v_item_ids
+    FROM upserted;
+
+    WITH removed AS (
+        DELETE FROM storage_items si
+        USING unnest(v_storage_ids, v_item_ids) AS k(storage_id, item_id)
+        WHERE si.storage_id = k.storage_id AND si.item_id = k.item_id AND si.quantity <= 0
+        RETURNING si.storage_id, si.quantity
+    )
+    SELECT array_agg(storage_id), array_agg(quantity) INTO v_removed_storage_ids, v_removed_quantities
+    FROM (SELECT storage_id, -SUM(quantity) AS quantity FROM removed GROUP BY storage_id) c;
+
+    IF v_removed_storage_ids IS NOT NULL THEN
+        PERFORM add_to_storage_totals(v_removed_storage_ids, v_removed_quantities, FALSE);
+    END IF;
+
+    DELETE FROM inventory_compaction_xacts WHERE xact_id = pg_current_xact_id();
+
+    RETURN v_movement_count;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Текущий остаток: свернутый остаток плюс несвернутые движения. balance и pending показывают, сколько из них где
+CREATE OR REPLACE VIEW current_storage_stock AS
+SELECT c.storage_id, c.item_id,
+       SUM(c.balance + c.pending) AS quantity,
+       SUM(c.balance) AS balance,
+       SUM(c.pending) AS pending
+FROM (
+    SELECT storage_id, item_id, quantity AS balance, 0 AS pending FROM storage_items
+    UNION ALL
+    SELECT storage_id, item_id, 0, quantity FROM inventory_movements
+) c
+GROUP BY c.storage_id, c.item_id;
+
+GRANT SELECT ON TABLE current_storage_stock TO vendor, employee, manager;
+
+-- Старые построчные триггеры склада
+DROP TRIGGER IF EXISTS trg_before_storage_items_insert_update ON storage_items;
+DROP TRIGGER IF EXISTS trg_after_delivery_items_change ON delivery_items;
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_use ON service_orders;
+
+-- Имена триггеров вставки прежние: массовая загрузка отключает их по имени и проводит загруженные строки сама
+CREATE TRIGGER trg_after_delivery_items_change
+AFTER INSERT ON delivery_items
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+DROP TRIGGER IF EXISTS trg_after_delivery_items_update ON delivery_items;
+CREATE TRIGGER trg_after_delivery_items_update
+AFTER UPDATE ON delivery_items
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+CREATE TRIGGER trg_after_service_orders_items_use
+AFTER INSERT ON service_orders
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_update ON service_orders;
+CREATE TRIGGER trg_after_service_orders_items_update
+AFTER UPDATE ON service_orders
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+DROP TRIGGER IF EXISTS trg_after_delivery_items_delete ON delivery_items;
+CREATE TRIGGER trg_after_delivery_items_delete
+AFTER DELETE ON delivery_items
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+DROP TRIGGER IF EXISTS trg_after_service_orders_items_delete ON service_orders;
+CREATE TRIGGER trg_after_service_orders_items_delete
+AFTER DELETE ON service_orders
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_post_inventory_movements();
+
+DROP TRIGGER IF EXISTS trg_before_orders_delete_reverse_items ON orders;
+CREATE TRIGGER trg_before_orders_delete_reverse_items
+BEFORE DELETE ON orders
+FOR EACH ROW
+EXECUTE FUNCTION trg_reverse_order_service_movements();
+
+-- Триггеры storage_totals. TRUNCATE storage_items их обходит, после него скрипт нужно выполнить повторно
+DROP TRIGGER IF EXISTS trg_after_storage_items_insert ON storage_items;
+CREATE TRIGGER trg_after_storage_items_insert
+AFTER INSERT ON storage_items
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_update_storage_totals();
+
+DROP TRIGGER IF EXISTS trg_after_storage_items_update ON storage_items;
+CREATE TRIGGER trg_after_storage_items_update
+AFTER UPDATE ON storage_items
+REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_update_storage_totals();
+
+DROP TRIGGER IF EXISTS trg_after_storage_items_delete ON storage_items;
+CREATE TRIGGER trg_after_storage_items_delete
+AFTER DELETE ON storage_items
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_update_storage_totals();
+
+DROP TRIGGER IF EXISTS trg_after_inventory_movements_insert ON inventory_movements;
+CREATE TRIGGER trg_after_inventory_movements_insert
+AFTER INSERT ON inventory_movements
+REFERENCING NEW TABLE AS new_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_update_storage_totals();
+
+DROP TRIGGER IF EXISTS trg_after_inventory_movements_delete ON inventory_movements;
+CREATE TRIGGER trg_after_inventory_movements_delete
+AFTER DELETE ON inventory_movements
+REFERENCING OLD TABLE AS old_rows
+FOR EACH STATEMENT
+EXECUTE FUNCTION trg_update_storage_totals();
+
+-- Начальное заполнение storage_totals, склад заблокирован с начала скрипта
+INSERT INTO storage_totals (storage_id, slot, quantity)
+SELECT s.id, 0,
+       COALESCE((SELECT SUM(si.quantity) FROM storage_items si WHERE si.storage_id = s.id), 0) +
+       COALESCE((SELECT SUM(m.quantity) FROM inventory_movements m WHERE m.storage_id = s.id), 0)
+FROM storages s;
+
+COMMIT;
+
+ANALYZE inventory_movements, storage_totals;
+
+-- Уведомления об изменении новых таблиц для клиентского кэша
+\ir 12-change-notify.sql